@@ -36,7 +36,10 @@
 #include "luxrays/utils/mc.h"
 
 #include <fstream>
+#include <sstream>
+#include <iterator>
 using std::ifstream;
+using std::ofstream;
 
 using namespace luxrays;
 using namespace lux;
@@ -46,7 +49,8 @@ RealisticCamera::RealisticCamera(const MotionSystem &world2cam,
 				 float hither, float yon, 
 				 float sopen, float sclose, int sdist,
 				 float filmdistance, float aperture_diameter, string specfile, 
-				 float filmdiag, Film *f)
+				 float filmdiag, bool rayTransfer, u_int rayTransferResolution,
+				 const string &rayTransferCacheFile, Film *f)
 	: Camera(world2cam, hither, yon, sopen, sclose, sdist, f) 
 {
     filmDistance = filmdistance;
@@ -68,6 +72,10 @@ RealisticCamera::RealisticCamera(const MotionSystem &world2cam,
     RasterToFilm = Inverse(FilmToRaster);
     FilmToCamera = Translate(Vector(0.f, 0.f, -filmDistance - distToBack));
     RasterToCamera =  FilmToCamera * RasterToFilm;
+
+	rayTransferRes = max(rayTransferResolution, 2U);
+	if (rayTransfer)
+		InitRayTransferTable(specfile, rayTransferCacheFile);
 }   
 RealisticCamera::~RealisticCamera(void) {
 }
@@ -91,6 +99,21 @@ float RealisticCamera::GenerateRay(const Sample &sample, Ray *ray) const {
     cos4 *= cos4;
     cos4 *= cos4;
 
+    // Use the ray transfer table if available, trace the lens components
+    // otherwise
+    if (!(rayTransferTable.size() > 0 && LookUpRayTransfer(PCamera, lensU, lensV, ray)) &&
+        !TraceLenses(ray)) {
+        // return dead ray
+        ray->mint = 1.f;
+        ray->maxt = 0.f;
+        return 1.f;
+    }
+    ray->maxt = (ClipYon - ClipHither) / ray->d.z;
+    *ray *= CameraToWorld;
+    return cos4 / filmDist2;
+}
+
+bool RealisticCamera::TraceLenses(Ray *ray) const {
     // Iterate over the lens components, and intersect
     DifferentialGeometry dg;
     float thit;
@@ -101,11 +124,8 @@ float RealisticCamera::GenerateRay(const Sample &sample, Ray *ray) const {
             float eta = lenses[i]->eta;
             float cos_i = Dot(-ray->d, n);
             float sint2 = (eta * eta * (1 - cos_i*cos_i));
-            if (sint2 > 1.) { // total internal reflection, return dead ray
-                ray->mint = 1.f;
-                ray->maxt = 0.f;
-                return 1.f;
-            }
+            if (sint2 > 1.) // total internal reflection
+                return false;
             // use snell's law
             float cost = sqrtf(max(0.f, 1.f - sint2));
             float nscale = eta * cos_i - cost;
@@ -118,15 +138,10 @@ float RealisticCamera::GenerateRay(const Sample &sample, Ray *ray) const {
             ray->mint = 0.f;
             ray->maxt = INFINITY;
         }
-        else { // no intersection, return dead ray
-            ray->mint = 1.f;
-            ray->maxt = 0.f;
-            return 1.f;
-        }
+        else // no intersection
+            return false;
     }
-    ray->maxt = (ClipYon - ClipHither) / ray->d.z;
-    *ray *= CameraToWorld;
-    return cos4 / filmDist2;
+    return true;
 }
 
 float RealisticCamera::ParseLensData(const string& specfile) {
@@ -190,6 +205,286 @@ float RealisticCamera::ParseLensData(const string& specfile) {
     return accumdist;
 }
 
+//------------------------------------------------------------------------------
+// Ray transfer table
+//------------------------------------------------------------------------------
+
+bool RealisticCamera::LookUpRayTransfer(const Point &pCamera, float lensU,
+	float lensV, Ray *ray) const
+{
+	// Rotate the back lens point in the plane including the film point and
+	// the axis
+	const float r = sqrtf(pCamera.x * pCamera.x + pCamera.y * pCamera.y);
+	float cosPhi = 1.f, sinPhi = 0.f;
+	if (r > 0.f) {
+		cosPhi = pCamera.x / r;
+		sinPhi = pCamera.y / r;
+	}
+	const float u = cosPhi * lensU + sinPhi * lensV;
+	const float v = cosPhi * lensV - sinPhi * lensU;
+
+	const u_int n = rayTransferRes;
+	const float fr = r * rayTransferRScale;
+	const float fu = (u + backAperture) * rayTransferUVScale;
+	const float fv = (v + backAperture) * rayTransferUVScale;
+	if (!(fr < n - 1) || !(fu >= 0.f) || !(fu < n - 1) ||
+		!(fv >= 0.f) || !(fv < n - 1))
+		return false;
+
+	const u_int ir = Floor2UInt(fr);
+	const u_int iu = Floor2UInt(fu);
+	const u_int iv = Floor2UInt(fv);
+	if (!rayTransferCellValid[(ir * (n - 1) + iu) * (n - 1) + iv])
+		return false;
+
+	// Trilinear interpolation of the vertices of the cell
+	const float dr = fr - ir, du = fu - iu, dv = fv - iv;
+	float t[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+	for (u_int c = 0; c < 8; ++c) {
+		const float w = ((c & 4) ? dr : 1.f - dr) *
+			((c & 2) ? du : 1.f - du) * ((c & 1) ? dv : 1.f - dv);
+		const float *e = &rayTransferTable[(((ir + ((c >> 2) & 1)) * n +
+			iu + ((c >> 1) & 1)) * n + iv + (c & 1)) * 6];
+		for (u_int k = 0; k < 6; ++k)
+			t[k] += w * e[k];
+	}
+
+	// Rotate back the ray in the film point plane
+	ray->o = Point(cosPhi * t[0] - sinPhi * t[1],
+		sinPhi * t[0] + cosPhi * t[1], t[2]);
+	ray->d = Normalize(Vector(cosPhi * t[3] - sinPhi * t[4],
+		sinPhi * t[3] + cosPhi * t[4], t[5]));
+	ray->mint = 0.f;
+	ray->maxt = INFINITY;
+
+	return true;
+}
+
+void RealisticCamera::InitRayTransferTable(const string &specfile,
+	const string &cacheFile)
+{
+	// The table covers the whole film diagonal and back lens aperture
+	rayTransferRadius = filmDiag * .5001f;
+	rayTransferRScale = (rayTransferRes - 1) / rayTransferRadius;
+	rayTransferUVScale = (rayTransferRes - 1) / (2.f * backAperture);
+
+	// The cache is valid only for the same lens system and table settings
+	std::ostringstream key;
+	key.precision(9);
+	key << "resolution " << rayTransferRes << " filmdistance " <<
+		filmDistance << " aperture_diameter " << apertureDiameter <<
+		" filmdiag " << filmDiag << "\n";
+	ifstream lensFile(specfile.c_str());
+	key << string(std::istreambuf_iterator<char>(lensFile),
+		std::istreambuf_iterator<char>());
+
+	if (cacheFile == "" || !LoadRayTransferTable(cacheFile, key.str())) {
+		const double start = luxrays::WallClockTime();
+		BuildRayTransferTable();
+		LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table " <<
+			rayTransferRes << "^3 built in " <<
+			luxrays::WallClockTime() - start << " secs";
+
+		if (cacheFile != "")
+			SaveRayTransferTable(cacheFile, key.str());
+	}
+
+	ReportRayTransferAccuracy();
+}
+
+void RealisticCamera::BuildRayTransferTable()
+{
+	// The blocked rays are searched on a grid with half the cell size of the
+	// table so a vignetting edge crossing a cell is detected even if all
+	// the vertices of the cell are unblocked
+	const u_int n = rayTransferRes;
+	const u_int m = 2 * n - 1;
+	rayTransferTable.resize(n * n * n * 6);
+	vector<u_char> rayValid(m * m * m);
+
+	for (u_int jr = 0; jr < m; ++jr) {
+		const float r = .5f * jr / rayTransferRScale;
+		for (u_int ju = 0; ju < m; ++ju) {
+			const float u = .5f * ju / rayTransferUVScale - backAperture;
+			for (u_int jv = 0; jv < m; ++jv) {
+				const float v = .5f * jv / rayTransferUVScale - backAperture;
+
+				// The film point is on the x axis
+				Ray ray;
+				ray.o = Point(r, 0.f, -filmDistance - distToBack);
+				ray.d = Normalize(Point(u, v, -distToBack) - ray.o);
+				ray.mint = 0.f;
+				ray.maxt = INFINITY;
+
+				rayValid[(jr * m + ju) * m + jv] = TraceLenses(&ray);
+
+				// Only the even rays are vertices of the table
+				if ((jr & 1) || (ju & 1) || (jv & 1))
+					continue;
+				float *e = &rayTransferTable[(((jr >> 1) * n + (ju >> 1)) * n + (jv >> 1)) * 6];
+				e[0] = ray.o.x;
+				e[1] = ray.o.y;
+				e[2] = ray.o.z;
+				e[3] = ray.d.x;
+				e[4] = ray.d.y;
+				e[5] = ray.d.z;
+			}
+		}
+	}
+
+	// A cell can be used only if all the rays traced inside it are not
+	// blocked
+	rayTransferCellValid.resize((n - 1) * (n - 1) * (n - 1));
+	for (u_int ir = 0; ir < n - 1; ++ir) {
+		for (u_int iu = 0; iu < n - 1; ++iu) {
+			for (u_int iv = 0; iv < n - 1; ++iv) {
+				bool valid = true;
+				for (u_int c = 0; c < 27; ++c)
+					valid = valid && rayValid[((2 * ir + c / 9) * m +
+						2 * iu + (c / 3) % 3) * m + 2 * iv + c % 3];
+				rayTransferCellValid[(ir * (n - 1) + iu) * (n - 1) + iv] = valid;
+			}
+		}
+	}
+}
+
+static const char rayTransferMagic[8] = { 'L', 'X', 'R', 'T', 'T', '0', '0', '2' };
+
+bool RealisticCamera::LoadRayTransferTable(const string &cacheFile,
+	const string &key)
+{
+	ifstream file(cacheFile.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+		return false;
+
+	char magic[8];
+	u_int keySize = 0;
+	file.read(magic, 8);
+	file.read(reinterpret_cast<char *>(&keySize), sizeof(u_int));
+	if (!file || !std::equal(magic, magic + 8, rayTransferMagic) ||
+		keySize != key.size())
+		return false;
+	string fileKey(keySize, ' ');
+	file.read(&fileKey[0], keySize);
+	if (!file || fileKey != key) {
+		LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table cache '" <<
+			cacheFile << "' is out of date";
+		return false;
+	}
+
+	const u_int n = rayTransferRes;
+	rayTransferTable.resize(n * n * n * 6);
+	rayTransferCellValid.resize((n - 1) * (n - 1) * (n - 1));
+	file.read(reinterpret_cast<char *>(&rayTransferTable[0]),
+		rayTransferTable.size() * sizeof(float));
+	file.read(reinterpret_cast<char *>(&rayTransferCellValid[0]),
+		rayTransferCellValid.size());
+	if (!file) {
+		LOG(LUX_WARNING, LUX_BADFILE) << "Error while reading realistic camera ray transfer table cache '" <<
+			cacheFile << "'";
+		rayTransferTable.clear();
+		rayTransferCellValid.clear();
+		return false;
+	}
+
+	LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table loaded from '" <<
+		cacheFile << "'";
+	return true;
+}
+
+void RealisticCamera::SaveRayTransferTable(const string &cacheFile,
+	const string &key) const
+{
+	ofstream file(cacheFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	const u_int keySize = key.size();
+	file.write(rayTransferMagic, 8);
+	file.write(reinterpret_cast<const char *>(&keySize), sizeof(u_int));
+	file.write(key.data(), keySize);
+	file.write(reinterpret_cast<const char *>(&rayTransferTable[0]),
+		rayTransferTable.size() * sizeof(float));
+	file.write(reinterpret_cast<const char *>(&rayTransferCellValid[0]),
+		rayTransferCellValid.size());
+
+	if (!file)
+		LOG(LUX_WARNING, LUX_SYSTEM) << "Unable to write realistic camera ray transfer table cache '" <<
+			cacheFile << "'";
+}
+
+void RealisticCamera::ReportRayTransferAccuracy() const
+{
+	// Compare the table with the exact tracing of the same rays
+	const u_int sampleCount = 16384;
+	RandomGenerator rng(1);
+	vector<Point> pCameras(sampleCount);
+	vector<float> lensUs(sampleCount), lensVs(sampleCount);
+	vector<Ray> exactRays(sampleCount), tableRays(sampleCount);
+	for (u_int i = 0; i < sampleCount; ++i) {
+		const Point pRaster(rng.floatValue() * film->xResolution,
+			rng.floatValue() * film->yResolution, 0.f);
+		pCameras[i] = RasterToCamera * pRaster;
+		ConcentricSampleDisk(rng.floatValue(), rng.floatValue(),
+			&lensUs[i], &lensVs[i]);
+		lensUs[i] *= backAperture;
+		lensVs[i] *= backAperture;
+
+		exactRays[i].o = pCameras[i];
+		exactRays[i].d = Normalize(Point(lensUs[i], lensVs[i], -distToBack) -
+			pCameras[i]);
+		exactRays[i].mint = 0.f;
+		exactRays[i].maxt = INFINITY;
+		tableRays[i] = exactRays[i];
+	}
+
+	vector<bool> exactValid(sampleCount), tableValid(sampleCount);
+	double start = luxrays::WallClockTime();
+	for (u_int i = 0; i < sampleCount; ++i)
+		exactValid[i] = TraceLenses(&exactRays[i]);
+	const double traceTime = luxrays::WallClockTime() - start;
+	start = luxrays::WallClockTime();
+	for (u_int i = 0; i < sampleCount; ++i)
+		tableValid[i] = LookUpRayTransfer(pCameras[i], lensUs[i], lensVs[i],
+			&tableRays[i]);
+	const double tableTime = luxrays::WallClockTime() - start;
+
+	u_int tableCount = 0, blockedCount = 0;
+	double originError = 0.0, directionError = 0.0;
+	float maxOriginError = 0.f, maxDirectionError = 0.f;
+	for (u_int i = 0; i < sampleCount; ++i) {
+		if (!tableValid[i])
+			continue;
+		++tableCount;
+		// All the rays traced inside a table cell are unblocked but a
+		// feature smaller than half a cell can still block a ray
+		if (!exactValid[i]) {
+			++blockedCount;
+			continue;
+		}
+
+		const float oe = Distance(exactRays[i].o, tableRays[i].o);
+		const float de = Degrees(acosf(Clamp(Dot(exactRays[i].d,
+			tableRays[i].d), -1.f, 1.f)));
+		originError += oe;
+		directionError += de;
+		maxOriginError = max(maxOriginError, oe);
+		maxDirectionError = max(maxDirectionError, de);
+	}
+
+	const u_int validCount = max(tableCount - blockedCount, 1U);
+	LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table: " <<
+		(100.f * tableCount) / sampleCount << "% of the rays from the table (" <<
+		blockedCount << " blocked rays not detected)";
+	if (blockedCount > 0)
+		LOG(LUX_WARNING, LUX_NOERROR) << "Realistic camera ray transfer table lets " <<
+			(100.f * blockedCount) / sampleCount << "% of the blocked rays through the lens " <<
+			"system, increase raytransferresolution to reduce the light leaks";
+	LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table error: origin avg. " <<
+		originError / validCount << "mm max. " << maxOriginError <<
+		"mm, direction avg. " << directionError / validCount << " max. " <<
+		maxDirectionError << " degrees";
+	LOG(LUX_INFO, LUX_NOERROR) << "Realistic camera ray transfer table look up is " <<
+		traceTime / max(tableTime, 1e-9) << " times faster than lens tracing";
+}
+
 Camera* RealisticCamera::CreateCamera(const MotionSystem &world2cam, 
 	const ParamSet &params,	Film *film)
 {
@@ -213,6 +508,12 @@ Camera* RealisticCamera::CreateCamera(const MotionSystem &world2cam,
 	float filmdistance = params.FindOneFloat("filmdistance", 70.0); // about 70 mm default to film
  	float fstop = params.FindOneFloat("aperture_diameter", 1.0);	
 	float filmdiag = params.FindOneFloat("filmdiag", 35.0);
+	// Optional precomputed ray transfer table. It is a biased approximation:
+	// the rays are interpolated and a ray blocked by a lens feature smaller
+	// than half a table cell (i.e. the edge of a tiny stop) reaches the film
+	bool rayTransfer = params.FindOneBool("raytransfertable", false);
+	int rayTransferResolution = params.FindOneInt("raytransferresolution", 64);
+	string rayTransferCacheFile = params.FindOneString("raytransfercache", "");
 
 	if (specfile == "") {
 	    printf( "No lens spec file supplied!\n" );
@@ -234,7 +535,8 @@ Camera* RealisticCamera::CreateCamera(const MotionSystem &world2cam,
     }
 	return new RealisticCamera(world2cam, screen, hither, yon,
 				   shutteropen, shutterclose, shutterdist, filmdistance, fstop, 
-				   specfile, filmdiag, film);
+				   specfile, filmdiag, rayTransfer, max(rayTransferResolution, 2),
+				   rayTransferCacheFile, film);
 }
 
 static DynamicLoader::RegisterCamera<RealisticCamera> r("realistic");
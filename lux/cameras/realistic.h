@@ -43,7 +43,8 @@ public:
 		const float Screen[4],
 		float hither, float yon, float sopen, float sclose, int sdist,
 		float filmdistance, float aperture_diameter, string specfile,
-		float filmdiag, Film *film);
+		float filmdiag, bool rayTransfer, u_int rayTransferRes,
+		const string &rayTransferCacheFile, Film *film);
 	virtual ~RealisticCamera(void);
 	virtual float GenerateRay(const Sample &sample, Ray *) const;
 	virtual bool SampleW(luxrays::MemoryArena &arena, const SpectrumWavelengths &sw,
@@ -70,12 +71,38 @@ public:
   
 private:
 	float ParseLensData(const string& specfile);
+	// Traces the ray through all lens elements, returns false if the ray
+	// is blocked
+	bool TraceLenses(Ray *ray) const;
+
+	// The lens system is rotationally symmetric so the rays leaving the
+	// front element can be tabulated as a function of the distance of the
+	// film point from the axis and of the back lens point, rotated in the
+	// plane including the film point and the axis. Rays falling in a cell
+	// including a blocked ray, searched with half the cell size, are traced
+	// through the lens elements. Lens features smaller than that are not
+	// detected and let some light through: this is a known bias of the table.
+	void InitRayTransferTable(const string &specfile, const string &cacheFile);
+	void BuildRayTransferTable();
+	bool LoadRayTransferTable(const string &cacheFile, const string &key);
+	void SaveRayTransferTable(const string &cacheFile, const string &key) const;
+	void ReportRayTransferAccuracy() const;
+	// Returns false if the ray can not be computed with the table
+	bool LookUpRayTransfer(const Point &pCamera, float lensU, float lensV,
+		Ray *ray) const;
 
 	float filmDistance, filmDist2, filmDiag;
 	float apertureDiameter, distToBack, backAperture;
  
 	vector<boost::shared_ptr<Lens> > lenses;
 
+	u_int rayTransferRes;
+	float rayTransferRadius, rayTransferRScale, rayTransferUVScale;
+	// Origin and direction of the ray leaving the lens system for each
+	// vertex of the table
+	vector<float> rayTransferTable;
+	vector<u_char> rayTransferCellValid;
+
 	Transform RasterToFilm, RasterToCamera, FilmToCamera;
 };
 
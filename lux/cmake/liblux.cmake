@@ -77,6 +77,7 @@ SET(lux_core_src
 	core/photonmap.cpp
 	core/pngio.cpp
 	core/primitive.cpp
+	core/renderercounters.cpp
 	core/rendererstatistics.cpp
 	core/renderfarm.cpp
 	core/renderinghints.cpp
@@ -504,6 +505,7 @@ SET(lux_core_hdr
 	core/primitive.h
 	core/randomgen.h
 	core/renderer.h
+	core/renderercounters.h
 	core/rendererstatistics.h
 	core/renderfarm.h
 	core/renderinghints.h
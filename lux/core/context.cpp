@@ -110,6 +110,13 @@ boost::shared_ptr<lux::Texture<FresnelGeneral> > lux::Context::GetFresnelTexture
 	}
 	return boost::shared_ptr<lux::Texture<FresnelGeneral> >();
 }
+string lux::Context::GetTextureKey(const string &type, const string &n) const
+{
+	map<string, string>::const_iterator it = graphicsState->textureKeys.find(type + " " + n);
+	if (it == graphicsState->textureKeys.end())
+		return "";
+	return it->second;
+}
 boost::shared_ptr<lux::Material > lux::Context::GetMaterial(const string &n) const
 {
 	if (n != "") {
@@ -512,7 +519,33 @@ void lux::Context::Texture(const string &n, const string &type,
 			graphicsState->fresnelTextures[n] = fr;
 	} else {
 		LOG(LUX_ERROR,LUX_SYNTAX) << "Texture type '" << type << "' unknown";
+		return;
+	}
+
+	// Build the definition key of the texture: it includes the keys of the
+	// referenced textures (already defined) and the image file date and size
+	// so editing any of them changes the key
+	std::stringstream key;
+	key.precision(9);
+	key << texname << " " << curTransform.StaticTransform() << " " << params.ToString();
+	const vector<string> texNames(params.GetTextureNames());
+	for (u_int i = 0; i < texNames.size(); ++i) {
+		key << " [" << GetTextureKey("float", texNames[i]) <<
+			"] [" << GetTextureKey("color", texNames[i]) <<
+			"] [" << GetTextureKey("fresnel", texNames[i]) << "]";
+	}
+	const string fileName(params.FindOneString("filename", ""));
+	if (fileName != "") {
+		try {
+			const boost::filesystem::path filePath(AdjustFilename(fileName, true));
+			if (boost::filesystem::exists(filePath))
+				key << " " << boost::filesystem::file_size(filePath) <<
+					" " << boost::filesystem::last_write_time(filePath);
+		} catch (boost::filesystem::filesystem_error &) {
+			// The file can not be accessed, the key only has its name
+		}
 	}
+	graphicsState->textureKeys[type + " " + n] = key.str();
 }
 void lux::Context::Material(const string &n, const ParamSet &params) {
 	VERIFY_WORLD("Material");
@@ -78,6 +78,9 @@ public:
 	boost::shared_ptr<lux::Texture<SWCSpectrum> > GetColorTexture(const string &n) const;
 	boost::shared_ptr<lux::Texture<FresnelGeneral> > GetFresnelTexture(const string &n) const;
 	boost::shared_ptr<lux::Material > GetMaterial(const string &n) const;
+	// Returns the definition of a texture (including the textures it
+	// references and the image file date and size), usable as cache key
+	string GetTextureKey(const string &type, const string &n) const;
 
 	void Init();
 	void Cleanup();
@@ -318,6 +321,8 @@ private:
 		map<string, boost::shared_ptr<lux::Texture<float> > > floatTextures;
 		map<string, boost::shared_ptr<lux::Texture<SWCSpectrum> > > colorTextures;
 		map<string, boost::shared_ptr<lux::Texture<FresnelGeneral> > > fresnelTextures;
+		// Texture definitions indexed by "<type> <name>", see GetTextureKey()
+		map<string, string> textureKeys;
 		map<string, boost::shared_ptr<lux::Material> > namedMaterials;
 		map<string, boost::shared_ptr<lux::Volume> > namedVolumes;
 		boost::shared_ptr<lux::Volume> exterior;
@@ -49,7 +49,7 @@ void ContributionBuffer::Buffer::Splat(Film *film, u_int tileIndex)
 }
 
 ContributionBuffer::ContributionBuffer(ContributionPool *p) :
-	sampleCount(0.f), pool(p)
+	sampleCount(0.f), counters(NULL), pool(p)
 {
 	buffers.resize(pool->CFull.size());
 	for (u_int i = 0; i < buffers.size(); ++i) {
@@ -104,7 +104,7 @@ void ContributionPool::End(ContributionBuffer *c)
 	// will be done in Flush.
 }
 
-void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
+u_int ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 	u_int tileIndex, u_int bufferGroup)
 {
 	// store the current Buffer pointer for later comparison
@@ -117,7 +117,7 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 	// already swapped the buffer while we waited.
 	// The new buffer should be empty so just return.
 	if ((*b) != buf)
-		return;
+		return 0;
 
 	vector<vector<ContributionBuffer::Buffer*> > &full_buffers(CFull[tileIndex]);
 
@@ -135,7 +135,7 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 		if (!CFree.empty()) {
 			*b = CFree.back();
 			CFree.pop_back();
-			return;
+			return 0;
 		}
 		// No free buffers, try allocating a new one
 		// but make sure we don't allocate too many new buffers.
@@ -143,7 +143,7 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 		u_int bufferMisses = ++splattingMisses;
 		if (bufferMisses < maxBufferMisses) {
 			*b = new ContributionBuffer::Buffer();
-			return;
+			return 0;
 		} 
 		if (bufferMisses > 1000000) {
 			// reset to avoid overflow
@@ -168,7 +168,12 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 	// until CFree is filled with free buffers again.
 	// This prevents a thread from trying to splat
 	// prematurely.
-	boost::mutex::scoped_lock main_splatting_lock(mainSplattingMutex);
+	u_int lockWaits = 0;
+	boost::mutex::scoped_lock main_splatting_lock(mainSplattingMutex, boost::try_to_lock);
+	if (!main_splatting_lock.owns_lock()) {
+		++lockWaits;
+		main_splatting_lock.lock();
+	}
 
 	const float count = sampleCount;
 	sampleCount = 0.f;
@@ -180,7 +185,11 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 
 	{
 		// aquire tile splatting lock
-		tile_mutex::scoped_lock tile_splatting_lock(tileSplattingMutexes[tileIndex]);
+		tile_mutex::scoped_lock tile_splatting_lock(tileSplattingMutexes[tileIndex], boost::try_to_lock);
+		if (!tile_splatting_lock.owns_lock()) {
+			++lockWaits;
+			tile_splatting_lock.lock();
+		}
 
 		// release main splatting lock
 		main_splatting_lock.unlock();
@@ -203,6 +212,8 @@ void ContributionPool::Next(ContributionBuffer::Buffer* volatile *b, float *sc,
 		// put splatted buffers back
 		CFree.insert(CFree.end(), splat_buffers.begin(), splat_buffers.end());
 	}
+
+	return lockWaits;
 }
 
 void ContributionPool::Flush()
@@ -27,6 +27,7 @@
 #include "luxrays/core/color/color.h"
 #include "fastmutex.h"
 #include "osfunc.h"
+#include "renderercounters.h"
 
 #include <boost/thread/mutex.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -100,8 +101,13 @@ public:
 		sampleCount += c;
 	}
 
+	// The counters of the render thread owning this buffer, can be NULL
+	void SetCounters(RendererThreadCounters *c) { counters = c; }
+	RendererThreadCounters *GetCounters() const { return counters; }
+
 private:
 	float sampleCount;
+	RendererThreadCounters *counters;
 	vector<vector<Buffer *> > buffers;
 	ContributionPool *pool;
 };
@@ -143,8 +149,10 @@ public:
 	 * accumulated to in the Film.
 	 *
 	 * @param bufferGroup The buffer group that the contributions in the Buffer belongs to.
+	 *
+	 * @return The number of splatting locks the calling thread had to wait for.
 	 */
-	void Next(ContributionBuffer::Buffer* volatile *b, float *sc, u_int tileIndex,
+	u_int Next(ContributionBuffer::Buffer* volatile *b, float *sc, u_int tileIndex,
 		u_int bufferGroup);
 
 	// Flush() and Delete() are not thread safe,
@@ -184,7 +192,7 @@ private:
 inline void ContributionBuffer::Add(const Contribution &c, float weight)
 {
 
-	u_int tileIndex0, tileIndex1;
+	u_int tileIndex0, tileIndex1, lockWaits = 0;
 	// Add the contribution to each tile that it spans.
 	u_int num_tiles = pool->GetFilmTileIndexes(c, &tileIndex0, &tileIndex1);
 
@@ -200,7 +208,7 @@ inline void ContributionBuffer::Add(const Contribution &c, float weight)
 			// Get an empty buffer from the pool.
 			// Next() will reset sampleCount if current thread 
 			// swaps buffers.
-			pool->Next(buf, &sampleCount, tileIndex0, c.bufferGroup);
+			lockWaits += pool->Next(buf, &sampleCount, tileIndex0, c.bufferGroup);
 			// Another thread may have swapped buf before we managed to.
 			// Technically there's a chance we waited so long for the lock
 			// in Next() that the buffer we got back has already been filled
@@ -212,10 +220,16 @@ inline void ContributionBuffer::Add(const Contribution &c, float weight)
 		Buffer* volatile* const buf = &(buffers[tileIndex1][c.bufferGroup]);
 		u_int i = 0;
 		while (!((*buf)->Add(c, weight)) && (i++ < 10)) {
-			pool->Next(buf, &sampleCount, tileIndex1, c.bufferGroup);
+			lockWaits += pool->Next(buf, &sampleCount, tileIndex1, c.bufferGroup);
 		}
 	}
 
+	if (counters) {
+		counters->Increment(COUNTER_SPLATS);
+		if (lockWaits > 0)
+			counters->Add(COUNTER_LOCK_WAITS, lockWaits);
+	}
+
 }
 
 }//namespace lux
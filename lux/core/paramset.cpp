@@ -29,6 +29,10 @@
 #include <string>
 #include <vector>
 
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_set.hpp>
+
 namespace lux {
 
 // ParamSet Helper
@@ -70,6 +74,35 @@ bool LookupType(const char *token, ParamType *type, string &name)
 	return true;
 }
 
+// ParamSet name index
+const char *InternParamName(const string &name)
+{
+	// The set nodes are never moved so the returned pointers stay valid
+	static boost::mutex internedNamesMutex;
+	static boost::unordered_set<string> internedNames;
+
+	boost::mutex::scoped_lock lock(internedNamesMutex);
+	return internedNames.insert(name).first->c_str();
+}
+size_t ParamNameHash::operator()(const char *name) const
+{
+	return boost::hash_range(name, name + strlen(name));
+}
+template <class T> inline void IndexParams(ParamSetIndex &index,
+	const vector<ParamSetItem<T> *> &vec, ParamType type)
+{
+	for (u_int i = 0; i < vec.size(); ++i)
+		index[InternParamName(vec[i]->name)].pos[type] = i;
+}
+static inline u_int FindParam(const ParamSetIndex &index, const string &name,
+	ParamType type)
+{
+	ParamSetIndex::const_iterator it = index.find(name.c_str());
+	if (it == index.end())
+		return ParamSetIndexEntry::NOT_FOUND;
+	return it->second.pos[type];
+}
+
 // ParamSet Macros
 template <class T> inline void DelParams(vector<ParamSetItem<T> *> &vec)
 {
@@ -78,42 +111,52 @@ template <class T> inline void DelParams(vector<ParamSetItem<T> *> &vec)
 	vec.clear();
 }
 template <class T> inline bool EraseParamType(vector<ParamSetItem<T> *> &vec,
-	const string &name)
+	ParamSetIndex &index, ParamType type, const string &name)
 {
-	for (u_int i = 0; i < vec.size(); ++i)
-		if (vec[i]->name == name) {
-			delete vec[i];
-			vec.erase(vec.begin() + i);
-			return true;
-		}
-	return false;
+	ParamSetIndex::iterator it = index.find(name.c_str());
+	if (it == index.end())
+		return false;
+	const u_int i = it->second.pos[type];
+	if (i == ParamSetIndexEntry::NOT_FOUND)
+		return false;
+
+	delete vec[i];
+	vec.erase(vec.begin() + i);
+
+	// Update the positions of the following parameters of the same type
+	it->second.pos[type] = ParamSetIndexEntry::NOT_FOUND;
+	for (u_int j = i; j < vec.size(); ++j)
+		index.find(vec[j]->name.c_str())->second.pos[type] = j;
+	return true;
 }
 template <class T> inline void AddParamType(vector<ParamSetItem<T> *> &vec,
-	const string &name, const T *data, u_int nItems)
+	ParamSetIndex &index, ParamType type, const string &name,
+	const T *data, u_int nItems)
 {
-	EraseParamType(vec, name);
+	EraseParamType(vec, index, type, name);
 	vec.push_back(new ParamSetItem<T>(name, data, nItems));
+	index[InternParamName(name)].pos[type] = vec.size() - 1;
 }
 template <class T> inline const T *LookupPtr(const vector<ParamSetItem<T> *> &vec,
-	const string &name, u_int *nItems)
+	const ParamSetIndex &index, ParamType type, const string &name,
+	u_int *nItems)
 {
-	for (u_int i = 0; i < vec.size(); ++i)
-		if (vec[i]->name == name) {
-			*nItems = vec[i]->nItems;
-			vec[i]->lookedUp = true;
-			return vec[i]->data;
-		}
-	return NULL;
+	const u_int i = FindParam(index, name, type);
+	if (i == ParamSetIndexEntry::NOT_FOUND)
+		return NULL;
+	*nItems = vec[i]->nItems;
+	vec[i]->lookedUp = true;
+	return vec[i]->data;
 }
 template <class T> inline const T &LookupOne(const vector<ParamSetItem<T> *> &vec,
-	const string &name, const T &d)
+	const ParamSetIndex &index, ParamType type, const string &name,
+	const T &d)
 {
-	for (u_int i = 0; i < vec.size(); ++i)
-		if (vec[i]->name == name && vec[i]->nItems == 1) {
-			vec[i]->lookedUp = true;
-			return *(vec[i]->data);
-		}
-	return d;
+	const u_int i = FindParam(index, name, type);
+	if (i == ParamSetIndexEntry::NOT_FOUND || vec[i]->nItems != 1)
+		return d;
+	vec[i]->lookedUp = true;
+	return *(vec[i]->data);
 }
 template <class T> inline void CheckUnused(const vector<ParamSetItem<T> *> &vec)
 {
@@ -122,12 +165,14 @@ template <class T> inline void CheckUnused(const vector<ParamSetItem<T> *> &vec)
 			LOG( LUX_WARNING,LUX_NOERROR) << "Parameter '" << vec[i]->name << "' not used";
 		}
 }
-template <class T> inline void MarkAsUsed(const vector<ParamSetItem<T> *> &vec, const vector<ParamSetItem<T> *> &vecOther)
+template <class T> inline void MarkAsUsed(const vector<ParamSetItem<T> *> &vec,
+	const ParamSetIndex &index, ParamType type,
+	const vector<ParamSetItem<T> *> &vecOther)
 {
 	for (u_int i = 0; i < vecOther.size(); ++i) {
 		if (vecOther[i]->lookedUp) {
 			u_int n;
-			LookupPtr(vec, vecOther[i]->name, &n);
+			LookupPtr(vec, index, type, vecOther[i]->name, &n);
 		}
 	}
 }
@@ -1095,6 +1140,7 @@ ParamSet &ParamSet::operator=(const ParamSet &p2) {
 			strings.push_back(p2.strings[i]->Clone());
 		for (u_int i = 0; i < p2.textures.size(); ++i)
 			textures.push_back(p2.textures[i]->Clone());
+		RebuildIndex();
 	}
 	return *this;
 }
@@ -1122,135 +1168,144 @@ void ParamSet::Add(const ParamSet &params) {
 
 void ParamSet::AddFloat(const string &name, const float *data, u_int nItems)
 {
-	AddParamType(floats, name, data, nItems);
+	AddParamType(floats, index, PARAM_TYPE_FLOAT, name, data, nItems);
 }
 void ParamSet::AddInt(const string &name, const int *data, u_int nItems)
 {
-	AddParamType(ints, name, data, nItems);
+	AddParamType(ints, index, PARAM_TYPE_INT, name, data, nItems);
 }
 void ParamSet::AddBool(const string &name, const bool *data, u_int nItems)
 {
-	AddParamType(bools, name, data, nItems);
+	AddParamType(bools, index, PARAM_TYPE_BOOL, name, data, nItems);
 }
 void ParamSet::AddPoint(const string &name, const Point *data, u_int nItems)
 {
-	AddParamType(points, name, data, nItems);
+	AddParamType(points, index, PARAM_TYPE_POINT, name, data, nItems);
 }
 void ParamSet::AddVector(const string &name, const Vector *data, u_int nItems)
 {
-	AddParamType(vectors, name, data, nItems);
+	AddParamType(vectors, index, PARAM_TYPE_VECTOR, name, data, nItems);
 }
 void ParamSet::AddNormal(const string &name, const Normal *data, u_int nItems)
 {
-	AddParamType(normals, name, data, nItems);
+	AddParamType(normals, index, PARAM_TYPE_NORMAL, name, data, nItems);
 }
 void ParamSet::AddRGBColor(const string &name, const RGBColor *data, u_int nItems)
 {
-	AddParamType(spectra, name, data, nItems);
+	AddParamType(spectra, index, PARAM_TYPE_COLOR, name, data, nItems);
 }
 void ParamSet::AddString(const string &name, const string *data, u_int nItems)
 {
-	AddParamType(strings, name, data, nItems);
+	AddParamType(strings, index, PARAM_TYPE_STRING, name, data, nItems);
 }
 void ParamSet::AddTexture(const string &name, const string &value)
 {
-	AddParamType(textures, name, &value, 1);
+	AddParamType(textures, index, PARAM_TYPE_TEXTURE, name, &value, 1);
 }
 bool ParamSet::EraseInt(const string &n) {
-	return EraseParamType(ints, n);
+	return EraseParamType(ints, index, PARAM_TYPE_INT, n);
 }
 bool ParamSet::EraseBool(const string &n) {
-	return EraseParamType(bools, n);
+	return EraseParamType(bools, index, PARAM_TYPE_BOOL, n);
 }
 bool ParamSet::EraseFloat(const string &n) {
-	return EraseParamType(floats, n);
+	return EraseParamType(floats, index, PARAM_TYPE_FLOAT, n);
 }
 bool ParamSet::ErasePoint(const string &n) {
-	return EraseParamType(points, n);
+	return EraseParamType(points, index, PARAM_TYPE_POINT, n);
 }
 bool ParamSet::EraseVector(const string &n) {
-	return EraseParamType(vectors, n);
+	return EraseParamType(vectors, index, PARAM_TYPE_VECTOR, n);
 }
 bool ParamSet::EraseNormal(const string &n) {
-	return EraseParamType(normals, n);
+	return EraseParamType(normals, index, PARAM_TYPE_NORMAL, n);
 }
 bool ParamSet::EraseRGBColor(const string &n) {
-	return EraseParamType(spectra, n);
+	return EraseParamType(spectra, index, PARAM_TYPE_COLOR, n);
 }
 bool ParamSet::EraseString(const string &n) {
-	return EraseParamType(strings, n);
+	return EraseParamType(strings, index, PARAM_TYPE_STRING, n);
 }
 bool ParamSet::EraseTexture(const string &n) {
-	return EraseParamType(textures, n);
+	return EraseParamType(textures, index, PARAM_TYPE_TEXTURE, n);
 }
 float ParamSet::FindOneFloat(const string &name, float d) const
 {
-	return LookupOne(floats, name, d);
+	return LookupOne(floats, index, PARAM_TYPE_FLOAT, name, d);
 }
 const float *ParamSet::FindFloat(const string &name, u_int *nItems) const
 {
-	return LookupPtr(floats, name, nItems);
+	return LookupPtr(floats, index, PARAM_TYPE_FLOAT, name, nItems);
 }
 const int *ParamSet::FindInt(const string &name, u_int *nItems) const
 {
-	return LookupPtr(ints, name, nItems);
+	return LookupPtr(ints, index, PARAM_TYPE_INT, name, nItems);
 }
 const bool *ParamSet::FindBool(const string &name, u_int *nItems) const
 {
-	return LookupPtr(bools, name, nItems);
+	return LookupPtr(bools, index, PARAM_TYPE_BOOL, name, nItems);
 }
 int ParamSet::FindOneInt(const string &name, int d) const
 {
-	return LookupOne(ints, name, d);
+	return LookupOne(ints, index, PARAM_TYPE_INT, name, d);
 }
 bool ParamSet::FindOneBool(const string &name, bool d) const
 {
-	return LookupOne(bools, name, d);
+	return LookupOne(bools, index, PARAM_TYPE_BOOL, name, d);
 }
 const Point *ParamSet::FindPoint(const string &name, u_int *nItems) const
 {
-	return LookupPtr(points, name, nItems);
+	return LookupPtr(points, index, PARAM_TYPE_POINT, name, nItems);
 }
 const Point &ParamSet::FindOnePoint(const string &name, const Point &d) const
 {
-	return LookupOne(points, name, d);
+	return LookupOne(points, index, PARAM_TYPE_POINT, name, d);
 }
 const Vector *ParamSet::FindVector(const string &name, u_int *nItems) const
 {
-	return LookupPtr(vectors, name, nItems);
+	return LookupPtr(vectors, index, PARAM_TYPE_VECTOR, name, nItems);
 }
 const Vector &ParamSet::FindOneVector(const string &name, const Vector &d) const
 {
-	return LookupOne(vectors, name, d);
+	return LookupOne(vectors, index, PARAM_TYPE_VECTOR, name, d);
 }
 const Normal *ParamSet::FindNormal(const string &name, u_int *nItems) const
 {
-	return LookupPtr(normals, name, nItems);
+	return LookupPtr(normals, index, PARAM_TYPE_NORMAL, name, nItems);
 }
 const Normal &ParamSet::FindOneNormal(const string &name, const Normal &d) const
 {
-	return LookupOne(normals, name, d);
+	return LookupOne(normals, index, PARAM_TYPE_NORMAL, name, d);
 }
 const RGBColor *ParamSet::FindRGBColor(const string &name, u_int *nItems) const
 {
-	return LookupPtr(spectra, name, nItems);
+	return LookupPtr(spectra, index, PARAM_TYPE_COLOR, name, nItems);
 }
 const RGBColor &ParamSet::FindOneRGBColor(const string &name, const RGBColor &d) const
 {
-	return LookupOne(spectra, name, d);
+	return LookupOne(spectra, index, PARAM_TYPE_COLOR, name, d);
 }
 const string *ParamSet::FindString(const string &name, u_int *nItems) const
 {
-	return LookupPtr(strings, name, nItems);
+	return LookupPtr(strings, index, PARAM_TYPE_STRING, name, nItems);
 }
 const string &ParamSet::FindOneString(const string &name, const string &d) const
 {
-	return LookupOne(strings, name, d);
+	return LookupOne(strings, index, PARAM_TYPE_STRING, name, d);
 }
 const string &ParamSet::FindTexture(const string &name) const
 {
 	static const string empty("");
-	return LookupOne(textures, name, empty);
+	return LookupOne(textures, index, PARAM_TYPE_TEXTURE, name, empty);
+}
+vector<string> ParamSet::GetTextureNames() const
+{
+	vector<string> names;
+	for (u_int i = 0; i < textures.size(); ++i) {
+		for (u_int j = 0; j < textures[i]->nItems; ++j)
+			names.push_back(textures[i]->data[j]);
+	}
+	return names;
 }
 void ParamSet::MarkAllUsed() const {
 	// Marks all params as used
@@ -1266,15 +1321,15 @@ void ParamSet::MarkAllUsed() const {
 }
 void ParamSet::MarkUsed(const ParamSet &p2) const {
 	// marks any used params in p2 as used in this
-	MarkAsUsed(ints, p2.ints);
-	MarkAsUsed(bools, p2.bools);
-	MarkAsUsed(floats, p2.floats);
-	MarkAsUsed(points, p2.points);
-	MarkAsUsed(vectors, p2.vectors);
-	MarkAsUsed(normals, p2.normals);
-	MarkAsUsed(spectra, p2.spectra);
-	MarkAsUsed(strings, p2.strings);
-	MarkAsUsed(textures, p2.textures);
+	MarkAsUsed(ints, index, PARAM_TYPE_INT, p2.ints);
+	MarkAsUsed(bools, index, PARAM_TYPE_BOOL, p2.bools);
+	MarkAsUsed(floats, index, PARAM_TYPE_FLOAT, p2.floats);
+	MarkAsUsed(points, index, PARAM_TYPE_POINT, p2.points);
+	MarkAsUsed(vectors, index, PARAM_TYPE_VECTOR, p2.vectors);
+	MarkAsUsed(normals, index, PARAM_TYPE_NORMAL, p2.normals);
+	MarkAsUsed(spectra, index, PARAM_TYPE_COLOR, p2.spectra);
+	MarkAsUsed(strings, index, PARAM_TYPE_STRING, p2.strings);
+	MarkAsUsed(textures, index, PARAM_TYPE_TEXTURE, p2.textures);
 }
 void ParamSet::ReportUnused() const {
 	CheckUnused(ints);
@@ -1297,6 +1352,19 @@ void ParamSet::Clear() {
 	DelParams(spectra);
 	DelParams(strings);
 	DelParams(textures);
+	index.clear();
+}
+void ParamSet::RebuildIndex() {
+	index.clear();
+	IndexParams(index, ints, PARAM_TYPE_INT);
+	IndexParams(index, bools, PARAM_TYPE_BOOL);
+	IndexParams(index, floats, PARAM_TYPE_FLOAT);
+	IndexParams(index, points, PARAM_TYPE_POINT);
+	IndexParams(index, vectors, PARAM_TYPE_VECTOR);
+	IndexParams(index, normals, PARAM_TYPE_NORMAL);
+	IndexParams(index, spectra, PARAM_TYPE_COLOR);
+	IndexParams(index, strings, PARAM_TYPE_STRING);
+	IndexParams(index, textures, PARAM_TYPE_TEXTURE);
 }
 string ParamSet::ToString() const {
 	std::stringstream ret("");
@@ -27,6 +27,9 @@
 #include "api.h"
 
 #include <boost/serialization/split_member.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <cstring>
 
 #include <map>
 using std::map;
@@ -44,6 +47,29 @@ typedef enum { PARAM_TYPE_INT, PARAM_TYPE_BOOL, PARAM_TYPE_FLOAT,
 	PARAM_TYPE_COLOR, PARAM_TYPE_STRING, PARAM_TYPE_TEXTURE } ParamType;
 bool LookupType(const char *token, ParamType *type, string &name);
 
+// ParamSet name index: parameter names are interned so the index keys don't
+// require a copy of the name for each ParamSet
+const char *InternParamName(const string &name);
+struct ParamNameHash {
+	size_t operator()(const char *name) const;
+};
+struct ParamNameEqual {
+	bool operator()(const char *a, const char *b) const {
+		return strcmp(a, b) == 0;
+	}
+};
+// The position of a parameter in each ParamSet typed vector
+struct ParamSetIndexEntry {
+	static const u_int NOT_FOUND = 0xffffffffu;
+	ParamSetIndexEntry() {
+		for (u_int i = 0; i <= PARAM_TYPE_TEXTURE; ++i)
+			pos[i] = NOT_FOUND;
+	}
+	u_int pos[PARAM_TYPE_TEXTURE + 1];
+};
+typedef boost::unordered_map<const char *, ParamSetIndexEntry,
+	ParamNameHash, ParamNameEqual> ParamSetIndex;
+
 // ParamSet Declarations
 template <class T> struct ParamSetItem {
 	// ParamSetItem Public Methods
@@ -140,6 +166,8 @@ public:
 	const Normal *FindNormal(const string &, u_int *nItems) const;
 	const RGBColor *FindRGBColor(const string &, u_int *nItems) const;
 	const string *FindString(const string &, u_int *nItems) const;
+	// The names of all the textures referenced by texture parameters
+	vector<string> GetTextureNames() const;
 	boost::shared_ptr<Texture<SWCSpectrum> >
 		GetSWCSpectrumTexture(const string &name,
 		const RGBColor &def) const;
@@ -160,6 +188,8 @@ public:
 	string ToString() const;
 
 private:
+	void RebuildIndex();
+
 	// ParamSet Data
 	vector<ParamSetItem<int> *> ints;
 	vector<ParamSetItem<bool> *> bools;
@@ -170,6 +200,8 @@ private:
 	vector<ParamSetItem<RGBColor> *> spectra;
 	vector<ParamSetItem<string> *> strings;
 	vector<ParamSetItem<string> *> textures;
+	// Name index used for the lookups
+	ParamSetIndex index;
 	
 	template<class Archive>
 		void serialize(Archive & ar, const unsigned int version)
@@ -183,6 +215,9 @@ private:
 			ar & spectra;
 			ar & strings;
 			ar & textures;
+
+			if (Archive::is_loading::value)
+				RebuildIndex();
 		}
 	
 };
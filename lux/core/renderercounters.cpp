@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 1998-2013 by authors (see AUTHORS.txt)                  *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ *   Lux Renderer is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Lux Renderer is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ *   This project is based on PBRT ; see http://www.pbrt.org               *
+ *   Lux Renderer website : http://www.luxrender.net                       *
+ ***************************************************************************/
+
+#include "renderercounters.h"
+
+#include <algorithm>
+
+using namespace lux;
+
+RendererCounters::RendererCounters() {
+	for (u_int i = 0; i < COUNTER_TYPE_COUNT; ++i)
+		retiredCounts[i] = 0.0;
+}
+
+RendererCounters::~RendererCounters() {
+	for (u_int i = 0; i < threadCounters.size(); ++i)
+		delete threadCounters[i];
+}
+
+RendererThreadCounters *RendererCounters::AddThread() {
+	RendererThreadCounters *counters = new RendererThreadCounters();
+
+	boost::mutex::scoped_lock lock(threadsMutex);
+	threadCounters.push_back(counters);
+
+	return counters;
+}
+
+void RendererCounters::RemoveThread(RendererThreadCounters *counters) {
+	if (!counters)
+		return;
+
+	boost::mutex::scoped_lock lock(threadsMutex);
+	std::vector<RendererThreadCounters *>::iterator it =
+		std::find(threadCounters.begin(), threadCounters.end(), counters);
+	if (it == threadCounters.end())
+		return;
+
+	for (u_int i = 0; i < COUNTER_TYPE_COUNT; ++i)
+		retiredCounts[i] += counters->Get(static_cast<RendererCounterType>(i));
+	threadCounters.erase(it);
+	delete counters;
+}
+
+double RendererCounters::Get(const RendererCounterType type) const {
+	boost::mutex::scoped_lock lock(threadsMutex);
+
+	double total = retiredCounts[type];
+	for (u_int i = 0; i < threadCounters.size(); ++i)
+		total += threadCounters[i]->Get(type);
+
+	return total;
+}
+
+void RendererCounters::Get(double *totals) const {
+	boost::mutex::scoped_lock lock(threadsMutex);
+
+	for (u_int i = 0; i < COUNTER_TYPE_COUNT; ++i) {
+		const RendererCounterType type = static_cast<RendererCounterType>(i);
+		totals[i] = retiredCounts[i];
+		for (u_int j = 0; j < threadCounters.size(); ++j)
+			totals[i] += threadCounters[j]->Get(type);
+	}
+}
+
+void RendererCounters::Reset() {
+	boost::mutex::scoped_lock lock(threadsMutex);
+
+	for (u_int i = 0; i < COUNTER_TYPE_COUNT; ++i)
+		retiredCounts[i] = 0.0;
+	for (u_int i = 0; i < threadCounters.size(); ++i)
+		threadCounters[i]->Reset();
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 1998-2013 by authors (see AUTHORS.txt)                  *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ *   Lux Renderer is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Lux Renderer is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ *   This project is based on PBRT ; see http://www.pbrt.org               *
+ *   Lux Renderer website : http://www.luxrender.net                       *
+ ***************************************************************************/
+
+#ifndef LUX_RENDERERCOUNTERS_H
+#define LUX_RENDERERCOUNTERS_H
+// renderercounters.h*
+#include "lux.h"
+#include "luxrays/utils/memory.h"
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace lux
+{
+
+typedef enum {
+	COUNTER_SAMPLES, // Samples rendered
+	COUNTER_CONTRIBUTIONS, // Non black contributions
+	COUNTER_CONTRIBUTION_PATHS, // Samples with at least one contribution
+	COUNTER_RAYS, // Camera, bounce and shadow rays
+	COUNTER_SPLATS, // Contributions added to the film buffers
+	COUNTER_BSDFS, // BSDFs evaluated at surface hits
+	COUNTER_LOCK_WAITS, // Contended splatting locks
+	COUNTER_TYPE_COUNT
+} RendererCounterType;
+
+// Hot path counters of a single render thread. Only the owning thread writes
+// them, without any lock or atomic read-modify-write, other threads only read
+// them when the statistics are queried. Each block is allocated on its own
+// cache lines so render threads don't false share.
+class RendererThreadCounters {
+public:
+	RendererThreadCounters() { Reset(); }
+
+	void Increment(const RendererCounterType type) {
+		counters[type] = counters[type] + 1.0;
+	}
+	void Add(const RendererCounterType type, const double value) {
+		counters[type] = counters[type] + value;
+	}
+	double Get(const RendererCounterType type) const { return counters[type]; }
+	void Reset() {
+		for (u_int i = 0; i < COUNTER_TYPE_COUNT; ++i)
+			counters[i] = 0.0;
+	}
+
+	void *operator new(size_t s) { return luxrays::AllocAligned<char>(s); }
+	void operator delete(void *p) { luxrays::FreeAligned(p); }
+
+private:
+	volatile double counters[COUNTER_TYPE_COUNT];
+	char padding[L1_CACHE_LINE_SIZE - (sizeof(double) * COUNTER_TYPE_COUNT) % L1_CACHE_LINE_SIZE];
+};
+
+// The set of the RendererThreadCounters of a renderer. The totals are only
+// computed when asked for. The counts of removed threads are retained so the
+// totals never decrease while rendering.
+class RendererCounters {
+public:
+	RendererCounters();
+	~RendererCounters();
+
+	// Thread-safe, the returned counters are owned by this object
+	RendererThreadCounters *AddThread();
+	// Thread-safe, the counters of the thread are folded in the totals
+	void RemoveThread(RendererThreadCounters *counters);
+
+	// Thread-safe
+	double Get(const RendererCounterType type) const;
+	// Thread-safe, returns a consistent set of COUNTER_TYPE_COUNT totals
+	void Get(double *totals) const;
+
+	// Can only be called when no render thread is running
+	void Reset();
+
+private:
+	mutable boost::mutex threadsMutex;
+	std::vector<RendererThreadCounters *> threadCounters;
+	double retiredCounts[COUNTER_TYPE_COUNT];
+};
+
+}//namespace lux
+
+#endif // LUX_RENDERERCOUNTERS_H
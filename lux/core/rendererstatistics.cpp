@@ -57,6 +57,12 @@ RendererStatistics::RendererStatistics()
 
 	AddIntAttribute(*this, "threadCount", "Number of rendering threads on local node", &RendererStatistics::getThreadCount);
 	AddIntAttribute(*this, "slaveNodeCount", "Number of network slave nodes", &RendererStatistics::getSlaveNodeCount);
+
+	AddDoubleAttribute(*this, "rayCount", "Number of rays traced by local node", &RendererStatistics::getRayCount);
+	AddDoubleAttribute(*this, "raysPerSecond", "Average number of rays traced per second by local node", &RendererStatistics::getRaysPerSecond);
+	AddDoubleAttribute(*this, "splatCount", "Number of contributions splatted by local node", &RendererStatistics::getSplatCount);
+	AddDoubleAttribute(*this, "bsdfCount", "Number of BSDFs evaluated by local node", &RendererStatistics::getBSDFCount);
+	AddDoubleAttribute(*this, "lockWaitCount", "Number of contended splatting locks on local node", &RendererStatistics::getLockWaitCount);
 }
 
 void RendererStatistics::reset() {
@@ -64,6 +70,7 @@ void RendererStatistics::reset() {
 	
 	resetDerived();
 
+	counters.Reset();
 	timer.Reset();
 	windowStartTime = 0.0;
 	windowCurrentTime = 0.0;
@@ -89,6 +96,12 @@ void RendererStatistics::updateStatisticsWindow() {
 	windowStartTime = windowCurrentTime;
 }
 
+double RendererStatistics::getRaysPerSecond() {
+	const double elapsed = getElapsedTime();
+
+	return elapsed > 0.0 ? getRayCount() / elapsed : 0.0;
+}
+
 // Returns halttime if set, otherwise infinity
 double RendererStatistics::getHaltTime() {
 	int haltTime = 0;
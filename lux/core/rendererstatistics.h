@@ -26,6 +26,7 @@
 // rendererstatistics.h
 #include "lux.h"
 #include "queryable.h"
+#include "renderercounters.h"
 #include "timer.h"
 
 #include <string>
@@ -54,6 +55,10 @@ public:
 	// multithread safe while in running state
 	double elapsedTime() const;
 
+	// Per render thread hot path counters, only summed when queried
+	RendererCounters &GetCounters() { return counters; }
+	const RendererCounters &GetCounters() const { return counters; }
+
 	class Formatted : public Queryable {
 	public:
 		virtual ~Formatted() {};
@@ -123,6 +128,7 @@ public:
 
 protected:
 	Timer timer;
+	RendererCounters counters;
 	boost::mutex windowMutex;
 	double windowStartTime;
 	double windowCurrentTime;
@@ -135,6 +141,12 @@ protected:
 	double getPercentConvergence();
 	u_int getSlaveNodeCount();
 
+	double getRayCount() { return counters.Get(COUNTER_RAYS); }
+	double getRaysPerSecond();
+	double getSplatCount() { return counters.Get(COUNTER_SPLATS); }
+	double getBSDFCount() { return counters.Get(COUNTER_BSDFS); }
+	double getLockWaitCount() { return counters.Get(COUNTER_LOCK_WAITS); }
+
 	// These methods must be overridden for renderers
 	// which provide alternative measurable halt conditions
 	virtual double getRemainingTime();
@@ -28,6 +28,7 @@
 #include "primitive.h"
 #include "transport.h"
 #include "camera.h"
+#include "sampling.h"
 
 #include <boost/thread/thread.hpp>
 #include <boost/noncopyable.hpp>
@@ -65,22 +66,28 @@ public:
 		bool scatteredStart, const Ray &ray, float u,
 		Intersection *isect, BSDF **bsdf, float *pdf, float *pdfBack,
 		SWCSpectrum *f) const {
-		return volumeIntegrator->Intersect(*this, sample, volume,
-			scatteredStart, ray, u, isect, bsdf, pdf, pdfBack, f);
+		const bool hit = volumeIntegrator->Intersect(*this, sample,
+			volume, scatteredStart, ray, u, isect, bsdf, pdf, pdfBack, f);
+		CountIntersection(sample, true, hit);
+		return hit;
 	}
 	// Used to complete intersection data with LuxRays
 	bool Intersect(const Sample &sample, const Volume *volume,
 		bool scatteredStart, const Ray &ray,
 		const luxrays::RayHit &rayHit, float u, Intersection *isect,
 		BSDF **bsdf, float *pdf, float *pdfBack, SWCSpectrum *f) const {
-		return volumeIntegrator->Intersect(*this, sample, volume,
-			scatteredStart, ray, rayHit, u, isect, bsdf, pdf,
+		const bool hit = volumeIntegrator->Intersect(*this, sample,
+			volume, scatteredStart, ray, rayHit, u, isect, bsdf, pdf,
 			pdfBack, f);
+		// The ray itself has been counted by the renderer tracing it
+		CountIntersection(sample, false, hit);
+		return hit;
 	}
 	bool Connect(const Sample &sample, const Volume *volume,
 		bool scatteredStart, bool scatteredEnd, const Point &p0,
 		const Point &p1, bool clip, SWCSpectrum *f, float *pdf,
 		float *pdfR) const {
+		CountIntersection(sample, true, false);
 		return volumeIntegrator->Connect(*this, sample, volume,
 			scatteredStart, scatteredEnd, p0, p1, clip, f, pdf,
 			pdfR);
@@ -162,6 +169,18 @@ public:
 	luxrays::DataSet *dataSet;
 
 private:
+	// Updates the counters of the render thread, if any, tracing the sample
+	static void CountIntersection(const Sample &sample, bool traced, bool hit) {
+		RendererThreadCounters *counters = sample.contribBuffer ?
+			sample.contribBuffer->GetCounters() : NULL;
+		if (!counters)
+			return;
+		if (traced)
+			counters->Increment(COUNTER_RAYS);
+		if (hit)
+			counters->Increment(COUNTER_BSDFS);
+	}
+
 	bool filmOnly; // whether this scene has entire scene (incl. geometry, ..) or only a film
 };
 
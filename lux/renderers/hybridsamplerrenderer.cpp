@@ -166,7 +166,7 @@ bool SurfaceIntegratorStateBuffer::NextState(u_int &nrContribs, u_int &nrSamples
 HybridSamplerRenderer::HybridSamplerRenderer(const int oclPlatformIndex, bool useGPUs,
 		const u_int forceGPUWorkGroupSize, const string &deviceSelection,
 		const u_int rayBufSize, const u_int stateBufCount,
-		const u_int qbvhStackSize) : HybridRenderer() {
+		const u_int qbvhStackSize, const bool raySorting) : HybridRenderer() {
 	state = INIT;
 
 	if (!IsPowerOf2(rayBufSize)) {
@@ -260,13 +260,21 @@ HybridSamplerRenderer::HybridSamplerRenderer(const int oclPlatformIndex, bool us
 		}
 
 		LOG(LUX_INFO, LUX_NOERROR) << "Devices used:";
+		vector<luxrays::IntersectionDevice *> realDevices;
 		luxrays::VirtualIntersectionDevice *vdevice = dynamic_cast<luxrays::VirtualIntersectionDevice *>(intersectionDevice);
-		if (vdevice) {
-			const vector<luxrays::IntersectionDevice *> &realDevices = vdevice->GetRealDevices();
-			BOOST_FOREACH(luxrays::IntersectionDevice *rd, realDevices)
-					LOG(LUX_INFO, LUX_NOERROR) << " [" << rd->GetName() << "]";
-		} else
-			LOG(LUX_INFO, LUX_NOERROR) << " [" << intersectionDevice->GetName() << "]";
+		if (vdevice)
+			realDevices = vdevice->GetRealDevices();
+		else
+			realDevices.push_back(intersectionDevice);
+
+		BOOST_FOREACH(luxrays::IntersectionDevice *rd, realDevices) {
+			LOG(LUX_INFO, LUX_NOERROR) << " [" << rd->GetName() << "]";
+
+			// Ray sorting is supported only by native devices
+			luxrays::NativeThreadIntersectionDevice *ndevice = dynamic_cast<luxrays::NativeThreadIntersectionDevice *>(rd);
+			if (ndevice)
+				ndevice->SetRaySorting(raySorting);
+		}
 	}
 
 	intersectionDevice->SetMaxStackSize(qbvhStackSize);
@@ -520,11 +528,13 @@ void HybridSamplerRenderer::RemoveRenderThread() {
 //------------------------------------------------------------------------------
 
 HybridSamplerRenderer::RenderThread::RenderThread(u_int index, HybridSamplerRenderer *r) :
-	n(index), thread(NULL), renderer(r), samples(0.), blackSamples(0.), blackSamplePaths(0.) {
+	n(index), thread(NULL), renderer(r) {
+	counters = renderer->rendererStatistics->GetCounters().AddThread();
 }
 
 HybridSamplerRenderer::RenderThread::~RenderThread() {
 	delete thread;
+	renderer->rendererStatistics->GetCounters().RemoveThread(counters);
 }
 
 void HybridSamplerRenderer::RenderThread::RenderImpl(RenderThread *renderThread) {
@@ -546,6 +556,8 @@ void HybridSamplerRenderer::RenderThread::RenderImpl(RenderThread *renderThread)
 		// It depends on the fact that the film buffers have been created
 		// This is done during the preprocessing phase
 		ContributionBuffer *contribBuffer = new ContributionBuffer(scene.camera()->film->contribPool);
+		RendererThreadCounters *counters = renderThread->counters;
+		contribBuffer->SetCounters(counters);
 
 		// initialize the thread's rangen
 		u_long seed;
@@ -570,6 +582,7 @@ void HybridSamplerRenderer::RenderThread::RenderImpl(RenderThread *renderThread)
 
 			stateBuffers[i] = new SurfaceIntegratorStateBuffer(scene, contribBuffer, &rng, rayBuffer);
 			stateBuffers[i]->GenerateRays();
+			counters->Add(COUNTER_RAYS, rayBuffer->GetRayCount());
 			intersectionDevice->PushRayBuffer(rayBuffer, threadIndex);
 		}
 
@@ -624,11 +637,10 @@ void HybridSamplerRenderer::RenderThread::RenderImpl(RenderThread *renderThread)
 			// Jeanphi - Hijack statistics until volume integrator revamp
 			{
 				// update samples statistics
-				fast_mutex::scoped_lock lockStats(renderThread->statLock);
-				renderThread->blackSamples += nrContribs;
+				counters->Add(COUNTER_CONTRIBUTIONS, nrContribs);
 				if (nrContribs > 0)
-					++(renderThread->blackSamplePaths);
-				renderThread->samples += nrSamples;
+					counters->Increment(COUNTER_CONTRIBUTION_PATHS);
+				counters->Add(COUNTER_SAMPLES, nrSamples);
 			}
 
 			if (renderIsOver) {
@@ -649,6 +661,7 @@ void HybridSamplerRenderer::RenderThread::RenderImpl(RenderThread *renderThread)
 			// Trace the RayBuffer
 			//----------------------------------------------------------------------
 
+			counters->Add(COUNTER_RAYS, rayBuffer->GetRayCount());
 			intersectionDevice->PushRayBuffer(rayBuffer, threadIndex);
 		}
 
@@ -678,6 +691,8 @@ Renderer *HybridSamplerRenderer::CreateRenderer(const ParamSet &params) {
 
 	const u_int rayBufferSize = params.FindOneInt("raybuffersize", 8192);
 	const u_int stateBufferCount = max(1, params.FindOneInt("statebuffercount", 1));
+	// Reorder the rays of each buffer for a more coherent traversal (native devices only)
+	const bool raySorting = params.FindOneBool("raysorting", false);
 
 	string deviceSelection = configParams.FindOneString("opencl.devices.select", "");
 	int platformIndex = configParams.FindOneInt("opencl.platform.index", -1);
@@ -699,7 +714,7 @@ Renderer *HybridSamplerRenderer::CreateRenderer(const ParamSet &params) {
 	params.MarkUsed(configParams);
 	return new HybridSamplerRenderer(platformIndex, useGPUs,
 			forceGPUWorkGroupSize, deviceSelection, rayBufferSize,
-			stateBufferCount, qbvhStackSize);
+			stateBufferCount, qbvhStackSize, raySorting);
 }
 
 static DynamicLoader::RegisterRenderer<HybridSamplerRenderer> r("hybrid");
@@ -76,7 +76,7 @@ public:
 	HybridSamplerRenderer(const int oclPlatformIndex, bool useGPUs,
 			const u_int forceGPUWorkGroupSize, const string &deviceSelection,
 			const u_int rayBufferSize, const u_int stateBufferCount,
-			const u_int qbvhStackSize);
+			const u_int qbvhStackSize, const bool raySorting);
 	~HybridSamplerRenderer();
 
 	RendererType GetType() const;
@@ -112,8 +112,8 @@ private:
 		HybridSamplerRenderer *renderer;
 
 		// Rendering statistics
-		fast_mutex statLock;
-		double samples, blackSamples, blackSamplePaths;
+		// Only written by the thread itself, read by the statistics
+		RendererThreadCounters *counters;
 	};
 
 	void CreateRenderThread();
@@ -283,11 +283,13 @@ void SamplerRenderer::RemoveRenderThread() {
 
 
 SamplerRenderer::RenderThread::RenderThread(u_int index, SamplerRenderer *r) :
-	n(index), renderer(r), thread(NULL), samples(0.), blackSamples(0.), blackSamplePaths(0.) {
+	n(index), renderer(r), thread(NULL) {
+	counters = renderer->rendererStatistics->GetCounters().AddThread();
 }
 
 SamplerRenderer::RenderThread::~RenderThread() {
 	delete thread;
+	renderer->rendererStatistics->GetCounters().RemoveThread(counters);
 }
 
 void SamplerRenderer::RenderThread::RenderImpl(RenderThread *myThread) {
@@ -320,6 +322,7 @@ void SamplerRenderer::RenderThread::RenderImpl(RenderThread *myThread) {
 	// It depends on the fact that the film buffers have been created
 	// This is done during the preprocessing phase
 	sample.contribBuffer = new ContributionBuffer(scene.camera()->film->contribPool);
+	sample.contribBuffer->SetCounters(myThread->counters);
 	sample.camera = scene.camera()->Clone();
 	sample.realTime = 0.f;
 
@@ -363,11 +366,11 @@ void SamplerRenderer::RenderThread::RenderImpl(RenderThread *myThread) {
 		{
 			const u_int nContribs = scene.surfaceIntegrator->Li(scene, sample);
 			// update samples statistics
-			fast_mutex::scoped_lock lockStats(myThread->statLock);
-			myThread->blackSamples += nContribs;
+			RendererThreadCounters *counters = myThread->counters;
+			counters->Add(COUNTER_CONTRIBUTIONS, nContribs);
 			if (nContribs > 0)
-				++(myThread->blackSamplePaths);
-			++(myThread->samples);
+				counters->Increment(COUNTER_CONTRIBUTION_PATHS);
+			counters->Increment(COUNTER_SAMPLES);
 		}
 
 		sampler->AddSample(sample);
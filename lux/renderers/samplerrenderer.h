@@ -128,8 +128,8 @@ private:
 		u_int  n;
 		SamplerRenderer *renderer;
 		boost::thread *thread; // keep pointer to delete the thread object
-		double samples, blackSamples, blackSamplePaths;
-		fast_mutex statLock;
+		// Only written by the thread itself, read by the statistics
+		RendererThreadCounters *counters;
 	};
 
 	void CreateRenderThread();
@@ -191,14 +191,12 @@ double HSRStatistics::getEfficiency() {
 	double sampleCount = 0.0;
 	double blackSampleCount = 0.0;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSampleCount is necessary
-	boost::mutex::scoped_lock lock(renderer->classWideMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSampleCount += renderer->renderThreads[i]->blackSamples;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSampleCount += totals[COUNTER_CONTRIBUTIONS];
 
 	return sampleCount ? (100.0 * blackSampleCount) / sampleCount : 0.0;
 }
@@ -207,14 +205,12 @@ double HSRStatistics::getEfficiencyWindow() {
 	double sampleCount = 0.0 - windowEffSampleCount;
 	double blackSampleCount = 0.0 - windowEffBlackSampleCount;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSampleCount is necessary
-	boost::mutex::scoped_lock lock(renderer->classWideMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSampleCount += renderer->renderThreads[i]->blackSamples;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSampleCount += totals[COUNTER_CONTRIBUTIONS];
 
 	windowPEffSampleCount += sampleCount;
 	windowPEffBlackSampleCount += blackSampleCount;
@@ -226,14 +222,12 @@ double HSRStatistics::getPathEfficiency() {
 	double sampleCount = 0.0;
 	double blackSamplePathCount = 0.0;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSamplePathCount is necessary
-	boost::mutex::scoped_lock lock(renderer->classWideMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSamplePathCount += renderer->renderThreads[i]->blackSamplePaths;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSamplePathCount += totals[COUNTER_CONTRIBUTION_PATHS];
 
 	return sampleCount ? (100.0 * blackSamplePathCount) / sampleCount : 0.0;
 }
@@ -242,14 +236,12 @@ double HSRStatistics::getPathEfficiencyWindow() {
 	double sampleCount = 0.0 - windowPEffSampleCount;
 	double blackSamplePathCount = 0.0 - windowPEffBlackSampleCount;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSamplePathCount is necessary
-	boost::mutex::scoped_lock lock(renderer->classWideMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSamplePathCount += renderer->renderThreads[i]->blackSamplePaths;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSamplePathCount += totals[COUNTER_CONTRIBUTION_PATHS];
 
 	windowPEffSampleCount += sampleCount;
 	windowPEffBlackSampleCount += blackSamplePathCount;
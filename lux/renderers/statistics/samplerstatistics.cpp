@@ -126,14 +126,12 @@ double SRStatistics::getEfficiency() {
 	double sampleCount = 0.0;
 	double blackSampleCount = 0.0;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSampleCount is necessary
-	boost::mutex::scoped_lock lock(renderer->renderThreadsMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSampleCount += renderer->renderThreads[i]->blackSamples;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSampleCount += totals[COUNTER_CONTRIBUTIONS];
 
 	return sampleCount ? (100.0 * blackSampleCount) / sampleCount : 0.0;
 }
@@ -142,14 +140,12 @@ double SRStatistics::getEfficiencyWindow() {
 	double sampleCount = 0.0 - windowEffSampleCount;
 	double blackSampleCount = 0.0 - windowEffBlackSampleCount;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSampleCount is necessary
-	boost::mutex::scoped_lock lock(renderer->renderThreadsMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSampleCount += renderer->renderThreads[i]->blackSamples;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSampleCount += totals[COUNTER_CONTRIBUTIONS];
 
 	windowPEffSampleCount += sampleCount;
 	windowPEffBlackSampleCount += blackSampleCount;
@@ -161,14 +157,12 @@ double SRStatistics::getPathEfficiency() {
 	double sampleCount = 0.0;
 	double blackSamplePathCount = 0.0;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSamplePathCount is necessary
-	boost::mutex::scoped_lock lock(renderer->renderThreadsMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSamplePathCount += renderer->renderThreads[i]->blackSamplePaths;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSamplePathCount += totals[COUNTER_CONTRIBUTION_PATHS];
 
 	return sampleCount ? (100.0 * blackSamplePathCount) / sampleCount : 0.0;
 }
@@ -177,14 +171,12 @@ double SRStatistics::getPathEfficiencyWindow() {
 	double sampleCount = 0.0 - windowPEffSampleCount;
 	double blackSamplePathCount = 0.0 - windowPEffBlackSampleCount;
 
-	// Get the current counts from the renderthreads
+	// Get the current counts from the render thread counters
 	// Cannot just use getSampleCount() because the blackSamplePathCount is necessary
-	boost::mutex::scoped_lock lock(renderer->renderThreadsMutex);
-	for (u_int i = 0; i < renderer->renderThreads.size(); ++i) {
-		fast_mutex::scoped_lock lockStats(renderer->renderThreads[i]->statLock);
-		sampleCount += renderer->renderThreads[i]->samples;
-		blackSamplePathCount += renderer->renderThreads[i]->blackSamplePaths;
-	}
+	double totals[COUNTER_TYPE_COUNT];
+	counters.Get(totals);
+	sampleCount += totals[COUNTER_SAMPLES];
+	blackSamplePathCount += totals[COUNTER_CONTRIBUTION_PATHS];
 
 	windowPEffSampleCount += sampleCount;
 	windowPEffBlackSampleCount += blackSamplePathCount;
@@ -25,8 +25,16 @@
 #include "luxrays/core/color/spectrumwavelengths.h"
 #include "geometry/raydifferential.h"
 #include "shape.h"
+#include "osfunc.h"
 
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
 #include <boost/pool/object_pool.hpp>
+#include <boost/thread.hpp>
+#include <boost/filesystem.hpp>
 
 using namespace lux;
 
@@ -230,6 +238,7 @@ boost::shared_ptr<LoopSubdiv::SubdivResult> LoopSubdiv::Refine() const {
 			}
 		}
 		newVertices.reserve(v.size());
+		vector<SDVertex *> children(v.size(), NULL);
 		for (u_int j = 0; j < v.size(); ++j) {
 			SDVertex *vert = v[j];
 			if (!vert->startFace)
@@ -237,22 +246,14 @@ boost::shared_ptr<LoopSubdiv::SubdivResult> LoopSubdiv::Refine() const {
 			vert->child = vertexArena.construct();
 			vert->child->regular = v[j]->regular;
 			vert->child->boundary = v[j]->boundary;
-			// Update vertex positions for even vertices
-			if (!vert->boundary) {
-				// Apply one-ring rule for even vertex
-				if (vert->regular)
-					weightOneRing(newUniqueVertices, vert->child, vert, 1.f/16.f);
-				else
-					weightOneRing(newUniqueVertices, vert->child, vert, beta(vert->valence()));
-			} else {
-				// Apply boundary rule for even vertex
-				weightBoundary(newUniqueVertices, vert->child, vert, 1.f/8.f);
-			}
 			// Update even vertex face pointers
 			const SDFace *sf = vert->startFace;
 			vert->child->startFace = sf->children[sf->vnum(vert->P)];
 			newVertices.push_back(v[j]->child);
+			children[j] = vert->child;
 		}
+		// Update vertex positions for even vertices
+		ApplyVertexRules(v, children, false, newUniqueVertices);
 
 		// Compute new odd edge vertices
 		// Update new mesh topology
@@ -397,15 +398,10 @@ boost::shared_ptr<LoopSubdiv::SubdivResult> LoopSubdiv::Refine() const {
 	// Push vertices to limit surface
 	SDVertex *Vlimit = new SDVertex[v.size()];
 	set<Point, PointCompare> uniqueLimit;
-	for (u_int i = 0; i < v.size(); ++i) {
-		// Skip unused vertices
-		if (!v[i]->startFace)
-			continue;
-		if (v[i]->boundary)
-			weightBoundary(uniqueLimit, &Vlimit[i], v[i], 1.f/5.f);
-		else
-			weightOneRing(uniqueLimit, &Vlimit[i], v[i], gamma(v[i]->valence()));
-	}
+	vector<SDVertex *> limitVerts(v.size());
+	for (u_int i = 0; i < v.size(); ++i)
+		limitVerts[i] = &Vlimit[i];
+	ApplyVertexRules(v, limitVerts, true, uniqueLimit);
 	for (u_int i = 0; i < v.size(); ++i) {
 		v[i]->P = Vlimit[i].P;
 		v[i]->u = Vlimit[i].u;
@@ -546,12 +542,135 @@ void LoopSubdiv::GenerateNormals(const vector<SDVertex *> v) {
 	}
 }
 
+// Number of vertices fetched at once by each thread of ApplyVertexRules()
+static const size_t vertexRulesBlockSize = 4096;
+
+void LoopSubdiv::ApplyVertexRulesThread(const vector<SDVertex *> &verts,
+	const vector<SDVertex *> &dest, bool limit,
+	vector<Point> &positions, u_int *blockCounter) const
+{
+	// Only dest[i] and positions[i] are written, the current level is
+	// only read
+	for (;;) {
+		const size_t first = static_cast<size_t>(osAtomicInc(blockCounter)) * vertexRulesBlockSize;
+		if (first >= verts.size())
+			break;
+		const size_t last = min(first + vertexRulesBlockSize, verts.size());
+		for (size_t i = first; i < last; ++i) {
+			SDVertex *vert = verts[i];
+			// Skip unused vertices
+			if (!vert->startFace)
+				continue;
+			if (limit) {
+				// Push the vertex to the limit surface
+				if (vert->boundary)
+					weightBoundary(dest[i], &positions[i], vert, 1.f/5.f);
+				else
+					weightOneRing(dest[i], &positions[i], vert, gamma(vert->valence()));
+			} else if (!vert->boundary) {
+				// Apply one-ring rule for even vertex
+				if (vert->regular)
+					weightOneRing(dest[i], &positions[i], vert, 1.f/16.f);
+				else
+					weightOneRing(dest[i], &positions[i], vert, beta(vert->valence()));
+			} else {
+				// Apply boundary rule for even vertex
+				weightBoundary(dest[i], &positions[i], vert, 1.f/8.f);
+			}
+		}
+	}
+}
+
+void LoopSubdiv::ApplyVertexRules(const vector<SDVertex *> &verts,
+	const vector<SDVertex *> &dest, bool limit,
+	set<Point, PointCompare> &unique) const
+{
+	vector<Point> positions(verts.size());
+	u_int blockCounter = 0;
+	const u_int blockCount = (verts.size() + vertexRulesBlockSize - 1) / vertexRulesBlockSize;
+	const u_int threadCount = min(max(boost::thread::hardware_concurrency(), 1U), blockCount);
+	if (threadCount > 1) {
+		boost::thread_group threads;
+		for (u_int i = 0; i < threadCount; ++i)
+			threads.create_thread(boost::bind(&LoopSubdiv::ApplyVertexRulesThread,
+				this, boost::cref(verts), boost::cref(dest), limit,
+				boost::ref(positions), &blockCounter));
+		threads.join_all();
+	} else
+		ApplyVertexRulesThread(verts, dest, limit, positions, &blockCounter);
+
+	// The set isn't thread safe, the positions are inserted serially
+	for (u_int i = 0; i < verts.size(); ++i) {
+		if (verts[i]->startFace)
+			dest[i]->P = &(*(unique.insert(positions[i]).first));
+	}
+}
+
+// Evaluates the displacement of a range of vertices, the vertices are
+// processed in blocks fetched with an atomic counter
+class DisplacementEvaluator {
+public:
+	DisplacementEvaluator(const vector<SDVertex *> &v,
+		const Texture<float> &dm, float dmScale, float dmOffset,
+		vector<Vector> &d, u_int *counter) : verts(v), dispMap(dm),
+		scale(dmScale), offset(dmOffset), displacements(d),
+		blockCounter(counter) { }
+
+	void operator()() {
+		SpectrumWavelengths swl;
+		swl.Sample(.5f);
+
+		for (;;) {
+			const size_t first = static_cast<size_t>(osAtomicInc(blockCounter)) * blockSize;
+			if (first >= verts.size())
+				break;
+			const size_t last = min(first + blockSize, verts.size());
+			for (size_t i = first; i < last; ++i) {
+				const SDVertex *v = verts[i];
+				if (!v->startFace)
+					continue;
+				Vector dpdu, dpdv;
+				CoordinateSystem(Vector(v->n), &dpdu, &dpdv);
+				DifferentialGeometry dg(*(v->P), v->n, dpdu, dpdv,
+					Normal(0, 0, 0), Normal(0, 0, 0), v->u, v->v,
+					NULL);
+				displacements[i] = (dispMap.Evaluate(swl, dg) *
+					scale + offset) * Normalize(Vector(v->n));
+			}
+		}
+	}
+
+	static const size_t blockSize = 4096;
+
+private:
+	const vector<SDVertex *> &verts;
+	const Texture<float> &dispMap;
+	const float scale, offset;
+	vector<Vector> &displacements;
+	u_int *blockCounter;
+};
+
 void LoopSubdiv::ApplyDisplacementMap(set<Point, PointCompare> &unique, const vector<SDVertex *> verts) const
 {
 	// Dade - apply the displacement map
 	SHAPE_LOG(name, LUX_INFO,LUX_NOERROR) << "Applying displacement map to " << verts.size() << " vertices";
-	SpectrumWavelengths swl;
-	swl.Sample(.5f);
+
+	// Evaluate the displacement of all vertices in parallel, the texture
+	// evaluation is the expensive part of the displacement
+	vector<Vector> displacements(verts.size());
+	u_int blockCounter = 0;
+	const u_int blockCount = (verts.size() + DisplacementEvaluator::blockSize - 1) / DisplacementEvaluator::blockSize;
+	const u_int threadCount = min(max(boost::thread::hardware_concurrency(), 1U), blockCount);
+	DisplacementEvaluator evaluator(verts, *displacementMap,
+		displacementMapScale, displacementMapOffset, displacements,
+		&blockCounter);
+	if (threadCount > 1) {
+		boost::thread_group threads;
+		for (u_int i = 0; i < threadCount; ++i)
+			threads.create_thread(boost::ref(evaluator));
+		threads.join_all();
+	} else
+		evaluator();
 
 	// Compute vertex displacement
 	map<const Point *, std::pair<Vector, u_int> > dispMap;
@@ -559,14 +678,7 @@ void LoopSubdiv::ApplyDisplacementMap(set<Point, PointCompare> &unique, const ve
 		SDVertex *v = verts[i];
 		if (!v->startFace)
 			continue;
-		Vector dpdu, dpdv;
-		CoordinateSystem(Vector(v->n), &dpdu, &dpdv);
-		DifferentialGeometry dg(*(v->P), v->n, dpdu, dpdv,
-			Normal(0, 0, 0), Normal(0, 0, 0), v->u, v->v,
-			NULL);
-		Vector displacement((displacementMap->Evaluate(swl, dg) *
-			displacementMapScale + displacementMapOffset) *
-			Normalize(Vector(v->n)));
+		const Vector &displacement(displacements[i]);
 		map<const Point *, std::pair<Vector, u_int> >::iterator d = dispMap.find(v->P);
 		if (d == dispMap.end()) {
 			// If the point hasn't been found yet
@@ -593,7 +705,157 @@ void LoopSubdiv::ApplyDisplacementMap(set<Point, PointCompare> &unique, const ve
 		verts[i]->P = uniqueMap[verts[i]->P];
 }
 
-void LoopSubdiv::weightOneRing(set<Point, PointCompare> &unique, SDVertex *destVert, SDVertex *vert,
+//------------------------------------------------------------------------------
+// Refined mesh cache
+//------------------------------------------------------------------------------
+
+// File layout: magic, version, triangle and vertex counts, a bit mask of the
+// available vertex attributes and the raw arrays
+static const char subdivCacheMagic[8] = { 'L', 'X', 'S', 'U', 'B', 'D', 'I', 'V' };
+static const u_int subdivCacheVersion = 1;
+
+enum {
+	SUBDIV_CACHE_HAS_N = 1,
+	SUBDIV_CACHE_HAS_UV = 2,
+	SUBDIV_CACHE_HAS_COLS = 4,
+	SUBDIV_CACHE_HAS_ALPHAS = 8
+};
+
+template<class T> static T *ReadCacheArray(std::istream &in, size_t count)
+{
+	T *data = new T[count];
+	in.read(reinterpret_cast<char *>(data), count * sizeof(T));
+	return data;
+}
+
+template<class T> static void WriteCacheArray(std::ostream &out, const T *data, size_t count)
+{
+	out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+}
+
+boost::shared_ptr<LoopSubdiv::SubdivResult> LoopSubdiv::LoadResult(const string &fileName)
+{
+	std::ifstream in(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+	if (!in.good())
+		return boost::shared_ptr<SubdivResult>();
+
+	char magic[8];
+	u_int version, ntris, nverts, flags;
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char *>(&version), sizeof(version));
+	in.read(reinterpret_cast<char *>(&ntris), sizeof(ntris));
+	in.read(reinterpret_cast<char *>(&nverts), sizeof(nverts));
+	in.read(reinterpret_cast<char *>(&flags), sizeof(flags));
+	if (!in.good() || memcmp(magic, subdivCacheMagic, sizeof(magic)) ||
+		version != subdivCacheVersion ||
+		(flags & ~(SUBDIV_CACHE_HAS_N | SUBDIV_CACHE_HAS_UV |
+		SUBDIV_CACHE_HAS_COLS | SUBDIV_CACHE_HAS_ALPHAS)))
+		return boost::shared_ptr<SubdivResult>();
+
+	// The counts must match the file length in case of a corrupted or
+	// truncated file, before allocating anything
+	const size_t nindices = 3 * static_cast<size_t>(ntris);
+	const size_t vertexSize = sizeof(Point) +
+		((flags & SUBDIV_CACHE_HAS_N) ? sizeof(Normal) : 0) +
+		((flags & SUBDIV_CACHE_HAS_UV) ? 2 * sizeof(float) : 0) +
+		((flags & SUBDIV_CACHE_HAS_COLS) ? 3 * sizeof(float) : 0) +
+		((flags & SUBDIV_CACHE_HAS_ALPHAS) ? sizeof(float) : 0);
+	const std::streampos dataStart = in.tellg();
+	in.seekg(0, std::ios_base::end);
+	const std::streampos fileEnd = in.tellg();
+	in.seekg(dataStart);
+	if (!in.good() || (dataStart < 0) || (fileEnd < dataStart) ||
+		static_cast<unsigned long long>(fileEnd - dataStart) !=
+		static_cast<unsigned long long>(nindices) * sizeof(int) +
+		static_cast<unsigned long long>(nverts) * vertexSize)
+		return boost::shared_ptr<SubdivResult>();
+
+	int *indices = NULL;
+	Point *P = NULL;
+	Normal *N = NULL;
+	float *uv = NULL, *cols = NULL, *alphas = NULL;
+	try {
+		indices = ReadCacheArray<int>(in, nindices);
+		P = ReadCacheArray<Point>(in, nverts);
+		if (flags & SUBDIV_CACHE_HAS_N)
+			N = ReadCacheArray<Normal>(in, nverts);
+		if (flags & SUBDIV_CACHE_HAS_UV)
+			uv = ReadCacheArray<float>(in, 2 * static_cast<size_t>(nverts));
+		if (flags & SUBDIV_CACHE_HAS_COLS)
+			cols = ReadCacheArray<float>(in, 3 * static_cast<size_t>(nverts));
+		if (flags & SUBDIV_CACHE_HAS_ALPHAS)
+			alphas = ReadCacheArray<float>(in, nverts);
+	} catch (std::bad_alloc &) {
+		delete[] indices;
+		delete[] P;
+		delete[] N;
+		delete[] uv;
+		delete[] cols;
+		delete[] alphas;
+		return boost::shared_ptr<SubdivResult>();
+	}
+
+	// The result takes the ownership of the arrays
+	boost::shared_ptr<SubdivResult> res(new SubdivResult(ntris, nverts,
+		indices, P, N, uv, cols, alphas));
+	if (!in.good())
+		return boost::shared_ptr<SubdivResult>();
+
+	// Check the indices in case of a corrupted file
+	for (size_t i = 0; i < nindices; ++i) {
+		if (static_cast<u_int>(indices[i]) >= nverts)
+			return boost::shared_ptr<SubdivResult>();
+	}
+
+	return res;
+}
+
+bool LoopSubdiv::SaveResult(const string &fileName, const SubdivResult &res)
+{
+	// Write a temporary file first so concurrent renders sharing the cache
+	// never read a partially written file
+	const string tmpFileName = fileName + ".tmp" +
+		boost::lexical_cast<string>(boost::this_thread::get_id());
+	bool written;
+	{
+		std::ofstream out(tmpFileName.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!out.good())
+			return false;
+
+		const u_int flags = (res.N ? SUBDIV_CACHE_HAS_N : 0) |
+			(res.uv ? SUBDIV_CACHE_HAS_UV : 0) |
+			(res.cols ? SUBDIV_CACHE_HAS_COLS : 0) |
+			(res.alphas ? SUBDIV_CACHE_HAS_ALPHAS : 0);
+		out.write(subdivCacheMagic, sizeof(subdivCacheMagic));
+		out.write(reinterpret_cast<const char *>(&subdivCacheVersion), sizeof(subdivCacheVersion));
+		out.write(reinterpret_cast<const char *>(&res.ntris), sizeof(res.ntris));
+		out.write(reinterpret_cast<const char *>(&res.nverts), sizeof(res.nverts));
+		out.write(reinterpret_cast<const char *>(&flags), sizeof(flags));
+		WriteCacheArray(out, res.indices, 3 * static_cast<size_t>(res.ntris));
+		WriteCacheArray(out, res.P, res.nverts);
+		if (res.N)
+			WriteCacheArray(out, res.N, res.nverts);
+		if (res.uv)
+			WriteCacheArray(out, res.uv, 2 * static_cast<size_t>(res.nverts));
+		if (res.cols)
+			WriteCacheArray(out, res.cols, 3 * static_cast<size_t>(res.nverts));
+		if (res.alphas)
+			WriteCacheArray(out, res.alphas, res.nverts);
+		written = out.good();
+	}
+
+	boost::system::error_code ec;
+	if (written)
+		boost::filesystem::rename(tmpFileName, fileName, ec);
+	if (!written || ec) {
+		boost::filesystem::remove(tmpFileName, ec);
+		return false;
+	}
+
+	return true;
+}
+
+void LoopSubdiv::weightOneRing(SDVertex *destVert, Point *destP, SDVertex *vert,
 	float beta) const
 {
 	// Put _vert_ one-ring in _Pring_
@@ -651,7 +913,7 @@ void LoopSubdiv::weightOneRing(set<Point, PointCompare> &unique, SDVertex *destV
 		alpha += beta * Vring[i]->alpha;
 	}
 
-	destVert->P = &(*(unique.insert(P).first));
+	*destP = P;
 	if (uvSplit) {
 		destVert->u = vert->u;
 		destVert->v = vert->v;
@@ -695,13 +957,13 @@ void SDVertex::oneRing(Point *Pring) const
 	}
 }
 
-void LoopSubdiv::weightBoundary(set<Point, PointCompare> &unique, SDVertex *destVert,  SDVertex *vert,
+void LoopSubdiv::weightBoundary(SDVertex *destVert, Point *destP, SDVertex *vert,
 	float beta) const
 {
 	// Put _vert_ one-ring in _Pring_
 	u_int valence = vert->valence();
 	if (displacementMapSharpBoundary) {
-		destVert->P = &(*(unique.insert(*(vert->P)).first));
+		*destP = *(vert->P);
 		destVert->u = vert->u;
 		destVert->v = vert->v;
 		destVert->n = vert->n;
@@ -717,7 +979,7 @@ void LoopSubdiv::weightBoundary(set<Point, PointCompare> &unique, SDVertex *dest
 	while ((f2 = face->nextFace(vert->P)) != NULL && f2 != vert->startFace)
 		face = f2;
 	if (f2 == vert->startFace) {
-		weightOneRing(unique, destVert, vert, beta);
+		weightOneRing(destVert, destP, vert, beta);
 		return;
 	}
 	f2 = face;
@@ -760,7 +1022,7 @@ void LoopSubdiv::weightBoundary(set<Point, PointCompare> &unique, SDVertex *dest
 	Point P((1 - 2 * beta) * *(vert->P));
 	P += beta * *(Vring[0]->P);
 	P += beta * *(Vring[valence - 1]->P);
-	destVert->P = &(*(unique.insert(P).first));
+	*destP = P;
 
 	if (uvSplit) {
 		destVert->u = vert->u;
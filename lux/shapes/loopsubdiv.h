@@ -200,19 +200,37 @@ public:
 	};
 	boost::shared_ptr<SubdivResult> Refine() const;
 
+	// On-disk cache of refined meshes, LoadResult() returns an empty
+	// pointer if the file doesn't exist or can not be read
+	static boost::shared_ptr<SubdivResult> LoadResult(const string &fileName);
+	static bool SaveResult(const string &fileName, const SubdivResult &res);
+
 private:
 	// LoopSubdiv Private Methods
 	float beta(u_int valence) const {
 		if (valence == 3) return 3.f/16.f;
 		else return 3.f / (8.f * valence);
 	}
-	void weightOneRing(set<Point, PointCompare> &unique, SDVertex *destVert, SDVertex *vert, float beta) const ;
-	void weightBoundary(set<Point, PointCompare> &unique, SDVertex *destVert, SDVertex *vert, float beta) const;
+	// The new position is returned in destP, the caller stores it in the
+	// unique vertex set and sets destVert->P
+	void weightOneRing(SDVertex *destVert, Point *destP, SDVertex *vert, float beta) const;
+	void weightBoundary(SDVertex *destVert, Point *destP, SDVertex *vert, float beta) const;
 	float gamma(u_int valence) const {
 		return 1.f / (valence + 3.f / (8.f * beta(valence)));
 	}
 	static void GenerateNormals(const vector<SDVertex *> verts);
 
+	// Applies the even vertex rules (or the limit surface rules if limit is
+	// true) to verts[i] and stores the result in dest[i]. The rules are
+	// evaluated in parallel, the positions are then inserted in unique in
+	// the vertex order so the result doesn't depend on the thread scheduling.
+	void ApplyVertexRules(const vector<SDVertex *> &verts,
+		const vector<SDVertex *> &dest, bool limit,
+		set<Point, PointCompare> &unique) const;
+	void ApplyVertexRulesThread(const vector<SDVertex *> &verts,
+		const vector<SDVertex *> &dest, bool limit,
+		vector<Point> &positions, u_int *blockCounter) const;
+
 	void ApplyDisplacementMap(set<Point, PointCompare> &unique, const vector<SDVertex *> verts) const;
 
 	// LoopSubdiv Private Data
@@ -24,12 +24,15 @@
 #include "dynload.h"
 #include "context.h"
 #include "loopsubdiv.h"
+#include "tigerhash.h"
 
 #include "./mikktspace/mikktspace.h"
 #include "./mikktspace/weldmesh.h"
 
 #include "luxrays/core/trianglemesh.h"
 
+#include <boost/filesystem.hpp>
+
 using namespace lux;
 
 Mesh::Mesh(const Transform &o2w, bool ro, const string &name,
@@ -268,6 +271,39 @@ private:
 	const boost::shared_ptr<Primitive> ptr;
 };
 
+string Mesh::GetSubdivisionCacheFileName() const
+{
+	if (subdivCacheDir == "")
+		return "";
+
+	// The key covers the input mesh, all the subdivision parameters and the
+	// displacement map definition (the extra key)
+	tigerhash h;
+	const u_int header[4] = { ntris, nverts, nSubdivLevels,
+		(n ? 1U : 0U) | (uvs ? 2U : 0U) | (cols ? 4U : 0U) |
+		(alphas ? 8U : 0U) | (displacementMap ? 16U : 0U) |
+		(displacementMapNormalSmooth ? 32U : 0U) |
+		(displacementMapSharpBoundary ? 64U : 0U) |
+		(normalSplit ? 128U : 0U) };
+	h.update(reinterpret_cast<const char *>(header), sizeof(header));
+	const float dm[2] = { displacementMapScale, displacementMapOffset };
+	h.update(reinterpret_cast<const char *>(dm), sizeof(dm));
+	h.update(subdivCacheKey.c_str(), subdivCacheKey.length());
+	h.update(reinterpret_cast<const char *>(triVertexIndex), 3 * ntris * sizeof(int));
+	h.update(reinterpret_cast<const char *>(p), nverts * sizeof(Point));
+	if (n)
+		h.update(reinterpret_cast<const char *>(n), nverts * sizeof(Normal));
+	if (uvs)
+		h.update(reinterpret_cast<const char *>(uvs), 2 * nverts * sizeof(float));
+	if (cols)
+		h.update(reinterpret_cast<const char *>(cols), 3 * nverts * sizeof(float));
+	if (alphas)
+		h.update(reinterpret_cast<const char *>(alphas), nverts * sizeof(float));
+
+	return (boost::filesystem::path(subdivCacheDir) /
+		(digest_string(h.end_message()) + ".lxsubdiv")).string();
+}
+
 void Mesh::Refine(vector<boost::shared_ptr<Primitive> > &refined,
 	const PrimitiveRefinementHints &refineHints,
 	const boost::shared_ptr<Primitive> &thisPtr)
@@ -280,19 +316,34 @@ void Mesh::Refine(vector<boost::shared_ptr<Primitive> > &refined,
 		MeshSubdivType concreteSubdivType = subdivType;
 		switch (concreteSubdivType) {
 			case SUBDIV_LOOP: {
-				// Apply subdivision
-				LoopSubdiv loopsubdiv(ntris, nverts,
-					triVertexIndex, p, uvs, n, cols, alphas,
-					nSubdivLevels, displacementMap,
-					displacementMapScale,
-					displacementMapOffset,
-					displacementMapNormalSmooth,
-					displacementMapSharpBoundary,
-					normalSplit, name);
-				boost::shared_ptr<LoopSubdiv::SubdivResult> res(loopsubdiv.Refine());
-				// Check if subdivision was successfull
-				if (!res)
-					break;
+				// Look for an already refined mesh in the cache
+				const string cacheFileName(GetSubdivisionCacheFileName());
+				boost::shared_ptr<LoopSubdiv::SubdivResult> res;
+				if (cacheFileName != "") {
+					res = LoopSubdiv::LoadResult(cacheFileName);
+					if (res)
+						SHAPE_LOG(name, LUX_INFO, LUX_NOERROR) << "Loaded " << res->ntris << " subdivided triangles from cache file '" << cacheFileName << "'";
+				}
+
+				if (!res) {
+					// Apply subdivision
+					LoopSubdiv loopsubdiv(ntris, nverts,
+						triVertexIndex, p, uvs, n, cols, alphas,
+						nSubdivLevels, displacementMap,
+						displacementMapScale,
+						displacementMapOffset,
+						displacementMapNormalSmooth,
+						displacementMapSharpBoundary,
+						normalSplit, name);
+					res = loopsubdiv.Refine();
+					// Check if subdivision was successfull
+					if (!res)
+						break;
+
+					if ((cacheFileName != "") &&
+						!LoopSubdiv::SaveResult(cacheFileName, *res))
+						SHAPE_LOG(name, LUX_WARNING, LUX_SYSTEM) << "Unable to write the subdivision cache file '" << cacheFileName << "'";
+				}
 
 				// Remove the old mesh data
 				delete[] p;
@@ -1101,7 +1152,7 @@ static Shape *CreateShape(const Transform &o2w, bool reverseOrientation, const P
 
 	const float colorGamma = params.FindOneFloat("gamma", 1.f);
 
-	return new Mesh(o2w, reverseOrientation, name,
+	Mesh *mesh = new Mesh(o2w, reverseOrientation, name,
 		accelType,
 		npi, P, N, UV, cols, alphas, colorGamma,
 		triType, triIndicesCount, triIndices,
@@ -1110,6 +1161,18 @@ static Shape *CreateShape(const Transform &o2w, bool reverseOrientation, const P
 		displacementMapScale, displacementMapOffset,
 		displacementMapNormalSmooth, displacementMapSharpBoundary,
 		normalSplit, genTangents);
+
+	// Optional on-disk cache of the loop subdivision
+	const string subdivCache = params.FindOneString("subdivcache", "");
+	if (subdivCache != "") {
+		// The definition of the displacement map is part of the cache key
+		const string dmName(displacementMapName != "" ?
+			displacementMapName : params.FindTexture("displacementmap"));
+		mesh->SetSubdivisionCache(subdivCache,
+			Context::GetActive()->GetTextureKey("float", dmName));
+	}
+
+	return mesh;
 }
 
 static Shape *CreateShape( const Transform &o2w, bool reverseOrientation, const ParamSet &params,
@@ -69,6 +69,14 @@ public:
 	virtual void GetShadingInformation(const DifferentialGeometry &dgShading,
 		RGBColor *color, float *alpha) const;
 
+	// Enables the on-disk cache of the loop subdivision result, extraKey
+	// is added to the cache key (i.e. the displacement map definition, see
+	// Context::GetTextureKey())
+	void SetSubdivisionCache(const string &dir, const string &extraKey) {
+		subdivCacheDir = dir;
+		subdivCacheKey = extraKey;
+	}
+
 	friend class MeshWaldTriangle;
 	friend class MeshBaryTriangle;
 	friend class MeshMicroDisplacementTriangle;
@@ -85,6 +93,7 @@ public:
 
 protected:
 	void GenerateTangentSpace();
+	string GetSubdivisionCacheFileName() const;
 
 	// Lotus - refinement data
 	MeshAccelType accelType;
@@ -120,6 +129,8 @@ protected:
 	float displacementMapMin, displacementMapMax;
 	bool displacementMapNormalSmooth, displacementMapSharpBoundary;
 	bool normalSplit;
+	// optional on-disk cache of the subdivided mesh
+	string subdivCacheDir, subdivCacheKey;
 
 	// Generate tangent space for mesh
 	bool generateTangents;
@@ -473,6 +473,17 @@ Shape* PlyMesh::CreateShape(const Transform &o2w,
 		nsubdivlevels, displacementMap, displacementMapScale,
 		displacementMapOffset, displacementMapNormalSmooth,
 		displacementMapSharpBoundary, normalSplit, genTangents);
+
+	// Optional on-disk cache of the loop subdivision
+	const string subdivCache = params.FindOneString("subdivcache", "");
+	if (subdivCache != "") {
+		// The definition of the displacement map is part of the cache key
+		const string dmName(displacementMapName != "" ?
+			displacementMapName : params.FindTexture("displacementmap"));
+		mesh->SetSubdivisionCache(subdivCache,
+			Context::GetActive()->GetTextureKey("float", dmName));
+	}
+
 	delete[] p;
 	delete[] n;
 	delete[] uv;
@@ -0,0 +1,145 @@
+/***************************************************************************
+ *   Copyright (C) 1998-2013 by authors (see AUTHORS.txt)                  *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ *   Lux Renderer is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Lux Renderer is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ *   This project is based on PBRT ; see http://www.pbrt.org               *
+ *   Lux Renderer website : http://www.luxrender.net                       *
+ ***************************************************************************/
+
+// luxbenchparams.cpp*: micro-benchmark of the ParamSet lookups and of the
+// Context::Shape()/Context::MakeNamedMaterial() throughput
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "api.h"
+#include "paramset.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace lux;
+
+static const u_int DEFAULT_COUNT = 200000;
+
+static double Now()
+{
+	const boost::posix_time::ptime t(boost::posix_time::microsec_clock::universal_time());
+	return (t - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_microseconds() / 1000000.;
+}
+
+static void PrintResult(const std::string &name, u_int count, double time)
+{
+	std::cout << name << ": " << count << " in " << time << " secs (" <<
+		(time > 0. ? count / time : 0.) << " per sec)" << std::endl;
+}
+
+static void BenchParamSetLookups(u_int count)
+{
+	// A ParamSet with a size similar to the one of a material with
+	// textures and of a mesh shape
+	ParamSet params;
+	const std::string names[] = { "Kd", "Ks", "Kr", "Kt", "index",
+		"uroughness", "vroughness", "sigma", "bumpmap", "film",
+		"filmindex", "d", "radius", "zmin", "zmax", "phimax", "nsubdivlevels",
+		"dmscale", "dmoffset", "displacementmap" };
+	const u_int nameCount = sizeof(names) / sizeof(names[0]);
+	for (u_int i = 0; i < nameCount; ++i) {
+		const float f = static_cast<float>(i);
+		params.AddFloat(names[i], &f);
+	}
+
+	const double startTime = Now();
+	float sum = 0.f;
+	for (u_int i = 0; i < count; ++i)
+		for (u_int j = 0; j < nameCount; ++j)
+			sum += params.FindOneFloat(names[j], 0.f);
+	const double time = Now() - startTime;
+
+	PrintResult("ParamSet::FindOneFloat()", count * nameCount, time);
+	// Avoid the loop to be optimized away
+	if (sum < 0.f)
+		std::cout << sum << std::endl;
+}
+
+static void BenchMakeNamedMaterial(u_int count)
+{
+	const float kd[3] = { .5f, .5f, .5f };
+	const float sigma = .1f;
+
+	const double startTime = Now();
+	for (u_int i = 0; i < count; ++i) {
+		std::ostringstream name;
+		name << "material_" << i;
+		luxMakeNamedMaterial(name.str().c_str(),
+			"string type", "matte",
+			"color Kd", kd,
+			"float sigma", &sigma,
+			LUX_NULL);
+	}
+	const double time = Now() - startTime;
+
+	PrintResult("Context::MakeNamedMaterial()", count, time);
+}
+
+static void BenchShape(u_int count)
+{
+	const float radius = .5f;
+	const float zmin = -.5f, zmax = .5f, phimax = 360.f;
+
+	const double startTime = Now();
+	for (u_int i = 0; i < count; ++i) {
+		std::ostringstream name;
+		name << "material_" << i;
+
+		luxAttributeBegin();
+		luxNamedMaterial(name.str().c_str());
+		luxTranslate(static_cast<float>(i % 1000), static_cast<float>(i / 1000), 0.f);
+		luxShape("sphere",
+			"float radius", &radius,
+			"float zmin", &zmin,
+			"float zmax", &zmax,
+			"float phimax", &phimax,
+			LUX_NULL);
+		luxAttributeEnd();
+	}
+	const double time = Now() - startTime;
+
+	PrintResult("Context::Shape()", count, time);
+}
+
+int main(int argc, char **argv)
+{
+	const u_int count = (argc > 1) ? static_cast<u_int>(atoi(argv[1])) : DEFAULT_COUNT;
+	std::cout << "Usage: " << argv[0] << " [count]" << std::endl;
+
+	BenchParamSetLookups(count);
+
+	luxInit();
+	// Only errors are interesting here
+	luxErrorFilter(LUX_ERROR);
+
+	luxWorldBegin();
+	BenchMakeNamedMaterial(count);
+	BenchShape(count);
+
+	// The scene is never rendered
+	luxCleanup();
+
+	return EXIT_SUCCESS;
+}
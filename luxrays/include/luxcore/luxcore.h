@@ -86,6 +86,23 @@ CPP_EXPORT CPP_API void Init(void (*LogHandler)(const char *) = NULL);
  */
 CPP_EXPORT CPP_API void ParseLXS(const std::string &fileName, luxrays::Properties &renderConfig, luxrays::Properties &scene);
 
+class Scene;
+
+/*!
+ * \brief Parses a scene described using LuxRender SDL (Scene Description Language).
+ * Inline trianglemesh/mesh shapes are directly defined in the passed Scene
+ * (with Scene::DefineMesh()) instead of being returned as properties. This
+ * avoids a copy of all the mesh data in the scene properties and it is faster.
+ *
+ * \param fileName is the name of the file to parse.
+ * \param renderConfig is where the rendering configuration properties are returned.
+ * \param sceneProps is where the scene properties are returned.
+ * \param scene is where the inline meshes are defined. The scene properties
+ * have to be parsed with the same Scene.
+ */
+CPP_EXPORT CPP_API void ParseLXS(const std::string &fileName, luxrays::Properties &renderConfig,
+		luxrays::Properties &sceneProps, Scene &scene);
+
 class RenderSession;
 
 /*!
@@ -281,6 +298,34 @@ public:
 	template<class T> const T *GetChannel(const FilmChannelType type, const u_int index = 0) {
 		throw std::runtime_error("Called Film::GetChannel() with wrong type");
 	}
+	/*!
+	 * \brief Returns the number of values of each pixel of a channel (for
+	 * instance 4 for CHANNEL_RADIANCE_PER_PIXEL_NORMALIZED: RGB and weight).
+	 *
+	 * \param type is the Film channel to use.
+	 *
+	 * \return the number of values of each pixel.
+	 */
+	u_int GetChannelPixelSize(const FilmChannelType type) const;
+	/*!
+	 * \brief Returns the version of the Film content. The version is
+	 * incremented each time the Film content changes (new samples, reset,
+	 * resize, image pipeline edit, etc.). The memory returned by GetChannel()
+	 * can be read without any copy and the read is consistent if the version
+	 * is the same before and after the read. A resize frees the memory
+	 * returned by GetChannel().
+	 *
+	 * \return the current version.
+	 */
+	u_longlong GetVersion() const;
+	/*!
+	 * \brief Returns if the Film content has changed since a version.
+	 *
+	 * \param version is a value returned by GetVersion().
+	 *
+	 * \return true if the Film content has changed, false otherwise.
+	 */
+	bool HasChanged(const u_longlong version) const;
 
 	/*!
 	 * \brief Sets configuration Properties with new values. This method can be
@@ -870,7 +915,9 @@ public:
 	bool HasDone() const;
 
 	/*!
-	 * \brief Used to wait for the end of the rendering.
+	 * \brief Used to wait for the end of the rendering. It throws an
+	 * exception if the rendering has been stopped by an error (i.e. a
+	 * background OpenCL kernel compilation failure).
 	 */
 	void WaitForDone() const;
 
@@ -0,0 +1,146 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#ifndef _LUXRAYS_CQBVHACCEL_H
+#define	_LUXRAYS_CQBVHACCEL_H
+
+#include <emmintrin.h>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/accelerators/qbvhaccel.h"
+
+namespace luxrays {
+
+/**
+   The compressed QBVH node structure, 64 bytes long (one cache line, half of
+   a QBVHNode). The 4 children bounding boxes are quantized to 8 bits per
+   coordinate, relative to the bounding box of the node. The quantized boxes
+   are always conservative (i.e. they include the original boxes).
+*/
+class CQBVHNode {
+public:
+	/**
+	   Initialize the node from a QBVH node with the same children
+	*/
+	void Init(const QBVHNode &node);
+
+	/**
+	   Return the quantized bounding box of the ith child
+	*/
+	BBox GetBBox(const u_int i) const;
+
+	/**
+	   Intersect a ray described by sse variables with the 4 bounding boxes
+	   of the node (same as QBVHNode::BBoxIntersect()).
+	*/
+	inline int32_t BBoxIntersect(const QuadRay &ray4, const __m128 invDir[3],
+		const int sign[3]) const {
+		const __m128 o[3] = { ray4.ox, ray4.oy, ray4.oz };
+
+		__m128 tMin = ray4.mint;
+		__m128 tMax = ray4.maxt;
+		for (u_int axis = 0; axis < 3; ++axis) {
+			const __m128 boxOrigin = _mm_set1_ps(origin[axis]);
+			const __m128 boxScale = _mm_set1_ps(scale[axis]);
+
+			const __m128 bMin = _mm_add_ps(boxOrigin,
+					_mm_mul_ps(Dequantize(bounds[sign[axis]][axis]), boxScale));
+			const __m128 bMax = _mm_add_ps(boxOrigin,
+					_mm_mul_ps(Dequantize(bounds[1 - sign[axis]][axis]), boxScale));
+
+			tMin = _mm_max_ps(tMin, _mm_mul_ps(_mm_sub_ps(bMin, o[axis]), invDir[axis]));
+			tMax = _mm_min_ps(tMax, _mm_mul_ps(_mm_sub_ps(bMax, o[axis]), invDir[axis]));
+		}
+
+		//return the visit flags
+		return _mm_movemask_ps(_mm_cmpge_ps(tMax, tMin));
+	}
+
+	/**
+	   The origin and the size of a quantization step of the node
+	   bounding box
+	*/
+	float origin[3], scale[3];
+
+	/**
+	   The 4 quantized bounding boxes, in SoA form: bounds[0] are the
+	   min. values and bounds[1] the max. values for each axis
+	*/
+	u_char bounds[2][3][4];
+
+	/**
+	   The 4 children, with the same encoding of QBVHNode (including leaves)
+	*/
+	int32_t children[4];
+
+private:
+	static inline __m128 Dequantize(const u_char q[4]) {
+		int32_t packed;
+		memcpy(&packed, q, sizeof(int32_t));
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i q32 = _mm_unpacklo_epi16(
+				_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+
+		return _mm_cvtepi32_ps(q32);
+	}
+};
+
+/**
+   Compressed QBVH accelerator: a QBVH with CQBVHNode nodes. The tree and the
+   QuadTriangle primitives are the ones of a QBVHAccel, only the nodes are
+   compressed. It trades a bit of traversal work (node decoding and the
+   looser quantized bounds) for half the node memory and cache footprint.
+*/
+class CQBVHAccel : public Accelerator {
+public:
+	CQBVHAccel(const Context *context, u_int mp, u_int fst, u_int sf);
+	virtual ~CQBVHAccel();
+
+	virtual AcceleratorType GetType() const { return ACCEL_CQBVH; }
+	virtual OpenCLKernels *NewOpenCLKernels(OpenCLIntersectionDevice *device,
+		const u_int kernelCount, const u_int stackSize) const { return NULL; }
+	virtual bool CanRunOnOpenCLDevice(OpenCLIntersectionDevice *device) const {
+		return false;
+	}
+	virtual void Init(const std::deque<const Mesh *> &meshes,
+		const u_longlong totalVertexCount,
+		const u_longlong totalTriangleCount);
+
+	virtual bool Intersect(const Ray *ray, RayHit *hit) const;
+	virtual bool IntersectWithStats(const Ray *ray, RayHit *hit,
+			AcceleratorTraversalStats *stats) const;
+
+	u_int GetNodeCount() const { return nNodes; }
+	size_t GetNodesMemorySize() const { return nNodes * sizeof(CQBVHNode); }
+	size_t GetPrimitivesMemorySize() const;
+
+private:
+	const Context *ctx;
+
+	// Used to build the tree and to store the QuadTriangle primitives
+	QBVHAccel *qbvh;
+
+	CQBVHNode *nodes;
+	u_int nNodes;
+};
+
+}
+
+#endif	/* _LUXRAYS_CQBVHACCEL_H */
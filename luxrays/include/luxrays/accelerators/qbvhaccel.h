@@ -373,6 +373,144 @@ public:
 	}
 };
 
+/***************************************************/
+
+/**
+   The QBVH traversal, shared by all the node layouts with the same
+   children encoding and a QBVHNode like BBoxIntersect() method.
+*/
+template<class NodeType, bool HAS_STATS> inline bool QBVHIntersect(const NodeType *nodes,
+		const QuadTriangle *prims, const Ray *initialRay, RayHit *rayHit,
+		AcceleratorTraversalStats *stats) {
+	if (HAS_STATS)
+		stats->AddRay();
+
+	rayHit->t = initialRay->maxt;
+	rayHit->SetMiss();
+	if (!nodes)
+		return false;
+
+	Ray ray(*initialRay);
+
+	//------------------------------
+	// Prepare the ray for intersection
+	QuadRay ray4(ray);
+	__m128 invDir[3];
+	invDir[0] = _mm_set1_ps(1.f / ray.d.x);
+	invDir[1] = _mm_set1_ps(1.f / ray.d.y);
+	invDir[2] = _mm_set1_ps(1.f / ray.d.z);
+
+	int signs[3];
+	ray.GetDirectionSigns(signs);
+
+	//------------------------------
+	// Main loop
+	int todoNode = 0; // the index in the stack
+	int32_t nodeStack[64];
+	nodeStack[0] = 0; // first node to handle: root node
+
+	while (todoNode >= 0) {
+		// Leaves are identified by a negative index
+		if (!QBVHNode::IsLeaf(nodeStack[todoNode])) {
+			if (HAS_STATS)
+				stats->AddNodeVisit(nodeStack[todoNode]);
+
+			const NodeType &node = nodes[nodeStack[todoNode]];
+			--todoNode;
+
+			// It is quite strange but checking here for empty nodes slows down the rendering
+			const int32_t visit = node.BBoxIntersect(ray4, invDir, signs);
+
+			switch (visit) {
+				case (0x1 | 0x0 | 0x0 | 0x0):
+					nodeStack[++todoNode] = node.children[0];
+					break;
+				case (0x0 | 0x2 | 0x0 | 0x0):
+					nodeStack[++todoNode] = node.children[1];
+					break;
+				case (0x1 | 0x2 | 0x0 | 0x0):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[1];
+					break;
+				case (0x0 | 0x0 | 0x4 | 0x0):
+					nodeStack[++todoNode] = node.children[2];
+					break;
+				case (0x1 | 0x0 | 0x4 | 0x0):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[2];
+					break;
+				case (0x0 | 0x2 | 0x4 | 0x0):
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[2];
+					break;
+				case (0x1 | 0x2 | 0x4 | 0x0):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[2];
+					break;
+				case (0x0 | 0x0 | 0x0 | 0x8):
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x1 | 0x0 | 0x0 | 0x8):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x0 | 0x2 | 0x0 | 0x8):
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x1 | 0x2 | 0x0 | 0x8):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x0 | 0x0 | 0x4 | 0x8):
+					nodeStack[++todoNode] = node.children[2];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x1 | 0x0 | 0x4 | 0x8):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[2];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x0 | 0x2 | 0x4 | 0x8):
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[2];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+				case (0x1 | 0x2 | 0x4 | 0x8):
+					nodeStack[++todoNode] = node.children[0];
+					nodeStack[++todoNode] = node.children[1];
+					nodeStack[++todoNode] = node.children[2];
+					nodeStack[++todoNode] = node.children[3];
+					break;
+			}
+		} else {
+			//----------------------
+			// It is a leaf,
+			// all the informations are encoded in the index
+			const int32_t leafData = nodeStack[todoNode];
+			--todoNode;
+
+			if (QBVHNode::IsEmpty(leafData))
+				continue;
+
+			if (HAS_STATS)
+				stats->AddLeafVisit();
+
+			// Perform intersection
+			const u_int nbQuadPrimitives = QBVHNode::NbQuadPrimitives(leafData);
+
+			const u_int offset = QBVHNode::FirstQuadIndex(leafData);
+
+			for (u_int primNumber = offset; primNumber < (offset + nbQuadPrimitives); ++primNumber)
+				prims[primNumber].Intersect(ray4, ray, rayHit);
+		}//end of the else
+	}
+
+	return !rayHit->Miss();
+}
+
 /***************************************************/
 class QBVHAccel : public Accelerator {
 public:
@@ -399,8 +537,11 @@ public:
 	   primitive and fills in an Intersection object.
 	*/
 	virtual bool Intersect(const Ray *ray, RayHit *hit) const;
+	virtual bool IntersectWithStats(const Ray *ray, RayHit *hit,
+			AcceleratorTraversalStats *stats) const;
 
 	friend class MQBVHAccel;
+	friend class CQBVHAccel;
 #if !defined(LUXRAYS_DISABLE_OPENCL)
 	friend class OpenCLQBVHKernels;
 	friend class OpenCLMQBVHKernels;
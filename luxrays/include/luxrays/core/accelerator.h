@@ -21,6 +21,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include "luxrays/luxrays.h"
 #include "luxrays/core/geometry/ray.h"
@@ -29,12 +30,48 @@
 namespace luxrays {
 
 typedef enum {
-	ACCEL_AUTO, ACCEL_BVH, ACCEL_QBVH, ACCEL_MQBVH, ACCEL_MBVH, ACCEL_EMBREE
+	ACCEL_AUTO, ACCEL_BVH, ACCEL_QBVH, ACCEL_MQBVH, ACCEL_MBVH, ACCEL_EMBREE, ACCEL_CQBVH
 } AcceleratorType;
 
 class OpenCLKernels;
 class OpenCLIntersectionDevice;
 
+//------------------------------------------------------------------------------
+// AcceleratorTraversalStats
+//
+// Counts the work done by an accelerator to trace a sequence of rays. The
+// distinct nodes visited by each window of windowSize consecutive rays are
+// an estimate of the working set (and cache footprint) of the traversal: it
+// depends on the order the rays are traced, unlike the node visits per ray.
+//------------------------------------------------------------------------------
+
+class AcceleratorTraversalStats {
+public:
+	AcceleratorTraversalStats(const u_int windowSize = 64);
+
+	void Reset();
+
+	void AddRay() {
+		++rayCount;
+		if (windowSize > 0)
+			currentWindow = static_cast<u_int>((rayCount - 1) / windowSize) + 1;
+	}
+	void AddNodeVisit(const u_int nodeIndex);
+	void AddLeafVisit() { ++leafVisitCount; }
+
+	double GetNodeVisitsPerRay() const;
+	double GetLeafVisitsPerRay() const;
+	double GetDistinctNodesPerWindow() const;
+
+	u_int windowSize;
+	u_longlong rayCount, nodeVisitCount, leafVisitCount, distinctNodeVisitCount;
+
+private:
+	// The last window (+1) each node has been visited
+	std::vector<u_int> nodeLastWindow;
+	u_int currentWindow;
+};
+
 class Accelerator {
 public:
 	Accelerator() { }
@@ -51,6 +88,13 @@ public:
 	virtual void Update() { throw new std::runtime_error("Internal error in Accelerator::Update()"); }
 
 	virtual bool Intersect(const Ray *ray, RayHit *hit) const = 0;
+	// Like Intersect() but collects traversal statistics too. Accelerators
+	// without support for statistics count only the rays.
+	virtual bool IntersectWithStats(const Ray *ray, RayHit *hit,
+			AcceleratorTraversalStats *stats) const {
+		stats->AddRay();
+		return Intersect(ray, hit);
+	}
 
 	static std::string AcceleratorType2String(const AcceleratorType type);
 	static AcceleratorType String2AcceleratorType(const std::string &type);
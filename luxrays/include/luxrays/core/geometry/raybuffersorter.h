@@ -0,0 +1,64 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#ifndef _LUXRAYS_RAYBUFFERSORTER_H
+#define _LUXRAYS_RAYBUFFERSORTER_H
+
+#include <vector>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/geometry/ray.h"
+#include "luxrays/core/geometry/bbox.h"
+
+namespace luxrays {
+
+//------------------------------------------------------------------------------
+// RayBufferSorter
+//
+// Reorders a batch of rays to improve the coherence of the accelerator
+// traversal: rays are binned by direction octant first and then by the cell,
+// along a Morton curve, of a 512^3 grid over the scene bounding box including
+// their origin. Secondary rays (i.e. after a diffuse bounce) are very incoherent
+// in the order they are generated.
+//------------------------------------------------------------------------------
+
+class RayBufferSorter {
+public:
+	RayBufferSorter() { }
+	RayBufferSorter(const BBox &bbox) { SetBBox(bbox); }
+
+	void SetBBox(const BBox &bbox);
+
+	// Computes the order of the rays, available with GetOrder()
+	void Sort(const Ray *rays, const size_t rayCount);
+	const std::vector<u_int> &GetOrder() const { return order; }
+
+	u_int GetKey(const Ray &ray) const;
+
+private:
+	Point pMin;
+	Vector invExtent;
+
+	std::vector<u_longlong> keys;
+	std::vector<u_int> order;
+};
+
+}
+
+#endif	/* _LUXRAYS_RAYBUFFERSORTER_H */
@@ -144,6 +144,9 @@ public:
 
 	void SetThreadCount(const u_int count) { assert(!started); threadCount = count; }
 	u_int GetThreadCount() { return threadCount; }
+	// Reorders the rays of each RayBuffer (see RayBufferSorter) before tracing them
+	void SetRaySorting(const bool enable) { assert(!started); enableRaySorting = enable; }
+	bool IsRaySortingEnabled() const { return enableRaySorting; }
 
 	virtual void SetDataSet(DataSet *newDataSet);
 	virtual void Start();
@@ -178,6 +181,7 @@ private:
 			const u_int threadIndex);
 
 	u_int threadCount;
+	bool enableRaySorting;
 	vector<boost::thread *> intersectionThreads;
 	RayBufferQueueM2M *rayBufferQueue;
 	
@@ -64,6 +64,7 @@ typedef unsigned int u_int;
 #endif
 
 #include <sstream>
+#include <iomanip>
 
 #if defined(__linux__) || defined(__APPLE__) || defined(__CYGWIN__) || defined(__OpenBSD__) || defined(__FreeBSD__)
 #include <stddef.h>
@@ -322,6 +323,42 @@ inline std::string ToString(const Matrix4x4 &m) {
 	return ss.str();
 }
 
+// Returns s quoted and escaped as a JSON string
+inline std::string ToJSONString(const std::string &s) {
+	std::ostringstream ss;
+	ss << "\"";
+	for (size_t i = 0; i < s.length(); ++i) {
+		const char c = s[i];
+		switch (c) {
+			case '"':
+				ss << "\\\"";
+				break;
+			case '\\':
+				ss << "\\\\";
+				break;
+			case '\n':
+				ss << "\\n";
+				break;
+			case '\r':
+				ss << "\\r";
+				break;
+			case '\t':
+				ss << "\\t";
+				break;
+			default:
+				if ((unsigned char)c < 0x20)
+					ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') <<
+							(unsigned int)(unsigned char)c << std::dec;
+				else
+					ss << c;
+				break;
+		}
+	}
+	ss << "\"";
+
+	return ss.str();
+}
+
 inline unsigned int UIntLog2(unsigned int value) {
 	unsigned int l = 0;
 	while (value >>= 1) l++;
@@ -84,6 +84,15 @@ inline void AtomicInc(unsigned int *val) {
 #endif
 }
 
+// Returns the value before the increment
+inline unsigned int AtomicFetchAndInc(unsigned int *val) {
+#if (BOOST_VERSION < 104800)
+	return boost::interprocess::detail::atomic_inc32(((uint32_t *)val));
+#else
+	return boost::interprocess::ipcdetail::atomic_inc32(((uint32_t *)val));
+#endif
+}
+
 inline void AtomicDec(unsigned int *val) {
 #if (BOOST_VERSION < 104800)
 	boost::interprocess::detail::atomic_dec32(((uint32_t *)val));
@@ -234,10 +234,17 @@ class Distribution2D {
 public:
 	// Distribution2D Public Methods
 	Distribution2D(const float *data, u_int nu, u_int nv) {
-		pConditionalV.reserve(nv);
-		// Compute conditional sampling distribution for $\tilde{v}$
-		for (u_int v = 0; v < nv; ++v)
-			pConditionalV.push_back(new Distribution1D(data + v * nu, nu));
+		// Compute conditional sampling distribution for $\tilde{v}$, each
+		// row is independent so they are built in parallel
+		pConditionalV.resize(nv);
+		#pragma omp parallel for
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int v = 0; v < nv; ++v)
+			pConditionalV[v] = new Distribution1D(data + v * nu, nu);
 		// Compute marginal sampling distribution $p[\tilde{v}]$
 		std::vector<float> marginalFunc;
 		marginalFunc.reserve(nv);
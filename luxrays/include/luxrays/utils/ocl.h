@@ -34,6 +34,7 @@
 #else
 #include <CL/cl.hpp>
 #endif
+#include "luxrays/luxrays.h"
 #include "luxrays/core/utils.h"
 
 namespace luxrays {
@@ -44,16 +45,28 @@ extern std::string oclErrorString(cl_int error);
 
 class oclKernelCache {
 public:
-	oclKernelCache() { }
+	oclKernelCache() : hitCount(0), missCount(0), evictionCount(0) { }
 	virtual ~oclKernelCache() { }
 
 	virtual cl::Program *Compile(cl::Context &context, cl::Device &device,
 		const std::string &kernelsParameters, const std::string &kernelSource,
 		bool *cached, cl::STRING_CLASS *error) = 0;
 
+	// Cache statistics
+	u_int GetHitCount() const;
+	u_int GetMissCount() const;
+	u_int GetEvictionCount() const;
+
 	static cl::Program *ForcedCompile(cl::Context &context, cl::Device &device,
 		const std::string &kernelsParameters, const std::string &kernelSource,
 		cl::STRING_CLASS *error);
+
+protected:
+	// The statistics are guarded by the same mutex used for the cache files
+	void IncHitCount();
+	void IncMissCount();
+
+	u_int hitCount, missCount, evictionCount;
 };
 
 class oclKernelDummyCache : public oclKernelCache {
@@ -66,6 +79,7 @@ public:
 		bool *cached, cl::STRING_CLASS *error) {
 		if (cached)
 			*cached = false;
+		IncMissCount();
 
 		return ForcedCompile(context, device, kernelsParameters, kernelSource, error);
 	}
@@ -85,23 +99,41 @@ private:
 	std::vector<char *> kernels;
 };
 
-// WARNING: this class is not thread safe !
+// The cache files are stored in a directory for each platform/device/driver
+// and named after the hash of the kernel parameters and source. The cache can
+// be bounded in size: the least recently used files are removed first (the
+// last write time of a file is updated at each cache hit).
+//
+// Multiple instances (i.e. one for each rendering thread) can be safely used
+// at the same time.
 class oclKernelPersistentCache : public oclKernelCache {
 public:
-	oclKernelPersistentCache(const std::string &applicationName);
+	// A maxSize of 0 means no limit
+	oclKernelPersistentCache(const std::string &applicationName,
+		const u_longlong maxSize = 0);
 	~oclKernelPersistentCache();
 
 	cl::Program *Compile(cl::Context &context, cl::Device &device,
 		const std::string &kernelsParameters, const std::string &kernelSource,
 		bool *cached, cl::STRING_CLASS *error);
 
+	u_longlong GetMaxSize() const { return maxSize; }
+	// Returns the size of all the files in the cache
+	u_longlong GetSize() const;
+
 	static std::string HashString(const std::string &ss);
 	static u_int HashBin(const char *s, const size_t size);
 
 private:
 	boost::filesystem::path GetCacheDir(const std::string &applicationName) const;
+	cl::Program *CompileAndStore(cl::Context &context, cl::Device &device,
+		const std::string &kernelsParameters, const std::string &kernelSource,
+		const boost::filesystem::path &dirPath, const boost::filesystem::path &filePath,
+		cl::STRING_CLASS *error);
+	void EvictEntries(const boost::filesystem::path &keepFilePath);
 
 	std::string appName;
+	u_longlong maxSize;
 };
 
 }
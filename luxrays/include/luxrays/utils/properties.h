@@ -491,7 +491,7 @@ inline std::ostream &operator<<(std::ostream &os, const Property &p) {
  */
 class Properties {
 public:
-	Properties() { }
+	Properties() : nextNameSeq(0) { }
 	/*!
 	 * \brief Sets the list of Property from a text file .
 	 * 
@@ -713,16 +713,30 @@ private:
 		}
 	}
 	template<class Archive> void save(Archive &ar, const u_int version) const {
-		const size_t count = names.size();
+		const size_t count = GetSize();
 		ar & count;
 
-		BOOST_FOREACH(const std::string &name, names)
+		BOOST_FOREACH(const std::string &name, GetAllNames())
 			ar << Get(name);
 	}
 	BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+	// Returns the names starting with prefix, sorted by insertion order
+	void GetAllNamesIndexed(const std::string &prefix, std::vector<std::string> &namesSubset) const;
+	// Marks the entry of names as deleted, returns false if the name is undefined
+	bool MarkDeleted(const std::string &propName);
+	// Removes the entries marked as deleted from names and namesSeq
+	void CompactNames();
+
 	// This vector used, among other things, to keep track of the insertion order
 	std::vector<std::string> names;
+	// The insertion sequence number of each entry of names (in ascending order),
+	// the highest bit is set for the entries marked as deleted
+	std::vector<u_longlong> namesSeq;
+	u_longlong nextNameSeq;
+	// All names sorted alphabetically (with their insertion sequence number)
+	// in order to answer prefix queries without scanning all names
+	std::map<std::string, u_longlong> namesIndex;
 	boost::unordered_map<std::string, Property> props;
 };
 
@@ -0,0 +1,113 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _LUXRAYS_TIMELINE_H
+#define	_LUXRAYS_TIMELINE_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/utils.h"
+
+namespace luxrays {
+
+//------------------------------------------------------------------------------
+// Timeline
+//
+// Records the phases of a process (i.e. the start of a rendering) as a list of
+// timed events with one track for each thread. The recording is disabled by
+// default and costs only a test of a flag in this case. The timeline can be
+// saved in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+//------------------------------------------------------------------------------
+
+class Timeline {
+public:
+	static void Enable(const bool enable);
+	static bool IsEnabled() { return enabled; }
+	static void Clear();
+
+	// Adds an event covering the [startTime, endTime] interval, times are
+	// the ones returned by WallClockTime()
+	static void AddEvent(const std::string &name, const std::string &category,
+			const double startTime, const double endTime);
+	// Adds an instantaneous event
+	static void AddInstantEvent(const std::string &name, const std::string &category);
+
+	static void WriteChromeTrace(std::ostream &os);
+	static void SaveChromeTrace(const std::string &fileName);
+
+private:
+	typedef struct {
+		std::string name, category;
+		double startTime, endTime;
+		u_int threadIndex;
+		bool instant;
+	} Event;
+
+	// Must be called with eventsMutex locked
+	static u_int GetThreadIndex();
+
+	static bool enabled;
+	static double originTime;
+
+	static boost::mutex eventsMutex;
+	static std::vector<Event> events;
+	static std::map<boost::thread::id, u_int> threadIndices;
+};
+
+//------------------------------------------------------------------------------
+// TimelineScope
+//
+// Adds to the Timeline an event covering the life time of the object. The name
+// and the category have to be string literals, nothing is copied when the
+// Timeline is disabled.
+//------------------------------------------------------------------------------
+
+class TimelineScope {
+public:
+	TimelineScope(const char *n, const char *c) : name(n), category(c) {
+		startTime = Timeline::IsEnabled() ? WallClockTime() : -1.0;
+	}
+	// The event name is n followed by arg (i.e. a file name)
+	TimelineScope(const char *n, const std::string &arg, const char *c) : name(n), category(c) {
+		if (Timeline::IsEnabled()) {
+			nameArg = arg;
+			startTime = WallClockTime();
+		} else
+			startTime = -1.0;
+	}
+	~TimelineScope() {
+		if ((startTime >= 0.0) && Timeline::IsEnabled())
+			Timeline::AddEvent(name + nameArg, category, startTime, WallClockTime());
+	}
+
+private:
+	const char *name, *category;
+	std::string nameArg;
+	double startTime;
+};
+
+}
+
+#endif	/* _LUXRAYS_TIMELINE_H */
@@ -19,6 +19,8 @@
 #ifndef _SLG_BIDIRVMCPU_H
 #define	_SLG_BIDIRVMCPU_H
 
+#include <boost/thread/barrier.hpp>
+
 #include "slg/slg.h"
 #include "slg/engines/bidircpu/bidircpu.h"
 
@@ -31,14 +33,34 @@ namespace slg {
 class BiDirVMCPURenderEngine;
 class BiDirVMCPURenderThread;
 
+// The compact copy of a light path vertex stored in the HashGrid, it includes
+// only what is required by vertex merging
+typedef struct {
+	luxrays::Point p;
+	luxrays::Vector fixedDir;
+	luxrays::Spectrum throughput;
+	float dVCM, dVM;
+	u_int lightID;
+} LightVertexVM;
+
+// The HashGrid is shared by all render threads: each thread adds its own
+// light path vertices and all threads build the grid in parallel
 class HashGrid {
 public:
-	HashGrid() { }
+	HashGrid() : vertexCount(0) { }
 	~HashGrid() { }
 
+	void Init(const u_int threadCount);
+
 	u_int GetVertexCount() const { return vertexCount; }
 
-	void Build(vector<vector<PathVertexVM> > &pathsVertices, const float radius);
+	// Replaces the light path vertices of a render thread
+	void SetThreadVertices(const u_int threadIndex,
+		const vector<vector<PathVertexVM> > &pathsVertices);
+
+	// Must be called by all render threads, the barrier is used to
+	// synchronize the build steps
+	void Build(const u_int threadIndex, boost::barrier *barrier, const float radius);
 
 	void Process(const BiDirVMCPURenderThread *thread,
 		const PathVertexVM &eyeVertex, luxrays::Spectrum *radiance) const;
@@ -50,7 +72,7 @@ private:
 		const PathVertexVM &eyeVertex, const int i0, const int i1,
 		luxrays::Spectrum *radiance) const;
 	void Process(const BiDirVMCPURenderThread *thread,
-		const PathVertexVM &eyeVertex, const PathVertexVM *lightVertex,
+		const PathVertexVM &eyeVertex, const LightVertexVM &lightVertex,
 		luxrays::Spectrum *radiance) const;
 
 	void HashRange(const u_int i, int *i0, int *i1) const {
@@ -82,8 +104,12 @@ private:
 	luxrays::BBox vertexBBox;
 	u_int vertexCount;
 
-	vector<const PathVertexVM *> lightVertices;
-    vector<int> cellEnds;
+	// Per thread light path vertices and their bounding boxes
+	vector<vector<LightVertexVM> > threadLightVertices;
+	vector<luxrays::BBox> threadVertexBBoxes;
+
+	vector<LightVertexVM> lightVertices;
+	vector<u_int> cellEnds;
 
 	// Statistics
 	//mutable u_int mergeHitsV2V; // merge Volume with Volume path vertex
@@ -108,6 +134,7 @@ private:
 class BiDirVMCPURenderEngine : public BiDirCPURenderEngine {
 public:
 	BiDirVMCPURenderEngine(const RenderConfig *cfg, Film *flm, boost::mutex *flmMutex);
+	virtual ~BiDirVMCPURenderEngine();
 
 	virtual RenderEngineType GetType() const { return GetObjectType(); }
 	virtual std::string GetTag() const { return GetObjectTag(); }
@@ -127,6 +154,12 @@ protected:
 	static const luxrays::Properties &GetDefaultProps();
 
 	virtual void StartLockLess();
+	virtual void StopLockLess();
+	virtual void EndSceneEditLockLess(const EditActionList &editActions);
+
+	// The vertex merging grid of all render threads
+	HashGrid hashGrid;
+	boost::barrier *threadsSyncBarrier;
 
 private:
 	CPURenderThread *NewRenderThread(const u_int index, luxrays::IntersectionDevice *device) {
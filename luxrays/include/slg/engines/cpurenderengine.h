@@ -124,6 +124,9 @@ public:
 	virtual void StartLockLess();
 	virtual void StopLockLess();
 
+	virtual bool HasCheckpointSupport() const { return true; }
+	virtual luxrays::Properties GetCheckpointState();
+
 	static luxrays::Properties ToProperties(const luxrays::Properties &cfg);
 
 	friend class CPUNoTileRenderThread;
@@ -25,6 +25,7 @@
 #include "slg/film/film.h"
 #include "slg/film/filmsamplesplatter.h"
 #include "slg/bsdf/bsdf.h"
+#include "slg/engines/pathtracer.h"
 
 namespace slg {
 
@@ -41,27 +42,10 @@ public:
 
 	friend class PathCPURenderEngine;
 
-private:
+protected:
 	virtual boost::thread *AllocRenderThread() { return new boost::thread(&PathCPURenderThread::RenderFunc, this); }
 
 	void RenderFunc();
-
-	void GenerateEyeRay(luxrays::Ray &eyeRay, Sampler *sampler, SampleResult &sampleResult);
-
-	bool DirectLightSampling(
-		const float time, const float u0,
-		const float u1, const float u2,
-		const float u3, const float u4,
-		const luxrays::Spectrum &pathThrouput, const BSDF &bsdf,
-		PathVolumeInfo volInfo, const u_int depth,
-		SampleResult *sampleResult);
-
-	void DirectHitFiniteLight(const BSDFEvent lastBSDFEvent, const luxrays::Spectrum &pathThrouput,
-			const float distance, const BSDF &bsdf, const float lastPdfW,
-			SampleResult *sampleResult);
-	void DirectHitInfiniteLight(const BSDFEvent lastBSDFEvent, const luxrays::Spectrum &pathThrouput,
-			const luxrays::Vector &eyeDir, const float lastPdfW,
-			SampleResult *sampleResult);
 };
 
 class PathCPURenderEngine : public CPUNoTileRenderEngine {
@@ -93,6 +77,9 @@ public:
 
 	bool useFastPixelFilter, forceBlackBackground;
 
+	// Initialized with the above settings by StartLockLess()
+	PathTracer pathTracer;
+
 	friend class PathCPURenderThread;
 
 protected:
@@ -32,6 +32,7 @@
 #include "slg/engines/pathoclbase/compiledscene.h"
 #include "slg/engines/pathocl/pathocl_datatypes.h"
 #include "slg/film/filters/filter.h"
+#include "slg/samplers/sampler.h"
 
 namespace slg {
 
@@ -47,6 +48,7 @@ public:
 			PathOCLRenderEngine *re);
 	virtual ~PathOCLRenderThread();
 
+	virtual void Start();
 	virtual void Stop();
 
 	friend class PathOCLRenderEngine;
@@ -60,7 +62,9 @@ protected:
 	virtual std::string AdditionalKernelSources();
 	virtual void SetAdditionalKernelArgs();
 	virtual void CompileAdditionalKernels(cl::Program *program);
+	virtual void RenderCPUFallback(boost::thread &compileThread);
 
+	void InitFallbackFilm();
 	void InitGPUTaskBuffer();
 	void InitSamplesBuffer();
 	void InitSampleDataBuffer();
@@ -97,6 +101,13 @@ protected:
 	u_int sampleDimensions;
 
 	slg::ocl::pathocl::GPUTaskStats *gpuTaskStats;
+
+	// Film used by the CPU rendering done while kernels are compiled. It is
+	// allocated by Start(), before the rendering thread is started, and it is
+	// never replaced while the thread runs. The mutex protects its content
+	// while it is merged with the engine film.
+	Film *fallbackFilm;
+	boost::mutex fallbackFilmMutex;
 };
 
 //------------------------------------------------------------------------------
@@ -134,6 +145,8 @@ public:
 
 	u_int taskCount;
 	bool usePixelAtomics, useFastPixelFilter, forceBlackBackground;
+	// Render on the CPU while kernels are compiled in background
+	bool cpuFallback;
 
 protected:
 	static const luxrays::Properties &GetDefaultProps();
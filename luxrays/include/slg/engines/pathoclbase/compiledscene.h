@@ -77,6 +77,9 @@ public:
 	vector<luxrays::Triangle> tris;
 	vector<luxrays::ocl::Mesh> meshDescs;
 	luxrays::BSphere worldBSphere;
+	// Memory used by the compiled geometry and the memory that would be
+	// required without sharing the instanced meshes
+	size_t geometrySize, flattenedGeometrySize;
 
 	// Compiled Scene Objects
 	vector<slg::ocl::SceneObject> sceneObjs;
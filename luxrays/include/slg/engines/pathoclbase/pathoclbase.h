@@ -121,6 +121,14 @@ protected:
 
 	void StartRenderThread();
 	void StopRenderThread();
+	void RenderThread();
+
+	// Background kernel compilation
+	bool BackgroundInitKernels();
+	void CompileKernelsThreadImpl();
+	// Called while the kernels are compiled in background, the default
+	// implementation just waits for the end of the compilation
+	virtual void RenderCPUFallback(boost::thread &compileThread);
 
 	void IncThreadFilms();
 	void ClearThreadFilms(cl::CommandQueue &oclQueue);
@@ -179,6 +187,9 @@ protected:
 
 	std::string kernelsParameters;
 	luxrays::oclKernelCache *kernelCache;
+	// Used by the background kernel compilation
+	std::string kernelsCompilationError;
+	bool backgroundKernelsInit, backgroundKernelsInitClearFilms;
 
 	boost::thread *renderThread;
 
@@ -206,6 +217,11 @@ public:
 	virtual bool HasDone() const;
 	virtual void WaitForDone() const;
 
+	// Kernel cache statistics of all render threads
+	u_int GetKernelCacheHitCount() const;
+	u_int GetKernelCacheMissCount() const;
+	u_int GetKernelCacheEvictionCount() const;
+
 	friend class PathOCLBaseRenderThread;
 
 	size_t maxMemPageSize;
@@ -227,7 +243,7 @@ protected:
 	vector<PathOCLBaseRenderThread *> renderThreads;
 	
 	std::string additionalKernelOptions;
-	bool writeKernelsToFile;
+	bool writeKernelsToFile, backgroundKernelCompilation;
 };
 
 }
@@ -0,0 +1,97 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_PATHTRACER_H
+#define	_SLG_PATHTRACER_H
+
+#include <vector>
+
+#include "luxrays/core/intersectiondevice.h"
+
+#include "slg/slg.h"
+#include "slg/samplers/sampler.h"
+#include "slg/film/film.h"
+#include "slg/film/filters/filterdistribution.h"
+#include "slg/bsdf/bsdf.h"
+#include "slg/volumes/volume.h"
+
+namespace slg {
+
+//------------------------------------------------------------------------------
+// The CPU path tracing integrator
+//
+// It is used by PATHCPU rendering threads and by the PATHOCL CPU rendering
+// done while the kernels are compiled in background.
+//------------------------------------------------------------------------------
+
+class PathTracer {
+public:
+	PathTracer();
+
+	// The number of samples required by RenderSample()
+	u_int GetSampleSize() const {
+		return sampleBootSize + // To generate eye ray
+			(maxPathDepth + 1) * sampleStepSize; // For each path vertex
+	}
+
+	// Traces a path and stores the result in sampleResults[0]. It doesn't
+	// call Sampler::NextSample().
+	void RenderSample(luxrays::IntersectionDevice *device, const Scene *scene,
+			const Film *film, Sampler *sampler, std::vector<SampleResult> &sampleResults) const;
+
+	void GenerateEyeRay(const Scene *scene, const Film *film, luxrays::Ray &eyeRay,
+			Sampler *sampler, SampleResult &sampleResult) const;
+
+	bool DirectLightSampling(
+		luxrays::IntersectionDevice *device, const Scene *scene,
+		const float time, const float u0,
+		const float u1, const float u2,
+		const float u3, const float u4,
+		const luxrays::Spectrum &pathThrouput, const BSDF &bsdf,
+		PathVolumeInfo volInfo, const u_int depth,
+		SampleResult *sampleResult) const;
+
+	void DirectHitFiniteLight(const Scene *scene, const BSDFEvent lastBSDFEvent,
+			const luxrays::Spectrum &pathThrouput, const float distance, const BSDF &bsdf,
+			const float lastPdfW, SampleResult *sampleResult) const;
+	void DirectHitInfiniteLight(const Scene *scene, const BSDFEvent lastBSDFEvent,
+			const luxrays::Spectrum &pathThrouput, const luxrays::Vector &eyeDir,
+			const float lastPdfW, SampleResult *sampleResult) const;
+
+	// The sample layout
+	static const u_int sampleBootSize = 5;
+	static const u_int sampleStepSize = 9;
+
+	u_int maxPathDepth;
+
+	u_int rrDepth;
+	float rrImportanceCap;
+
+	// Clamping settings
+	float pdfClampValue;
+
+	bool forceBlackBackground;
+
+	// Used to sample the pixel filter if it isn't NULL, otherwise the
+	// samples are splatted on the film
+	const FilterDistribution *pixelFilterDistribution;
+};
+
+}
+
+#endif	/* _SLG_PATHTRACER_H */
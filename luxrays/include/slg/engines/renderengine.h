@@ -45,6 +45,7 @@ typedef enum {
 	BIASPATHCPU,
 	BIASPATHOCL,
 	RTBIASPATHOCL,
+	WAVEFRONTPATHCPU,
 	RENDER_ENGINE_TYPE_COUNT
 } RenderEngineType;
 
@@ -84,6 +85,17 @@ public:
 	void SetSeed(const unsigned long seed);
 	void GenerateNewSeed();
 
+	//--------------------------------------------------------------------------
+	// Checkpoint related methods
+	//--------------------------------------------------------------------------
+
+	virtual bool HasCheckpointSupport() const { return false; }
+	// Returns the state required to resume the rendering (film excluded)
+	virtual luxrays::Properties GetCheckpointState();
+	// Sets the film and the state to resume the rendering from. It must be
+	// called before Start() and startFilm must be available until Start() returns.
+	virtual void SetCheckpoint(const Film *startFilm, const luxrays::Properties &state);
+
 	virtual bool IsMaterialCompiled(const MaterialType type) const {
 		return true;
 	}
@@ -162,6 +174,10 @@ protected:
 	u_int seedBase;
 	luxrays::RandomGenerator seedBaseGenerator;
 
+	// The checkpoint to resume the rendering from (if any)
+	const Film *startFilm;
+	luxrays::Properties startState;
+
 	double startTime, elapsedTime;
 	double samplesCount, raysCount;
 
@@ -30,6 +30,7 @@
 #include "slg/engines/bidirvmcpu/bidirvmcpu.h"
 #include "slg/engines/filesaver/filesaver.h"
 #include "slg/engines/biaspathcpu/biaspathcpu.h"
+#include "slg/engines/wavefrontpathcpu/wavefrontpathcpu.h"
 #include "slg/engines/biaspathocl/biaspathocl.h"
 
 namespace slg {
@@ -76,6 +77,7 @@ protected:
 	OBJECTSTATICREGISTRY_DECLARE_REGISTRATION(RenderEngineRegistry, BiasPathOCLRenderEngine);
 	OBJECTSTATICREGISTRY_DECLARE_REGISTRATION(RenderEngineRegistry, RTBiasPathOCLRenderEngine);
 #endif
+	OBJECTSTATICREGISTRY_DECLARE_REGISTRATION(RenderEngineRegistry, WavefrontPathCPURenderEngine);
 	// Just add here any new Engine (don't forget in the .cpp too)
 
 	friend class RenderEngine;
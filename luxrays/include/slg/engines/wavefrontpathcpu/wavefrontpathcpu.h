@@ -0,0 +1,153 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_WAVEFRONTPATHCPU_H
+#define	_SLG_WAVEFRONTPATHCPU_H
+
+#include <vector>
+
+#include "slg/slg.h"
+#include "slg/engines/pathcpu/pathcpu.h"
+
+namespace slg {
+
+//------------------------------------------------------------------------------
+// Wavefront path tracing CPU render engine
+//
+// Each rendering thread keeps a wavefront of paths in SoA arrays and advances
+// all of them one stage at a time (intersection, direct light sampling,
+// shadow rays, BSDF sampling), like the PathOCL micro-kernels do. Between the
+// stages, the paths are sorted by ray direction or by material in order to
+// improve memory access coherence. It renders the same images of PATHCPU.
+//------------------------------------------------------------------------------
+
+class WavefrontPathCPURenderEngine;
+
+class WavefrontPathCPURenderThread : public PathCPURenderThread {
+public:
+	WavefrontPathCPURenderThread(WavefrontPathCPURenderEngine *engine, const u_int index,
+			luxrays::IntersectionDevice *device);
+	~WavefrontPathCPURenderThread();
+
+	friend class WavefrontPathCPURenderEngine;
+
+private:
+	typedef enum {
+		GENERATE_EYE_RAY,
+		INTERSECT,
+		DIRECT_LIGHT,
+		SAMPLE_BSDF,
+		SPLAT_SAMPLE
+	} PathState;
+
+	virtual boost::thread *AllocRenderThread() { return new boost::thread(&WavefrontPathCPURenderThread::RenderFuncWavefront, this); }
+
+	void RenderFuncWavefront();
+
+	void AllocPaths(const u_int sampleSize);
+	void FreePaths();
+
+	// Fills the list of the paths in the state and returns its size
+	u_int SelectPaths(const PathState state);
+	void SortPathsByDirection(const u_int count);
+	void SortPathsByMaterial(const u_int count);
+
+	// The stages
+	void GenerateEyeRays(const u_int count);
+	void Intersect(const u_int count);
+	void DirectLightSampling(const u_int count);
+	void TraceShadowRays(const u_int count);
+	void SampleBSDF(const u_int count);
+	u_int SplatSamples(const u_int count, VarianceClamping &varianceClamping);
+
+	void InitSampleResult(SampleResult &sampleResult) const;
+	void SetMissedFirstHitAOVs(SampleResult &sampleResult) const;
+
+	luxrays::RandomGenerator *rndGen;
+
+	//--------------------------------------------------------------------------
+	// Path states, one entry for each path of the wavefront
+	//--------------------------------------------------------------------------
+
+	std::vector<PathState> states;
+	std::vector<Sampler *> samplers;
+	// A vector for each path because Sampler::NextSample() requires one
+	std::vector<std::vector<SampleResult> > sampleResults;
+	std::vector<luxrays::Ray> rays;
+	std::vector<luxrays::RayHit> rayHits;
+	std::vector<BSDF> bsdfs;
+	std::vector<PathVolumeInfo> volInfos;
+	std::vector<luxrays::Spectrum> pathThroughputs;
+	std::vector<u_int> pathVertexCounts;
+	std::vector<BSDFEvent> lastBSDFEvents;
+	std::vector<float> lastPdfWs;
+	std::vector<double> rayCounts;
+
+	// Direct light sampling results, waiting for the shadow ray test
+	std::vector<luxrays::Ray> shadowRays;
+	std::vector<luxrays::Spectrum> directLightRadiances;
+	std::vector<luxrays::Spectrum> irradiances;
+	std::vector<const LightSource *> directLights;
+	std::vector<BSDFEvent> directLightEvents;
+	std::vector<bool> hasShadowRays;
+	std::vector<bool> isLightVisibles;
+
+	//--------------------------------------------------------------------------
+	// The list of the paths processed by a stage and the sort keys
+	//--------------------------------------------------------------------------
+
+	std::vector<u_int> pathIndices;
+	std::vector<std::pair<u_int, u_int> > sortKeys;
+};
+
+class WavefrontPathCPURenderEngine : public PathCPURenderEngine {
+public:
+	WavefrontPathCPURenderEngine(const RenderConfig *cfg, Film *flm, boost::mutex *flmMutex);
+
+	virtual RenderEngineType GetType() const { return GetObjectType(); }
+	virtual std::string GetTag() const { return GetObjectTag(); }
+
+	//--------------------------------------------------------------------------
+	// Static methods used by RenderEngineRegistry
+	//--------------------------------------------------------------------------
+
+	static RenderEngineType GetObjectType() { return WAVEFRONTPATHCPU; }
+	static std::string GetObjectTag() { return "WAVEFRONTPATHCPU"; }
+	static luxrays::Properties ToProperties(const luxrays::Properties &cfg);
+	static RenderEngine *FromProperties(const RenderConfig *rcfg, Film *flm, boost::mutex *flmMutex);
+
+	// The number of paths of the wavefront of each thread
+	u_int wavefrontSize;
+	bool sortPaths;
+
+	friend class WavefrontPathCPURenderThread;
+
+protected:
+	static const luxrays::Properties &GetDefaultProps();
+
+	virtual void StartLockLess();
+
+private:
+	CPURenderThread *NewRenderThread(const u_int index, luxrays::IntersectionDevice *device) {
+		return new WavefrontPathCPURenderThread(this, index, device);
+	}
+};
+
+}
+
+#endif	/* _SLG_WAVEFRONTPATHCPU_H */
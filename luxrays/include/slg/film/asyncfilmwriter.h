@@ -0,0 +1,97 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_ASYNCFILMWRITER_H
+#define	_SLG_ASYNCFILMWRITER_H
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "luxrays/utils/properties.h"
+#include "slg/slg.h"
+#include "slg/film/filmoutputs.h"
+
+namespace slg {
+
+class Film;
+
+//------------------------------------------------------------------------------
+// AsyncFilmWriter
+//
+// Writes all the film outputs as the parts of a single tiled multipart
+// OpenEXR file. The caller is blocked only for the time required to copy the
+// outputs (i.e. the snapshot), the conversion, the compression and the I/O
+// are done on a background thread.
+//------------------------------------------------------------------------------
+
+class AsyncFilmWriter {
+public:
+	AsyncFilmWriter(const std::string &fileName, const std::string &compression,
+			const u_int tileSize, const u_int threadCount);
+	~AsyncFilmWriter();
+
+	const std::string &GetFileName() const { return fileName; }
+
+	// Copies all the outputs of the film and queues the write. The film must
+	// be already locked by the caller. If the previous snapshot has not been
+	// written yet, it is replaced by the new one.
+	void Write(Film &film);
+	// Waits for the write of the last snapshot
+	void WaitForDone();
+
+	// Returns NULL if the multipart EXR output is not enabled
+	static AsyncFilmWriter *FromProperties(const luxrays::Properties &cfg);
+	static luxrays::Properties ToProperties(const luxrays::Properties &cfg);
+
+private:
+	typedef struct {
+		std::string name;
+		u_int channelCount;
+		bool isUInt;
+		std::vector<float> floatPixels;
+		std::vector<u_int> uintPixels;
+	} Part;
+
+	typedef struct {
+		u_int width, height;
+		std::vector<Part> parts;
+	} Snapshot;
+
+	static const luxrays::Properties &GetDefaultProps();
+
+	void WriteThreadImpl();
+	void WriteSnapshot(const Snapshot &snapshot) const;
+
+	const std::string fileName, compression;
+	const u_int tileSize;
+
+	boost::thread *writeThread;
+	boost::mutex queueMutex;
+	boost::condition_variable queueCondition;
+	// The snapshot waiting to be written
+	Snapshot *pendingSnapshot;
+	bool isWriting, quit;
+};
+
+}
+
+#endif	/* _SLG_ASYNCFILMWRITER_H */
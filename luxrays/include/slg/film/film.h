@@ -162,8 +162,13 @@ public:
 	void SetImagePipelines(ImagePipeline *newImagePiepeline);
 	void SetImagePipelines(std::vector<ImagePipeline *> &newImagePiepelines);
 	const ImagePipeline *GetImagePipeline(const u_int index) const { return imagePipelines[index]; }
+	u_int GetImagePipelineCount() const { return imagePipelines.size(); }
 
 	void CopyDynamicSettings(const Film &film);
+	// Returns a copy of the film and of all its channels (the convergence
+	// test state excluded). Used to take a snapshot of the film, i.e. to
+	// serialize it without holding the film lock.
+	Film *Copy() const;
 
 	void SetRadianceChannelScale(const u_int index, const RadianceChannelScale &scale);
 
@@ -186,8 +191,11 @@ public:
 	}
 
 	u_int GetChannelCount(const FilmChannelType type) const;
+	// Returns the number of values of each pixel of a channel
+	static u_int GetChannelPixelSize(const FilmChannelType type);
 	size_t GetOutputSize(const FilmOutputs::FilmOutputType type) const;
 	bool HasOutput(const FilmOutputs::FilmOutputType type) const;
+	const FilmOutputs &GetFilmOutputs() const { return filmOutputs; }
 	void Output();
 	void Output(const std::string &fileName, const FilmOutputs::FilmOutputType type,
 		const luxrays::Properties *props = NULL);
@@ -209,6 +217,12 @@ public:
 	u_int GetWidth() const { return width; }
 	u_int GetHeight() const { return height; }
 	const u_int *GetSubRegion() const { return subRegion; }
+	// The version is incremented each time the content of the film changes
+	// (samples added or merged, reset, resize, new image pipeline or radiance
+	// group scales). It is protected by the same lock used for the film.
+	u_longlong GetVersion() const { return version; }
+	// Used to continue the version of a film replaced by this one
+	void SetVersion(const u_longlong v) { version = v; }
 	double GetTotalSampleCount() const {
 		return statsTotalSampleCount;
 	}
@@ -232,15 +246,25 @@ public:
 
 	void SetSampleCount(const double count) {
 		statsTotalSampleCount = count;
+		++version;
 	}
 	void AddSampleCount(const double count) {
 		statsTotalSampleCount += count;
+		++version;
 	}
 
 	void AddSample(const u_int x, const u_int y,
 		const SampleResult &sampleResult, const float weight = 1.f);
 	void AddSampleResultColor(const u_int x, const u_int y,
 		const SampleResult &sampleResult, const float weight);
+	// Splats the color information of a sample on a footprint of pixels
+	// starting at (x0, y0) with the footprintWeights filter weights (pixels
+	// outside of the film are skipped). The list of the channels to update
+	// is built only once for the whole footprint.
+	void AddSampleResultColor(const int x0, const int y0,
+		const u_int footprintWidth, const u_int footprintHeight,
+		const float *footprintWeights,
+		const SampleResult &sampleResult, const float weight);
 	void AddSampleResultData(const u_int x, const u_int y,
 		const SampleResult &sampleResult);
 
@@ -321,6 +345,7 @@ private:
 	template<class Archive> void serialize(Archive &ar, const u_int version);
 
 	void FreeChannels();
+	void BuildSplatChannels(const SampleResult &sampleResult);
 	void MergeSampleBuffers(const u_int index);
 	void GetPixelFromMergedSampleBuffers(const u_int index, float *c) const;
 	void GetPixelFromMergedSampleBuffers(const u_int x, const u_int y, float *c) const {
@@ -353,6 +378,25 @@ private:
 	bool hasDataChannel, hasComposingChannel;
 
 	double statsTotalSampleCount, statsStartSampleTime, statsAvgSampleSec;
+	u_longlong version;
+	// The film version used by the last run of each image pipeline
+	std::vector<u_longlong> imagePipelineVersions;
+
+	// The channels updated by the footprint version of AddSampleResultColor(),
+	// built once for each sample by BuildSplatChannels()
+	template<u_int CHANNELS, u_int WEIGHT_CHANNELS> class SplatChannel {
+	public:
+		SplatChannel(GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, float> *c,
+			const float *v) : channel(c), value(v) { }
+
+		GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, float> *channel;
+		const float *value;
+	};
+	std::vector<SplatChannel<4, 1> > splatChannels41;
+	std::vector<SplatChannel<3, 0> > splatChannels30;
+	std::vector<SplatChannel<2, 1> > splatChannels21;
+	// BY_MATERIAL_ID and BY_OBJECT_ID values
+	std::vector<luxrays::Spectrum> splatColors;
 
 	std::vector<ImagePipeline *> imagePipelines;
 	ConvergenceTest *convTest;
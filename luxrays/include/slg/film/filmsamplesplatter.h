@@ -39,6 +39,10 @@ public:
 
 	// This method must be thread-safe.
 	void SplatSample(Film &film, const SampleResult &sampleResult, const float weight) const;
+	// Splats a batch of samples: the list of Film channels to update is
+	// built once for each sample instead of once for each filtered pixel.
+	// This method must be thread-safe as long as each thread uses a different Film.
+	void SplatSamples(Film &film, const std::vector<SampleResult> &sampleResults, const float weight) const;
 
 private:
 	const Filter *filter;
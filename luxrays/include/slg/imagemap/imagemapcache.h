@@ -34,6 +34,20 @@ namespace slg {
 
 class ImageMapCache {
 public:
+	// Used to describe an image map file to preload
+	class ImageMapRequest {
+	public:
+		ImageMapRequest(const std::string &name, const float g,
+			const ImageMapStorage::ChannelSelectionType selType,
+			const ImageMapStorage::StorageType stType) :
+			fileName(name), gamma(g), selectionType(selType), storageType(stType) { }
+
+		std::string fileName;
+		float gamma;
+		ImageMapStorage::ChannelSelectionType selectionType;
+		ImageMapStorage::StorageType storageType;
+	};
+
 	ImageMapCache();
 	~ImageMapCache();
 
@@ -45,6 +59,13 @@ public:
 		const ImageMapStorage::ChannelSelectionType selectionType,
 		const ImageMapStorage::StorageType storageType);
 
+	// Decodes in parallel all the image map files not yet loaded. They are
+	// added to the cache only when requested with GetImageMap() in order to
+	// preserve the image maps order (and so their indices).
+	void PreloadImageMaps(const std::vector<ImageMapRequest> &requests);
+	// Deletes all the preloaded image maps not requested with GetImageMap()
+	void DeletePreloadedImageMaps();
+
 	// Get a path/name from imageMap object
 	const std::string &GetPath(const ImageMap *im)const {
 		for (boost::unordered_map<std::string, ImageMap *>::const_iterator it = mapByName.begin(); it != mapByName.end(); ++it) {
@@ -78,9 +99,15 @@ private:
 		const ImageMapStorage::StorageType storageType) const;
 	std::string GetCacheKey(const std::string &fileName) const;
 
+	ImageMap *LoadImageMap(const std::string &fileName, const float gamma,
+		const ImageMapStorage::ChannelSelectionType selectionType,
+		const ImageMapStorage::StorageType storageType) const;
+
 	boost::unordered_map<std::string, ImageMap *> mapByName;
 	// Used to preserve insertion order and to retrieve insertion index
 	std::vector<ImageMap *> maps;
+	// Image maps loaded by PreloadImageMaps() and not yet requested
+	boost::unordered_map<std::string, ImageMap *> preloadedMaps;
 
 	float allImageScale;
 };
@@ -19,10 +19,16 @@
 #ifndef _SLG_INFINITELIGHT_H
 #define	_SLG_INFINITELIGHT_H
 
+#include <string>
+
+#include <boost/unordered_map.hpp>
+
 #include "slg/lights/light.h"
 
 namespace slg {
 
+class InfiniteLightDistributionCache;
+
 //------------------------------------------------------------------------------
 // InfiniteLight implementation
 //------------------------------------------------------------------------------
@@ -57,12 +63,56 @@ public:
 
 	virtual luxrays::Properties ToProperties(const ImageMapCache &imgMapCache) const;
 
+	// Builds the importance sampling distribution of an image map with the
+	// requested resolution, each cell is the average of the pixels it covers
+	static luxrays::Distribution2D *BuildImageMapDistribution(const ImageMap *imageMap,
+			const bool sampleUpperHemisphereOnly, const u_int width, const u_int height);
+
 	const ImageMap *imageMap;
 	UVMapping2D mapping;
 	bool sampleUpperHemisphereOnly;
+	// The max. width/height of the importance sampling distribution, 0 means
+	// the image map resolution
+	u_int distributionMaxSize;
+	// Optional, used to share the distribution across light redefinitions
+	InfiniteLightDistributionCache *distributionCache;
 
 private:	
-	luxrays::Distribution2D *imageMapDistribution;
+	const luxrays::Distribution2D *imageMapDistribution;
+};
+
+//------------------------------------------------------------------------------
+// InfiniteLightDistributionCache
+//
+// Editing an infinite light (i.e. changing the gain or the transformation)
+// re-creates the light source. The cache avoids to rebuild the importance
+// sampling distribution when the image map doesn't change.
+//------------------------------------------------------------------------------
+
+class InfiniteLightDistributionCache {
+public:
+	InfiniteLightDistributionCache() { }
+	~InfiniteLightDistributionCache();
+
+	// The returned distribution must be given back with Release()
+	const luxrays::Distribution2D *Get(const ImageMap *imageMap,
+			const bool sampleUpperHemisphereOnly, const u_int width, const u_int height);
+	void Release(const luxrays::Distribution2D *distribution);
+
+	// Used when an image map is redefined: the distributions still in use are
+	// kept alive but are not returned anymore by Get()
+	void Invalidate(const ImageMap *imageMap);
+
+private:
+	typedef struct {
+		luxrays::Distribution2D *distribution;
+		const ImageMap *imageMap;
+		std::string key;
+		u_int refCount;
+	} CacheEntry;
+
+	boost::unordered_map<std::string, CacheEntry *> entryByKey;
+	boost::unordered_map<const luxrays::Distribution2D *, CacheEntry *> entryByDistribution;
 };
 
 }
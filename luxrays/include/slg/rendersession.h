@@ -25,6 +25,7 @@
 #include "slg/renderconfig.h"
 #include "slg/engines/renderengine.h"
 #include "slg/film/film.h"
+#include "slg/film/asyncfilmwriter.h"
 
 namespace slg {
 	
@@ -61,6 +62,24 @@ protected:
 	double lastPeriodicSave, periodiceSaveTime;
 
 	bool periodicSaveEnabled;
+
+	bool IsCheckpointWriting();
+	void WriteCheckpoint(Film *checkpointFilm);
+	void CheckpointThreadImpl(Film *checkpointFilm, const luxrays::Properties engineState);
+
+	static void SaveCheckpoint(const std::string &fileName, const Film *film,
+		const luxrays::Properties &engineState);
+	static Film *LoadCheckpoint(const std::string &fileName, luxrays::Properties *engineState);
+
+	// Checkpoints are written on a background thread, together with the
+	// periodic film saves, and used to resume an interrupted rendering
+	std::string checkpointFileName;
+	boost::thread *checkpointThread;
+	Film *checkpointStartFilm;
+
+	// Used to write all film outputs in a single multipart EXR file on a
+	// background thread (NULL if not enabled)
+	AsyncFilmWriter *asyncFilmWriter;
 };
 
 }
@@ -37,19 +37,29 @@ namespace slg {
 
 class MetropolisSamplerSharedData : public SamplerSharedData {
 public:
-	MetropolisSamplerSharedData();
+	MetropolisSamplerSharedData(const u_int chainCount = 1);
 	virtual ~MetropolisSamplerSharedData() { }
 
+	virtual luxrays::Properties GetState() const;
+	virtual void SetState(const luxrays::Properties &state);
+
 	static SamplerSharedData *FromProperties(const luxrays::Properties &cfg, luxrays::RandomGenerator *rndGen);
 
 	// I'm storing totalLuminance and sampleCount on shared variables
 	// in order to have far more accurate estimation in the image mean intensity
-	// computation
-	double totalLuminance, sampleCount;
+	// computation. There is one entry for each chain of a sampler because
+	// each chain has a different target function.
+	std::vector<double> totalLuminance, sampleCount;
 };
 
 //------------------------------------------------------------------------------
 // Metropolis sampler
+//
+// Each sampler can multiplex more than one Markov chain. Chain 0 targets the
+// sample luminance while the other chains target the luminance raised to
+// smaller exponents (i.e. they are "hotter" and can escape more easily from
+// isolated features like caustic paths). Adjacent chains periodically try to
+// swap their states (replica exchange). All chains contribute to the film.
 //------------------------------------------------------------------------------
 
 class MetropolisSampler : public Sampler {
@@ -57,7 +67,10 @@ public:
 	MetropolisSampler(luxrays::RandomGenerator *rnd, Film *film,
 			const FilmSampleSplatter *flmSplatter, const u_int maxRej,
 			const float pLarge, const float imgRange,
-			MetropolisSamplerSharedData *samplerSharedData);
+			MetropolisSamplerSharedData *samplerSharedData,
+			const u_int chainCount = 1, const float swapRate = 0.f,
+			const float hotChainExponent = 1.f,
+			const bool stratifiedLargeSteps = false);
 	virtual ~MetropolisSampler();
 
 	virtual SamplerType GetType() const { return GetObjectType(); }
@@ -81,29 +94,51 @@ public:
 	static slg::ocl::Sampler *FromPropertiesOCL(const luxrays::Properties &cfg);
 
 private:
+	typedef struct {
+		float *samples;
+		u_int *sampleStamps;
+
+		float weight;
+		u_int consecRejects;
+		u_int stamp;
+
+		// Data saved for the current sample
+		u_int currentStamp;
+		double currentLuminance;
+		float *currentSamples;
+		u_int *currentSampleStamps;
+		std::vector<SampleResult> currentSampleResult;
+
+		// The chain target function is luminance^exponent
+		float exponent;
+
+		bool isLargeMutation, cooldown;
+	} MetropolisChain;
+
 	static const luxrays::Properties &GetDefaultProps();
 
+	double Target(const MetropolisChain &chain, const double luminance) const;
+	float InvMeanTarget(const u_int chainIndex) const;
+	void SplatCurrentSample(const u_int chainIndex);
+	void SetUpNextMutation(MetropolisChain &chain);
+	void TrySwap();
+
 	MetropolisSamplerSharedData *sharedData;
 
 	u_int maxRejects;
 	float largeMutationProbability, imageMutationRange;
+	float chainSwapRate, hotChainExponent;
+	bool stratifiedLargeSteps;
 
 	u_int sampleSize;
-	float *samples;
-	u_int *sampleStamps;
-
-	float weight;
-	u_int consecRejects;
-	u_int stamp;
 
-	// Data saved for the current sample
-	u_int currentStamp;
-	double currentLuminance;
-	float *currentSamples;
-	u_int *currentSampleStamps;
-	std::vector<SampleResult> currentSampleResult;
+	std::vector<MetropolisChain> chains;
+	// The chain used for the current sample
+	u_int chainIndex;
 
-	bool isLargeMutation, cooldown;
+	// Used to stratify the image X/Y of large mutations
+	u_int largeStepIndex;
+	float largeStepOffsetX, largeStepOffsetY;
 };
 
 }
@@ -52,6 +52,11 @@ public:
 	SamplerSharedData() { }
 	virtual ~SamplerSharedData() { }
 
+	// Used to save and restore the state of the sampler (i.e. pass counters)
+	// in a rendering checkpoint
+	virtual luxrays::Properties GetState() const { return luxrays::Properties(); }
+	virtual void SetState(const luxrays::Properties &state) { }
+
 	static SamplerSharedData *FromProperties(const luxrays::Properties &cfg, luxrays::RandomGenerator *rndGen);
 };
 
@@ -42,6 +42,9 @@ public:
 	SobolSamplerSharedData(luxrays::RandomGenerator *rndGen);
 	virtual ~SobolSamplerSharedData() { }
 
+	virtual luxrays::Properties GetState() const;
+	virtual void SetState(const luxrays::Properties &state);
+
 	static SamplerSharedData *FromProperties(const luxrays::Properties &cfg, luxrays::RandomGenerator *rndGen);
 
 	float rng0, rng1;
@@ -59,6 +62,50 @@ public:
 
 extern void SobolGenerateDirectionVectors(u_int *vectors, const u_int dimensions);
 
+//------------------------------------------------------------------------------
+// SobolSequence
+//
+// Generates all the dimensions of consecutive Sobol samples at once. Moving
+// from index i to i + 1 flips the bits 0..c of i (c is the number of trailing
+// zeros of i + 1) so each dimension is updated with a single XOR of the
+// prefix XOR of its first c + 1 direction numbers. The tables are stored bit
+// major so the update of all dimensions is a plain loop over contiguous
+// memory the compiler can vectorize.
+//------------------------------------------------------------------------------
+
+class SobolSequence {
+public:
+	SobolSequence();
+	~SobolSequence() { }
+
+	void RequestSamples(const u_int size);
+	u_int GetDimensionCount() const { return dimensionCount; }
+
+	// Computes all the dimensions of the sample index from scratch
+	void SetIndex(const u_int index);
+	// Moves to the next sample index with one XOR for each dimension
+	void NextIndex();
+	u_int GetIndex() const { return index; }
+	const u_int *GetValues() const { return &values[0]; }
+
+	// Writes all the dimensions of count consecutive samples, starting
+	// from index first, in values[sample * GetDimensionCount() + dimension]
+	void GenerateBlock(const u_int first, const u_int count, u_int *values);
+
+	// Reference one dimension at a time implementation
+	u_int SobolDimension(const u_int index, const u_int dimension) const;
+
+private:
+	u_int dimensionCount;
+	// Direction numbers, dimension major
+	std::vector<u_int> directions;
+	// Prefix XOR of the direction numbers, bit major
+	std::vector<u_int> grayDirections;
+
+	u_int index;
+	std::vector<u_int> values;
+};
+
 class SobolSampler : public Sampler {
 public:
 	SobolSampler(luxrays::RandomGenerator *rnd, Film *flm,
@@ -87,11 +134,9 @@ public:
 private:
 	static const luxrays::Properties &GetDefaultProps();
 
-	u_int SobolDimension(const u_int index, const u_int dimension) const;
-
 	SobolSamplerSharedData *sharedData;
 
-	u_int *directions;
+	SobolSequence sequence;
 	u_int passBase, passOffset;
 };
 
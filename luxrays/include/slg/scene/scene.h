@@ -31,6 +31,7 @@
 #include "slg/cameras/camera.h"
 #include "slg/editaction.h"
 #include "slg/lights/light.h"
+#include "slg/lights/infinitelight.h"
 #include "slg/lights/lightsourcedefinition.h"
 #include "slg/textures/texture.h"
 #include "slg/textures/texturedefs.h"
@@ -125,6 +126,9 @@ public:
 
 	ExtMeshCache extMeshCache; // Mesh objects cache
 	ImageMapCache imgMapCache; // Image maps cache
+	// Infinite light importance sampling distributions cache, it must be
+	// declared before lightDefs
+	InfiniteLightDistributionCache infiniteLightDistributionCache;
 
 	TextureDefinitions texDefs; // Texture definitions
 	MaterialDefinitions matDefs; // Material definitions
@@ -162,6 +166,8 @@ protected:
 	LightSource *CreateLightSource(const std::string &lightName, const luxrays::Properties &props);
 
 	Texture *GetTexture(const luxrays::Property &name);
+
+	void AddImageMapsEditAction();
 };
 
 }
@@ -20,6 +20,7 @@
 #define	_SLG_DENSITYGRIDTEX_H
 
 #include "slg/textures/texture.h"
+#include "slg/textures/sparsedensitygrid.h"
 
 namespace slg {
 
@@ -31,8 +32,13 @@ class DensityGridTexture : public Texture {
 public:
 	enum WrapMode { WRAP_REPEAT, WRAP_BLACK, WRAP_WHITE, WRAP_CLAMP };
 	DensityGridTexture(const TextureMapping3D *mp, const u_int nx, const u_int ny, const u_int nz,
-            const float *dt, const std::string wrapmode);
-	virtual ~DensityGridTexture() { }
+            const float *dt, const std::string wrapmode,
+			const ImageMapStorage::StorageType storageType = ImageMapStorage::FLOAT);
+	// The texture takes the ownership of the grid. The file name is used only
+	// to export the texture definition.
+	DensityGridTexture(const TextureMapping3D *mp, SparseDensityGrid *grid,
+			const std::string wrapmode, const std::string &fileName);
+	virtual ~DensityGridTexture() { delete grid; }
 
 	virtual TextureType GetType() const { return DENSITYGRID_TEX; }
 	virtual float GetFloatValue(const HitPoint &hitPoint) const;
@@ -40,20 +46,29 @@ public:
 	virtual float Y() const { return .5f; }
 	virtual float Filter() const { return .5f; }
 
-	const vector<float> &GetData() const { return data; }
+	const SparseDensityGrid *GetGrid() const { return grid; }
+	u_int GetNx() const { return nx; }
+	u_int GetNy() const { return ny; }
+	u_int GetNz() const { return nz; }
+	WrapMode GetWrapMode() const { return wrapMode; }
+	// Returns the voxel value, out of range indices are clamped
+	float GetVoxel(const int x, const int y, const int z) const { return D(x, y, z); }
 
 	virtual luxrays::Properties ToProperties(const ImageMapCache &imgMapCache) const;
 	const TextureMapping3D *GetTextureMapping() const { return mapping; }
 
 private:
+	void SetWrapMode(const std::string &wrapmode);
+
 	const float D(int x, int y, int z) const {
-		return data[((luxrays::Clamp(z, 0, nz - 1) * ny) + luxrays::Clamp(y, 0, ny - 1)) * nx + luxrays::Clamp(x, 0, nx - 1)];
+		return grid->GetVoxel(x, y, z);
 	}
 
 	const TextureMapping3D *mapping;
     const int nx, ny, nz;
-	vector<float> data;
+	SparseDensityGrid *grid;
 	WrapMode wrapMode;
+	std::string fileName;
 };
 
 }
@@ -0,0 +1,112 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_SPARSEDENSITYGRID_H
+#define	_SLG_SPARSEDENSITYGRID_H
+
+#include <string>
+#include <vector>
+
+#include <boost/serialization/version.hpp>
+
+#include "luxrays/luxrays.h"
+#include "slg/imagemap/imagemap.h"
+
+namespace slg {
+
+//------------------------------------------------------------------------------
+// SparseDensityGrid
+//
+// A voxel grid split in bricks of BRICK_SIZE^3 voxels. Bricks with a constant
+// value (i.e. empty space) have no voxel storage at all, the others store
+// their voxels quantized between the brick min. and max. values.
+//------------------------------------------------------------------------------
+
+class SparseDensityGrid {
+public:
+	static const u_int BRICK_SIZE_SHIFT = 3;
+	static const u_int BRICK_SIZE = 1 << BRICK_SIZE_SHIFT;
+	static const u_int BRICK_SIZE_MASK = BRICK_SIZE - 1;
+	static const u_int BRICK_VOXEL_COUNT = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+	// Brick index used for bricks without voxel storage
+	static const u_int CONSTANT_BRICK = 0xffffffffu;
+
+	SparseDensityGrid(const u_int nx, const u_int ny, const u_int nz,
+			const float *data, const ImageMapStorage::StorageType storageType);
+	~SparseDensityGrid() { }
+
+	u_int GetNx() const { return nx; }
+	u_int GetNy() const { return ny; }
+	u_int GetNz() const { return nz; }
+	u_int GetBricksX() const { return bricksX; }
+	u_int GetBricksY() const { return bricksY; }
+	u_int GetBricksZ() const { return bricksZ; }
+	u_int GetBrickCount() const { return bricksX * bricksY * bricksZ; }
+	u_int GetStoredBrickCount() const { return storedBrickCount; }
+	ImageMapStorage::StorageType GetStorageType() const { return storageType; }
+
+	// Out of range indices are clamped
+	float GetVoxel(const int x, const int y, const int z) const;
+	// Returns a dense copy of the grid
+	void GetDenseData(std::vector<float> &data) const;
+
+	const std::vector<u_int> &GetBrickIndices() const { return brickIndices; }
+	const std::vector<float> &GetBrickMins() const { return brickMins; }
+	const std::vector<float> &GetBrickMaxs() const { return brickMaxs; }
+	const std::vector<u_char> &GetVoxelsData() const { return voxels; }
+	size_t GetMemorySize() const;
+
+	static size_t GetVoxelSize(const ImageMapStorage::StorageType storageType);
+
+	// Bricked volume file support
+	static SparseDensityGrid *LoadSerialized(const std::string &fileName);
+	static void SaveSerialized(const std::string &fileName, const SparseDensityGrid *grid);
+
+	friend class boost::serialization::access;
+
+private:
+	// Used by serialization
+	SparseDensityGrid() { }
+
+	template<class Archive> void serialize(Archive &ar, const u_int version);
+	// Checks the consistency of the data read from a file
+	bool IsValid() const;
+
+	float DecodeVoxel(const u_int brickIndex, const u_int storedBrickIndex,
+			const u_int voxelIndex) const;
+	void EncodeVoxel(const u_int storedBrickIndex, const u_int voxelIndex,
+			const float value, const float min, const float max);
+
+	u_int nx, ny, nz;
+	u_int bricksX, bricksY, bricksZ;
+	u_int storedBrickCount;
+	ImageMapStorage::StorageType storageType;
+
+	// Per brick information
+	std::vector<u_int> brickIndices;
+	std::vector<float> brickMins, brickMaxs;
+
+	// Voxels of the stored bricks
+	std::vector<u_char> voxels;
+};
+
+}
+
+BOOST_CLASS_VERSION(slg::SparseDensityGrid, 1)
+
+#endif	/* _SLG_SPARSEDENSITYGRID_H */
@@ -0,0 +1,154 @@
+#line 2 "texture_densitygrid_funcs.cl"
+
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+//------------------------------------------------------------------------------
+// DensityGrid texture
+//------------------------------------------------------------------------------
+
+// I can have a DENSITYGRID texture only if PARAM_HAS_IMAGEMAPS is defined
+#if defined(PARAM_ENABLE_TEX_DENSITYGRID) && defined(PARAM_HAS_IMAGEMAPS)
+
+#define DENSITYGRID_BRICK_SIZE_SHIFT 3
+#define DENSITYGRID_BRICK_SIZE_MASK 7
+#define DENSITYGRID_BRICK_VOXEL_COUNT 512
+#define DENSITYGRID_CONSTANT_BRICK 0xffffffffu
+
+#define DENSITYGRID_WRAP_REPEAT 0
+#define DENSITYGRID_WRAP_BLACK 1
+#define DENSITYGRID_WRAP_WHITE 2
+#define DENSITYGRID_WRAP_CLAMP 3
+
+// The data layout is: brick indices, brick min. values, brick max. values and
+// the voxels of the stored bricks
+float DensityGridTexture_D(__global const DensityGridTexParam *densityGrid,
+		__global const float *data, const int x, const int y, const int z) {
+	const uint cx = clamp(x, 0, (int)densityGrid->nx - 1);
+	const uint cy = clamp(y, 0, (int)densityGrid->ny - 1);
+	const uint cz = clamp(z, 0, (int)densityGrid->nz - 1);
+
+	const uint brickCount = densityGrid->bricksX * densityGrid->bricksY * densityGrid->bricksZ;
+	const uint brickIndex = ((cz >> DENSITYGRID_BRICK_SIZE_SHIFT) * densityGrid->bricksY +
+			(cy >> DENSITYGRID_BRICK_SIZE_SHIFT)) * densityGrid->bricksX + (cx >> DENSITYGRID_BRICK_SIZE_SHIFT);
+	// The brick indices are stored as uint
+	__global const uint *brickIndices = (__global const uint *)data;
+	const uint storedBrickIndex = brickIndices[brickIndex];
+	const float brickMin = data[brickCount + brickIndex];
+	if (storedBrickIndex == DENSITYGRID_CONSTANT_BRICK)
+		return brickMin;
+	const float brickMax = data[2 * brickCount + brickIndex];
+
+	const uint voxelIndex = storedBrickIndex * DENSITYGRID_BRICK_VOXEL_COUNT +
+			((((cz & DENSITYGRID_BRICK_SIZE_MASK) << DENSITYGRID_BRICK_SIZE_SHIFT) +
+			(cy & DENSITYGRID_BRICK_SIZE_MASK)) << DENSITYGRID_BRICK_SIZE_SHIFT) + (cx & DENSITYGRID_BRICK_SIZE_MASK);
+	__global const void *voxels = &data[3 * brickCount];
+
+	switch (densityGrid->storageType) {
+		case BYTE:
+			return mix(brickMin, brickMax, ((__global const uchar *)voxels)[voxelIndex] * (1.f / 255.f));
+		case HALF:
+			return mix(brickMin, brickMax, vload_half(voxelIndex, (__global const half *)voxels));
+		case FLOAT:
+			return ((__global const float *)voxels)[voxelIndex];
+		default:
+			return 0.f;
+	}
+}
+
+float DensityGridTexture_ConstEvaluateFloat(__global const Texture *tex,
+		__global HitPoint *hitPoint
+		IMAGEMAPS_PARAM_DECL) {
+	__global const DensityGridTexParam *densityGrid = &tex->densityGrid;
+	__global const ImageMap *imageMap = &imageMapDescs[densityGrid->imageMapIndex];
+	__global const float *data = ImageMap_GetPixelsAddress(
+			imageMapBuff, imageMap->pageIndex, imageMap->pixelsIndex);
+
+	const float3 P = TextureMapping3D_Map(&densityGrid->mapping, hitPoint);
+	const int nx = densityGrid->nx;
+	const int ny = densityGrid->ny;
+	const int nz = densityGrid->nz;
+
+	float x, y, z;
+	int vx, vy, vz;
+	switch (densityGrid->wrapMode) {
+		case DENSITYGRID_WRAP_REPEAT:
+			x = P.x * nx;
+			vx = Floor2Int(x);
+			x -= vx;
+			vx = Mod(vx, nx);
+			y = P.y * ny;
+			vy = Floor2Int(y);
+			y -= vy;
+			vy = Mod(vy, ny);
+			z = P.z * nz;
+			vz = Floor2Int(z);
+			z -= vz;
+			vz = Mod(vz, nz);
+			break;
+		case DENSITYGRID_WRAP_BLACK:
+		case DENSITYGRID_WRAP_WHITE:
+			if (P.x < 0.f || P.x >= 1.f ||
+				P.y < 0.f || P.y >= 1.f ||
+				P.z < 0.f || P.z >= 1.f)
+				return (densityGrid->wrapMode == DENSITYGRID_WRAP_BLACK) ? 0.f : 1.f;
+			x = P.x * nx;
+			vx = Floor2Int(x);
+			x -= vx;
+			y = P.y * ny;
+			vy = Floor2Int(y);
+			y -= vy;
+			z = P.z * nz;
+			vz = Floor2Int(z);
+			z -= vz;
+			break;
+		case DENSITYGRID_WRAP_CLAMP:
+			x = clamp(P.x, 0.f, 1.f) * nx;
+			vx = min(Floor2Int(x), nx - 1);
+			x -= vx;
+			y = clamp(P.y, 0.f, 1.f) * ny;
+			vy = min(Floor2Int(P.y * ny), ny - 1);
+			y -= vy;
+			z = clamp(P.z, 0.f, 1.f) * nz;
+			vz = min(Floor2Int(P.z * nz), nz - 1);
+			z -= vz;
+			break;
+		default:
+			return 0.f;
+	}
+
+	// Trilinear interpolation of the grid element
+	return mix(
+		mix(
+			mix(DensityGridTexture_D(densityGrid, data, vx, vy, vz), DensityGridTexture_D(densityGrid, data, vx + 1, vy, vz), x),
+			mix(DensityGridTexture_D(densityGrid, data, vx, vy + 1, vz), DensityGridTexture_D(densityGrid, data, vx + 1, vy + 1, vz), x),
+			y),
+		mix(
+			mix(DensityGridTexture_D(densityGrid, data, vx, vy, vz + 1), DensityGridTexture_D(densityGrid, data, vx + 1, vy, vz + 1), x),
+			mix(DensityGridTexture_D(densityGrid, data, vx, vy + 1, vz + 1), DensityGridTexture_D(densityGrid, data, vx + 1, vy + 1, vz + 1), x),
+			y),
+		z);
+}
+
+float3 DensityGridTexture_ConstEvaluateSpectrum(__global const Texture *tex,
+		__global HitPoint *hitPoint
+		IMAGEMAPS_PARAM_DECL) {
+	return (float3)(DensityGridTexture_ConstEvaluateFloat(tex, hitPoint IMAGEMAPS_PARAM));
+}
+
+#endif
@@ -24,7 +24,7 @@ typedef enum {
 	CONST_FLOAT, CONST_FLOAT3, IMAGEMAP, SCALE_TEX, FRESNEL_APPROX_N,
 	FRESNEL_APPROX_K, MIX_TEX, ADD_TEX, SUBTRACT_TEX, HITPOINTCOLOR, HITPOINTALPHA,
 	HITPOINTGREY, NORMALMAP_TEX, BLACKBODY_TEX, IRREGULARDATA_TEX,
-	ABS_TEX, CLAMP_TEX, BILERP_TEX, COLORDEPTH_TEX, HSV_TEX,
+	ABS_TEX, CLAMP_TEX, BILERP_TEX, COLORDEPTH_TEX, HSV_TEX, DENSITYGRID_TEX,
 	// Procedural textures
 	BLENDER_BLEND, BLENDER_CLOUDS, BLENDER_DISTORTED_NOISE, BLENDER_MAGIC,
 	BLENDER_MARBLE, BLENDER_MUSGRAVE, BLENDER_STUCCI, BLENDER_WOOD, BLENDER_VORONOI,
@@ -306,6 +306,15 @@ typedef struct {
 	Spectrum rgb;
 } IrregularDataParam;
 
+typedef struct {
+	TextureMapping3D mapping;
+	unsigned int nx, ny, nz;
+	unsigned int bricksX, bricksY, bricksZ;
+	// The brick indices, bounds and voxels are stored as an image map
+	unsigned int imageMapIndex;
+	unsigned int storageType, wrapMode;
+} DensityGridTexParam;
+
 typedef struct {
 	unsigned int krIndex;
 } FresnelColorParam;
@@ -374,6 +383,7 @@ typedef struct {
         NormalMapTexParam normalMap;
 		BlackBodyParam blackBody;
 		IrregularDataParam irregularData;
+		DensityGridTexParam densityGrid;
 		FresnelColorParam fresnelColor;
 		FresnelConstParam fresnelConst;
 		AbsTexParam absTex;
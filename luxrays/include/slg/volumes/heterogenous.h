@@ -20,6 +20,7 @@
 #define	_SLG_HETEROGENOUSVOL_H
 
 #include "slg/volumes/volume.h"
+#include "slg/volumes/majorantgrid.h"
 
 namespace slg {
 
@@ -32,7 +33,9 @@ public:
 	HeterogeneousVolume(const Texture *iorTex, const Texture *emiTex,
 			const Texture *a, const Texture *s,
 			const Texture *g, const float stepSize, const u_int maxStepsCount,
-			const bool multiScattering);
+			const bool multiScattering, const bool tracking = false,
+			const u_int trackingCellSize = 8);
+	virtual ~HeterogeneousVolume();
 
 	virtual float Scatter(const luxrays::Ray &ray, const float u, const bool scatteredStart,
 		luxrays::Spectrum *connectionThroughput, luxrays::Spectrum *connectionEmission) const;
@@ -65,17 +68,33 @@ public:
 	float GetStepSize() const { return stepSize; }
 	u_int GetMaxStepsCount() const { return maxStepsCount; }
 	bool IsMultiScattering() const { return multiScattering; }
+	bool IsTracking() const { return tracking; }
+	u_int GetTrackingCellSize() const { return trackingCellSize; }
+	// Returns NULL when ray marching is used
+	const VolumeMajorantGrid *GetMajorantGrid() const { return majorantGrid; }
 
 protected:
 	virtual luxrays::Spectrum SigmaA(const HitPoint &hitPoint) const;
 	virtual luxrays::Spectrum SigmaS(const HitPoint &hitPoint) const;
 
 private:
+	void UpdateMajorantGrid();
+
+	float ScatterRayMarching(const luxrays::Ray &ray, const float u, const bool scatteredStart,
+		luxrays::Spectrum *connectionThroughput, luxrays::Spectrum *connectionEmission) const;
+	float ScatterTracking(const luxrays::Ray &ray, const float u, const bool scatteredStart,
+		luxrays::Spectrum *connectionThroughput, luxrays::Spectrum *connectionEmission) const;
+
 	const Texture *sigmaA, *sigmaS;
 	SchlickScatter schlickScatter;
 	float stepSize;
 	u_int maxStepsCount;
 	const bool multiScattering;
+
+	// Delta/ratio tracking support
+	const bool tracking;
+	const u_int trackingCellSize;
+	VolumeMajorantGrid *majorantGrid;
 };
 
 }
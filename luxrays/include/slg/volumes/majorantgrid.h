@@ -0,0 +1,83 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_MAJORANTGRID_H
+#define	_SLG_MAJORANTGRID_H
+
+#include <vector>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/geometry/ray.h"
+#include "luxrays/core/geometry/transform.h"
+#include "slg/textures/texture.h"
+
+namespace slg {
+
+class DensityGridTexture;
+
+//------------------------------------------------------------------------------
+// VolumeMajorantGrid
+//
+// A coarse grid of upper bounds of the extinction coefficient of a volume,
+// used by the delta/ratio tracking of HeterogeneousVolume to skip empty
+// space. The extinction is bounded by scale * density + offset where density
+// is the value of a DensityGridTexture. Each cell covers cellSize^3 voxels of
+// the density grid (plus a 1 voxel apron required by trilinear interpolation).
+//------------------------------------------------------------------------------
+
+class VolumeMajorantGrid {
+public:
+	// Returns NULL if the extinction described by the 2 textures can not be
+	// bounded with a majorant grid
+	static VolumeMajorantGrid *Create(const Texture *sigmaA, const Texture *sigmaS,
+			const u_int cellSize);
+
+	~VolumeMajorantGrid() { }
+
+	// Transforms a world space ray into the grid space (t values are preserved)
+	luxrays::Ray ToGridSpace(const luxrays::Ray &ray) const { return worldToGrid * ray; }
+
+	// Returns the majorant of the cell including gridRay(t) and, in tExit,
+	// the ray t value where the ray leaves the cell. Outside of the grid,
+	// tExit is where the ray enters the grid or infinity if it never does.
+	float GetMajorant(const luxrays::Ray &gridRay, const float t, float *tExit) const;
+
+	float GetMaxMajorant() const { return maxMajorant; }
+	u_int GetCellCount() const { return cellCountX * cellCountY * cellCountZ; }
+
+private:
+	VolumeMajorantGrid(const DensityGridTexture *densityTex, const float scale,
+			const float offset, const u_int cellSize);
+
+	float Cell(const u_int x, const u_int y, const u_int z) const {
+		return majorants[(z * cellCountY + y) * cellCountX + x];
+	}
+
+	luxrays::Transform worldToGrid;
+	u_int cellCountX, cellCountY, cellCountZ;
+	// The size of a cell in grid space
+	float cellSizeX, cellSizeY, cellSizeZ;
+	std::vector<float> majorants;
+	// Majorant used outside the [0, 1]^3 grid domain
+	float outsideMajorant;
+	float maxMajorant;
+};
+
+}
+
+#endif	/* _SLG_MAJORANTGRID_H */
@@ -0,0 +1,127 @@
+# -*- coding: utf-8 -*-
+################################################################################
+# Copyright 1998-2015 by authors (see AUTHORS.txt)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+
+import os
+import unittest
+import pyluxcore
+
+from pyluxcoreunittests.tests.utils import *
+
+class TestFilm(unittest.TestCase):
+	def test_Film_ChannelView(self):
+		props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+		props.SetFromFile("resources/scenes/simple/simple.cfg")
+		props.Set(GetEngineProperties("PATHCPU"))
+		config = pyluxcore.RenderConfig(props)
+
+		session = pyluxcore.RenderSession(config)
+		session.Start()
+		session.WaitForDone()
+		session.Stop()
+
+		film = session.GetFilm()
+		version = film.GetVersion()
+		self.assertFalse(film.HasChanged(version))
+
+		channelType = pyluxcore.FilmChannelType.RADIANCE_PER_PIXEL_NORMALIZED
+		self.assertTrue(film.GetChannelCount(channelType) > 0)
+		self.assertEqual(film.GetChannelPixelSize(channelType), 4)
+
+		view = film.GetChannelView(channelType)
+		self.assertTrue(view.readonly)
+		self.assertEqual(len(view.tobytes()), film.GetWidth() * film.GetHeight() * 4 * 4)
+
+		# Reading a channel doesn't change the film
+		film.GetChannelView(pyluxcore.FilmChannelType.IMAGEPIPELINE)
+		self.assertFalse(film.HasChanged(version))
+
+		# The view is over the film memory
+		view2 = film.GetChannelView(channelType)
+		self.assertEqual(view.tobytes(), view2.tobytes())
+
+		# The view keeps the film and the session alive
+		data = view.tobytes()
+		del film
+		del session
+		self.assertEqual(view.tobytes(), data)
+
+	def test_Film_CheckpointResume(self):
+		checkpointFileName = "testfilm_checkpoint.flm"
+		if os.path.exists(checkpointFileName):
+			os.remove(checkpointFileName)
+
+		props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+		props.SetFromFile("resources/scenes/simple/simple.cfg")
+		props.Set(GetEngineProperties("PATHCPU"))
+		props.Set(pyluxcore.Property("sampler.type", "SOBOL"))
+		props.Set(pyluxcore.Property("batch.checkpoint.filename", checkpointFileName))
+
+		def RenderSampleCount():
+			config = pyluxcore.RenderConfig(props)
+			session = pyluxcore.RenderSession(config)
+			session.Start()
+			session.WaitForDone()
+			session.UpdateStats()
+			sampleCount = session.GetStats().Get("stats.renderengine.total.samplecount").GetFloat()
+			# Writes a checkpoint on a background thread too
+			session.GetFilm().SaveOutputs()
+			session.Stop()
+
+			return sampleCount
+
+		sampleCount = RenderSampleCount()
+		# The checkpoint is written when the session is deleted at the latest
+		self.assertTrue(os.path.exists(checkpointFileName))
+
+		# The second rendering continues from the samples of the first one
+		resumedSampleCount = RenderSampleCount()
+		self.assertTrue(resumedSampleCount > 1.5 * sampleCount)
+
+		os.remove(checkpointFileName)
+
+	def test_Film_MultipartEXR(self):
+		exrFileName = "testfilm_multipart.exr"
+		outputFileName = "testfilm_output.png"
+		for fileName in [exrFileName, outputFileName]:
+			if os.path.exists(fileName):
+				os.remove(fileName)
+
+		props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+		props.SetFromFile("resources/scenes/simple/simple.cfg")
+		props.Set(GetEngineProperties("PATHCPU"))
+		props.Set(pyluxcore.Property("film.multipartexr.filename", exrFileName))
+		props.Set(pyluxcore.Property("film.outputs.0.type", "RGB_IMAGEPIPELINE"))
+		props.Set(pyluxcore.Property("film.outputs.0.filename", outputFileName))
+		config = pyluxcore.RenderConfig(props)
+
+		# The multipart EXR properties are part of the configuration
+		self.assertEqual(config.GetProperty("film.multipartexr.filename").GetString(), exrFileName)
+		self.assertEqual(config.GetProperty("film.multipartexr.compression").GetString(), "zip")
+
+		session = pyluxcore.RenderSession(config)
+		session.Start()
+		session.WaitForDone()
+		session.GetFilm().SaveOutputs()
+		session.Stop()
+		# The pending multipart EXR snapshot is written when the session is deleted
+		del session
+
+		# The film outputs are written in addition to the multipart EXR file
+		for fileName in [exrFileName, outputFileName]:
+			self.assertTrue(os.path.exists(fileName))
+			os.remove(fileName)
@@ -0,0 +1,90 @@
+# -*- coding: utf-8 -*-
+################################################################################
+# Copyright 1998-2015 by authors (see AUTHORS.txt)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import random
+import unittest
+import pyluxcore
+
+from pyluxcoreunittests.tests.utils import *
+
+def RenderWithKernelCache(backgroundCompile, additionalProps = ""):
+	# Create the rendering configuration
+	props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+	props.SetFromFile("resources/scenes/simple/simple.cfg")
+	props.Set(GetEngineProperties("PATHOCL"))
+	props.SetFromString("""
+		opencl.kernelcache = PERSISTENT
+		opencl.kernel.compile.background = %d
+		""" % backgroundCompile)
+	props.SetFromString(additionalProps)
+
+	config = pyluxcore.RenderConfig(props)
+	session = pyluxcore.RenderSession(config)
+
+	session.Start()
+	session.WaitForDone()
+	session.UpdateStats()
+	stats = session.GetStats()
+	session.Stop()
+
+	return stats
+
+class KernelCache(LuxCoreTest):
+	def test_KernelCache_Persistent(self):
+		# The first rendering fills the cache (if it was empty)
+		RenderWithKernelCache(0)
+
+		# The second rendering has to find all the kernels in the cache
+		stats = RenderWithKernelCache(0)
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.hits").GetInt(), 0)
+		self.assertEqual(stats.Get("stats.opencl.kernelcache.misses").GetInt(), 0)
+
+	def test_KernelCache_PersistentMaxSize(self):
+		# The max. path depth is a kernel parameter: unique values are used to
+		# have kernels not already available in the cache
+		depths = random.sample(range(1000, 100000), 2)
+		# With a 1 byte limit, only the last stored kernel is kept in the cache
+		def Render(depth):
+			return RenderWithKernelCache(0, """
+				opencl.kernelcache.persistent.maxsize = 1
+				path.maxdepth = %d
+				""" % depth)
+
+		stats = Render(depths[0])
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.misses").GetInt(), 0)
+
+		# Storing the second kernel evicts the first one
+		stats = Render(depths[1])
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.misses").GetInt(), 0)
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.evictions").GetInt(), 0)
+
+		# The first kernel is not available anymore
+		stats = Render(depths[0])
+		self.assertEqual(stats.Get("stats.opencl.kernelcache.hits").GetInt(), 0)
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.evictions").GetInt(), 0)
+
+		# The most recently used kernel is still available
+		stats = Render(depths[0])
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.hits").GetInt(), 0)
+		self.assertEqual(stats.Get("stats.opencl.kernelcache.evictions").GetInt(), 0)
+
+	def test_KernelCache_BackgroundCompile(self):
+		stats = RenderWithKernelCache(1)
+
+		self.assertGreater(stats.Get("stats.renderengine.total.samplecount").GetFloat(), 0.0)
+		self.assertGreater(stats.Get("stats.opencl.kernelcache.hits").GetInt() +
+			stats.Get("stats.opencl.kernelcache.misses").GetInt(), 0)
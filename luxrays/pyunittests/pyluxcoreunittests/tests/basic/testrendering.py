@@ -28,3 +28,62 @@ class SimpleRendering(ImageTest):
     pass
 
 SimpleRendering = AddTests(SimpleRendering, TestSimpleRendering, GetEngineListWithSamplers())
+
+# Each case renders the simple scene with a reference configuration and with an
+# alternative implementation of the same feature. Both must converge to the
+# same image, only the noise pattern can be different. The configurations are
+# (engine, sampler, extra properties) tuples, each extra property line must be
+# terminated by a new line.
+EQUIVALENT_RENDERINGS = {
+	# The wavefront path tracer
+	"WAVEFRONTPATHCPU_RANDOM": (
+		("PATHCPU", "RANDOM", ""),
+		("WAVEFRONTPATHCPU", "RANDOM", "")),
+	"WAVEFRONTPATHCPU_SOBOL": (
+		("PATHCPU", "SOBOL", ""),
+		("WAVEFRONTPATHCPU", "SOBOL", "")),
+	# The compressed QBVH
+	"CQBVH": (
+		("PATHCPU", "RANDOM", "accelerator.type = QBVH\n"),
+		("PATHCPU", "RANDOM", "accelerator.type = CQBVH\n")),
+	# The Metropolis sampler with multiple chains
+	"METROPOLISCHAINS_PATHCPU": (
+		("PATHCPU", "METROPOLIS", ""),
+		("PATHCPU", "METROPOLIS", "sampler.metropolis.chaincount = 4\n"
+			"sampler.metropolis.swaprate = 0.1\n"
+			"sampler.metropolis.stratifiedlargesteps = 1\n")),
+	"METROPOLISCHAINS_BIDIRCPU": (
+		("BIDIRCPU", "METROPOLIS", ""),
+		("BIDIRCPU", "METROPOLIS", "sampler.metropolis.chaincount = 4\n"
+			"sampler.metropolis.swaprate = 0.1\n"
+			"sampler.metropolis.stratifiedlargesteps = 1\n"))
+}
+
+# Returns the average of each RGB channel
+def GetChannelAverages(config):
+	engineType, samplerType, extraProps = config
+
+	props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+	props.SetFromFile("resources/scenes/simple/simple.cfg")
+	props.Set(GetEngineProperties(engineType))
+	props.Set(pyluxcore.Property("batch.haltdebug", 16))
+	props.Set(pyluxcore.Property("sampler.type", samplerType))
+	props.Set(pyluxcore.Properties().SetFromString(extraProps))
+
+	size, imageBufferFloat = Render(pyluxcore.RenderConfig(props))
+
+	pixelCount = len(imageBufferFloat) // 3
+	return [sum(imageBufferFloat[c::3]) / pixelCount for c in range(3)]
+
+def TestEquivalentRendering(cls, caseName):
+	referenceConfig, config = EQUIVALENT_RENDERINGS[caseName]
+	referenceAverages = GetChannelAverages(referenceConfig)
+	averages = GetChannelAverages(config)
+
+	for c in range(3):
+		cls.assertAlmostEqual(referenceAverages[c], averages[c], delta = referenceAverages[c] * 0.05)
+
+class EquivalentRendering(LuxCoreTest):
+    pass
+
+EquivalentRendering = AddTests(EquivalentRendering, TestEquivalentRendering, sorted(EQUIVALENT_RENDERINGS.keys()))
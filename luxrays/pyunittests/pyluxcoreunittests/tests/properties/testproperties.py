@@ -78,6 +78,23 @@ class TestProperties(unittest.TestCase):
 		self.assertEqual(props.GetAllUniqueSubNames("test1"), ["test1.prop1", "test1.prop2"])
 		self.assertEqual(props.GetAllUniqueSubNames("test1.prop1"), ["test1.prop1.prop2"])
 
+	def test_Properties_InsertionOrder(self):
+		props = pyluxcore.Properties()
+		props.Set(pyluxcore.Property("test1.propb.aa", "aa"))
+		props.Set(pyluxcore.Property("test1.propa.aa", "aa"))
+		props.Set(pyluxcore.Property("test1.propc.aa", "aa"))
+		props.Set(pyluxcore.Property("test1.propa.bb", "bb"))
+		props.Set(pyluxcore.Property("test1.propb.bb", "bb"))
+
+		# Prefix queries return the names in insertion order, not sorted
+		self.assertEqual(props.GetAllNames("test1.propa"), ["test1.propa.aa", "test1.propa.bb"])
+		self.assertEqual(props.GetAllUniqueSubNames("test1"), ["test1.propb", "test1.propa", "test1.propc"])
+
+		props.DeleteAll(["test1.propb.aa", "test1.propc.aa"])
+		self.assertEqual(props.GetAllNames(), ["test1.propa.aa", "test1.propa.bb", "test1.propb.bb"])
+		self.assertEqual(props.GetAllUniqueSubNames("test1"), ["test1.propa", "test1.propb"])
+		self.assertEqual(props.HaveNames("test1.propc"), False)
+
 	def test_Properties_HaveNames(self):
 		props = pyluxcore.Properties()
 		props.Set(pyluxcore.Property("test1.prop1", "aa"))
@@ -134,6 +151,14 @@ class TestProperties(unittest.TestCase):
 		self.assertEqual(props.GetSize(), 1)
 		self.assertEqual(props.IsDefined("test1.prop2"), False)
 
+		# Deleted names are not listed and a deleted name set again is appended
+		props.Set(pyluxcore.Property("test3.prop1", "dd"))
+		props.Set(pyluxcore.Property("test1.prop1", "ee"))
+		props.Delete("test3.prop1")
+		self.assertEqual(props.GetSize(), 2)
+		self.assertEqual(props.GetAllNames(), ["test2.prop1.aa", "test1.prop1"])
+		self.assertEqual(props.ToString(), 'test2.prop1.aa = "cc"\ntest1.prop1 = "ee"\n')
+
 	def test_Properties_ToString(self):
 		props = pyluxcore.Properties()
 		props.Set(pyluxcore.Property("test1.prop1", "aa"))
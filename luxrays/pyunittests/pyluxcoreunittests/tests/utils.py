@@ -54,13 +54,16 @@ def Render(config):
 	return GetRendering(session)
 
 def GetEngineList():
-	return ["PATHCPU", "BIDIRCPU", "BIASPATHCPU", "PATHOCL", "BIASPATHOCL"]
+	return ["PATHCPU", "WAVEFRONTPATHCPU", "BIDIRCPU", "BIASPATHCPU", "PATHOCL", "BIASPATHOCL"]
 
 def GetEngineListWithSamplers():
 	return [
 		("PATHCPU", "RANDOM"),
 		("PATHCPU", "SOBOL"),
 		("PATHCPU", "METROPOLIS"),
+		("WAVEFRONTPATHCPU", "RANDOM"),
+		("WAVEFRONTPATHCPU", "SOBOL"),
+		("WAVEFRONTPATHCPU", "METROPOLIS"),
 		("BIDIRCPU", "RANDOM"),
 		("BIDIRCPU", "SOBOL"),
 		("BIDIRCPU", "METROPOLIS"),
@@ -80,6 +83,11 @@ engineProperties = {
 		renderengine.type = PATHCPU
 		batch.haltdebug = 1
 		"""),
+	"WAVEFRONTPATHCPU" : pyluxcore.Properties().SetFromString(
+		"""
+		renderengine.type = WAVEFRONTPATHCPU
+		batch.haltdebug = 1
+		"""),
 	"BIDIRCPU" : pyluxcore.Properties().SetFromString(
 		"""
 		renderengine.type = BIDIRCPU
@@ -0,0 +1,81 @@
+# -*- coding: utf-8 -*-
+################################################################################
+# Copyright 1998-2015 by authors (see AUTHORS.txt)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import unittest
+import pyluxcore
+
+from pyluxcoreunittests.tests.utils import *
+
+################################################################################
+# Heterogeneous volume tracking test
+################################################################################
+
+def GetVolumeAverageRendering(volumeProps):
+	props = pyluxcore.Properties(LuxCoreTest.customConfigProps)
+	props.SetFromFile("resources/scenes/simple/simple.cfg")
+	props.Set(GetEngineProperties("PATHCPU"))
+	props.Set(pyluxcore.Property("batch.haltdebug", 16))
+	props.Set(pyluxcore.Property("sampler.type", "RANDOM"))
+
+	scene = pyluxcore.Scene("resources/scenes/simple/simple.scn")
+	scene.Parse(volumeProps)
+	scene.Parse(pyluxcore.Properties().SetFromString(
+		"""
+		scene.world.volume.default = fog
+		"""))
+
+	size, imageBufferFloat = Render(pyluxcore.RenderConfig(props, scene))
+
+	return sum(imageBufferFloat) / len(imageBufferFloat)
+
+# The majorant grid tracking of an heterogeneous volume with a constant
+# density grid must render the same image of an homogeneous volume
+def TestHeterogeneousTracking(cls, multiScattering):
+	homogeneousAverage = GetVolumeAverageRendering(pyluxcore.Properties().SetFromString(
+		"""
+		scene.volumes.fog.type = homogeneous
+		scene.volumes.fog.absorption = 0.02 0.02 0.02
+		scene.volumes.fog.scattering = 0.04 0.04 0.04
+		scene.volumes.fog.multiscattering = %d
+		""" % multiScattering))
+	heterogeneousAverage = GetVolumeAverageRendering(pyluxcore.Properties().SetFromString(
+		"""
+		scene.textures.density.type = densitygrid
+		scene.textures.density.nx = 2
+		scene.textures.density.ny = 2
+		scene.textures.density.nz = 2
+		scene.textures.density.data = 1 1 1 1 1 1 1 1
+		scene.textures.absorption.type = scale
+		scene.textures.absorption.texture1 = density
+		scene.textures.absorption.texture2 = 0.02 0.02 0.02
+		scene.textures.scattering.type = scale
+		scene.textures.scattering.texture1 = density
+		scene.textures.scattering.texture2 = 0.04 0.04 0.04
+		scene.volumes.fog.type = heterogeneous
+		scene.volumes.fog.absorption = absorption
+		scene.volumes.fog.scattering = scattering
+		scene.volumes.fog.multiscattering = %d
+		scene.volumes.fog.tracking.enable = 1
+		scene.volumes.fog.tracking.cellsize = 1
+		""" % multiScattering))
+
+	cls.assertAlmostEqual(homogeneousAverage, heterogeneousAverage, delta = homogeneousAverage * 0.05)
+
+class HeterogeneousTracking(LuxCoreTest):
+    pass
+
+HeterogeneousTracking = AddTests(HeterogeneousTracking, TestHeterogeneousTracking, [0, 1])
@@ -100,8 +100,9 @@ def main():
 	basicSuite = unittest.TestLoader().discover("pyluxcoreunittests.tests.basic", top_level_dir=".")
 	lightSuite = unittest.TestLoader().discover("pyluxcoreunittests.tests.lights", top_level_dir=".")
 	textureSuite = unittest.TestLoader().discover("pyluxcoreunittests.tests.textures", top_level_dir=".")
+	volumeSuite = unittest.TestLoader().discover("pyluxcoreunittests.tests.volumes", top_level_dir=".")
 	
-	allTests = unittest.TestSuite([propertiesSuite, basicSuite, lightSuite, textureSuite])
+	allTests = unittest.TestSuite([propertiesSuite, basicSuite, lightSuite, textureSuite, volumeSuite])
 	
 	# List the tests if required
 
@@ -0,0 +1,196 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/context.h"
+#include "luxrays/core/dataset.h"
+#include "luxrays/core/epsilon.h"
+#include "luxrays/core/exttrianglemesh.h"
+#include "luxrays/core/randomgen.h"
+#include "luxrays/accelerators/cqbvhaccel.h"
+#include "luxrays/utils/mc.h"
+
+using namespace std;
+using namespace luxrays;
+
+//------------------------------------------------------------------------------
+// Compares the memory usage and the performance of QBVH and of the compressed
+// QBVH on the meshes of a list of scenes
+//------------------------------------------------------------------------------
+
+#define DEFAULT_RAY_COUNT (4 * 1024 * 1024)
+#define DEFAULT_SCENES_DIR "scenes"
+
+static void DebugHandler(const char *msg) {
+}
+
+static void LoadMeshes(const boost::filesystem::path &path, vector<ExtTriangleMesh *> &meshes) {
+	if (boost::filesystem::is_directory(path)) {
+		for (boost::filesystem::recursive_directory_iterator it(path), end; it != end; ++it) {
+			if (boost::filesystem::is_regular_file(it->path()) && (it->path().extension() == ".ply"))
+				meshes.push_back(ExtTriangleMesh::LoadExtTriangleMesh(it->path().generic_string()));
+		}
+	} else
+		meshes.push_back(ExtTriangleMesh::LoadExtTriangleMesh(path.generic_string()));
+}
+
+// Rays leaving random points of the mesh surfaces in random directions
+static void GenerateRays(const vector<ExtTriangleMesh *> &meshes, const u_int rayCount,
+		vector<Ray> &rays) {
+	RandomGenerator rndGen(131);
+
+	rays.resize(rayCount);
+	for (u_int i = 0; i < rayCount; ++i) {
+		const ExtTriangleMesh *mesh = meshes[rndGen.uintValue() % meshes.size()];
+		const Triangle &tri = mesh->GetTriangles()[rndGen.uintValue() % mesh->GetTotalTriangleCount()];
+
+		float b0, b1, b2;
+		UniformSampleTriangle(rndGen.floatValue(), rndGen.floatValue(), &b1, &b2);
+		b0 = 1.f - b1 - b2;
+
+		const Point o = b0 * mesh->GetVertex(0.f, tri.v[0]) +
+				b1 * mesh->GetVertex(0.f, tri.v[1]) +
+				b2 * mesh->GetVertex(0.f, tri.v[2]);
+		const Vector d = UniformSampleSphere(rndGen.floatValue(), rndGen.floatValue());
+
+		rays[i] = Ray(o, d);
+		rays[i].mint = MachineEpsilon::E(o);
+	}
+}
+
+static double TraceRays(const Accelerator *accel, const vector<Ray> &rays, vector<RayHit> &rayHits) {
+	rayHits.resize(rays.size());
+
+	const double startTime = WallClockTime();
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int i = 0; i < rays.size(); ++i)
+		accel->Intersect(&rays[i], &rayHits[i]);
+
+	return WallClockTime() - startTime;
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		cout << "LuxRays Accelerator Benchmark\n";
+		cout << "Usage: " << argv[0] << " [ray count] [scene directory or PLY file]...\n";
+
+		const u_int rayCount = (argc > 1) ? (u_int)atoi(argv[1]) : DEFAULT_RAY_COUNT;
+		vector<boost::filesystem::path> scenes;
+		if (argc > 2) {
+			for (int i = 2; i < argc; ++i)
+				scenes.push_back(argv[i]);
+		} else {
+			// All the scenes in the default directory
+			for (boost::filesystem::directory_iterator it(DEFAULT_SCENES_DIR), end; it != end; ++it) {
+				if (boost::filesystem::is_directory(it->path()))
+					scenes.push_back(it->path());
+			}
+			sort(scenes.begin(), scenes.end());
+		}
+		cout << "Rays: " << rayCount << "\n";
+
+		Context *ctx = new Context(DebugHandler);
+
+		cout << setw(20) << left << "Scene" << right <<
+				setw(10) << "Triangles" <<
+				setw(14) << "QBVH nodes" <<
+				setw(14) << "CQBVH nodes" <<
+				setw(14) << "Triangles" <<
+				setw(14) << "QBVH" <<
+				setw(14) << "CQBVH" <<
+				setw(12) << "Mismatches" << "\n";
+		cout << setw(20) << "" <<
+				setw(10) << "" <<
+				setw(14) << "(Kbytes)" <<
+				setw(14) << "(Kbytes)" <<
+				setw(14) << "(Kbytes)" <<
+				setw(14) << "(M rays/sec)" <<
+				setw(14) << "(M rays/sec)" <<
+				setw(12) << "" << "\n";
+
+		for (u_int i = 0; i < scenes.size(); ++i) {
+			vector<ExtTriangleMesh *> meshes;
+			LoadMeshes(scenes[i], meshes);
+			if (meshes.size() == 0)
+				continue;
+
+			DataSet *dataSet = new DataSet(ctx);
+			for (u_int j = 0; j < meshes.size(); ++j)
+				dataSet->Add(meshes[j]);
+			dataSet->Preprocess();
+
+			vector<Ray> rays;
+			GenerateRays(meshes, rayCount, rays);
+
+			const Accelerator *qbvh = dataSet->GetAccelerator(ACCEL_QBVH);
+			const CQBVHAccel *cqbvh = static_cast<const CQBVHAccel *>(dataSet->GetAccelerator(ACCEL_CQBVH));
+
+			vector<RayHit> qbvhHits, cqbvhHits;
+			const double qbvhTime = TraceRays(qbvh, rays, qbvhHits);
+			const double cqbvhTime = TraceRays(cqbvh, rays, cqbvhHits);
+
+			// The quantized bounding boxes are conservative so the hits must
+			// be the same (excluding the hits at the same distance)
+			u_int mismatches = 0;
+			for (u_int j = 0; j < rayCount; ++j) {
+				if ((qbvhHits[j].t != cqbvhHits[j].t) || (qbvhHits[j].Miss() != cqbvhHits[j].Miss()))
+					++mismatches;
+			}
+
+			cout << setw(20) << left << scenes[i].filename().generic_string() << right <<
+					setw(10) << dataSet->GetTotalTriangleCount() <<
+					setw(14) << cqbvh->GetNodeCount() * sizeof(QBVHNode) / 1024 <<
+					setw(14) << cqbvh->GetNodesMemorySize() / 1024 <<
+					setw(14) << cqbvh->GetPrimitivesMemorySize() / 1024 <<
+					setw(14) << fixed << setprecision(2) << (rayCount / qbvhTime) / 1000000.0 <<
+					setw(14) << (rayCount / cqbvhTime) / 1000000.0 <<
+					setw(12) << mismatches << "\n";
+
+			delete dataSet;
+			for (u_int j = 0; j < meshes.size(); ++j) {
+				meshes[j]->Delete();
+				delete meshes[j];
+			}
+		}
+
+		delete ctx;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/accelerator.h"
+#include "luxrays/core/context.h"
+#include "luxrays/core/dataset.h"
+#include "luxrays/core/epsilon.h"
+#include "luxrays/core/randomgen.h"
+#include "luxrays/core/trianglemesh.h"
+#include "luxrays/core/geometry/raybuffersorter.h"
+
+using namespace std;
+using namespace luxrays;
+
+//------------------------------------------------------------------------------
+// Compares the traversal of a batch of incoherent secondary rays in the order
+// they are generated with the traversal of the same rays sorted by
+// RayBufferSorter
+//------------------------------------------------------------------------------
+
+#define DEFAULT_BUFFER_SIZE 8192
+#define DEFAULT_RAY_COUNT (1024 * 1024)
+#define CITY_SIZE 128
+#define STATS_WINDOW_SIZE 64
+
+static void DebugHandler(const char *msg) {
+	cerr << msg << "\n";
+}
+
+// A CITY_SIZE x CITY_SIZE grid of boxes with random heights on a ground plane
+static TriangleMesh *CreateCityMesh(RandomGenerator &rndGen) {
+	const u_int boxCount = CITY_SIZE * CITY_SIZE;
+	const u_int vertCount = 8 * boxCount + 4;
+	const u_int triCount = 10 * boxCount + 2;
+
+	Point *verts = TriangleMesh::AllocVerticesBuffer(vertCount);
+	Triangle *tris = TriangleMesh::AllocTrianglesBuffer(triCount);
+
+	// The box faces, the bottom one is never visible
+	static const u_int boxIndices[10][3] = {
+		{ 4, 5, 6 }, { 4, 6, 7 },
+		{ 0, 1, 5 }, { 0, 5, 4 },
+		{ 1, 2, 6 }, { 1, 6, 5 },
+		{ 2, 3, 7 }, { 2, 7, 6 },
+		{ 3, 0, 4 }, { 3, 4, 7 }
+	};
+
+	u_int vIndex = 0;
+	u_int tIndex = 0;
+	for (u_int y = 0; y < CITY_SIZE; ++y) {
+		for (u_int x = 0; x < CITY_SIZE; ++x) {
+			const float x0 = x + .1f;
+			const float x1 = x + .9f;
+			const float y0 = y + .1f;
+			const float y1 = y + .9f;
+			const float height = .5f + 4.f * rndGen.floatValue();
+
+			verts[vIndex + 0] = Point(x0, y0, 0.f);
+			verts[vIndex + 1] = Point(x1, y0, 0.f);
+			verts[vIndex + 2] = Point(x1, y1, 0.f);
+			verts[vIndex + 3] = Point(x0, y1, 0.f);
+			verts[vIndex + 4] = Point(x0, y0, height);
+			verts[vIndex + 5] = Point(x1, y0, height);
+			verts[vIndex + 6] = Point(x1, y1, height);
+			verts[vIndex + 7] = Point(x0, y1, height);
+
+			for (u_int i = 0; i < 10; ++i) {
+				tris[tIndex].v[0] = vIndex + boxIndices[i][0];
+				tris[tIndex].v[1] = vIndex + boxIndices[i][1];
+				tris[tIndex].v[2] = vIndex + boxIndices[i][2];
+				++tIndex;
+			}
+
+			vIndex += 8;
+		}
+	}
+
+	// The ground
+	verts[vIndex + 0] = Point(0.f, 0.f, 0.f);
+	verts[vIndex + 1] = Point(CITY_SIZE, 0.f, 0.f);
+	verts[vIndex + 2] = Point(CITY_SIZE, CITY_SIZE, 0.f);
+	verts[vIndex + 3] = Point(0.f, CITY_SIZE, 0.f);
+	tris[tIndex].v[0] = vIndex;
+	tris[tIndex].v[1] = vIndex + 1;
+	tris[tIndex].v[2] = vIndex + 2;
+	++tIndex;
+	tris[tIndex].v[0] = vIndex;
+	tris[tIndex].v[1] = vIndex + 2;
+	tris[tIndex].v[2] = vIndex + 3;
+
+	return new TriangleMesh(vertCount, triCount, verts, tris);
+}
+
+// Traces camera rays from random film positions and returns the rays leaving
+// the hit points in random directions, like the first bounce of a path tracer
+static void GenerateSecondaryRays(const Accelerator *accel, RandomGenerator &rndGen,
+		vector<Ray> &rays) {
+	const Point cameraPos(CITY_SIZE * .5f, -CITY_SIZE * .25f, CITY_SIZE * .5f);
+
+	size_t count = 0;
+	while (count < rays.size()) {
+		const Point target(CITY_SIZE * rndGen.floatValue(), CITY_SIZE * rndGen.floatValue(), 0.f);
+		const Ray cameraRay(cameraPos, Normalize(target - cameraPos));
+
+		RayHit rayHit;
+		if (!accel->Intersect(&cameraRay, &rayHit))
+			continue;
+
+		Ray &ray = rays[count++];
+		ray.o = cameraRay(rayHit.t);
+
+		// A random direction in the hemisphere facing the camera
+		Vector d;
+		do {
+			d = Vector(2.f * rndGen.floatValue() - 1.f,
+					2.f * rndGen.floatValue() - 1.f,
+					2.f * rndGen.floatValue() - 1.f);
+		} while ((d.LengthSquared() > 1.f) || (d.LengthSquared() == 0.f));
+		d = Normalize(d);
+		if (Dot(d, cameraRay.d) > 0.f)
+			d = -d;
+
+		ray.d = d;
+		ray.mint = MachineEpsilon::E(ray.o);
+		ray.maxt = INFINITY;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		cout << "LuxRays Ray Sorting Benchmark\n";
+		cout << "Usage: " << argv[0] << " [ray buffer size] [ray count]\n";
+
+		const u_int bufferSize = (argc > 1) ? (u_int)atoi(argv[1]) : DEFAULT_BUFFER_SIZE;
+		const u_int rayCount = (argc > 2) ? (u_int)atoi(argv[2]) : DEFAULT_RAY_COUNT;
+		cout << "Ray buffer size: " << bufferSize << "\n";
+		cout << "Rays: " << rayCount << "\n";
+
+		//----------------------------------------------------------------------
+		// Build the data set
+		//----------------------------------------------------------------------
+
+		Context *ctx = new Context(DebugHandler);
+
+		RandomGenerator rndGen(131);
+		TriangleMesh *mesh = CreateCityMesh(rndGen);
+		cout << "Triangles: " << mesh->GetTotalTriangleCount() << "\n";
+
+		DataSet *dataSet = new DataSet(ctx);
+		dataSet->SetAcceleratorType(ACCEL_QBVH);
+		dataSet->Add(mesh);
+		dataSet->Preprocess();
+		const Accelerator *accel = dataSet->GetAccelerator(ACCEL_QBVH);
+
+		vector<Ray> rays(rayCount);
+		GenerateSecondaryRays(accel, rndGen, rays);
+
+		//----------------------------------------------------------------------
+		// Traversal statistics
+		//----------------------------------------------------------------------
+
+		RayBufferSorter sorter(dataSet->GetBBox());
+		AcceleratorTraversalStats unsortedStats(STATS_WINDOW_SIZE);
+		AcceleratorTraversalStats sortedStats(STATS_WINDOW_SIZE);
+		vector<RayHit> unsortedHits(rayCount);
+		vector<RayHit> sortedHits(rayCount);
+
+		for (u_int first = 0; first < rayCount; first += bufferSize) {
+			const u_int count = Min(bufferSize, rayCount - first);
+
+			for (u_int i = first; i < first + count; ++i)
+				accel->IntersectWithStats(&rays[i], &unsortedHits[i], &unsortedStats);
+
+			sorter.Sort(&rays[first], count);
+			const vector<u_int> &order = sorter.GetOrder();
+			for (u_int i = 0; i < count; ++i) {
+				const u_int index = first + order[i];
+				accel->IntersectWithStats(&rays[index], &sortedHits[index], &sortedStats);
+			}
+		}
+
+		for (u_int i = 0; i < rayCount; ++i) {
+			if ((unsortedHits[i].t != sortedHits[i].t) ||
+					(unsortedHits[i].meshIndex != sortedHits[i].meshIndex) ||
+					(unsortedHits[i].triangleIndex != sortedHits[i].triangleIndex))
+				throw runtime_error("Sorted rays hits don't match the unsorted rays hits");
+		}
+
+		cout << "Unsorted: " << unsortedStats.GetNodeVisitsPerRay() << " nodes/ray, " <<
+				unsortedStats.GetLeafVisitsPerRay() << " leaves/ray, " <<
+				unsortedStats.GetDistinctNodesPerWindow() << " distinct nodes every " << STATS_WINDOW_SIZE << " rays\n";
+		cout << "Sorted: " << sortedStats.GetNodeVisitsPerRay() << " nodes/ray, " <<
+				sortedStats.GetLeafVisitsPerRay() << " leaves/ray, " <<
+				sortedStats.GetDistinctNodesPerWindow() << " distinct nodes every " << STATS_WINDOW_SIZE << " rays\n";
+
+		//----------------------------------------------------------------------
+		// Timings
+		//----------------------------------------------------------------------
+
+		RayHit rayHit;
+		double startTime = WallClockTime();
+		for (u_int i = 0; i < rayCount; ++i)
+			accel->Intersect(&rays[i], &rayHit);
+		const double unsortedTime = WallClockTime() - startTime;
+
+		double sortTime = 0.0;
+		startTime = WallClockTime();
+		for (u_int first = 0; first < rayCount; first += bufferSize) {
+			const u_int count = Min(bufferSize, rayCount - first);
+
+			const double sortStartTime = WallClockTime();
+			sorter.Sort(&rays[first], count);
+			sortTime += WallClockTime() - sortStartTime;
+
+			const vector<u_int> &order = sorter.GetOrder();
+			for (u_int i = 0; i < count; ++i)
+				accel->Intersect(&rays[first + order[i]], &rayHit);
+		}
+		const double sortedTime = WallClockTime() - startTime;
+
+		cout << "Unsorted: " << unsortedTime << " secs, " <<
+				(rayCount / unsortedTime) / 1000000.0 << " M rays/sec\n";
+		cout << "Sorted: " << sortedTime << " secs (" << sortTime << " secs sorting), " <<
+				(rayCount / sortedTime) / 1000000.0 << " M rays/sec\n";
+		cout << "Speedup: " << unsortedTime / sortedTime << "x\n";
+
+		delete dataSet;
+		mesh->Delete();
+		delete mesh;
+		delete ctx;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
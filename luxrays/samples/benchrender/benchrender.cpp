@@ -0,0 +1,564 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#if defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "luxrays/core/randomgen.h"
+#include "luxrays/core/utils.h"
+
+#include "luxcore/luxcore.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+
+//------------------------------------------------------------------------------
+// An end-to-end rendering benchmark suite: each scene is rendered with each
+// render engine, sampler and light strategy combination for a fixed sample
+// budget. Scenes can be configuration files (i.e. the ones under scenes/) or
+// generated stress scenes. The results are written as JSON so they can be
+// compared across builds.
+//------------------------------------------------------------------------------
+
+#define DEFAULT_ENGINES "PATHCPU,BIDIRCPU,LIGHTCPU"
+#define DEFAULT_SAMPLERS "RANDOM,SOBOL,METROPOLIS"
+#define DEFAULT_LIGHTSTRATEGIES "UNIFORM,POWER,LOG_POWER"
+#define DEFAULT_SAMPLES_PER_PIXEL 8
+#define DEFAULT_FILM_WIDTH 320
+#define DEFAULT_FILM_HEIGHT 240
+#define DEFAULT_TIMEOUT 600
+#define DEFAULT_JSON_FILE "benchrender.json"
+
+#define STRESS_INSTANCES_SCENE "stress:instances"
+#define STRESS_LIGHTS_SCENE "stress:lights"
+#define DEFAULT_STRESS_INSTANCES_COUNT 100000
+#define DEFAULT_STRESS_LIGHTS_COUNT 1000
+
+class BenchmarkSettings {
+public:
+	BenchmarkSettings() : samplesPerPixel(DEFAULT_SAMPLES_PER_PIXEL),
+		filmWidth(DEFAULT_FILM_WIDTH), filmHeight(DEFAULT_FILM_HEIGHT),
+		threadCount(0), timeout(DEFAULT_TIMEOUT), jsonFileName(DEFAULT_JSON_FILE),
+		stressInstancesCount(DEFAULT_STRESS_INSTANCES_COUNT),
+		stressLightsCount(DEFAULT_STRESS_LIGHTS_COUNT) { }
+
+	vector<string> scenes, engines, samplers, lightStrategies;
+	u_int samplesPerPixel, filmWidth, filmHeight, threadCount;
+	double timeout;
+	string jsonFileName;
+	u_int stressInstancesCount, stressLightsCount;
+	// Additional properties, applied to all runs
+	Properties cmdLineProps;
+};
+
+class BenchmarkResult {
+public:
+	BenchmarkResult() : failed(false), timedOut(false), loadTime(0.0),
+		buildTime(0.0), timeToFirstPixel(-1.0), renderTime(0.0),
+		samplesSec(0.0), raysSec(0.0), sampleCount(0.0), pass(0),
+		triangleCount(0.0), peakRSS(0) { }
+
+	string scene, engine, sampler, lightStrategy;
+	bool failed, timedOut;
+	string error;
+
+	double loadTime, buildTime, timeToFirstPixel, renderTime;
+	double samplesSec, raysSec, sampleCount;
+	u_int pass;
+	double triangleCount;
+	u_longlong peakRSS;
+};
+
+//------------------------------------------------------------------------------
+// Peak resident set size
+//------------------------------------------------------------------------------
+
+// Linux allows to reset the peak so each run reports its own peak, on the
+// other platforms the peak of the process so far is reported
+static void ResetPeakRSS() {
+#if defined(__linux__)
+	ofstream clearRefs("/proc/self/clear_refs");
+	if (clearRefs.good())
+		clearRefs << "5";
+#endif
+}
+
+static u_longlong GetPeakRSS() {
+#if defined(WIN32)
+	PROCESS_MEMORY_COUNTERS info;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+		return (u_longlong)info.PeakWorkingSetSize;
+	return 0;
+#else
+#if defined(__linux__)
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line)) {
+		if (boost::starts_with(line, "VmHWM:"))
+			return boost::lexical_cast<u_longlong>(boost::trim_copy(
+					boost::erase_last_copy(line.substr(6), "kB"))) * 1024;
+	}
+#endif
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+		return 0;
+#if defined(__APPLE__)
+	return (u_longlong)usage.ru_maxrss;
+#else
+	return (u_longlong)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Generated stress scenes
+//------------------------------------------------------------------------------
+
+static void DefineQuad(Scene *scene, const string &meshName) {
+	Point *p = Scene::AllocVerticesBuffer(4);
+	p[0] = Point(-.5f, -.5f, 0.f);
+	p[1] = Point(.5f, -.5f, 0.f);
+	p[2] = Point(.5f, .5f, 0.f);
+	p[3] = Point(-.5f, .5f, 0.f);
+
+	Triangle *vi = Scene::AllocTrianglesBuffer(2);
+	vi[0] = Triangle(0, 1, 2);
+	vi[1] = Triangle(2, 3, 0);
+
+	scene->DefineMesh(meshName, 4, 2, p, vi, NULL, NULL, NULL, NULL);
+}
+
+// A large number of randomly oriented instances of the same quad, lit by a
+// sun and a sky
+static void DefineStressInstancesScene(Scene *scene, const u_int instancesCount) {
+	DefineQuad(scene, "quad");
+
+	// Always the same seed so the scene is the same across runs and builds
+	RandomGenerator rnd(1u);
+
+	Properties props;
+	props <<
+			Property("scene.camera.lookat.orig")(0.f, -30.f, 20.f) <<
+			Property("scene.camera.lookat.target")(0.f, 0.f, 0.f) <<
+			Property("scene.lights.sun.type")("sun") <<
+			Property("scene.lights.sun.dir")(.3f, -.4f, 1.f) <<
+			Property("scene.lights.sky.type")("sky2") <<
+			Property("scene.lights.sky.dir")(.3f, -.4f, 1.f) <<
+			Property("scene.materials.mat.type")("matte") <<
+			Property("scene.materials.mat.kd")(.75f, .75f, .75f) <<
+			Property("scene.materials.glossy.type")("glossy2") <<
+			Property("scene.materials.glossy.kd")(.5f, .2f, .2f);
+	for (u_int i = 0; i < instancesCount; ++i) {
+		const Transform t = Translate(Vector(
+				40.f * (rnd.floatValue() - .5f),
+				40.f * (rnd.floatValue() - .5f),
+				10.f * rnd.floatValue())) *
+			Rotate(360.f * rnd.floatValue(),
+				Vector(rnd.floatValue() - .5f, rnd.floatValue() - .5f, 1.f));
+
+		const string prefix = "scene.objects.obj" + ToString(i);
+		props <<
+				Property(prefix + ".shape")("quad") <<
+				Property(prefix + ".material")((i % 2) ? "mat" : "glossy") <<
+				Property(prefix + ".transformation")(t.m);
+	}
+
+	scene->Parse(props);
+}
+
+// A ground plane lit by a large number of point lights, mostly useful to
+// compare the light strategies
+static void DefineStressLightsScene(Scene *scene, const u_int lightsCount) {
+	DefineQuad(scene, "quad");
+
+	RandomGenerator rnd(1u);
+
+	Properties props;
+	props <<
+			Property("scene.camera.lookat.orig")(0.f, -30.f, 30.f) <<
+			Property("scene.camera.lookat.target")(0.f, 0.f, 0.f) <<
+			Property("scene.materials.mat.type")("matte") <<
+			Property("scene.materials.mat.kd")(.75f, .75f, .75f) <<
+			Property("scene.objects.ground.shape")("quad") <<
+			Property("scene.objects.ground.material")("mat") <<
+			Property("scene.objects.ground.transformation")(Matrix4x4(
+				100.f, 0.f, 0.f, 0.f,
+				0.f, 100.f, 0.f, 0.f,
+				0.f, 0.f, 1.f, 0.f,
+				0.f, 0.f, 0.f, 1.f));
+	for (u_int i = 0; i < lightsCount; ++i) {
+		const string prefix = "scene.lights.light" + ToString(i);
+		// A few bright lights and a lot of dim ones
+		const float power = (i % 100) ? 1.f : 100.f;
+		props <<
+				Property(prefix + ".type")("point") <<
+				Property(prefix + ".position")(
+					50.f * (rnd.floatValue() - .5f),
+					50.f * (rnd.floatValue() - .5f),
+					.5f + 5.f * rnd.floatValue()) <<
+				Property(prefix + ".color")(
+					power * rnd.floatValue(),
+					power * rnd.floatValue(),
+					power * rnd.floatValue());
+	}
+
+	scene->Parse(props);
+}
+
+static bool IsStressScene(const string &sceneName) {
+	return boost::starts_with(sceneName, "stress:");
+}
+
+//------------------------------------------------------------------------------
+// A single benchmark run
+//------------------------------------------------------------------------------
+
+static void Render(const BenchmarkSettings &settings, BenchmarkResult &result) {
+	Properties props;
+	props <<
+			Property("renderengine.type")(result.engine) <<
+			Property("renderengine.seed")(1u) <<
+			Property("sampler.type")(result.sampler) <<
+			Property("lightstrategy.type")(result.lightStrategy) <<
+			Property("film.width")(settings.filmWidth) <<
+			Property("film.height")(settings.filmHeight) <<
+			Property("batch.haltdebug")(settings.samplesPerPixel) <<
+			Property("batch.periodicsave")(0.f);
+	if (settings.threadCount > 0)
+		props << Property("native.threads.count")(settings.threadCount);
+	props.Set(settings.cmdLineProps);
+
+	ResetPeakRSS();
+
+	//--------------------------------------------------------------------------
+	// Scene loading
+	//--------------------------------------------------------------------------
+
+	double startTime = WallClockTime();
+
+	Scene *scene = NULL;
+	RenderConfig *config;
+	if (IsStressScene(result.scene)) {
+		scene = new Scene();
+		if (result.scene == STRESS_INSTANCES_SCENE)
+			DefineStressInstancesScene(scene, settings.stressInstancesCount);
+		else if (result.scene == STRESS_LIGHTS_SCENE)
+			DefineStressLightsScene(scene, settings.stressLightsCount);
+		else {
+			delete scene;
+			throw runtime_error("Unknown stress scene: " + result.scene);
+		}
+
+		config = new RenderConfig(props, scene);
+	} else
+		config = new RenderConfig(Properties(result.scene).Set(props));
+
+	result.loadTime = WallClockTime() - startTime;
+
+	//--------------------------------------------------------------------------
+	// Rendering
+	//--------------------------------------------------------------------------
+
+	RenderSession *session = NULL;
+	try {
+		session = new RenderSession(config);
+		const Properties &stats = session->GetStats();
+
+		// Start() returns after the data set and the light strategy have been
+		// built, when the render threads have been started
+		startTime = WallClockTime();
+		session->Start();
+		const double renderStartTime = WallClockTime();
+		result.buildTime = renderStartTime - startTime;
+
+		while (!session->HasDone()) {
+			const double elapsedTime = WallClockTime() - renderStartTime;
+			if (elapsedTime > settings.timeout) {
+				result.timedOut = true;
+				break;
+			}
+
+			if (result.timeToFirstPixel < 0.0) {
+				// Updating the statistics merges the films, so this is done
+				// only until the first sample has been received
+				session->UpdateStats();
+				if (stats.Get("stats.renderengine.total.samplecount").Get<double>() > 0.0)
+					result.timeToFirstPixel = WallClockTime() - startTime;
+				boost::this_thread::sleep(boost::posix_time::millisec(5));
+			} else
+				boost::this_thread::sleep(boost::posix_time::millisec(50));
+		}
+		result.renderTime = WallClockTime() - renderStartTime;
+
+		session->UpdateStats();
+		if (result.timeToFirstPixel < 0.0)
+			result.timeToFirstPixel = WallClockTime() - startTime;
+		result.samplesSec = stats.Get("stats.renderengine.total.samplesec").Get<double>();
+		result.raysSec = stats.Get("stats.renderengine.total.raysec").Get<double>();
+		result.sampleCount = stats.Get("stats.renderengine.total.samplecount").Get<double>();
+		result.pass = stats.Get("stats.renderengine.pass").Get<u_int>();
+		result.triangleCount = stats.Get("stats.dataset.trianglecount").Get<double>();
+
+		session->Stop();
+	} catch (...) {
+		delete session;
+		delete config;
+		delete scene;
+		throw;
+	}
+
+	result.peakRSS = GetPeakRSS();
+
+	delete session;
+	delete config;
+	delete scene;
+}
+
+//------------------------------------------------------------------------------
+// JSON output
+//------------------------------------------------------------------------------
+
+static string JSONNumber(const double v) {
+	// JSON has no representation for infinite or NaN values
+	if (isnan(v) || isinf(v))
+		return "null";
+
+	return boost::str(boost::format("%.6g") % v);
+}
+
+static void WriteJSON(const BenchmarkSettings &settings, const vector<BenchmarkResult> &results,
+		const double totalTime, ostream &os) {
+	os << "{\n";
+	os << "  \"version\": " << ToJSONString(ToString(LUXCORE_VERSION_MAJOR) + "." + ToString(LUXCORE_VERSION_MINOR)) << ",\n";
+	os << "  \"date\": " << ToJSONString(boost::posix_time::to_iso_extended_string(
+			boost::posix_time::second_clock::universal_time())) << ",\n";
+	os << "  \"hardwareconcurrency\": " << boost::thread::hardware_concurrency() << ",\n";
+	os << "  \"threads\": " << settings.threadCount << ",\n";
+	os << "  \"samplesperpixel\": " << settings.samplesPerPixel << ",\n";
+	os << "  \"film\": { \"width\": " << settings.filmWidth << ", \"height\": " << settings.filmHeight << " },\n";
+	os << "  \"totaltime\": " << JSONNumber(totalTime) << ",\n";
+	os << "  \"runs\": [";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult &r = results[i];
+
+		os << ((i == 0) ? "\n" : ",\n");
+		os << "    {\n";
+		os << "      \"scene\": " << ToJSONString(r.scene) << ",\n";
+		os << "      \"renderengine\": " << ToJSONString(r.engine) << ",\n";
+		os << "      \"sampler\": " << ToJSONString(r.sampler) << ",\n";
+		os << "      \"lightstrategy\": " << ToJSONString(r.lightStrategy) << ",\n";
+		if (r.failed) {
+			os << "      \"status\": \"error\",\n";
+			os << "      \"error\": " << ToJSONString(r.error) << "\n";
+		} else {
+			os << "      \"status\": " << (r.timedOut ? "\"timeout\"" : "\"ok\"") << ",\n";
+			os << "      \"loadtime\": " << JSONNumber(r.loadTime) << ",\n";
+			os << "      \"buildtime\": " << JSONNumber(r.buildTime) << ",\n";
+			os << "      \"timetofirstpixel\": " << JSONNumber(r.timeToFirstPixel) << ",\n";
+			os << "      \"rendertime\": " << JSONNumber(r.renderTime) << ",\n";
+			os << "      \"pass\": " << r.pass << ",\n";
+			os << "      \"samplecount\": " << JSONNumber(r.sampleCount) << ",\n";
+			os << "      \"samplessec\": " << JSONNumber(r.samplesSec) << ",\n";
+			os << "      \"rayssec\": " << JSONNumber(r.raysSec) << ",\n";
+			os << "      \"trianglecount\": " << JSONNumber(r.triangleCount) << ",\n";
+			os << "      \"peakrss\": " << r.peakRSS << "\n";
+		}
+		os << "    }";
+	}
+
+	os << "\n  ]\n";
+	os << "}\n";
+}
+
+//------------------------------------------------------------------------------
+
+static vector<string> SplitList(const string &list) {
+	vector<string> values;
+	boost::split(values, list, boost::is_any_of(","));
+
+	vector<string> result;
+	for (size_t i = 0; i < values.size(); ++i) {
+		const string v = boost::trim_copy(values[i]);
+		if (v.length() > 0)
+			result.push_back(v);
+	}
+
+	return result;
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		luxcore::Init();
+
+		cout << "LuxCore Rendering Benchmark v" << LUXCORE_VERSION_MAJOR << "." << LUXCORE_VERSION_MINOR << "\n";
+
+		BenchmarkSettings settings;
+		string engines = DEFAULT_ENGINES;
+		string samplers = DEFAULT_SAMPLERS;
+		string lightStrategies = DEFAULT_LIGHTSTRATEGIES;
+		for (int i = 1; i < argc; i++) {
+			if (argv[i][0] == '-') {
+				if (argv[i][1] == 'h') {
+					cout << "Usage: " << argv[0] << " [options] [configuration files or " <<
+							STRESS_INSTANCES_SCENE << " or " << STRESS_LIGHTS_SCENE << "]\n" <<
+							" -E [comma separated render engines, default " << DEFAULT_ENGINES << "]\n" <<
+							" -S [comma separated samplers, default " << DEFAULT_SAMPLERS << "]\n" <<
+							" -L [comma separated light strategies, default " << DEFAULT_LIGHTSTRATEGIES << "]\n" <<
+							" -s [samples per pixel, default " << DEFAULT_SAMPLES_PER_PIXEL << "]\n" <<
+							" -w [film width, default " << DEFAULT_FILM_WIDTH << "]\n" <<
+							" -e [film height, default " << DEFAULT_FILM_HEIGHT << "]\n" <<
+							" -n [render threads count, default all cores]\n" <<
+							" -t [timeout of each run in secs, default " << DEFAULT_TIMEOUT << "]\n" <<
+							" -i [stress scene instances count, default " << DEFAULT_STRESS_INSTANCES_COUNT << "]\n" <<
+							" -l [stress scene lights count, default " << DEFAULT_STRESS_LIGHTS_COUNT << "]\n" <<
+							" -o [JSON output file, default " << DEFAULT_JSON_FILE << "]\n" <<
+							" -D [property name] [property value]\n" <<
+							" -d [current directory path]\n" <<
+							" -h <display this help and exit>\n";
+					exit(EXIT_SUCCESS);
+				}
+				else if (argv[i][1] == 'E') engines = argv[++i];
+				else if (argv[i][1] == 'S') samplers = argv[++i];
+				else if (argv[i][1] == 'L') lightStrategies = argv[++i];
+				else if (argv[i][1] == 's') settings.samplesPerPixel = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 'w') settings.filmWidth = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 'e') settings.filmHeight = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 'n') settings.threadCount = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 't') settings.timeout = atof(argv[++i]);
+				else if (argv[i][1] == 'i') settings.stressInstancesCount = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 'l') settings.stressLightsCount = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 'o') settings.jsonFileName = argv[++i];
+				else if (argv[i][1] == 'D') {
+					settings.cmdLineProps.Set(Property(argv[i + 1]).Add(argv[i + 2]));
+					i += 2;
+				}
+				else if (argv[i][1] == 'd') boost::filesystem::current_path(boost::filesystem::path(argv[++i]));
+				else {
+					cerr << "Invalid option: " << argv[i] << "\n";
+					exit(EXIT_FAILURE);
+				}
+			} else
+				settings.scenes.push_back(argv[i]);
+		}
+
+		if (settings.scenes.size() == 0) {
+			settings.scenes.push_back("scenes/cornell/cornell.cfg");
+			settings.scenes.push_back("scenes/luxball/luxball.cfg");
+			settings.scenes.push_back(STRESS_INSTANCES_SCENE);
+			settings.scenes.push_back(STRESS_LIGHTS_SCENE);
+		}
+		settings.engines = SplitList(engines);
+		settings.samplers = SplitList(samplers);
+		settings.lightStrategies = SplitList(lightStrategies);
+		settings.samplesPerPixel = Max(1u, settings.samplesPerPixel);
+
+		//----------------------------------------------------------------------
+		// Run all the combinations
+		//----------------------------------------------------------------------
+
+		cout << boost::format("%-32s %-10s %-10s %-10s %9s %9s %9s %12s %12s %9s\n") %
+				"Scene" % "Engine" % "Sampler" % "Lights" % "Load(s)" % "Build(s)" %
+				"TTFP(s)" % "Samples/sec" % "Rays/sec" % "RSS(MB)";
+
+		const double startTime = WallClockTime();
+		vector<BenchmarkResult> results;
+		for (size_t s = 0; s < settings.scenes.size(); ++s) {
+			for (size_t e = 0; e < settings.engines.size(); ++e) {
+				for (size_t m = 0; m < settings.samplers.size(); ++m) {
+					for (size_t l = 0; l < settings.lightStrategies.size(); ++l) {
+						BenchmarkResult result;
+						result.scene = settings.scenes[s];
+						result.engine = settings.engines[e];
+						result.sampler = settings.samplers[m];
+						result.lightStrategy = settings.lightStrategies[l];
+
+						try {
+							Render(settings, result);
+						} catch (exception &err) {
+							result.failed = true;
+							result.error = err.what();
+						}
+						results.push_back(result);
+
+						const string sceneName = boost::filesystem::path(result.scene).filename().string();
+						if (result.failed) {
+							cout << boost::format("%-32s %-10s %-10s %-10s ERROR: %s\n") %
+									sceneName % result.engine % result.sampler %
+									result.lightStrategy % result.error;
+						} else {
+							cout << boost::format("%-32s %-10s %-10s %-10s %9.3f %9.3f %9.3f %12.0f %12.0f %9.1f%s\n") %
+									sceneName % result.engine % result.sampler % result.lightStrategy %
+									result.loadTime % result.buildTime % result.timeToFirstPixel %
+									result.samplesSec % result.raysSec %
+									(result.peakRSS / (1024.0 * 1024.0)) %
+									(result.timedOut ? " (timeout)" : "");
+						}
+					}
+				}
+			}
+		}
+		const double totalTime = WallClockTime() - startTime;
+
+		//----------------------------------------------------------------------
+		// Write the results
+		//----------------------------------------------------------------------
+
+		ofstream jsonFile(settings.jsonFileName.c_str(), ios_base::out | ios_base::trunc);
+		if (!jsonFile.good())
+			throw runtime_error("Unable to open JSON output file: " + settings.jsonFileName);
+		WriteJSON(settings, results, totalTime, jsonFile);
+		jsonFile.close();
+
+		cout << "Results written to: " << settings.jsonFileName << "\n";
+
+		// Return an error if any of the runs has failed, so the benchmark can
+		// be used in scripts
+		for (size_t i = 0; i < results.size(); ++i) {
+			if (results[i].failed)
+				return EXIT_FAILURE;
+		}
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
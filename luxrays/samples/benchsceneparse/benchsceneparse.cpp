@@ -0,0 +1,136 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "luxrays/core/utils.h"
+
+#include "luxcore/luxcore.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+
+//------------------------------------------------------------------------------
+// A synthetic scene parsing benchmark: a single quad mesh instanced by a
+// large number of objects, all defined with a single Scene::Parse() call.
+//------------------------------------------------------------------------------
+
+#define DEFAULT_OBJECT_COUNT 500000
+
+static void DefineQuad(Scene *scene, const string &meshName) {
+	Point *p = Scene::AllocVerticesBuffer(4);
+	p[0] = Point(-.5f, -.5f, 0.f);
+	p[1] = Point(.5f, -.5f, 0.f);
+	p[2] = Point(.5f, .5f, 0.f);
+	p[3] = Point(-.5f, .5f, 0.f);
+
+	Triangle *vi = Scene::AllocTrianglesBuffer(2);
+	vi[0] = Triangle(0, 1, 2);
+	vi[1] = Triangle(2, 3, 0);
+
+	scene->DefineMesh(meshName, 4, 2, p, vi, NULL, NULL, NULL, NULL);
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		luxcore::Init();
+
+		cout << "LuxCore Scene Parsing Benchmark v" << LUXCORE_VERSION_MAJOR << "." << LUXCORE_VERSION_MINOR << "\n";
+		cout << "Usage: " << argv[0] << " [object count]\n";
+
+		const u_int objCount = (argc > 1) ? (u_int)atoi(argv[1]) : DEFAULT_OBJECT_COUNT;
+		const u_int gridSize = Max<u_int>(1, (u_int)sqrtf(objCount));
+
+		//----------------------------------------------------------------------
+		// Build the scene properties
+		//----------------------------------------------------------------------
+
+		double startTime = WallClockTime();
+
+		Properties props;
+		props <<
+				Property("scene.camera.lookat.orig")(0.f, 0.f, 10.f) <<
+				Property("scene.camera.lookat.target")(0.f, 0.f, 0.f) <<
+				Property("scene.materials.mat.type")("matte") <<
+				Property("scene.materials.mat.kd")(.75f, .75f, .75f);
+		for (u_int i = 0; i < objCount; ++i) {
+			const string prefix = "scene.objects.obj" + ToString(i);
+			props <<
+					Property(prefix + ".shape")("quad") <<
+					Property(prefix + ".material")("mat") <<
+					Property(prefix + ".transformation")(Matrix4x4(
+						1.f, 0.f, 0.f, float(i % gridSize),
+						0.f, 1.f, 0.f, float(i / gridSize),
+						0.f, 0.f, 1.f, 0.f,
+						0.f, 0.f, 0.f, 1.f));
+		}
+
+		const double propsTime = WallClockTime() - startTime;
+		cout << "Properties count: " << props.GetSize() << "\n";
+		cout << "Properties definition time: " << propsTime << " secs\n";
+
+		//----------------------------------------------------------------------
+		// Prefix queries
+		//----------------------------------------------------------------------
+
+		startTime = WallClockTime();
+		const vector<string> objKeys = props.GetAllUniqueSubNames("scene.objects");
+		const double uniqueSubNamesTime = WallClockTime() - startTime;
+		cout << "GetAllUniqueSubNames() time: " << uniqueSubNamesTime << " secs (" << objKeys.size() << " names)\n";
+
+		startTime = WallClockTime();
+		u_int count = 0;
+		for (vector<string>::const_iterator it = objKeys.begin(); it != objKeys.end(); ++it)
+			count += props.GetAllNames(*it + ".").size();
+		const double prefixQueriesTime = WallClockTime() - startTime;
+		cout << "GetAllNames() per object time: " << prefixQueriesTime << " secs (" << count << " names)\n";
+
+		//----------------------------------------------------------------------
+		// Scene parsing
+		//----------------------------------------------------------------------
+
+		Scene *scene = new Scene();
+		DefineQuad(scene, "quad");
+
+		startTime = WallClockTime();
+		scene->Parse(props);
+		const double parseTime = WallClockTime() - startTime;
+		cout << "Scene parsing time: " << parseTime << " secs\n";
+
+		delete scene;
+
+		//----------------------------------------------------------------------
+		// Deletes
+		//----------------------------------------------------------------------
+
+		startTime = WallClockTime();
+		props.DeleteAll(props.GetAllNames("scene.objects."));
+		const double deleteTime = WallClockTime() - startTime;
+		cout << "DeleteAll() time: " << deleteTime << " secs (" << props.GetSize() << " properties left)\n";
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,694 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "luxrays/core/context.h"
+#include "luxrays/core/randomgen.h"
+#include "luxrays/core/trianglemesh.h"
+#include "luxrays/core/utils.h"
+#include "luxrays/core/geometry/frame.h"
+#include "luxrays/utils/mc.h"
+
+#include "luxcore/luxcore.h"
+
+#include "slg/scene/scene.h"
+#include "slg/materials/material.h"
+#include "slg/textures/texture.h"
+#include "slg/lights/light.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// A micro-benchmark of the shading kernels: one instance of each material,
+// texture and light source type is defined with representative parameters and
+// each Material::Evaluate()/Sample()/Pdf(), Texture::GetSpectrumValue()/
+// GetFloatValue() and LightSource::Illuminate()/Emit() is run, single threaded,
+// on a fixed set of random hit points. The results are in evaluations/sec.
+//------------------------------------------------------------------------------
+
+#define DEFAULT_HITPOINTS_COUNT 4096
+#define DEFAULT_MIN_TIME .5
+#define BENCH_IMAGEMAP_NAME "benchshaders_imagemap"
+#define BENCH_IMAGEMAP_SIZE 256
+#define BENCH_DENSITYGRID_SIZE 32
+
+class BenchmarkSettings {
+public:
+	BenchmarkSettings() : hitPointsCount(DEFAULT_HITPOINTS_COUNT),
+		minTime(DEFAULT_MIN_TIME) { }
+
+	u_int hitPointsCount;
+	// Minimal time spent on each kernel
+	double minTime;
+	// Only the shaders with a name including this string are run
+	string filter;
+	string jsonFileName;
+};
+
+class BenchmarkResult {
+public:
+	BenchmarkResult(const string &k, const string &n, const string &f, const double e) :
+		kind(k), name(n), kernel(f), evalsSec(e) { }
+
+	string kind, name, kernel;
+	double evalsSec;
+};
+
+// The input of all the kernels
+typedef struct {
+	HitPoint hitPoint;
+	// In the shading frame of the hit point
+	Vector localLightDir, localEyeDir;
+	float u0, u1, u2, u3;
+} ShaderSample;
+
+//------------------------------------------------------------------------------
+// Benchmark scene
+//------------------------------------------------------------------------------
+
+// The names of the textures, materials and lights defined by the benchmark
+// (i.e. the scene includes also implicit textures, etc.)
+class BenchmarkShaders {
+public:
+	vector<string> textures, materials, lights;
+};
+
+static void DefineImageMap(Scene *scene) {
+	// A procedural RGB image with some high frequency details
+	vector<float> pixels(BENCH_IMAGEMAP_SIZE * BENCH_IMAGEMAP_SIZE * 3);
+	for (u_int y = 0; y < BENCH_IMAGEMAP_SIZE; ++y) {
+		for (u_int x = 0; x < BENCH_IMAGEMAP_SIZE; ++x) {
+			const float u = x / (float)BENCH_IMAGEMAP_SIZE;
+			const float v = y / (float)BENCH_IMAGEMAP_SIZE;
+			float *pixel = &pixels[(y * BENCH_IMAGEMAP_SIZE + x) * 3];
+			pixel[0] = .5f + .5f * sinf(20.f * u);
+			pixel[1] = .5f + .5f * cosf(30.f * v);
+			pixel[2] = ((x ^ y) & 8) ? 1.f : .1f;
+		}
+	}
+
+	scene->DefineImageMap<float>(BENCH_IMAGEMAP_NAME, &pixels[0], 1.f, 3,
+			BENCH_IMAGEMAP_SIZE, BENCH_IMAGEMAP_SIZE, ImageMapStorage::DEFAULT);
+}
+
+// Adds the definition of a shader with its parameters
+static void DefineShader(Properties &props, const string &prefix,
+		const string &type, const Properties &params) {
+	props << Property(prefix + ".type")(type);
+
+	const vector<string> &keys = params.GetAllNames();
+	for (vector<string>::const_iterator k = keys.begin(); k != keys.end(); ++k)
+		props << params.Get(*k).Renamed(prefix + "." + *k);
+}
+
+static void DefineTexture(Properties &props, BenchmarkShaders &shaders,
+		const string &type, const Properties &params = Properties()) {
+	const string name = "tex_" + type;
+	const string prefix = "scene.textures." + name;
+
+	DefineShader(props, prefix, type, params);
+
+	shaders.textures.push_back(name);
+}
+
+static void DefineTextures(Properties &props, BenchmarkShaders &shaders) {
+	// The textures referenced by other textures have to be defined first
+	DefineTexture(props, shaders, "imagemap", Properties() <<
+			Property("file")(BENCH_IMAGEMAP_NAME) <<
+			Property("gamma")(1.f));
+	DefineTexture(props, shaders, "constfloat1", Properties() <<
+			Property("value")(.5f));
+	DefineTexture(props, shaders, "constfloat3", Properties() <<
+			Property("value")(.7f, .5f, .3f));
+	DefineTexture(props, shaders, "fbm");
+
+	DefineTexture(props, shaders, "scale", Properties() <<
+			Property("texture1")(.5f, .5f, .5f) <<
+			Property("texture2")("tex_imagemap"));
+	DefineTexture(props, shaders, "fresnelapproxn", Properties() <<
+			Property("texture")("tex_constfloat3"));
+	DefineTexture(props, shaders, "fresnelapproxk", Properties() <<
+			Property("texture")("tex_constfloat3"));
+	DefineTexture(props, shaders, "checkerboard2d");
+	DefineTexture(props, shaders, "checkerboard3d");
+
+	// A smooth blob in the middle of the grid
+	Property data("data");
+	for (u_int z = 0; z < BENCH_DENSITYGRID_SIZE; ++z) {
+		for (u_int y = 0; y < BENCH_DENSITYGRID_SIZE; ++y) {
+			for (u_int x = 0; x < BENCH_DENSITYGRID_SIZE; ++x) {
+				const Vector d(
+						x / (float)BENCH_DENSITYGRID_SIZE - .5f,
+						y / (float)BENCH_DENSITYGRID_SIZE - .5f,
+						z / (float)BENCH_DENSITYGRID_SIZE - .5f);
+				data.Add(Max(0.f, 1.f - 4.f * d.LengthSquared()));
+			}
+		}
+	}
+	DefineTexture(props, shaders, "densitygrid", Properties() <<
+			Property("nx")(BENCH_DENSITYGRID_SIZE) <<
+			Property("ny")(BENCH_DENSITYGRID_SIZE) <<
+			Property("nz")(BENCH_DENSITYGRID_SIZE) <<
+			data);
+
+	DefineTexture(props, shaders, "mix", Properties() <<
+			Property("amount")("tex_fbm") <<
+			Property("texture1")(.8f, .2f, .2f) <<
+			Property("texture2")("tex_imagemap"));
+	DefineTexture(props, shaders, "marble");
+	DefineTexture(props, shaders, "blender_blend");
+	DefineTexture(props, shaders, "blender_clouds");
+	DefineTexture(props, shaders, "blender_distortednoise");
+	DefineTexture(props, shaders, "blender_magic");
+	DefineTexture(props, shaders, "blender_marble");
+	DefineTexture(props, shaders, "blender_musgrave");
+	DefineTexture(props, shaders, "blender_noise");
+	DefineTexture(props, shaders, "blender_stucci");
+	DefineTexture(props, shaders, "blender_wood");
+	DefineTexture(props, shaders, "blender_voronoi");
+	DefineTexture(props, shaders, "dots");
+	DefineTexture(props, shaders, "brick");
+	DefineTexture(props, shaders, "add", Properties() <<
+			Property("texture1")("tex_imagemap") <<
+			Property("texture2")(.1f, .1f, .1f));
+	DefineTexture(props, shaders, "subtract", Properties() <<
+			Property("texture1")("tex_imagemap") <<
+			Property("texture2")(.1f, .1f, .1f));
+	DefineTexture(props, shaders, "windy");
+	DefineTexture(props, shaders, "wrinkled");
+	DefineTexture(props, shaders, "uv");
+	DefineTexture(props, shaders, "band", Properties() <<
+			Property("amount")("tex_fbm") <<
+			Property("offset0")(0.f) <<
+			Property("value0")(.1f, .1f, .8f) <<
+			Property("offset1")(.5f) <<
+			Property("value1")(.1f, .8f, .1f) <<
+			Property("offset2")(1.f) <<
+			Property("value2")(.8f, .1f, .1f));
+	DefineTexture(props, shaders, "hitpointcolor");
+	DefineTexture(props, shaders, "hitpointalpha");
+	DefineTexture(props, shaders, "hitpointgrey");
+	DefineTexture(props, shaders, "cloud");
+	DefineTexture(props, shaders, "blackbody", Properties() <<
+			Property("temperature")(6500.f));
+	DefineTexture(props, shaders, "irregulardata", Properties() <<
+			Property("wavelengths")(400.f, 500.f, 600.f, 700.f) <<
+			Property("data")(.2f, .5f, .8f, .3f));
+	DefineTexture(props, shaders, "lampspectrum");
+	DefineTexture(props, shaders, "fresnelabbe");
+	DefineTexture(props, shaders, "fresnelcauchy");
+	DefineTexture(props, shaders, "fresnelcolor", Properties() <<
+			Property("kr")("tex_imagemap"));
+	DefineTexture(props, shaders, "fresnelconst");
+	DefineTexture(props, shaders, "fresnelpreset");
+	// fresnelluxpop and fresnelsopra require a data file
+	DefineTexture(props, shaders, "abs", Properties() <<
+			Property("texture")("tex_fbm"));
+	DefineTexture(props, shaders, "clamp", Properties() <<
+			Property("texture")("tex_fbm") <<
+			Property("min")(.2f) <<
+			Property("max")(.8f));
+	DefineTexture(props, shaders, "colordepth", Properties() <<
+			Property("kt")("tex_imagemap"));
+	DefineTexture(props, shaders, "normalmap", Properties() <<
+			Property("texture")("tex_imagemap"));
+	DefineTexture(props, shaders, "bilerp");
+	DefineTexture(props, shaders, "hsv", Properties() <<
+			Property("texture")("tex_imagemap"));
+}
+
+static void DefineMaterial(Properties &props, BenchmarkShaders &shaders,
+		const string &type, const Properties &params = Properties()) {
+	const string name = "mat_" + type;
+	const string prefix = "scene.materials." + name;
+
+	DefineShader(props, prefix, type, params);
+
+	shaders.materials.push_back(name);
+}
+
+static void DefineMaterials(Properties &props, BenchmarkShaders &shaders) {
+	// All parameters are constant so only the cost of the BSDF is measured
+	DefineMaterial(props, shaders, "matte");
+	DefineMaterial(props, shaders, "roughmatte");
+	DefineMaterial(props, shaders, "mirror");
+	DefineMaterial(props, shaders, "glass");
+	DefineMaterial(props, shaders, "archglass");
+	DefineMaterial(props, shaders, "null");
+	DefineMaterial(props, shaders, "mattetranslucent");
+	DefineMaterial(props, shaders, "roughmattetranslucent");
+	DefineMaterial(props, shaders, "glossy2");
+	DefineMaterial(props, shaders, "metal2");
+	DefineMaterial(props, shaders, "roughglass");
+	DefineMaterial(props, shaders, "velvet");
+	DefineMaterial(props, shaders, "cloth");
+	DefineMaterial(props, shaders, "carpaint");
+	DefineMaterial(props, shaders, "glossytranslucent");
+	DefineMaterial(props, shaders, "mix", Properties() <<
+			Property("material1")("mat_matte") <<
+			Property("material2")("mat_glossy2") <<
+			Property("amount")(.5f));
+	DefineMaterial(props, shaders, "glossycoating", Properties() <<
+			Property("base")("mat_matte"));
+}
+
+static void DefineLight(Properties &props, BenchmarkShaders &shaders,
+		const string &type, const Properties &params = Properties()) {
+	const string name = "light_" + type;
+	const string prefix = "scene.lights." + name;
+
+	DefineShader(props, prefix, type, params);
+
+	shaders.lights.push_back(name);
+}
+
+static void DefineLights(Properties &props, BenchmarkShaders &shaders) {
+	// The hit points are inside the [-1, 1]^3 box
+	DefineLight(props, shaders, "sky", Properties() <<
+			Property("dir")(.3f, -.4f, 1.f));
+	DefineLight(props, shaders, "sky2", Properties() <<
+			Property("dir")(.3f, -.4f, 1.f));
+	DefineLight(props, shaders, "infinite", Properties() <<
+			Property("file")(BENCH_IMAGEMAP_NAME) <<
+			Property("gamma")(1.f));
+	DefineLight(props, shaders, "sun", Properties() <<
+			Property("dir")(.3f, -.4f, 1.f));
+	DefineLight(props, shaders, "point", Properties() <<
+			Property("position")(0.f, 0.f, 3.f));
+	DefineLight(props, shaders, "mappoint", Properties() <<
+			Property("position")(0.f, 0.f, 3.f) <<
+			Property("mapfile")(BENCH_IMAGEMAP_NAME) <<
+			Property("gamma")(1.f));
+	DefineLight(props, shaders, "spot", Properties() <<
+			Property("position")(0.f, 0.f, 3.f) <<
+			Property("target")(0.f, 0.f, 0.f));
+	DefineLight(props, shaders, "projection", Properties() <<
+			Property("position")(0.f, 0.f, 3.f) <<
+			Property("target")(0.f, 0.f, 0.f) <<
+			Property("mapfile")(BENCH_IMAGEMAP_NAME) <<
+			Property("gamma")(1.f));
+	DefineLight(props, shaders, "laser", Properties() <<
+			Property("position")(0.f, 0.f, 3.f) <<
+			Property("target")(0.f, 0.f, 0.f));
+	DefineLight(props, shaders, "constantinfinite");
+	DefineLight(props, shaders, "sharpdistant", Properties() <<
+			Property("direction")(0.f, 0.f, -1.f));
+	DefineLight(props, shaders, "distant", Properties() <<
+			Property("direction")(0.f, 0.f, -1.f));
+
+	// An area light
+	props <<
+			Property("scene.materials.mat_emitter.type")("matte") <<
+			Property("scene.materials.mat_emitter.emission")(10.f, 10.f, 10.f) <<
+			Property("scene.objects.emitter.shape")("quad") <<
+			Property("scene.objects.emitter.material")("mat_emitter") <<
+			Property("scene.objects.emitter.transformation")(Matrix4x4(
+				2.f, 0.f, 0.f, 0.f,
+				0.f, 2.f, 0.f, 0.f,
+				0.f, 0.f, 1.f, 3.f,
+				0.f, 0.f, 0.f, 1.f));
+	shaders.lights.push_back(string("emitter") + TRIANGLE_LIGHT_POSTFIX + "0");
+}
+
+static Scene *CreateScene(BenchmarkShaders &shaders) {
+	Scene *scene = new Scene();
+
+	DefineImageMap(scene);
+
+	Point *p = TriangleMesh::AllocVerticesBuffer(4);
+	p[0] = Point(-.5f, -.5f, 0.f);
+	p[1] = Point(.5f, -.5f, 0.f);
+	p[2] = Point(.5f, .5f, 0.f);
+	p[3] = Point(-.5f, .5f, 0.f);
+	Triangle *vi = TriangleMesh::AllocTrianglesBuffer(2);
+	vi[0] = Triangle(0, 1, 2);
+	vi[1] = Triangle(2, 3, 0);
+	scene->DefineMesh("quad", 4, 2, p, vi, NULL, NULL, NULL, NULL);
+
+	Properties props;
+	props <<
+			Property("scene.camera.lookat.orig")(0.f, -5.f, 2.f) <<
+			Property("scene.camera.lookat.target")(0.f, 0.f, 0.f);
+	DefineTextures(props, shaders);
+	DefineMaterials(props, shaders);
+	DefineLights(props, shaders);
+
+	scene->Parse(props);
+
+	return scene;
+}
+
+static void GenerateSamples(const u_int count, vector<ShaderSample> &samples) {
+	// Always the same seed so the samples are the same across runs and builds
+	RandomGenerator rnd(1u);
+
+	samples.resize(count);
+	for (u_int i = 0; i < count; ++i) {
+		ShaderSample &s = samples[i];
+		HitPoint &hp = s.hitPoint;
+
+		hp.p = Point(
+				2.f * rnd.floatValue() - 1.f,
+				2.f * rnd.floatValue() - 1.f,
+				2.f * rnd.floatValue() - 1.f);
+		hp.uv = UV(rnd.floatValue(), rnd.floatValue());
+		const float u0 = rnd.floatValue();
+		const float u1 = rnd.floatValue();
+		hp.geometryN = Normal(UniformSampleSphere(u0, u1));
+		hp.shadeN = hp.geometryN;
+		CoordinateSystem(Vector(hp.shadeN), &hp.dpdu, &hp.dpdv);
+		hp.dndu = Normal();
+		hp.dndv = Normal();
+		hp.color = Spectrum(rnd.floatValue(), rnd.floatValue(), rnd.floatValue());
+		hp.alpha = 1.f;
+		hp.passThroughEvent = rnd.floatValue();
+		hp.localToWorld = Transform();
+		hp.interiorVolume = NULL;
+		hp.exteriorVolume = NULL;
+		hp.fromLight = false;
+		hp.intoObject = true;
+
+		// The eye is always above the surface while the light direction
+		// covers both reflection and transmission
+		const float u2 = rnd.floatValue();
+		const float u3 = rnd.floatValue();
+		s.localEyeDir = UniformSampleSphere(u2, u3);
+		s.localEyeDir.z = fabsf(s.localEyeDir.z);
+		const float u4 = rnd.floatValue();
+		const float u5 = rnd.floatValue();
+		s.localLightDir = UniformSampleSphere(u4, u5);
+		hp.fixedDir = hp.GetFrame().ToWorld(s.localEyeDir);
+
+		s.u0 = rnd.floatValue();
+		s.u1 = rnd.floatValue();
+		s.u2 = rnd.floatValue();
+		s.u3 = rnd.floatValue();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Kernels
+//------------------------------------------------------------------------------
+
+// All kernels return a value accumulated by the caller, so the compiler can not
+// optimize away the evaluation
+
+class MaterialEvaluateKernel {
+public:
+	MaterialEvaluateKernel(const Material *m) : mat(m) { }
+
+	float operator()(const ShaderSample &s) const {
+		BSDFEvent event;
+		return mat->Evaluate(s.hitPoint, s.localLightDir, s.localEyeDir, &event).Y();
+	}
+
+	const Material *mat;
+};
+
+class MaterialSampleKernel {
+public:
+	MaterialSampleKernel(const Material *m) : mat(m) { }
+
+	float operator()(const ShaderSample &s) const {
+		Vector sampledDir;
+		float pdfW, absCosSampledDir;
+		BSDFEvent event;
+		return mat->Sample(s.hitPoint, s.localEyeDir, &sampledDir, s.u0, s.u1,
+				s.hitPoint.passThroughEvent, &pdfW, &absCosSampledDir, &event).Y();
+	}
+
+	const Material *mat;
+};
+
+class MaterialPdfKernel {
+public:
+	MaterialPdfKernel(const Material *m) : mat(m) { }
+
+	float operator()(const ShaderSample &s) const {
+		float directPdfW = 0.f, reversePdfW = 0.f;
+		mat->Pdf(s.hitPoint, s.localLightDir, s.localEyeDir, &directPdfW, &reversePdfW);
+		return directPdfW + reversePdfW;
+	}
+
+	const Material *mat;
+};
+
+class TextureSpectrumKernel {
+public:
+	TextureSpectrumKernel(const Texture *t) : tex(t) { }
+
+	float operator()(const ShaderSample &s) const {
+		return tex->GetSpectrumValue(s.hitPoint).Y();
+	}
+
+	const Texture *tex;
+};
+
+class TextureFloatKernel {
+public:
+	TextureFloatKernel(const Texture *t) : tex(t) { }
+
+	float operator()(const ShaderSample &s) const {
+		return tex->GetFloatValue(s.hitPoint);
+	}
+
+	const Texture *tex;
+};
+
+class LightIlluminateKernel {
+public:
+	LightIlluminateKernel(const Scene *sc, const LightSource *l) : scene(sc), light(l) { }
+
+	float operator()(const ShaderSample &s) const {
+		Vector dir;
+		float distance, directPdfW;
+		return light->Illuminate(*scene, s.hitPoint.p, s.u0, s.u1,
+				s.hitPoint.passThroughEvent, &dir, &distance, &directPdfW).Y();
+	}
+
+	const Scene *scene;
+	const LightSource *light;
+};
+
+class LightEmitKernel {
+public:
+	LightEmitKernel(const Scene *sc, const LightSource *l) : scene(sc), light(l) { }
+
+	float operator()(const ShaderSample &s) const {
+		Point pos;
+		Vector dir;
+		float emissionPdfW;
+		return light->Emit(*scene, s.u0, s.u1, s.u2, s.u3,
+				s.hitPoint.passThroughEvent, &pos, &dir, &emissionPdfW).Y();
+	}
+
+	const Scene *scene;
+	const LightSource *light;
+};
+
+// Returns the number of evaluations/sec
+template <class Kernel> static double TimeKernel(const Kernel &kernel,
+		const vector<ShaderSample> &samples, const double minTime, double *sink) {
+	// Warm up the caches
+	float sum = 0.f;
+	for (size_t i = 0; i < samples.size(); ++i)
+		sum += kernel(samples[i]);
+
+	double evalsCount = 0.0;
+	const double startTime = WallClockTime();
+	double elapsedTime;
+	do {
+		for (size_t i = 0; i < samples.size(); ++i)
+			sum += kernel(samples[i]);
+		evalsCount += samples.size();
+
+		elapsedTime = WallClockTime() - startTime;
+	} while (elapsedTime < minTime);
+
+	*sink += sum;
+
+	return evalsCount / elapsedTime;
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+
+static void PrintResult(const BenchmarkResult &r) {
+	cout << boost::format("%-9s %-36s %-17s %12.3f %10.1f\n") %
+			r.kind % r.name % r.kernel % (r.evalsSec / 1000000.0) %
+			((r.evalsSec > 0.0) ? (1000000000.0 / r.evalsSec) : 0.0);
+}
+
+static void WriteJSON(const vector<BenchmarkResult> &results, ostream &os) {
+	os << "{\n";
+	os << "  \"version\": \"" << LUXCORE_VERSION_MAJOR << "." << LUXCORE_VERSION_MINOR << "\",\n";
+	os << "  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult &r = results[i];
+
+		// All names are generated by the benchmark and don't require escaping
+		os << "    {\"kind\": \"" << r.kind << "\", \"name\": \"" << r.name <<
+				"\", \"kernel\": \"" << r.kernel << "\", \"evalssec\": " <<
+				boost::str(boost::format("%.6g") % r.evalsSec) << "}" <<
+				((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+	os << "  ]\n";
+	os << "}\n";
+}
+
+//------------------------------------------------------------------------------
+
+static bool IsSelected(const BenchmarkSettings &settings, const string &name) {
+	return (settings.filter.length() == 0) || (name.find(settings.filter) != string::npos);
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		luxcore::Init();
+
+		cout << "LuxCore Shaders Benchmark v" << LUXCORE_VERSION_MAJOR << "." << LUXCORE_VERSION_MINOR << "\n";
+
+		BenchmarkSettings settings;
+		for (int i = 1; i < argc; i++) {
+			if (argv[i][0] == '-') {
+				if (argv[i][1] == 'h') {
+					cout << "Usage: " << argv[0] << " [options]\n" <<
+							" -n [hit points count, default " << DEFAULT_HITPOINTS_COUNT << "]\n" <<
+							" -t [min. time spent on each kernel in secs, default " << DEFAULT_MIN_TIME << "]\n" <<
+							" -f [run only the shaders with a name including this string]\n" <<
+							" -o [JSON output file]\n" <<
+							" -h <display this help and exit>\n";
+					exit(EXIT_SUCCESS);
+				}
+				else if (argv[i][1] == 'n') settings.hitPointsCount = (u_int)atoi(argv[++i]);
+				else if (argv[i][1] == 't') settings.minTime = atof(argv[++i]);
+				else if (argv[i][1] == 'f') settings.filter = argv[++i];
+				else if (argv[i][1] == 'o') settings.jsonFileName = argv[++i];
+				else {
+					cerr << "Invalid option: " << argv[i] << "\n";
+					exit(EXIT_FAILURE);
+				}
+			} else {
+				cerr << "Unknown argument: " << argv[i] << "\n";
+				exit(EXIT_FAILURE);
+			}
+		}
+		settings.hitPointsCount = Max(1u, settings.hitPointsCount);
+
+		//----------------------------------------------------------------------
+		// Build the scene
+		//----------------------------------------------------------------------
+
+		BenchmarkShaders shaders;
+		Scene *scene = CreateScene(shaders);
+
+		Context *ctx = new Context();
+		scene->Preprocess(ctx, 640, 480, NULL, ACCEL_AUTO, false);
+
+		vector<ShaderSample> samples;
+		GenerateSamples(settings.hitPointsCount, samples);
+
+		//----------------------------------------------------------------------
+		// Run all the kernels
+		//----------------------------------------------------------------------
+
+		cout << boost::format("%-9s %-36s %-17s %12s %10s\n") %
+				"Kind" % "Name" % "Kernel" % "Mevals/sec" % "ns/eval";
+
+		vector<BenchmarkResult> results;
+		double sink = 0.0;
+
+		for (size_t i = 0; i < shaders.textures.size(); ++i) {
+			const string &name = shaders.textures[i];
+			if (!IsSelected(settings, name))
+				continue;
+
+			const Texture *tex = scene->texDefs.GetTexture(name);
+			results.push_back(BenchmarkResult("texture", name, "GetSpectrumValue",
+					TimeKernel(TextureSpectrumKernel(tex), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+			results.push_back(BenchmarkResult("texture", name, "GetFloatValue",
+					TimeKernel(TextureFloatKernel(tex), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+		}
+
+		for (size_t i = 0; i < shaders.materials.size(); ++i) {
+			const string &name = shaders.materials[i];
+			if (!IsSelected(settings, name))
+				continue;
+
+			const Material *mat = scene->matDefs.GetMaterial(name);
+			results.push_back(BenchmarkResult("material", name, "Evaluate",
+					TimeKernel(MaterialEvaluateKernel(mat), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+			results.push_back(BenchmarkResult("material", name, "Sample",
+					TimeKernel(MaterialSampleKernel(mat), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+			results.push_back(BenchmarkResult("material", name, "Pdf",
+					TimeKernel(MaterialPdfKernel(mat), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+		}
+
+		for (size_t i = 0; i < shaders.lights.size(); ++i) {
+			const string &name = shaders.lights[i];
+			if (!IsSelected(settings, name))
+				continue;
+
+			const LightSource *light = scene->lightDefs.GetLightSource(name);
+			results.push_back(BenchmarkResult("light", name, "Illuminate",
+					TimeKernel(LightIlluminateKernel(scene, light), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+			results.push_back(BenchmarkResult("light", name, "Emit",
+					TimeKernel(LightEmitKernel(scene, light), samples, settings.minTime, &sink)));
+			PrintResult(results.back());
+		}
+
+		// Printed only to be sure the evaluations are not optimized away
+		cout << "Checksum: " << sink << "\n";
+
+		if (settings.jsonFileName.length() > 0) {
+			ofstream jsonFile(settings.jsonFileName.c_str());
+			if (!jsonFile.good())
+				throw runtime_error("Unable to open JSON output file: " + settings.jsonFileName);
+			WriteJSON(results, jsonFile);
+			cout << "Results written to: " << settings.jsonFileName << "\n";
+		}
+
+		delete scene;
+		delete ctx;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
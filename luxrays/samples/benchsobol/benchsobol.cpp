@@ -0,0 +1,98 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "luxrays/core/utils.h"
+#include "slg/samplers/sobol.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// Compares the one dimension at a time Sobol sample generation with the
+// batched Gray-code generation of SobolSequence
+//------------------------------------------------------------------------------
+
+#define DEFAULT_DIMENSIONS 256
+#define DEFAULT_SAMPLE_COUNT (1024 * 1024)
+#define BLOCK_SIZE 64
+
+int main(int argc, char *argv[]) {
+	try {
+		cout << "Sobol Sample Generation Benchmark\n";
+		cout << "Usage: " << argv[0] << " [dimensions] [sample count]\n";
+
+		const u_int dimensions = (argc > 1) ? (u_int)atoi(argv[1]) : DEFAULT_DIMENSIONS;
+		const u_int sampleCount = (argc > 2) ? (u_int)atoi(argv[2]) : DEFAULT_SAMPLE_COUNT;
+		const u_int firstIndex = SOBOL_STARTOFFSET;
+		cout << "Dimensions: " << dimensions << "\n";
+		cout << "Samples: " << sampleCount << "\n";
+
+		SobolSequence sequence;
+		sequence.RequestSamples(dimensions);
+
+		//----------------------------------------------------------------------
+		// One dimension at a time
+		//----------------------------------------------------------------------
+
+		double startTime = WallClockTime();
+		u_int checksum1 = 0;
+		for (u_int i = 0; i < sampleCount; ++i)
+			for (u_int d = 0; d < dimensions; ++d)
+				checksum1 ^= sequence.SobolDimension(firstIndex + i, d);
+		const double dimensionTime = WallClockTime() - startTime;
+		cout << "One dimension at a time: " << dimensionTime << " secs, " <<
+				(sampleCount * (double)dimensions / dimensionTime) / 1000000.0 << " M values/sec, " <<
+				(sampleCount / dimensionTime) / 1000000.0 << " M samples/sec\n";
+
+		//----------------------------------------------------------------------
+		// Batched
+		//----------------------------------------------------------------------
+
+		vector<u_int> block(BLOCK_SIZE * dimensions);
+		startTime = WallClockTime();
+		u_int checksum2 = 0;
+		for (u_int i = 0; i < sampleCount; i += BLOCK_SIZE) {
+			const u_int count = Min<u_int>(BLOCK_SIZE, sampleCount - i);
+			sequence.GenerateBlock(firstIndex + i, count, &block[0]);
+			for (u_int j = 0; j < count * dimensions; ++j)
+				checksum2 ^= block[j];
+		}
+		const double batchedTime = WallClockTime() - startTime;
+		cout << "Batched: " << batchedTime << " secs, " <<
+				(sampleCount * (double)dimensions / batchedTime) / 1000000.0 << " M values/sec, " <<
+				(sampleCount / batchedTime) / 1000000.0 << " M samples/sec\n";
+
+		if (checksum1 != checksum2)
+			throw runtime_error("Batched Sobol samples don't match the reference implementation");
+		cout << "Speedup: " << dimensionTime / batchedTime << "x\n";
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "luxrays/core/randomgen.h"
+#include "luxrays/core/utils.h"
+#include "luxrays/utils/properties.h"
+#include "slg/film/film.h"
+#include "slg/film/filmsamplesplatter.h"
+#include "slg/film/sampleresult.h"
+#include "slg/film/filters/gaussian.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// Compares the one sample at a time splatting of FilmSampleSplatter with the
+// batched splatting
+//------------------------------------------------------------------------------
+
+#define DEFAULT_FILM_SIZE 512
+#define DEFAULT_SAMPLE_COUNT (2 * 1024 * 1024)
+#define BATCH_SIZE 64
+
+static const Film::FilmChannelType channelTypes[] = {
+	Film::RADIANCE_PER_PIXEL_NORMALIZED,
+	Film::ALPHA,
+	Film::DIRECT_DIFFUSE,
+	Film::EMISSION,
+	Film::INDIRECT_DIFFUSE,
+	Film::MATERIAL_ID_MASK,
+	Film::DIRECT_SHADOW_MASK
+};
+static const u_int channelTypesCount = sizeof(channelTypes) / sizeof(Film::FilmChannelType);
+
+static Film *CreateFilm(const u_int size) {
+	Film *film = new Film(size, size);
+	film->RemoveChannel(Film::IMAGEPIPELINE);
+	film->SetImagePipelines(NULL);
+	film->SetRadianceGroupCount(2);
+
+	for (u_int i = 0; i < channelTypesCount; ++i) {
+		const Properties prop = Properties() << Property("id")(1u);
+		film->AddChannel(channelTypes[i], &prop);
+	}
+	film->Init();
+
+	return film;
+}
+
+static void InitSampleResults(vector<SampleResult> &sampleResults, const u_int size,
+		RandomGenerator &rndGen) {
+	u_int sampleChannels = 0;
+	for (u_int i = 0; i < channelTypesCount; ++i)
+		sampleChannels |= channelTypes[i];
+	// MATERIAL_ID_MASK is computed from MATERIAL_ID
+	sampleChannels |= Film::MATERIAL_ID;
+
+	for (u_int i = 0; i < sampleResults.size(); ++i) {
+		SampleResult &sr = sampleResults[i];
+		sr.Init(sampleChannels, 2);
+		sr.useFilmSplat = true;
+		sr.filmX = rndGen.floatValue() * size;
+		sr.filmY = rndGen.floatValue() * size;
+		sr.radiance[0] = Spectrum(rndGen.floatValue(), rndGen.floatValue(), rndGen.floatValue());
+		sr.radiance[1] = Spectrum(rndGen.floatValue());
+		sr.alpha = 1.f;
+		sr.materialID = rndGen.uintValue() % 2;
+		sr.directDiffuse = Spectrum(rndGen.floatValue());
+		sr.emission = Spectrum();
+		sr.indirectDiffuse = Spectrum(rndGen.floatValue());
+		sr.directShadowMask = rndGen.floatValue();
+	}
+}
+
+static void CompareFilms(Film &film1, Film &film2) {
+	for (u_int i = 0; i < channelTypesCount; ++i) {
+		const u_int count = film1.GetChannelCount(channelTypes[i]);
+		for (u_int index = 0; index < count; ++index) {
+			const float *p1 = film1.GetChannel<float>(channelTypes[i], index);
+			const float *p2 = film2.GetChannel<float>(channelTypes[i], index);
+			// GetChannelPixelSize() returns the number of floats of each pixel
+			const size_t size = film1.GetWidth() * film1.GetHeight() *
+					Film::GetChannelPixelSize(channelTypes[i]);
+
+			for (size_t j = 0; j < size; ++j) {
+				if (p1[j] != p2[j])
+					throw runtime_error("Batched splatting doesn't match the reference implementation in channel: " +
+							Film::FilmChannelType2String(channelTypes[i]));
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		cout << "Film Sample Splatting Benchmark\n";
+		cout << "Usage: " << argv[0] << " [film size] [sample count]\n";
+
+		const u_int size = (argc > 1) ? (u_int)atoi(argv[1]) : DEFAULT_FILM_SIZE;
+		const u_int sampleCount = (argc > 2) ? (u_int)atoi(argv[2]) : DEFAULT_SAMPLE_COUNT;
+		cout << "Film size: " << size << "x" << size << "\n";
+		cout << "Samples: " << sampleCount << "\n";
+
+		const GaussianFilter filter(2.f, 2.f, 2.f);
+		const FilmSampleSplatter splatter(&filter);
+
+		Film *film1 = CreateFilm(size);
+		Film *film2 = CreateFilm(size);
+
+		RandomGenerator rndGen(131);
+		vector<SampleResult> sampleResults(BATCH_SIZE);
+
+		//----------------------------------------------------------------------
+		// One sample at a time
+		//----------------------------------------------------------------------
+
+		double sampleTime = 0.0;
+		double batchedTime = 0.0;
+		for (u_int i = 0; i < sampleCount; i += BATCH_SIZE) {
+			InitSampleResults(sampleResults, size, rndGen);
+
+			double startTime = WallClockTime();
+			for (u_int j = 0; j < sampleResults.size(); ++j)
+				splatter.SplatSample(*film1, sampleResults[j], 1.f);
+			sampleTime += WallClockTime() - startTime;
+
+			//------------------------------------------------------------------
+			// Batched
+			//------------------------------------------------------------------
+
+			startTime = WallClockTime();
+			splatter.SplatSamples(*film2, sampleResults, 1.f);
+			batchedTime += WallClockTime() - startTime;
+		}
+
+		cout << "One sample at a time: " << sampleTime << " secs, " <<
+				(sampleCount / sampleTime) / 1000000.0 << " M samples/sec\n";
+		cout << "Batched: " << batchedTime << " secs, " <<
+				(sampleCount / batchedTime) / 1000000.0 << " M samples/sec\n";
+
+		CompareFilms(*film1, *film2);
+		cout << "Speedup: " << sampleTime / batchedTime << "x\n";
+
+		delete film1;
+		delete film2;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
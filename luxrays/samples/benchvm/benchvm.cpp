@@ -0,0 +1,111 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+
+#include "luxrays/core/utils.h"
+
+#include "luxcore/luxcore.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+
+//------------------------------------------------------------------------------
+// A BIDIRVMCPU thread scaling benchmark: the same number of passes is
+// rendered with 1, 2, 4, etc. threads. All the light paths of a pass are
+// stored in the same vertex merging HashGrid so the number of light vertices
+// used by each eye path grows with the number of threads.
+//------------------------------------------------------------------------------
+
+#define DEFAULT_SCENE "scenes/cornell/cornell.cfg"
+#define DEFAULT_PASSES 8
+#define DEFAULT_LIGHTPATH_COUNT (16 * 1024)
+
+static double Render(const Properties &cfgProps, const u_int threadCount,
+		const u_int passes, const u_int lightPathsCount) {
+	Properties props = cfgProps;
+	props.Set(Property("renderengine.type")("BIDIRVMCPU"));
+	props.Set(Property("native.threads.count")(threadCount));
+	props.Set(Property("batch.haltdebug")(passes));
+	props.Set(Property("bidirvm.lightpath.count")(lightPathsCount));
+
+	RenderConfig *config = new RenderConfig(props);
+	RenderSession *session = new RenderSession(config);
+
+	const double startTime = WallClockTime();
+	session->Start();
+	session->WaitForDone();
+	const double renderTime = WallClockTime() - startTime;
+	session->Stop();
+
+	delete session;
+	delete config;
+
+	return renderTime;
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		luxcore::Init();
+
+		cout << "LuxCore Vertex Merging Benchmark v" << LUXCORE_VERSION_MAJOR << "." << LUXCORE_VERSION_MINOR << "\n";
+		cout << "Usage: " << argv[0] << " [scene configuration file] [passes] [light paths count] [max. thread count]\n";
+
+		const string cfgFileName = (argc > 1) ? argv[1] : DEFAULT_SCENE;
+		const u_int passes = (argc > 2) ? (u_int)atoi(argv[2]) : DEFAULT_PASSES;
+		const u_int lightPathsCount = (argc > 3) ? (u_int)atoi(argv[3]) : DEFAULT_LIGHTPATH_COUNT;
+		const u_int maxThreadCount = (argc > 4) ? (u_int)atoi(argv[4]) :
+			Max(1u, boost::thread::hardware_concurrency());
+
+		const Properties cfgProps(cfgFileName);
+
+		cout << boost::format("%8s %12s %16s %16s %10s\n") %
+				"Threads" % "Time (secs)" % "Merged paths" % "Samples/sec" % "Speedup";
+
+		double singleThreadSamplesSec = 0.0;
+		for (u_int threadCount = 1; threadCount <= maxThreadCount;
+				threadCount = (threadCount == maxThreadCount) ? (maxThreadCount + 1) :
+					Min(threadCount * 2, maxThreadCount)) {
+			const double renderTime = Render(cfgProps, threadCount, passes, lightPathsCount);
+
+			// Each thread traces lightPathsCount light and eye paths for
+			// each pass (the first pass is step 0)
+			const double sampleCount = double(threadCount) * lightPathsCount * (passes + 1);
+			const double samplesSec = sampleCount / renderTime;
+			if (threadCount == 1)
+				singleThreadSamplesSec = samplesSec;
+
+			cout << boost::format("%8d %12.3f %16d %16.0f %10.2f\n") %
+					threadCount % renderTime % (threadCount * lightPathsCount) %
+					samplesSec % (samplesSec / singleThreadSamplesSec);
+		}
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
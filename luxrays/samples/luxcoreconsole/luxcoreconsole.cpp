@@ -30,13 +30,21 @@
 
 #include "luxrays/luxrays.h"
 #include "luxrays/utils/ocl.h"
+#include "luxrays/utils/timeline.h"
 #include "luxcore/luxcore.h"
 
 using namespace std;
 using namespace luxrays;
 using namespace luxcore;
 
-static void BatchSimpleMode(RenderConfig *config) {
+static void SaveTimeline(const string &timelineFileName) {
+	Timeline::Enable(false);
+	Timeline::SaveChromeTrace(timelineFileName);
+
+	LC_LOG("Startup timeline saved in: " << timelineFileName);
+}
+
+static void BatchSimpleMode(RenderConfig *config, const string &timelineFileName) {
 	RenderSession *session = new RenderSession(config);
 
 	const u_int haltTime = config->GetProperty("batch.halttime").Get<u_int>();
@@ -47,6 +55,19 @@ static void BatchSimpleMode(RenderConfig *config) {
 	session->Start();
 
 	const Properties &stats = session->GetStats();
+	if (timelineFileName != "") {
+		// The startup timeline ends with the first rendered samples
+		while (!session->HasDone()) {
+			session->UpdateStats();
+			if (stats.Get("stats.renderengine.total.samplecount").Get<double>() > 0.0)
+				break;
+			boost::this_thread::sleep(boost::posix_time::millisec(5));
+		}
+		Timeline::AddInstantEvent("First samples", "session");
+
+		SaveTimeline(timelineFileName);
+	}
+
 	while (!session->HasDone()) {
 		boost::this_thread::sleep(boost::posix_time::millisec(1000));
 		session->UpdateStats();
@@ -97,7 +118,7 @@ int main(int argc, char *argv[]) {
 
 		bool removeUnusedMatsAndTexs = false;
 		Properties cmdLineProp;
-		string configFileName;
+		string configFileName, timelineFileName;
 		for (int i = 1; i < argc; i++) {
 			if (argv[i][0] == '-') {
 				// I should check for out of range array index...
@@ -112,6 +133,7 @@ int main(int argc, char *argv[]) {
 							" -D [property name] [property value]" << endl <<
 							" -d [current directory path]" << endl <<
 							" -c <remove all unused materials and textures>" << endl <<
+							" -T [startup timeline file (Chrome trace format)]" << endl <<
 							" -h <display this help and exit>");
 					exit(EXIT_SUCCESS);
 				}
@@ -139,6 +161,8 @@ int main(int argc, char *argv[]) {
 
 				else if (argv[i][1] == 'c') removeUnusedMatsAndTexs = true;
 
+				else if (argv[i][1] == 'T') timelineFileName = argv[++i];
+
 				else {
 					LC_LOG("Invalid option: " << argv[i]);
 					exit(EXIT_FAILURE);
@@ -154,6 +178,10 @@ int main(int argc, char *argv[]) {
 			}
 		}
 
+		// The timeline has to be enabled before loading the Scene
+		if (timelineFileName != "")
+			Timeline::Enable(true);
+
 		// Load the Scene
 		if (configFileName.compare("") == 0)
 			configFileName = "scenes/luxball/luxball.cfg";
@@ -164,8 +192,13 @@ int main(int argc, char *argv[]) {
 		if ((configFileName.length() >= 4) && (configFileName.substr(configFileName.length() - 4) == ".lxs")) {
 			// It is a LuxRender SDL file
 			LC_LOG("Parsing LuxRender SDL file...");
+			// The LuxRender SDL parser doesn't define images.scale so I can
+			// create the scene before the parsing and let the parser define
+			// the inline meshes directly in the scene
+			scene = new Scene(cmdLineProp.Get(Property("images.scale")(1.f)).Get<float>());
+
 			Properties renderConfigProps, sceneProps;
-			luxcore::ParseLXS(configFileName, renderConfigProps, sceneProps);
+			luxcore::ParseLXS(configFileName, renderConfigProps, sceneProps, *scene);
 
 			// For debugging
 			//LC_LOG("RenderConfig: \n" << renderConfigProps);
@@ -173,7 +206,6 @@ int main(int argc, char *argv[]) {
 
 			renderConfigProps.Set(cmdLineProp);
 
-			scene = new Scene(renderConfigProps.Get(Property("images.scale")(1.f)).Get<float>());
 			scene->Parse(sceneProps);
 			config = new RenderConfig(renderConfigProps.Set(cmdLineProp), scene);
 		} else {
@@ -196,12 +228,15 @@ int main(int argc, char *argv[]) {
 			session->Start();
 			session->Stop();
 
+			if (timelineFileName != "")
+				SaveTimeline(timelineFileName);
+
 			delete session;
 		} else {
 			// Force the film update at 2.5secs (mostly used by PathOCL)
 			config->Parse(Properties().Set(Property("screen.refresh.interval")(2500)));
 
-			BatchSimpleMode(config);
+			BatchSimpleMode(config, timelineFileName);
 		}
 
 		delete config;
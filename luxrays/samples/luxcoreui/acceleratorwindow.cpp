@@ -37,6 +37,7 @@ AcceleratorWindow::AcceleratorWindow(LuxCoreApp *a) : ObjectEditorWindow(a, "Acc
 		.Add("QBVH", 3)
 		.Add("MQBVH", 4)
 		.Add("EMBREE", 5)
+		.Add("CQBVH", 6)
 		.SetDefault("AUTO");
 }
 
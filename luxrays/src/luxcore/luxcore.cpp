@@ -101,16 +101,19 @@ extern u_int lineNum;
 extern Properties overwriteProps;
 extern Properties *renderConfigProps;
 extern Properties *sceneProps;
+extern luxcore::Scene *scene;
 
 } }
 
-void luxcore::ParseLXS(const string &fileName, Properties &renderConfigProps, Properties &sceneProps) {
+static void ParseLXSImpl(const string &fileName, Properties &renderConfigProps,
+		Properties &sceneProps, luxcore::Scene *scene) {
 	// Otherwise the code is not thread-safe
 	static boost::mutex parseLXSMutex;
 	boost::unique_lock<boost::mutex> lock(parseLXSMutex);
 
 	luxcore::parselxs::renderConfigProps = &renderConfigProps;
 	luxcore::parselxs::sceneProps = &sceneProps;
+	luxcore::parselxs::scene = scene;
 	luxcore::parselxs::ResetParser();
 
 	bool parseSuccess = false;
@@ -150,6 +153,15 @@ void luxcore::ParseLXS(const string &fileName, Properties &renderConfigProps, Pr
 		throw runtime_error("Parsing failed: " + fileName);
 }
 
+void luxcore::ParseLXS(const string &fileName, Properties &renderConfigProps, Properties &sceneProps) {
+	ParseLXSImpl(fileName, renderConfigProps, sceneProps, NULL);
+}
+
+void luxcore::ParseLXS(const string &fileName, Properties &renderConfigProps,
+		Properties &sceneProps, Scene &scene) {
+	ParseLXSImpl(fileName, renderConfigProps, sceneProps, &scene);
+}
+
 //------------------------------------------------------------------------------
 // Film
 //------------------------------------------------------------------------------
@@ -255,6 +267,23 @@ template<> const u_int *Film::GetChannel<u_int>(const FilmChannelType type, cons
 		return standAloneFilm->GetChannel<u_int>((slg::Film::FilmChannelType)type, index);
 }
 
+u_int Film::GetChannelPixelSize(const FilmChannelType type) const {
+	return slg::Film::GetChannelPixelSize((slg::Film::FilmChannelType)type);
+}
+
+u_longlong Film::GetVersion() const {
+	if (renderSession) {
+		boost::unique_lock<boost::mutex> lock(renderSession->renderSession->filmMutex);
+
+		return renderSession->renderSession->film->GetVersion();
+	} else
+		return standAloneFilm->GetVersion();
+}
+
+bool Film::HasChanged(const u_longlong version) const {
+	return (GetVersion() != version);
+}
+
 void Film::Parse(const luxrays::Properties &props) {
 	if (renderSession)
 		throw runtime_error("Film::Parse() can be used only with a stand alone Film");
@@ -696,6 +725,16 @@ void RenderSession::UpdateStats() {
 	// The explicit cast to size_t is required by VisualC++
 	stats.Set(Property("stats.dataset.trianglecount")(renderSession->renderConfig->scene->dataSet->GetTotalTriangleCount()));
 
+#if !defined(LUXRAYS_DISABLE_OPENCL)
+	// OpenCL kernel cache statistics
+	const slg::PathOCLBaseRenderEngine *oclEngine = dynamic_cast<const slg::PathOCLBaseRenderEngine *>(renderSession->renderEngine);
+	if (oclEngine) {
+		stats.Set(Property("stats.opencl.kernelcache.hits")(oclEngine->GetKernelCacheHitCount()));
+		stats.Set(Property("stats.opencl.kernelcache.misses")(oclEngine->GetKernelCacheMissCount()));
+		stats.Set(Property("stats.opencl.kernelcache.evictions")(oclEngine->GetKernelCacheEvictionCount()));
+	}
+#endif
+
 	// Some engine specific statistic
 	switch (renderSession->renderEngine->GetType()) {
 #if !defined(LUXRAYS_DISABLE_OPENCL)
@@ -89,6 +89,8 @@ namespace luxcore { namespace parselxs {
 
 Properties *renderConfigProps = NULL;
 Properties *sceneProps = NULL;
+// Optional, if defined inline meshes are directly defined in the scene
+luxcore::Scene *scene = NULL;
 
 Properties overwriteProps;
 Transform worldToCamera;
@@ -164,8 +166,12 @@ static boost::unordered_map<string, Properties> namedMaterials;
 // The named Textures
 static boost::unordered_set<string> namedTextures;
 static u_int freeObjectID, freeLightID;
+// Incremented at each parse (and never reset) to make the names of the
+// meshes defined directly in a Scene unique across parses
+static u_int parseIndex = 0;
 
 void ResetParser() {
+	++parseIndex;
 	overwriteProps.Clear();
 
 	*renderConfigProps <<
@@ -622,7 +628,13 @@ static bool LookupType(const char *token, ParamType *type, string &name) {
 	return true;
 }
 
-static void InitProperties(Properties &props, const u_int count, const ParamListElem *list) {
+static bool IsInlinedMeshParam(const string &name) {
+	return (name == "P") || (name == "indices") || (name == "triindices") ||
+			(name == "N") || (name == "uv");
+}
+
+static void InitProperties(Properties &props, const u_int count, const ParamListElem *list,
+		const bool skipInlinedMeshParams = false) {
 	for (u_int i = 0; i < count; ++i) {
 		ParamType type;
 		string name;
@@ -630,6 +642,9 @@ static void InitProperties(Properties &props, const u_int count, const ParamList
 			LC_LOG("Type of parameter '" << list[i].token << "' is unknown");
 			continue;
 		}
+		// Inlined mesh data is read directly from the parameter list
+		if (skipInlinedMeshParams && IsInlinedMeshParam(name))
+			continue;
 		if (list[i].textureHelper && type != PARAM_TYPE_TEXTURE &&
 			type != PARAM_TYPE_STRING) {
 			LC_LOG("Bad type for " << name << ". Changing it to a texture");
@@ -706,6 +721,119 @@ static void InitProperties(Properties &props, const u_int count, const ParamList
 	}
 }
 
+// Returns the data of a numeric parameter or NULL if it is not defined
+static const float *GetNumericParam(const u_int count, const ParamListElem *list,
+		const string &paramName, u_int *size) {
+	for (u_int i = 0; i < count; ++i) {
+		ParamType type;
+		string name;
+		if (!LookupType(list[i].token, &type, name) || (name != paramName))
+			continue;
+
+		if ((type == PARAM_TYPE_BOOL) || (type == PARAM_TYPE_STRING) || (type == PARAM_TYPE_TEXTURE))
+			throw runtime_error("Wrong type for parameter: " + paramName);
+
+		*size = list[i].size;
+		return static_cast<const float *>(list[i].arg);
+	}
+
+	return NULL;
+}
+
+// Defines a trianglemesh/mesh shape reading the vertices, indices, etc. directly
+// from the parameter list, without going trough a Property for each value
+static void DefineInlinedMesh(const string &shapeType, const string &objName,
+		const string &prefix, const u_int count, const ParamListElem *list) {
+	u_int pointsSize = 0;
+	const float *pointsData = GetNumericParam(count, list, "P", &pointsSize);
+	if (!pointsData)
+		throw runtime_error("Missing P parameter in trianglemesh/mesh: " + objName);
+	if ((pointsSize == 0) || (pointsSize % 3 != 0))
+		throw runtime_error("Wrong trianglemesh/mesh point list length: " + objName);
+	const u_int vertCount = pointsSize / 3;
+
+	const string indicesName = (shapeType == "trianglemesh") ? "indices" : "triindices";
+	u_int indicesSize = 0;
+	const float *indicesData = GetNumericParam(count, list, indicesName, &indicesSize);
+	if (!indicesData)
+		throw runtime_error("Missing indices parameter in trianglemesh/mesh: " + objName);
+	if ((indicesSize == 0) || (indicesSize % 3 != 0))
+		throw runtime_error("Wrong trianglemesh/mesh indices list length: " + objName);
+	const u_int triCount = indicesSize / 3;
+
+	u_int normalsSize = 0;
+	const float *normalsData = GetNumericParam(count, list, "N", &normalsSize);
+	if (normalsData && (normalsSize != pointsSize))
+		throw runtime_error("Wrong trianglemesh/mesh normal list length: " + objName);
+
+	u_int uvsSize = 0;
+	const float *uvsData = GetNumericParam(count, list, "uv", &uvsSize);
+	if (uvsData && (uvsSize != vertCount * 2))
+		throw runtime_error("Wrong trianglemesh/mesh uv list length: " + objName);
+
+	if (scene) {
+		// Hand the mesh directly to the scene
+		Point *p = Scene::AllocVerticesBuffer(vertCount);
+		for (u_int i = 0; i < vertCount; ++i)
+			p[i] = Point(pointsData[i * 3], pointsData[i * 3 + 1], pointsData[i * 3 + 2]);
+
+		Triangle *vi = Scene::AllocTrianglesBuffer(triCount);
+		for (u_int i = 0; i < triCount; ++i)
+			vi[i] = Triangle(static_cast<u_int>(indicesData[i * 3]),
+					static_cast<u_int>(indicesData[i * 3 + 1]),
+					static_cast<u_int>(indicesData[i * 3 + 2]));
+
+		Normal *n = NULL;
+		if (normalsData) {
+			n = new Normal[vertCount];
+			for (u_int i = 0; i < vertCount; ++i)
+				n[i] = Normal(normalsData[i * 3], normalsData[i * 3 + 1], normalsData[i * 3 + 2]);
+		}
+
+		UV *uv = NULL;
+		if (uvsData) {
+			uv = new UV[vertCount];
+			for (u_int i = 0; i < vertCount; ++i)
+				uv[i] = UV(uvsData[i * 2], uvsData[i * 2 + 1]);
+		}
+
+		// Many LXS files can be parsed in the same Scene
+		const string meshName = "LUXCORE_MESH_" + ToString(parseIndex) + "_" + objName;
+		scene->DefineMesh(meshName, vertCount, triCount, p, vi, n, uv, NULL, NULL);
+
+		*sceneProps <<
+			Property(prefix + ".shape")(meshName) <<
+			Property(prefix + ".transformation")(currentTransform.m);
+	} else {
+		Property points(prefix + ".vertices");
+		for (u_int i = 0; i < pointsSize; ++i)
+			points.Add(pointsData[i]);
+
+		Property faces(prefix + ".faces");
+		for (u_int i = 0; i < indicesSize; ++i)
+			faces.Add(static_cast<int>(indicesData[i]));
+
+		*sceneProps <<
+			points <<
+			faces <<
+			Property(prefix + ".transformation")(currentTransform.m);
+
+		if (normalsData) {
+			Property normals(prefix + ".normals");
+			for (u_int i = 0; i < normalsSize; ++i)
+				normals.Add(normalsData[i]);
+			*sceneProps << normals;
+		}
+
+		if (uvsData) {
+			Property uvs(prefix + ".uvs");
+			for (u_int i = 0; i < uvsSize; ++i)
+				uvs.Add(uvsData[i]);
+			*sceneProps << uvs;
+		}
+	}
+}
+
 } }
 
 using namespace luxcore::parselxs;
@@ -3055,7 +3183,7 @@ yyreduce:
 #line 1353 "D:/luxrender/luxrays/src/luxcore/luxparser/luxparse.y"
     {
 	Properties props;
-	InitProperties(props, CPS, CP);
+	InitProperties(props, CPS, CP, true);
 
 	// Define object name
 	string objName;
@@ -3096,45 +3224,7 @@ yyreduce:
 			Property(prefix + ".ply")(props.Get(Property("filename")("none")).Get<string>()) <<
 			Property(prefix + ".transformation")(currentTransform.m);
 	} else 	if ((name == "trianglemesh") || (name == "mesh")) {
-		if (!props.IsDefined("P"))
-			throw runtime_error("Missing P parameter in trianglemesh/mesh: " + objName);
-		Property pointsProp = props.Get("P");
-		if ((pointsProp.GetSize() == 0) || (pointsProp.GetSize() % 3 != 0))
-			throw runtime_error("Wrong trianglemesh/mesh point list length: " + objName);
-		// Copy all vertices
-		Property points = pointsProp.Renamed(prefix + ".vertices");
-
-		const string indicesName = (name == "trianglemesh") ? "indices" : "triindices";
-		if (!props.IsDefined(indicesName))
-			throw runtime_error("Missing indices parameter in trianglemesh/mesh: " + objName);
-		Property indicesProp = props.Get(indicesName);
-		if ((indicesProp.GetSize() == 0) || (indicesProp.GetSize() % 3 != 0))
-			throw runtime_error("Wrong trianglemesh/mesh indices list length: " + objName);
-		// Copy all indices
-		Property faces = indicesProp.Renamed(prefix + ".faces");
-
-		*sceneProps <<
-			points <<
-			faces <<
-			Property(prefix + ".transformation")(currentTransform.m);
-
-		if (props.IsDefined("N")) {
-			Property normalsProp = props.Get("N");
-			if ((normalsProp.GetSize() == 0) ||	(normalsProp.GetSize() != pointsProp.GetSize()))
-				throw runtime_error("Wrong trianglemesh/mesh normal list length: " + objName);
-			// Copy all normals
-			*sceneProps <<
-					normalsProp.Renamed(prefix + ".normals");
-		}
-
-		if (props.IsDefined("uv")) {
-			Property uvsProps = props.Get("uv");
-			if ((uvsProps.GetSize() == 0) || (uvsProps.GetSize() != pointsProp.GetSize()))
-				throw runtime_error("Wrong trianglemesh/mesh uv list length: " + objName);
-			// Copy all uvs
-			*sceneProps <<
-					uvsProps.Renamed(prefix + ".uvs");
-		}
+		DefineInlinedMesh(name, objName, prefix, CPS, CP);
 	} else {
 		LC_LOG("LuxCore doesn't support the shape type " + name + ", ignoring the shape definition");
 	}
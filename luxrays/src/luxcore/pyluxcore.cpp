@@ -357,14 +357,18 @@ static luxrays::Property Properties_GetWithDefaultValues(luxrays::Properties *pr
 
 void Properties_DeleteAll(luxrays::Properties *props, const boost::python::list &l) {
 	const boost::python::ssize_t size = len(l);
+	vector<string> names;
+	names.reserve(size);
 	for (boost::python::ssize_t i = 0; i < size; ++i) {
 		const string objType = extract<string>((l[i].attr("__class__")).attr("__name__"));
 
 		if (objType == "str")
-			props->Delete(extract<string>(l[i]));
+			names.push_back(extract<string>(l[i]));
 		else
 			throw runtime_error("Unsupported data type included in Properties.DeleteAll() list: " + objType);
 	}
+
+	props->DeleteAll(names);
 }
 
 //------------------------------------------------------------------------------
@@ -437,6 +441,89 @@ static void Film_GetOutputUInt2(Film *film, const Film::FilmOutputType type,
 	Film_GetOutputUInt1(film, type, obj, 0);
 }
 
+// The Python buffer exporter of a Film channel memory. It holds a reference to
+// the Python Film object so the Film (and the RenderSession owning it) can not
+// be deleted while a memoryview of the channel is alive.
+typedef struct {
+	PyObject_HEAD
+	PyObject *film;
+	void *buffer;
+	Py_ssize_t size;
+} FilmChannelBuffer;
+
+static void FilmChannelBuffer_Dealloc(FilmChannelBuffer *self) {
+	Py_XDECREF(self->film);
+	PyObject_Del(self);
+}
+
+static int FilmChannelBuffer_GetBuffer(FilmChannelBuffer *self, Py_buffer *view, int flags) {
+	return PyBuffer_FillInfo(view, (PyObject *)self, self->buffer, self->size, 1, flags);
+}
+
+static PyBufferProcs FilmChannelBufferProcs;
+static PyTypeObject FilmChannelBufferType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static void FilmChannelBuffer_InitType() {
+	FilmChannelBufferProcs.bf_getbuffer = (getbufferproc)FilmChannelBuffer_GetBuffer;
+
+	FilmChannelBufferType.tp_name = "pyluxcore.FilmChannelBuffer";
+	FilmChannelBufferType.tp_basicsize = sizeof(FilmChannelBuffer);
+	FilmChannelBufferType.tp_dealloc = (destructor)FilmChannelBuffer_Dealloc;
+	FilmChannelBufferType.tp_as_buffer = &FilmChannelBufferProcs;
+#if PY_MAJOR_VERSION >= 3
+	FilmChannelBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+#else
+	FilmChannelBufferType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+
+	if (PyType_Ready(&FilmChannelBufferType) < 0)
+		throw_error_already_set();
+}
+
+// Returns a read-only memoryview over the channel memory, without any copy.
+// It can be used with numpy.frombuffer(). The view keeps the film alive but
+// it is invalidated when the film is resized: the film version changes and the
+// view has to be requested again. Film.GetVersion() can be used to check if
+// the content has been updated while it was read.
+static boost::python::object Film_GetChannelView1(boost::python::object &filmObj,
+		const Film::FilmChannelType type, const u_int index) {
+	Film &film = extract<Film &>(filmObj);
+
+	if (index >= film.GetChannelCount(type))
+		throw runtime_error("Film channel not available in Film.GetChannelView() method: " +
+				luxrays::ToString(type) + "/" + luxrays::ToString(index));
+
+	const size_t size = film.GetWidth() * film.GetHeight() * film.GetChannelPixelSize(type);
+	void *buffer;
+	if ((type == Film::CHANNEL_MATERIAL_ID) || (type == Film::CHANNEL_OBJECT_ID) ||
+			(type == Film::CHANNEL_FRAMEBUFFER_MASK))
+		buffer = (void *)film.GetChannel<u_int>(type, index);
+	else
+		buffer = (void *)film.GetChannel<float>(type, index);
+	if (!buffer)
+		throw runtime_error("Film channel not allocated in Film.GetChannelView() method: " +
+				luxrays::ToString(type) + "/" + luxrays::ToString(index));
+
+	FilmChannelBuffer *channelBuffer = PyObject_New(FilmChannelBuffer, &FilmChannelBufferType);
+	if (!channelBuffer)
+		throw_error_already_set();
+	Py_INCREF(filmObj.ptr());
+	channelBuffer->film = filmObj.ptr();
+	channelBuffer->buffer = buffer;
+	channelBuffer->size = size * 4;
+	// The memoryview holds the only reference to the exporter
+	boost::python::handle<> channelBufferHandle((PyObject *)channelBuffer);
+
+	return boost::python::object(boost::python::handle<>(PyMemoryView_FromObject(channelBufferHandle.get())));
+}
+
+static boost::python::object Film_GetChannelView2(boost::python::object &filmObj,
+		const Film::FilmChannelType type) {
+	return Film_GetChannelView1(filmObj, type, 0);
+}
+
 //------------------------------------------------------------------------------
 // Glue for Camera class
 //------------------------------------------------------------------------------
@@ -898,9 +985,12 @@ BOOST_PYTHON_MODULE(pyluxcore) {
 
 	def("Version", LuxCoreVersion, "Returns the LuxCore version");
 
+	FilmChannelBuffer_InitType();
+
 	def("Init", &LuxCore_Init);
 	def("Init", &LuxCore_InitDefaultHandler);
-	def("ParseLXS", &ParseLXS);
+	def("ParseLXS", (void (*)(const string &, luxrays::Properties &, luxrays::Properties &))&ParseLXS);
+	def("ParseLXS", (void (*)(const string &, luxrays::Properties &, luxrays::Properties &, luxcore::Scene &))&ParseLXS);
 
 	def("GetOpenCLDeviceList", &GetOpenCLDeviceList);
 	
@@ -1031,6 +1121,35 @@ BOOST_PYTHON_MODULE(pyluxcore) {
 		.value("BY_OBJECT_ID", Film::OUTPUT_BY_OBJECT_ID)
 	;
 
+	enum_<Film::FilmChannelType>("FilmChannelType")
+		.value("RADIANCE_PER_PIXEL_NORMALIZED", Film::CHANNEL_RADIANCE_PER_PIXEL_NORMALIZED)
+		.value("RADIANCE_PER_SCREEN_NORMALIZED", Film::CHANNEL_RADIANCE_PER_SCREEN_NORMALIZED)
+		.value("ALPHA", Film::CHANNEL_ALPHA)
+		.value("IMAGEPIPELINE", Film::CHANNEL_IMAGEPIPELINE)
+		.value("DEPTH", Film::CHANNEL_DEPTH)
+		.value("POSITION", Film::CHANNEL_POSITION)
+		.value("GEOMETRY_NORMAL", Film::CHANNEL_GEOMETRY_NORMAL)
+		.value("SHADING_NORMAL", Film::CHANNEL_SHADING_NORMAL)
+		.value("MATERIAL_ID", Film::CHANNEL_MATERIAL_ID)
+		.value("DIRECT_DIFFUSE", Film::CHANNEL_DIRECT_DIFFUSE)
+		.value("DIRECT_GLOSSY", Film::CHANNEL_DIRECT_GLOSSY)
+		.value("EMISSION", Film::CHANNEL_EMISSION)
+		.value("INDIRECT_DIFFUSE", Film::CHANNEL_INDIRECT_DIFFUSE)
+		.value("INDIRECT_GLOSSY", Film::CHANNEL_INDIRECT_GLOSSY)
+		.value("INDIRECT_SPECULAR", Film::CHANNEL_INDIRECT_SPECULAR)
+		.value("MATERIAL_ID_MASK", Film::CHANNEL_MATERIAL_ID_MASK)
+		.value("DIRECT_SHADOW_MASK", Film::CHANNEL_DIRECT_SHADOW_MASK)
+		.value("INDIRECT_SHADOW_MASK", Film::CHANNEL_INDIRECT_SHADOW_MASK)
+		.value("UV", Film::CHANNEL_UV)
+		.value("RAYCOUNT", Film::CHANNEL_RAYCOUNT)
+		.value("BY_MATERIAL_ID", Film::CHANNEL_BY_MATERIAL_ID)
+		.value("IRRADIANCE", Film::CHANNEL_IRRADIANCE)
+		.value("OBJECT_ID", Film::CHANNEL_OBJECT_ID)
+		.value("OBJECT_ID_MASK", Film::CHANNEL_OBJECT_ID_MASK)
+		.value("BY_OBJECT_ID", Film::CHANNEL_BY_OBJECT_ID)
+		.value("FRAMEBUFFER_MASK", Film::CHANNEL_FRAMEBUFFER_MASK)
+	;
+
     class_<Film>("Film", init<string>())
 		.def("GetWidth", &Film::GetWidth)
 		.def("GetHeight", &Film::GetHeight)
@@ -1044,6 +1163,12 @@ BOOST_PYTHON_MODULE(pyluxcore) {
 		.def("GetOutputFloat", &Film_GetOutputFloat2)
 		.def("GetOutputUInt", &Film_GetOutputUInt1)
 		.def("GetOutputUInt", &Film_GetOutputUInt2)
+		.def("GetChannelCount", &Film::GetChannelCount)
+		.def("GetChannelPixelSize", &Film::GetChannelPixelSize)
+		.def("GetChannelView", &Film_GetChannelView1)
+		.def("GetChannelView", &Film_GetChannelView2)
+		.def("GetVersion", &Film::GetVersion)
+		.def("HasChanged", &Film::HasChanged)
 		.def("Parse", &Film::Parse)
     ;
 
@@ -0,0 +1,184 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <cmath>
+#include <limits>
+
+#include "luxrays/accelerators/cqbvhaccel.h"
+#include "luxrays/core/context.h"
+
+using namespace std;
+using namespace luxrays;
+
+//------------------------------------------------------------------------------
+// CQBVHNode
+//------------------------------------------------------------------------------
+
+// Must use the same operations of CQBVHNode::BBoxIntersect()
+static inline float DequantizeCoordinate(const float origin, const float scale, const u_int q) {
+	return origin + static_cast<float>(q) * scale;
+}
+
+// Returns the smallest quantization step (within the float precision) so the
+// last step includes pMax
+static float QuantizationScale(const float pMin, const float pMax) {
+	const float s = (pMax - pMin) * (1.f / 255.f);
+	if (DequantizeCoordinate(pMin, s, 255) >= pMax)
+		return s;
+
+	// Rounding errors: search the step between lo (too small) and hi (large
+	// enough). A step can not be smaller than 1 ulp of the origin.
+	float lo = s;
+	float hi = Max(s, nextafterf(fabsf(pMin), numeric_limits<float>::infinity()) - fabsf(pMin));
+	while (DequantizeCoordinate(pMin, hi, 255) < pMax) {
+		lo = hi;
+		hi *= 2.f;
+	}
+
+	// Bisection, at most one step per bit of the float mantissa
+	for (u_int i = 0; i < 24; ++i) {
+		const float mid = lo + (hi - lo) * .5f;
+		if ((mid <= lo) || (mid >= hi))
+			break;
+
+		if (DequantizeCoordinate(pMin, mid, 255) >= pMax)
+			hi = mid;
+		else
+			lo = mid;
+	}
+
+	return hi;
+}
+
+void CQBVHNode::Init(const QBVHNode &node) {
+	// The bounding box of the node is the union of the children ones
+	BBox nodeBBox;
+	for (u_int i = 0; i < 4; ++i) {
+		if (node.LeafIsEmpty(i))
+			continue;
+
+		for (u_int axis = 0; axis < 3; ++axis) {
+			nodeBBox.pMin[axis] = Min(nodeBBox.pMin[axis], reinterpret_cast<const float *>(&node.bboxes[0][axis])[i]);
+			nodeBBox.pMax[axis] = Max(nodeBBox.pMax[axis], reinterpret_cast<const float *>(&node.bboxes[1][axis])[i]);
+		}
+	}
+	if (!nodeBBox.IsValid())
+		nodeBBox = BBox(Point(0.f, 0.f, 0.f));
+
+	for (u_int axis = 0; axis < 3; ++axis) {
+		origin[axis] = nodeBBox.pMin[axis];
+
+		// The last quantization step must include the node bounding box
+		const float s = QuantizationScale(nodeBBox.pMin[axis], nodeBBox.pMax[axis]);
+		scale[axis] = s;
+
+		for (u_int i = 0; i < 4; ++i) {
+			if (node.LeafIsEmpty(i)) {
+				// An empty bounding box
+				bounds[0][axis][i] = 255;
+				bounds[1][axis][i] = 0;
+				continue;
+			}
+
+			const float bMin = reinterpret_cast<const float *>(&node.bboxes[0][axis])[i];
+			const float bMax = reinterpret_cast<const float *>(&node.bboxes[1][axis])[i];
+
+			u_int qMin = 0;
+			u_int qMax = 0;
+			if (s > 0.f) {
+				qMin = static_cast<u_int>(Clamp(floor((static_cast<double>(bMin) - origin[axis]) / s), 0.0, 255.0));
+				qMax = static_cast<u_int>(Clamp(ceil((static_cast<double>(bMax) - origin[axis]) / s), 0.0, 255.0));
+
+				// The quantized bounding box must include the original one.
+				// The dequantization rounding errors can require one more
+				// step, otherwise the node bounds (0 and 255) are used.
+				if (DequantizeCoordinate(origin[axis], s, qMin) > bMin)
+					qMin = ((qMin > 0) && (DequantizeCoordinate(origin[axis], s, qMin - 1) <= bMin)) ? (qMin - 1) : 0;
+				if (DequantizeCoordinate(origin[axis], s, qMax) < bMax)
+					qMax = ((qMax < 255) && (DequantizeCoordinate(origin[axis], s, qMax + 1) >= bMax)) ? (qMax + 1) : 255;
+			}
+
+			bounds[0][axis][i] = static_cast<u_char>(qMin);
+			bounds[1][axis][i] = static_cast<u_char>(qMax);
+		}
+	}
+
+	for (u_int i = 0; i < 4; ++i)
+		children[i] = node.children[i];
+}
+
+BBox CQBVHNode::GetBBox(const u_int i) const {
+	BBox bbox;
+	for (u_int axis = 0; axis < 3; ++axis) {
+		bbox.pMin[axis] = DequantizeCoordinate(origin[axis], scale[axis], bounds[0][axis][i]);
+		bbox.pMax[axis] = DequantizeCoordinate(origin[axis], scale[axis], bounds[1][axis][i]);
+	}
+
+	return bbox;
+}
+
+//------------------------------------------------------------------------------
+// CQBVHAccel
+//------------------------------------------------------------------------------
+
+CQBVHAccel::CQBVHAccel(const Context *context, u_int mp, u_int fst, u_int sf) :
+		ctx(context), nodes(NULL), nNodes(0) {
+	qbvh = new QBVHAccel(context, mp, fst, sf);
+}
+
+CQBVHAccel::~CQBVHAccel() {
+	FreeAligned(nodes);
+	delete qbvh;
+}
+
+void CQBVHAccel::Init(const std::deque<const Mesh *> &meshes, const u_longlong totalVertexCount,
+		const u_longlong totalTriangleCount) {
+	qbvh->Init(meshes, totalVertexCount, totalTriangleCount);
+
+	// Handle the empty DataSet case
+	if (!qbvh->nodes)
+		return;
+
+	// Compress the QBVH nodes, the QuadTriangle primitives are still
+	// owned by the QBVH
+	nNodes = qbvh->nNodes;
+	nodes = AllocAligned<CQBVHNode>(nNodes);
+	for (u_int i = 0; i < nNodes; ++i)
+		nodes[i].Init(qbvh->nodes[i]);
+
+	FreeAligned(qbvh->nodes);
+	qbvh->nodes = NULL;
+
+	LR_LOG(ctx, "Total CQBVH nodes memory usage: " << GetNodesMemorySize() / 1024 << "Kbytes (" <<
+			nNodes * sizeof(QBVHNode) / 1024 << "Kbytes uncompressed)");
+	LR_LOG(ctx, "Total CQBVH QuadTriangle memory usage: " << GetPrimitivesMemorySize() / 1024 << "Kbytes");
+}
+
+size_t CQBVHAccel::GetPrimitivesMemorySize() const {
+	return qbvh->prims ? (qbvh->nQuads * sizeof(QuadTriangle)) : 0;
+}
+
+bool CQBVHAccel::Intersect(const Ray *ray, RayHit *rayHit) const {
+	return QBVHIntersect<CQBVHNode, false>(nodes, qbvh->prims, ray, rayHit, NULL);
+}
+
+bool CQBVHAccel::IntersectWithStats(const Ray *ray, RayHit *rayHit,
+		AcceleratorTraversalStats *stats) const {
+	return QBVHIntersect<CQBVHNode, true>(nodes, qbvh->prims, ray, rayHit, stats);
+}
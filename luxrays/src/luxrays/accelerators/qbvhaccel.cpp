@@ -597,125 +597,13 @@ void QBVHAccel::CreateSwizzledLeaf(int32_t parentIndex, int32_t childIndex,
 
 /***************************************************/
 
-bool QBVHAccel::Intersect(const Ray *initialRay, RayHit *rayHit) const {
-	rayHit->t = initialRay->maxt;
-	rayHit->SetMiss();
-	if (!nodes)
-		return false;
-
-	Ray ray(*initialRay);
-
-	//------------------------------
-	// Prepare the ray for intersection
-	QuadRay ray4(ray);
-	__m128 invDir[3];
-	invDir[0] = _mm_set1_ps(1.f / ray.d.x);
-	invDir[1] = _mm_set1_ps(1.f / ray.d.y);
-	invDir[2] = _mm_set1_ps(1.f / ray.d.z);
-
-	int signs[3];
-	ray.GetDirectionSigns(signs);
-
-	//------------------------------
-	// Main loop
-	int todoNode = 0; // the index in the stack
-	int32_t nodeStack[64];
-	nodeStack[0] = 0; // first node to handle: root node
-
-	while (todoNode >= 0) {
-		// Leaves are identified by a negative index
-		if (!QBVHNode::IsLeaf(nodeStack[todoNode])) {
-			QBVHNode &node = nodes[nodeStack[todoNode]];
-			--todoNode;
-
-			// It is quite strange but checking here for empty nodes slows down the rendering
-			const int32_t visit = node.BBoxIntersect(ray4, invDir, signs);
-
-			switch (visit) {
-				case (0x1 | 0x0 | 0x0 | 0x0):
-					nodeStack[++todoNode] = node.children[0];
-					break;
-				case (0x0 | 0x2 | 0x0 | 0x0):
-					nodeStack[++todoNode] = node.children[1];
-					break;
-				case (0x1 | 0x2 | 0x0 | 0x0):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[1];
-					break;
-				case (0x0 | 0x0 | 0x4 | 0x0):
-					nodeStack[++todoNode] = node.children[2];
-					break;
-				case (0x1 | 0x0 | 0x4 | 0x0):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[2];
-					break;
-				case (0x0 | 0x2 | 0x4 | 0x0):
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[2];
-					break;
-				case (0x1 | 0x2 | 0x4 | 0x0):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[2];
-					break;
-				case (0x0 | 0x0 | 0x0 | 0x8):
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x1 | 0x0 | 0x0 | 0x8):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x0 | 0x2 | 0x0 | 0x8):
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x1 | 0x2 | 0x0 | 0x8):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x0 | 0x0 | 0x4 | 0x8):
-					nodeStack[++todoNode] = node.children[2];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x1 | 0x0 | 0x4 | 0x8):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[2];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x0 | 0x2 | 0x4 | 0x8):
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[2];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-				case (0x1 | 0x2 | 0x4 | 0x8):
-					nodeStack[++todoNode] = node.children[0];
-					nodeStack[++todoNode] = node.children[1];
-					nodeStack[++todoNode] = node.children[2];
-					nodeStack[++todoNode] = node.children[3];
-					break;
-			}
-		} else {
-			//----------------------
-			// It is a leaf,
-			// all the informations are encoded in the index
-			const int32_t leafData = nodeStack[todoNode];
-			--todoNode;
-
-			if (QBVHNode::IsEmpty(leafData))
-				continue;
-
-			// Perform intersection
-			const u_int nbQuadPrimitives = QBVHNode::NbQuadPrimitives(leafData);
-
-			const u_int offset = QBVHNode::FirstQuadIndex(leafData);
-
-			for (u_int primNumber = offset; primNumber < (offset + nbQuadPrimitives); ++primNumber)
-				prims[primNumber].Intersect(ray4, ray, rayHit);
-		}//end of the else
-	}
+bool QBVHAccel::Intersect(const Ray *ray, RayHit *rayHit) const {
+	return QBVHIntersect<QBVHNode, false>(nodes, prims, ray, rayHit, NULL);
+}
 
-	return !rayHit->Miss();
+bool QBVHAccel::IntersectWithStats(const Ray *ray, RayHit *rayHit,
+		AcceleratorTraversalStats *stats) const {
+	return QBVHIntersect<QBVHNode, true>(nodes, prims, ray, rayHit, stats);
 }
 
 }
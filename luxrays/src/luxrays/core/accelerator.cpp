@@ -35,6 +35,8 @@ string Accelerator::AcceleratorType2String(const AcceleratorType type) {
 			return "MBVH";
 		case ACCEL_EMBREE:
 			return "EMBREE";
+		case ACCEL_CQBVH:
+			return "CQBVH";
 		default:
 			throw runtime_error("Unknown accelerator type in AcceleratorType2String(): " + ToString(type));
 	}
@@ -53,6 +55,51 @@ AcceleratorType Accelerator::String2AcceleratorType(const string &type) {
 		return ACCEL_MQBVH;
 	else if (type == "EMBREE")
 		return ACCEL_EMBREE;
+	else if (type == "CQBVH")
+		return ACCEL_CQBVH;
 	else
 		throw runtime_error("Unknown accelerator type in String2AcceleratorType(): " + type);
 }
+
+//------------------------------------------------------------------------------
+// AcceleratorTraversalStats
+//------------------------------------------------------------------------------
+
+AcceleratorTraversalStats::AcceleratorTraversalStats(const u_int ws) : windowSize(ws) {
+	Reset();
+}
+
+void AcceleratorTraversalStats::Reset() {
+	rayCount = 0;
+	nodeVisitCount = 0;
+	leafVisitCount = 0;
+	distinctNodeVisitCount = 0;
+	nodeLastWindow.clear();
+	currentWindow = 0;
+}
+
+void AcceleratorTraversalStats::AddNodeVisit(const u_int nodeIndex) {
+	++nodeVisitCount;
+
+	if (windowSize > 0) {
+		if (nodeIndex >= nodeLastWindow.size())
+			nodeLastWindow.resize(Max<size_t>(nodeIndex + 1, 2 * nodeLastWindow.size()), 0);
+
+		if (nodeLastWindow[nodeIndex] != currentWindow) {
+			nodeLastWindow[nodeIndex] = currentWindow;
+			++distinctNodeVisitCount;
+		}
+	}
+}
+
+double AcceleratorTraversalStats::GetNodeVisitsPerRay() const {
+	return (rayCount > 0) ? (nodeVisitCount / static_cast<double>(rayCount)) : 0.0;
+}
+
+double AcceleratorTraversalStats::GetLeafVisitsPerRay() const {
+	return (rayCount > 0) ? (leafVisitCount / static_cast<double>(rayCount)) : 0.0;
+}
+
+double AcceleratorTraversalStats::GetDistinctNodesPerWindow() const {
+	return (currentWindow > 0) ? (distinctNodeVisitCount / static_cast<double>(currentWindow)) : 0.0;
+}
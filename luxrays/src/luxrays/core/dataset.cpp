@@ -19,6 +19,7 @@
 #include <cstdlib>
 #include <cassert>
 #include <deque>
+#include <set>
 #include <sstream>
 #include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
@@ -29,9 +30,11 @@
 #include "luxrays/accelerators/bvhaccel.h"
 #include "luxrays/accelerators/qbvhaccel.h"
 #include "luxrays/accelerators/mqbvhaccel.h"
+#include "luxrays/accelerators/cqbvhaccel.h"
 #include "luxrays/accelerators/mbvhaccel.h"
 #include "luxrays/accelerators/embreeaccel.h"
 #include "luxrays/core/geometry/bsphere.h"
+#include "luxrays/utils/timeline.h"
 
 using namespace luxrays;
 
@@ -80,10 +83,44 @@ TriangleMeshID DataSet::Add(const Mesh *mesh) {
 void DataSet::Preprocess() {
 	assert (!preprocessed);
 
+	TimelineScope timelineScope("DataSet preprocessing", "luxrays");
+
 	LR_LOG(context, "Preprocessing DataSet");
 	LR_LOG(context, "Total vertex count: " << totalVertexCount);
 	LR_LOG(context, "Total triangle count: " << totalTriangleCount);
 
+	if (hasInstances || hasMotionBlur) {
+		// Instanced and motion blurred meshes share the geometry of their
+		// base mesh with two-level accelerators (i.e. MQBVH, MBVH and Embree)
+		std::set<const Mesh *> uniqueMeshes;
+		u_longlong uniqueVertexCount = 0;
+		u_longlong uniqueTriangleCount = 0;
+		BOOST_FOREACH(const Mesh *m, meshes) {
+			const Mesh *baseMesh;
+			switch (m->GetType()) {
+				case TYPE_TRIANGLE_INSTANCE:
+				case TYPE_EXT_TRIANGLE_INSTANCE:
+					baseMesh = dynamic_cast<const InstanceTriangleMesh *>(m)->GetTriangleMesh();
+					break;
+				case TYPE_TRIANGLE_MOTION:
+				case TYPE_EXT_TRIANGLE_MOTION:
+					baseMesh = dynamic_cast<const MotionTriangleMesh *>(m)->GetTriangleMesh();
+					break;
+				default:
+					baseMesh = m;
+					break;
+			}
+
+			if (uniqueMeshes.insert(baseMesh).second) {
+				uniqueVertexCount += baseMesh->GetTotalVertexCount();
+				uniqueTriangleCount += baseMesh->GetTotalTriangleCount();
+			}
+		}
+
+		LR_LOG(context, "Unique vertex count: " << uniqueVertexCount);
+		LR_LOG(context, "Unique triangle count: " << uniqueTriangleCount);
+	}
+
 	if (totalTriangleCount == 0) {
 		// Just initialize with some default value to avoid problems
 		bbox = Union(Union(bbox, Point(-1.f, -1.f, -1.f)), Point(1.f, 1.f, 1.f));
@@ -156,11 +193,23 @@ const Accelerator *DataSet::GetAccelerator(const AcceleratorType accelType) {
 				accel = new EmbreeAccel(context);
 				break;
 			}
+			case ACCEL_CQBVH: {
+				const int maxPrimsPerLeaf = 4;
+				const int fullSweepThreshold = 4 * maxPrimsPerLeaf;
+				const int skipFactor = 1;
+
+				accel = new CQBVHAccel(context,
+						maxPrimsPerLeaf, fullSweepThreshold, skipFactor);
+				break;
+			}
 			default:
 				throw std::runtime_error("Unknown AcceleratorType in DataSet::AddAccelerator()");
 		}
 
-		accel->Init(meshes, totalVertexCount, totalTriangleCount);
+		{
+			TimelineScope timelineScope("Accelerator build ", Accelerator::AcceleratorType2String(accelType), "luxrays");
+			accel->Init(meshes, totalVertexCount, totalTriangleCount);
+		}
 
 		accels[accelType] = accel;
 
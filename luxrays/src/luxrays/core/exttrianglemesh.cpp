@@ -24,6 +24,7 @@
 
 #include "luxrays/core/exttrianglemesh.h"
 #include "luxrays/utils/ply/rply.h"
+#include "luxrays/utils/timeline.h"
 
 using namespace std;
 using namespace luxrays;
@@ -272,6 +273,8 @@ static int FaceCB(p_ply_argument argument) {
 }
 
 ExtTriangleMesh *ExtTriangleMesh::LoadExtTriangleMesh(const string &fileName) {
+	TimelineScope timelineScope("Load mesh ", fileName, "mesh");
+
 	p_ply plyfile = ply_open(fileName.c_str(), NULL);
 	if (!plyfile) {
 		stringstream ss;
@@ -0,0 +1,82 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <algorithm>
+
+#include "luxrays/core/geometry/raybuffersorter.h"
+
+using namespace std;
+using namespace luxrays;
+
+//------------------------------------------------------------------------------
+// RayBufferSorter
+//------------------------------------------------------------------------------
+
+// Spreads the 9 bits of a 512^3 grid cell coordinate so there are 2 zero bits
+// between each of them. The 27 bits Morton code leaves room for the 3 bits of
+// the direction octant in a 32 bits key.
+static inline u_int ExpandBits(u_int v) {
+	v = (v * 0x00010001u) & 0xFF0000FFu;
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+
+	return v;
+}
+
+static inline u_int QuantizeCoordinate(const float v) {
+	return static_cast<u_int>(Clamp(v * 512.f, 0.f, 511.f));
+}
+
+void RayBufferSorter::SetBBox(const BBox &bbox) {
+	pMin = bbox.pMin;
+
+	const Vector extent = bbox.pMax - bbox.pMin;
+	invExtent = Vector(
+			(extent.x > 0.f) ? (1.f / extent.x) : 0.f,
+			(extent.y > 0.f) ? (1.f / extent.y) : 0.f,
+			(extent.z > 0.f) ? (1.f / extent.z) : 0.f);
+}
+
+u_int RayBufferSorter::GetKey(const Ray &ray) const {
+	const u_int octant = ((ray.d.x < 0.f) ? 1u : 0u) |
+			((ray.d.y < 0.f) ? 2u : 0u) |
+			((ray.d.z < 0.f) ? 4u : 0u);
+
+	const Vector o = ray.o - pMin;
+	const u_int cellX = QuantizeCoordinate(o.x * invExtent.x);
+	const u_int cellY = QuantizeCoordinate(o.y * invExtent.y);
+	const u_int cellZ = QuantizeCoordinate(o.z * invExtent.z);
+
+	return (octant << 27) |
+			(ExpandBits(cellX) << 2) | (ExpandBits(cellY) << 1) | ExpandBits(cellZ);
+}
+
+void RayBufferSorter::Sort(const Ray *rays, const size_t rayCount) {
+	// The ray index is stored in the lower 32 bits of the sort key
+	keys.resize(rayCount);
+	for (size_t i = 0; i < rayCount; ++i)
+		keys[i] = (static_cast<u_longlong>(GetKey(rays[i])) << 32) | i;
+
+	sort(keys.begin(), keys.end());
+
+	order.resize(rayCount);
+	for (size_t i = 0; i < rayCount; ++i)
+		order[i] = static_cast<u_int>(keys[i] & 0xffffffffu);
+}
@@ -21,6 +21,7 @@
 
 #include "luxrays/core/intersectiondevice.h"
 #include "luxrays/core/context.h"
+#include "luxrays/core/geometry/raybuffersorter.h"
 #include "luxrays/utils/atomic.h"
 
 using namespace luxrays;
@@ -38,6 +39,7 @@ NativeThreadIntersectionDevice::NativeThreadIntersectionDevice(
 	reportedPermissionError = false;
 	rayBufferQueue = NULL;
 	threadCount = boost::thread::hardware_concurrency();
+	enableRaySorting = false;
 }
 
 NativeThreadIntersectionDevice::~NativeThreadIntersectionDevice() {
@@ -142,6 +144,10 @@ void NativeThreadIntersectionDevice::IntersectionThread(NativeThreadIntersection
 	try {
 		RayBufferQueue *queue = renderDevice->rayBufferQueue;
 
+		RayBufferSorter sorter;
+		if (renderDevice->enableRaySorting)
+			sorter.SetBBox(renderDevice->dataSet->GetBBox());
+
 		const double startTime = WallClockTime();
 		while (!boost::this_thread::interruption_requested()) {
 			const double t1 = WallClockTime();
@@ -152,9 +158,21 @@ void NativeThreadIntersectionDevice::IntersectionThread(NativeThreadIntersection
 			const Ray *rb = rayBuffer->GetRayBuffer();
 			RayHit *hb = rayBuffer->GetHitBuffer();
 			const size_t rayCount = rayBuffer->GetRayCount();
-			for (unsigned int i = 0; i < rayCount; ++i) {
-				hb[i].SetMiss();
-				renderDevice->accel->Intersect(&rb[i], &hb[i]);
+			if (renderDevice->enableRaySorting) {
+				// Trace the rays in a more coherent order, the hits are still
+				// written at the index of their ray
+				sorter.Sort(rb, rayCount);
+				const vector<u_int> &order = sorter.GetOrder();
+				for (unsigned int i = 0; i < rayCount; ++i) {
+					const u_int index = order[i];
+					hb[index].SetMiss();
+					renderDevice->accel->Intersect(&rb[index], &hb[index]);
+				}
+			} else {
+				for (unsigned int i = 0; i < rayCount; ++i) {
+					hb[i].SetMiss();
+					renderDevice->accel->Intersect(&rb[i], &hb[i]);
+				}
 			}
 			renderDevice->threadTotalDataParallelRayCount[threadIndex] += rayCount;
 			queue->PushDone(rayBuffer);
@@ -20,11 +20,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <ctime>
 #include <string.h>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "luxrays/luxrays.h"
 #include "luxrays/core/utils.h"
@@ -145,6 +148,35 @@ string luxrays::oclErrorString(cl_int error) {
 // oclKernelCache
 //------------------------------------------------------------------------------
 
+// Used to serialize the accesses to the cache files of all the instances and
+// to the cache statistics
+static boost::mutex cacheFilesMutex;
+
+u_int oclKernelCache::GetHitCount() const {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+	return hitCount;
+}
+
+u_int oclKernelCache::GetMissCount() const {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+	return missCount;
+}
+
+u_int oclKernelCache::GetEvictionCount() const {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+	return evictionCount;
+}
+
+void oclKernelCache::IncHitCount() {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+	++hitCount;
+}
+
+void oclKernelCache::IncMissCount() {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+	++missCount;
+}
+
 cl::Program *oclKernelCache::ForcedCompile(cl::Context &context, cl::Device &device,
 		const string &kernelsParameters, const string &kernelSource,
 		cl::STRING_CLASS *error) {
@@ -190,7 +222,9 @@ cl::Program *oclKernelVolatileCache::Compile(cl::Context &context, cl::Device& d
 		const string &kernelsParameters, const string &kernelSource,
 		bool *cached, cl::STRING_CLASS *error) {
 	// Check if the kernel is available in the cache
-	boost::unordered_map<string, cl::Program::Binaries>::iterator it = kernelCache.find(kernelsParameters);
+	const string kernelKey = oclKernelPersistentCache::HashString(kernelsParameters) + "-" +
+			oclKernelPersistentCache::HashString(kernelSource);
+	boost::unordered_map<string, cl::Program::Binaries>::iterator it = kernelCache.find(kernelKey);
 
 	if (it == kernelCache.end()) {
 		// It isn't available, compile the source
@@ -211,11 +245,12 @@ cl::Program *oclKernelVolatileCache::Compile(cl::Context &context, cl::Device& d
 			memcpy(bin, bins[0], sizes[0]);
 			kernels.push_back(bin);
 
-			kernelCache[kernelsParameters] = cl::Program::Binaries(1, make_pair(bin, sizes[0]));
+			kernelCache[kernelKey] = cl::Program::Binaries(1, make_pair(bin, sizes[0]));
 		}
 
 		if (cached)
 			*cached = false;
+		IncMissCount();
 
 		return program;
 	} else {
@@ -227,6 +262,7 @@ cl::Program *oclKernelVolatileCache::Compile(cl::Context &context, cl::Device& d
 
 		if (cached)
 			*cached = true;
+		IncHitCount();
 
 		return program;
 	}
@@ -261,8 +297,10 @@ boost::filesystem::path oclKernelPersistentCache::GetCacheDir(const string &appl
 	return kernelCacheDir / "kernel_cache" / SanitizeFileName(applicationName);
 }
 
-oclKernelPersistentCache::oclKernelPersistentCache(const string &applicationName) {
+oclKernelPersistentCache::oclKernelPersistentCache(const string &applicationName,
+		const u_longlong maxCacheSize) {
 	appName = applicationName;
+	maxSize = maxCacheSize;
 
 	// Crate the cache directory
 	boost::filesystem::create_directories(GetCacheDir(appName));
@@ -299,6 +337,135 @@ u_int oclKernelPersistentCache::HashBin(const char *s, const size_t size) {
 	return hash;
 }
 
+namespace {
+
+class KernelCacheEntry {
+public:
+	KernelCacheEntry(const boost::filesystem::path &p, const time_t t, const u_longlong s) :
+		path(p), lastWriteTime(t), size(s) { }
+
+	bool operator<(const KernelCacheEntry &entry) const {
+		return lastWriteTime < entry.lastWriteTime;
+	}
+
+	boost::filesystem::path path;
+	time_t lastWriteTime;
+	u_longlong size;
+};
+
+}
+
+static void GetCacheEntries(const boost::filesystem::path &cacheDir,
+		vector<KernelCacheEntry> &entries, u_longlong *totalSize) {
+	*totalSize = 0;
+
+	boost::system::error_code ec;
+	for (boost::filesystem::recursive_directory_iterator it(cacheDir, ec), end; (it != end) && !ec; it.increment(ec)) {
+		const boost::filesystem::path &p = it->path();
+		boost::system::error_code fileEc;
+		if (!boost::filesystem::is_regular_file(p, fileEc) || (p.extension() != ".ocl"))
+			continue;
+
+		const u_longlong size = boost::filesystem::file_size(p, fileEc);
+		if (fileEc)
+			continue;
+		const time_t lastWriteTime = boost::filesystem::last_write_time(p, fileEc);
+		if (fileEc)
+			continue;
+
+		entries.push_back(KernelCacheEntry(p, lastWriteTime, size));
+		*totalSize += size;
+	}
+}
+
+u_longlong oclKernelPersistentCache::GetSize() const {
+	boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+
+	vector<KernelCacheEntry> entries;
+	u_longlong totalSize;
+	GetCacheEntries(GetCacheDir(appName), entries, &totalSize);
+
+	return totalSize;
+}
+
+void oclKernelPersistentCache::EvictEntries(const boost::filesystem::path &keepFilePath) {
+	vector<KernelCacheEntry> entries;
+	u_longlong totalSize;
+	GetCacheEntries(GetCacheDir(appName), entries, &totalSize);
+
+	if (totalSize <= maxSize)
+		return;
+
+	// Remove the least recently used files first
+	sort(entries.begin(), entries.end());
+	for (vector<KernelCacheEntry>::const_iterator it = entries.begin();
+			(it != entries.end()) && (totalSize > maxSize); ++it) {
+		boost::system::error_code ec;
+		if (boost::filesystem::equivalent(it->path, keepFilePath, ec))
+			continue;
+
+		// The file may have been already removed by another process
+		boost::filesystem::remove(it->path, ec);
+		if (!ec) {
+			totalSize -= it->size;
+			// cacheFilesMutex is already held by the caller
+			++evictionCount;
+		}
+	}
+}
+
+cl::Program *oclKernelPersistentCache::CompileAndStore(cl::Context &context, cl::Device &device,
+		const string &kernelsParameters, const string &kernelSource,
+		const boost::filesystem::path &dirPath, const boost::filesystem::path &filePath,
+		cl::STRING_CLASS *error) {
+	// The compilation is done without holding the lock
+	cl::Program *program = ForcedCompile(
+			context, device, kernelsParameters, kernelSource, error);
+	if (!program)
+		return NULL;
+
+	// Obtain the binaries of the sources
+	VECTOR_CLASS<char *> bins = program->getInfo<CL_PROGRAM_BINARIES>();
+	assert (bins.size() == 1);
+	VECTOR_CLASS<size_t> sizes = program->getInfo<CL_PROGRAM_BINARY_SIZES>();
+	assert (sizes.size() == 1);
+
+	// Create the file only if the binaries include something
+	if (sizes[0] > 0) {
+		boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+
+		// Add the kernel to the cache
+		boost::filesystem::create_directories(dirPath);
+
+		// The file is written with a temporary name and renamed at the end so
+		// other processes never read a partially written file
+		const boost::filesystem::path tmpFilePath = dirPath /
+				boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+		const string tmpFileName = tmpFilePath.generic_string();
+		BOOST_OFSTREAM file(tmpFileName.c_str(), ios_base::out | ios_base::binary);
+
+		// Write the binary hash
+		const u_int hashBin = HashBin(bins[0], sizes[0]);
+		file.write((char *)&hashBin, sizeof(int));
+
+		file.write(bins[0], sizes[0]);
+		// Check for errors
+		char buf[512];
+		if (file.fail()) {
+			sprintf(buf, "Unable to write kernel file cache %s", tmpFileName.c_str());
+			throw runtime_error(buf);
+		}
+
+		file.close();
+		boost::filesystem::rename(tmpFilePath, filePath);
+
+		if (maxSize > 0)
+			EvictEntries(filePath);
+	}
+
+	return program;
+}
+
 cl::Program *oclKernelPersistentCache::Compile(cl::Context &context, cl::Device& device,
 		const string &kernelsParameters, const string &kernelSource,
 		bool *cached, cl::STRING_CLASS *error) {
@@ -308,99 +475,83 @@ cl::Program *oclKernelPersistentCache::Compile(cl::Context &context, cl::Device&
 	const string platformName = boost::trim_copy(platform.getInfo<CL_PLATFORM_VENDOR>());
 	const string deviceName = boost::trim_copy(device.getInfo<CL_DEVICE_NAME>());
 	const string deviceUnits = ToString(device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>());
+	// Binaries compiled with a different driver may not work
+	const string driverVersion = boost::trim_copy(device.getInfo<CL_DRIVER_VERSION>());
 	const string kernelName = HashString(kernelsParameters) + "-" + HashString(kernelSource) + ".ocl";
 	const boost::filesystem::path dirPath = GetCacheDir(appName) / SanitizeFileName(platformName) /
-		SanitizeFileName(deviceName) / SanitizeFileName(deviceUnits);
+		SanitizeFileName(deviceName) / SanitizeFileName(deviceUnits) / SanitizeFileName(driverVersion);
 	const boost::filesystem::path filePath = dirPath / kernelName;
 	const string fileName = filePath.generic_string();
-	
-	if (!boost::filesystem::exists(filePath)) {
-		// It isn't available, compile the source
-		cl::Program *program = ForcedCompile(
-				context, device, kernelsParameters, kernelSource, error);
-		if (!program)
-			return NULL;
 
-		// Obtain the binaries of the sources
-		VECTOR_CLASS<char *> bins = program->getInfo<CL_PROGRAM_BINARIES>();
-		assert (bins.size() == 1);
-		VECTOR_CLASS<size_t> sizes = program->getInfo<CL_PROGRAM_BINARY_SIZES>();
-		assert (sizes.size() == 1);
-
-		// Create the file only if the binaries include something
-		if (sizes[0] > 0) {
-			// Add the kernel to the cache
-			boost::filesystem::create_directories(dirPath);
-			BOOST_OFSTREAM file(fileName.c_str(), ios_base::out | ios_base::binary);
-
-			// Write the binary hash
-			const u_int hashBin = HashBin(bins[0], sizes[0]);
-			file.write((char *)&hashBin, sizeof(int));
-
-			file.write(bins[0], sizes[0]);
-			// Check for errors
-			char buf[512];
-			if (file.fail()) {
-				sprintf(buf, "Unable to write kernel file cache %s", fileName.c_str());
-				throw runtime_error(buf);
+	char *kernelBin = NULL;
+	size_t kernelSize = 0;
+	{
+		boost::unique_lock<boost::mutex> lock(cacheFilesMutex);
+
+		if (boost::filesystem::exists(filePath)) {
+			const size_t fileSize = boost::filesystem::file_size(filePath);
+
+			if (fileSize > 4) {
+				kernelSize = fileSize - 4;
+				kernelBin = new char[kernelSize];
+
+				BOOST_IFSTREAM file(fileName.c_str(), ios_base::in | ios_base::binary);
+
+				// Read the binary hash
+				u_int hashBin;
+				file.read((char *)&hashBin, sizeof(int));
+
+				file.read(kernelBin, kernelSize);
+				// Check for errors
+				char buf[512];
+				if (file.fail()) {
+					delete[] kernelBin;
+					sprintf(buf, "Unable to read kernel file cache %s", fileName.c_str());
+					throw runtime_error(buf);
+				}
+
+				file.close();
+
+				// Check the binary hash
+				if (hashBin != HashBin(kernelBin, kernelSize)) {
+					delete[] kernelBin;
+					kernelBin = NULL;
+				} else {
+					// Mark the file as the most recently used
+					boost::system::error_code ec;
+					boost::filesystem::last_write_time(filePath, time(NULL), ec);
+				}
 			}
 
-			file.close();
+			// Something wrong in the file, remove the file
+			if (!kernelBin)
+				boost::filesystem::remove(filePath);
 		}
+	}
 
+	if (!kernelBin) {
+		// It isn't available, compile the source
 		if (cached)
 			*cached = false;
+		IncMissCount();
 
-		return program;
+		return CompileAndStore(context, device, kernelsParameters, kernelSource,
+				dirPath, filePath, error);
 	} else {
-		const size_t fileSize = boost::filesystem::file_size(filePath);
-
-		if (fileSize > 4) {
-			const size_t kernelSize = fileSize - 4;
-
-			char *kernelBin = new char[kernelSize];
-
-			BOOST_IFSTREAM file(fileName.c_str(), ios_base::in | ios_base::binary);
-
-			// Read the binary hash
-			u_int hashBin;
-			file.read((char *)&hashBin, sizeof(int));
-
-			file.read(kernelBin, kernelSize);
-			// Check for errors
-			char buf[512];
-			if (file.fail()) {
-				sprintf(buf, "Unable to read kernel file cache %s", fileName.c_str());
-				throw runtime_error(buf);
-			}
-
-			file.close();
-
-			// Check the binary hash
-			if (hashBin != HashBin(kernelBin, kernelSize)) {
-				// Something wrong in the file, remove the file and retry
-				boost::filesystem::remove(filePath);
-				return Compile(context, device, kernelsParameters, kernelSource, cached, error);
-			} else {
-				// Compile from the binaries
-				VECTOR_CLASS<cl::Device> buildDevice;
-				buildDevice.push_back(device);
-				cl::Program *program = new cl::Program(context, buildDevice,
-						cl::Program::Binaries(1, make_pair(kernelBin, kernelSize)));
-				program->build(buildDevice);
+		// Compile from the binaries
+		VECTOR_CLASS<cl::Device> buildDevice;
+		buildDevice.push_back(device);
+		cl::Program *program = new cl::Program(context, buildDevice,
+				cl::Program::Binaries(1, make_pair(kernelBin, kernelSize)));
+		program->build(buildDevice);
 
-				if (cached)
-					*cached = true;
+		if (cached)
+			*cached = true;
+		IncHitCount();
 
-				delete[] kernelBin;
+		delete[] kernelBin;
 
-				return program;
-			}
-		} else {
-			// Something wrong in the file, remove the file and retry
-			boost::filesystem::remove(filePath);
-			return Compile(context, device, kernelsParameters, kernelSource, cached, error);
-		}
+		return program;
 	}
 }
 
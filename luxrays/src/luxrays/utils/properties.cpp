@@ -342,7 +342,7 @@ string Property::ExtractPrefix(const string &name, const u_int count) {
 // Properties class
 //------------------------------------------------------------------------------
 
-Properties::Properties(const string &fileName) {
+Properties::Properties(const string &fileName) : nextNameSeq(0) {
 	SetFromFile(fileName);
 }
 
@@ -415,6 +415,8 @@ Properties &Properties::SetFromString(const string &propDefinitions) {
 
 Properties &Properties::Clear() {
 	names.clear();
+	namesSeq.clear();
+	namesIndex.clear();
 	props.clear();
 
 	return *this;
@@ -424,12 +426,35 @@ const vector<string> &Properties::GetAllNames() const {
 	return names;
 }
 
+static bool StartsWith(const string &name, const string &prefix) {
+	return (name.compare(0, prefix.length(), prefix) == 0);
+}
+
+static bool CompareNameSeq(const pair<u_longlong, string> &a, const pair<u_longlong, string> &b) {
+	return a.first < b.first;
+}
+
+void Properties::GetAllNamesIndexed(const string &prefix, vector<string> &namesSubset) const {
+	// All the names starting with prefix are contiguous in the index
+	vector<pair<u_longlong, string> > matches;
+	for (map<string, u_longlong>::const_iterator it = namesIndex.lower_bound(prefix);
+			(it != namesIndex.end()) && StartsWith(it->first, prefix); ++it)
+		matches.push_back(make_pair(it->second, it->first));
+
+	// Restore the insertion order
+	sort(matches.begin(), matches.end(), CompareNameSeq);
+
+	namesSubset.reserve(namesSubset.size() + matches.size());
+	for (vector<pair<u_longlong, string> >::const_iterator it = matches.begin(); it != matches.end(); ++it)
+		namesSubset.push_back(it->second);
+}
+
 vector<string> Properties::GetAllNames(const string &prefix) const {
+	if (prefix.length() == 0)
+		return GetAllNames();
+
 	vector<string> namesSubset;
-	BOOST_FOREACH(const string &name, names) {
-		if (name.find(prefix) == 0)
-			namesSubset.push_back(name);
-	}
+	GetAllNamesIndexed(prefix, namesSubset);
 
 	return namesSubset;
 }
@@ -438,7 +463,7 @@ vector<string> Properties::GetAllNamesRE(const string &regularExpression) const
 	boost::regex re(regularExpression);
 	
 	vector<string> namesSubset;
-	BOOST_FOREACH(const string &name, names) {
+	BOOST_FOREACH(const string &name, GetAllNames()) {
 		if (boost::regex_match(name, re))
 			namesSubset.push_back(name);
 	}
@@ -449,36 +474,42 @@ vector<string> Properties::GetAllNamesRE(const string &regularExpression) const
 vector<string> Properties::GetAllUniqueSubNames(const string &prefix) const {
 	const size_t fieldsCount = count(prefix.begin(), prefix.end(), '.') + 2;
 
-	set<string> definedNames;
-	vector<string> namesSubset;
-	BOOST_FOREACH(const string &name, names) {
-		if (name.find(prefix) == 0) {
-			// Check if it has been already defined
-
-			const string s = Property::ExtractPrefix(name, fieldsCount);
-			if ((s.length() > 0) && (definedNames.count(s) == 0)) {
-				namesSubset.push_back(s);
-				definedNames.insert(s);
-			}
-		}
+	// All the names with the same sub-name are contiguous in the index so I
+	// have only to track the first insertion of each sub-name
+	vector<pair<u_longlong, string> > subNames;
+	for (map<string, u_longlong>::const_iterator it = namesIndex.lower_bound(prefix);
+			(it != namesIndex.end()) && StartsWith(it->first, prefix); ++it) {
+		const string s = Property::ExtractPrefix(it->first, fieldsCount);
+		if (s.length() == 0)
+			continue;
+
+		if ((subNames.size() > 0) && (subNames.back().second == s))
+			subNames.back().first = Min(subNames.back().first, it->second);
+		else
+			subNames.push_back(make_pair(it->second, s));
 	}
 
+	// Restore the insertion order
+	sort(subNames.begin(), subNames.end(), CompareNameSeq);
+
+	vector<string> namesSubset;
+	namesSubset.reserve(subNames.size());
+	for (vector<pair<u_longlong, string> >::const_iterator it = subNames.begin(); it != subNames.end(); ++it)
+		namesSubset.push_back(it->second);
+
 	return namesSubset;
 }
 
 bool Properties::HaveNames(const string &prefix) const {
-	BOOST_FOREACH(const string &name, names) {
-		if (name.find(prefix) == 0)
-			return true;
-	}
+	map<string, u_longlong>::const_iterator it = namesIndex.lower_bound(prefix);
 
-	return false;
+	return (it != namesIndex.end()) && StartsWith(it->first, prefix);
 }
 
 bool Properties::HaveNamesRE(const string &regularExpression) const {
 	boost::regex re(regularExpression);
 
-	BOOST_FOREACH(const string &name, names) {
+	BOOST_FOREACH(const string &name, GetAllNames()) {
 		if (boost::regex_match(name, re))
 			return true;
 	}
@@ -488,10 +519,8 @@ bool Properties::HaveNamesRE(const string &regularExpression) const {
 
 Properties Properties::GetAllProperties(const string &prefix) const {
 	Properties subset;
-	BOOST_FOREACH(const string &name, names) {
-		if (name.find(prefix) == 0)
-			subset.Set(Get(name));
-	}
+	BOOST_FOREACH(const string &name, GetAllNames(prefix))
+		subset.Set(Get(name));
 
 	return subset;
 }
@@ -516,23 +545,66 @@ const Property &Properties::Get(const Property &prop) const {
 	return it->second;
 }
 
-void Properties::Delete(const string &propName) {
-	vector<string>::iterator it = find(names.begin(), names.end(), propName);
-	if (it != names.end())
-		names.erase(it);
+// Marks the deleted entries of namesSeq
+static const u_longlong NAME_DELETED = 0x8000000000000000ull;
+
+static bool CompareNameSeqDeleted(const u_longlong a, const u_longlong b) {
+	return (a & ~NAME_DELETED) < b;
+}
+
+bool Properties::MarkDeleted(const string &propName) {
+	map<string, u_longlong>::iterator it = namesIndex.find(propName);
+	if (it == namesIndex.end())
+		return false;
+
+	// namesSeq is sorted so I can look for the name position with a binary
+	// search
+	const size_t index = lower_bound(namesSeq.begin(), namesSeq.end(), it->second,
+			CompareNameSeqDeleted) - namesSeq.begin();
+	namesSeq[index] |= NAME_DELETED;
 
+	namesIndex.erase(it);
 	props.erase(propName);
+
+	return true;
+}
+
+void Properties::CompactNames() {
+	size_t dst = 0;
+	for (size_t src = 0; src < names.size(); ++src) {
+		if (namesSeq[src] & NAME_DELETED)
+			continue;
+
+		if (dst != src) {
+			names[dst].swap(names[src]);
+			namesSeq[dst] = namesSeq[src];
+		}
+		++dst;
+	}
+	names.resize(dst);
+	namesSeq.resize(dst);
+}
+
+void Properties::Delete(const string &propName) {
+	if (MarkDeleted(propName))
+		CompactNames();
 }
 
 void Properties::DeleteAll(const vector<string> &propNames) {
+	// The names are compacted only once for all the deletes
+	bool deleted = false;
 	BOOST_FOREACH(const string &n, propNames)
-		Delete(n);
+		deleted |= MarkDeleted(n);
+
+	if (deleted)
+		CompactNames();
 }
 
 string Properties::ToString() const {
 	stringstream ss;
 
-	for (vector<string>::const_iterator i = names.begin(); i != names.end(); ++i)
+	const vector<string> &allNames = GetAllNames();
+	for (vector<string>::const_iterator i = allNames.begin(); i != allNames.end(); ++i)
 		ss << props.at(*i).ToString() << "\n";
 
 	return ss.str();
@@ -544,6 +616,9 @@ Properties &Properties::Set(const Property &prop) {
 	if (!IsDefined(propName)) {
 		// It is a new name
 		names.push_back(propName);
+		namesSeq.push_back(nextNameSeq);
+		namesIndex.insert(make_pair(propName, nextNameSeq));
+		++nextNameSeq;
 	} else {
 		// boost::unordered_set::insert() doesn't overwrite an existing entry
 		props.erase(propName);
@@ -0,0 +1,146 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+#include "luxrays/utils/timeline.h"
+
+using namespace std;
+using namespace luxrays;
+
+//------------------------------------------------------------------------------
+// Timeline
+//------------------------------------------------------------------------------
+
+bool Timeline::enabled = false;
+double Timeline::originTime = 0.0;
+boost::mutex Timeline::eventsMutex;
+vector<Timeline::Event> Timeline::events;
+map<boost::thread::id, u_int> Timeline::threadIndices;
+
+void Timeline::Enable(const bool enable) {
+	boost::unique_lock<boost::mutex> lock(eventsMutex);
+
+	if (enable && !enabled && (events.size() == 0)) {
+		originTime = WallClockTime();
+		// The thread enabling the timeline is the first track
+		GetThreadIndex();
+	}
+	enabled = enable;
+}
+
+void Timeline::Clear() {
+	boost::unique_lock<boost::mutex> lock(eventsMutex);
+
+	events.clear();
+	threadIndices.clear();
+	originTime = WallClockTime();
+	GetThreadIndex();
+}
+
+u_int Timeline::GetThreadIndex() {
+	const boost::thread::id threadId = boost::this_thread::get_id();
+
+	map<boost::thread::id, u_int>::const_iterator it = threadIndices.find(threadId);
+	if (it != threadIndices.end())
+		return it->second;
+
+	const u_int index = threadIndices.size();
+	threadIndices[threadId] = index;
+
+	return index;
+}
+
+void Timeline::AddEvent(const string &name, const string &category,
+		const double startTime, const double endTime) {
+	boost::unique_lock<boost::mutex> lock(eventsMutex);
+
+	if (!enabled)
+		return;
+
+	Event e;
+	e.name = name;
+	e.category = category;
+	e.startTime = startTime;
+	e.endTime = endTime;
+	e.threadIndex = GetThreadIndex();
+	e.instant = false;
+	events.push_back(e);
+}
+
+void Timeline::AddInstantEvent(const string &name, const string &category) {
+	const double now = WallClockTime();
+
+	boost::unique_lock<boost::mutex> lock(eventsMutex);
+
+	if (!enabled)
+		return;
+
+	Event e;
+	e.name = name;
+	e.category = category;
+	e.startTime = now;
+	e.endTime = now;
+	e.threadIndex = GetThreadIndex();
+	e.instant = true;
+	events.push_back(e);
+}
+
+void Timeline::WriteChromeTrace(ostream &os) {
+	boost::unique_lock<boost::mutex> lock(eventsMutex);
+
+	// Chrome trace times are in microseconds
+	os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	// Thread names
+	for (u_int i = 0; i < threadIndices.size(); ++i) {
+		os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << i <<
+				", \"args\": {\"name\": \"" << ((i == 0) ? "Main thread" : ("Thread " + ToString(i))) << "\"}}";
+		os << (((i + 1 < threadIndices.size()) || (events.size() > 0)) ? ",\n" : "\n");
+	}
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event &e = events[i];
+
+		os << "{\"name\": " << ToJSONString(e.name) <<
+				", \"cat\": " << ToJSONString(e.category) <<
+				", \"pid\": 0, \"tid\": " << e.threadIndex <<
+				", \"ts\": " << boost::format("%.1f") % ((e.startTime - originTime) * 1000000.0);
+		if (e.instant)
+			os << ", \"ph\": \"i\", \"s\": \"g\"}";
+		else
+			os << ", \"ph\": \"X\", \"dur\": " << boost::format("%.1f") % ((e.endTime - e.startTime) * 1000000.0) << "}";
+		os << ((i + 1 < events.size()) ? ",\n" : "\n");
+	}
+
+	os << "]}\n";
+}
+
+void Timeline::SaveChromeTrace(const string &fileName) {
+	ofstream file(fileName.c_str(), ios_base::out | ios_base::trunc);
+	if (!file.good())
+		throw runtime_error("Unable to open timeline file: " + fileName);
+
+	WriteChromeTrace(file);
+
+	if (!file.good())
+		throw runtime_error("Error while writing timeline file: " + fileName);
+}
@@ -26,7 +26,17 @@ using namespace slg;
 //------------------------------------------------------------------------------
 
 BiDirVMCPURenderEngine::BiDirVMCPURenderEngine(const RenderConfig *rcfg, Film *flm, boost::mutex *flmMutex) :
-		BiDirCPURenderEngine(rcfg, flm, flmMutex) {
+		BiDirCPURenderEngine(rcfg, flm, flmMutex), threadsSyncBarrier(NULL) {
+}
+
+BiDirVMCPURenderEngine::~BiDirVMCPURenderEngine() {
+	// The render threads must be stopped before deleting the barrier
+	if (editMode)
+		EndSceneEdit(EditActionList());
+	if (started)
+		Stop();
+
+	delete threadsSyncBarrier;
 }
 
 void BiDirVMCPURenderEngine::StartLockLess() {
@@ -40,9 +50,31 @@ void BiDirVMCPURenderEngine::StartLockLess() {
 	baseRadius = cfg.Get(GetDefaultProps().Get("bidirvm.startradius.scale")).Get<float>() * renderConfig->scene->dataSet->GetBSphere().rad;
 	radiusAlpha = cfg.Get(GetDefaultProps().Get("bidirvm.alpha")).Get<float>();
 
+	// All render threads build and use the same HashGrid
+	hashGrid.Init(renderThreads.size());
+	delete threadsSyncBarrier;
+	threadsSyncBarrier = new boost::barrier(renderThreads.size());
+
 	BiDirCPURenderEngine::StartLockLess();
 }
 
+void BiDirVMCPURenderEngine::StopLockLess() {
+	BiDirCPURenderEngine::StopLockLess();
+
+	delete threadsSyncBarrier;
+	threadsSyncBarrier = NULL;
+}
+
+void BiDirVMCPURenderEngine::EndSceneEditLockLess(const EditActionList &editActions) {
+	// The render threads may have been interrupted while waiting on the
+	// barrier so I need a new one
+	hashGrid.Init(renderThreads.size());
+	delete threadsSyncBarrier;
+	threadsSyncBarrier = new boost::barrier(renderThreads.size());
+
+	BiDirCPURenderEngine::EndSceneEditLockLess(editActions);
+}
+
 //------------------------------------------------------------------------------
 // Static methods used by RenderEngineRegistry
 //------------------------------------------------------------------------------
@@ -67,207 +67,217 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 	vector<vector<SampleResult> > samplesResults(samplers.size());
 	vector<vector<PathVertexVM> > lightPathsVertices(samplers.size());
 	vector<Point> lensPoints(samplers.size());
-	HashGrid hashGrid;
+	HashGrid &hashGrid = engine->hashGrid;
+	// The light paths of all render threads are used for vertex merging
+	const u_int totalLightPathsCount = engine->lightPathsCount * engine->renderThreads.size();
 	// I can not use engine->renderConfig->GetProperty() here because the
 	// RenderConfig properties cache is not thread safe
 	const u_int haltDebug = engine->renderConfig->cfg.Get(Property("batch.haltdebug")(0u)).Get<u_int>();
 
-	for(u_int steps = 0; !boost::this_thread::interruption_requested(); ++steps) {
-		// Check if we are in pause mode
-		if (engine->pauseMode) {
-			// Check every 100ms if I have to continue the rendering
-			while (!boost::this_thread::interruption_requested() && engine->pauseMode)
-				boost::this_thread::sleep(boost::posix_time::millisec(100));
+	try {
+		for(u_int steps = 0; !boost::this_thread::interruption_requested(); ++steps) {
+			// Check if we are in pause mode
+			if (engine->pauseMode) {
+				// Check every 100ms if I have to continue the rendering
+				while (!boost::this_thread::interruption_requested() && engine->pauseMode)
+					boost::this_thread::sleep(boost::posix_time::millisec(100));
 
-			if (boost::this_thread::interruption_requested())
-				break;
-		}
+				if (boost::this_thread::interruption_requested())
+					break;
+			}
 
-		// Clear the arrays
-		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
-			samplesResults[samplerIndex].clear();
-			lightPathsVertices[samplerIndex].clear();
-		}
+			// Clear the arrays
+			for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
+				samplesResults[samplerIndex].clear();
+				lightPathsVertices[samplerIndex].clear();
+			}
 
-		// Setup vertex merging
-		float radius = engine->baseRadius;
-        radius /= powf(float(iteration + 1), .5f * (1.f - engine->radiusAlpha));
-		radius = Max(radius, DEFAULT_EPSILON_STATIC);
-		const float radius2 = radius * radius;
+			// Setup vertex merging
+			float radius = engine->baseRadius;
+	        radius /= powf(float(iteration + 1), .5f * (1.f - engine->radiusAlpha));
+			radius = Max(radius, DEFAULT_EPSILON_STATIC);
+			const float radius2 = radius * radius;
 
-		const float vmFactor = M_PI * radius2 * engine->lightPathsCount;
-		vmNormalization = 1.f / vmFactor;
+			const float vmFactor = M_PI * radius2 * totalLightPathsCount;
+			vmNormalization = 1.f / vmFactor;
 
-		const float etaVCM = vmFactor;
-		misVmWeightFactor = MIS(etaVCM);
-		misVcWeightFactor = MIS(1.f / etaVCM);
+			const float etaVCM = vmFactor;
+			misVmWeightFactor = MIS(etaVCM);
+			misVcWeightFactor = MIS(1.f / etaVCM);
 
-		// Using the same time for all rays in the same pass is required by the
-		// current implementation (i.e. I can not mix paths with different
-		// times). However this is detrimental for the Metropolis sampler.
-		const float time = rndGen->floatValue();
+			// Using the same time for all rays in the same pass is required by the
+			// current implementation (i.e. I can not mix paths with different
+			// times). However this is detrimental for the Metropolis sampler.
+			// The light paths are shared by all render threads so the time
+			// must be the same for all threads too.
+			const float time = RadicalInverse(iteration + 1, 2);
 
-		//----------------------------------------------------------------------
-		// Trace all light paths
-		//----------------------------------------------------------------------
+			//----------------------------------------------------------------------
+			// Trace all light paths
+			//----------------------------------------------------------------------
 
-		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
-			Sampler *sampler = samplers[samplerIndex];
+			for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
+				Sampler *sampler = samplers[samplerIndex];
 
-			// Sample a point on the camera lens
-			if (!camera->SampleLens(time, sampler->GetSample(3), sampler->GetSample(4),
-					&lensPoints[samplerIndex]))
-				continue;
+				// Sample a point on the camera lens
+				if (!camera->SampleLens(time, sampler->GetSample(3), sampler->GetSample(4),
+						&lensPoints[samplerIndex]))
+					continue;
 
-			TraceLightPath(time, sampler, lensPoints[samplerIndex],
-					lightPathsVertices[samplerIndex], samplesResults[samplerIndex]);
-		}
+				TraceLightPath(time, sampler, lensPoints[samplerIndex],
+						lightPathsVertices[samplerIndex], samplesResults[samplerIndex]);
+			}
 
-		//----------------------------------------------------------------------
-		// Store all light path vertices in the k-NN accelerator
-		//----------------------------------------------------------------------
-
-		hashGrid.Build(lightPathsVertices, radius);
-
-		//cout << "==========================================\n";
-		//cout << "Iteration: " << iteration << "  Paths: " << engine->lightPathsCount << "  Light path vertices: "<< hashGrid.GetVertexCount() <<"\n";
-
-		//----------------------------------------------------------------------
-		// Trace all eye paths
-		//----------------------------------------------------------------------
-
-		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
-			Sampler *sampler = samplers[samplerIndex];
-
-			PathVertexVM eyeVertex;
-			SampleResult &eyeSampleResult = AddResult(samplesResults[samplerIndex], false);
-
-			film->GetSampleXY(sampler->GetSample(0), sampler->GetSample(1),
-				&eyeSampleResult.filmX, &eyeSampleResult.filmY);
-			Ray eyeRay;
-			camera->GenerateRay(eyeSampleResult.filmX, eyeSampleResult.filmY, &eyeRay,
-				sampler->GetSample(9), sampler->GetSample(10), time);
-
-			eyeVertex.bsdf.hitPoint.fixedDir = -eyeRay.d;
-			eyeVertex.throughput = Spectrum(1.f);
-			const float cosAtCamera = Dot(scene->camera->GetDir(), eyeRay.d);
-			const float cameraPdfW = 1.f / (cosAtCamera * cosAtCamera * cosAtCamera *
-				scene->camera->GetPixelArea());
-			eyeVertex.dVCM = MIS(1.f / cameraPdfW);
-			eyeVertex.dVC = 1.f;
-			eyeVertex.dVM = 1.f;
-
-			eyeVertex.depth = 1;
-			while (eyeVertex.depth <= engine->maxEyePathDepth) {
-				eyeSampleResult.firstPathVertex = (eyeVertex.depth == 1);
-				eyeSampleResult.lastPathVertex = (eyeVertex.depth == engine->maxEyePathDepth);
-
-				const u_int sampleOffset = sampleBootSizeVM + engine->maxLightPathDepth * sampleLightStepSize +
-					(eyeVertex.depth - 1) * sampleEyeStepSize;
-
-				// NOTE: I account for volume emission only with path tracing (i.e. here and
-				// not in any other place)
-				RayHit eyeRayHit;
-				Spectrum connectionThroughput, connectEmission;
-				const bool hit = scene->Intersect(device, false,
-						&eyeVertex.volInfo, sampler->GetSample(sampleOffset),
-						&eyeRay, &eyeRayHit, &eyeVertex.bsdf,
-						&connectionThroughput, &eyeVertex.throughput, &eyeSampleResult);
-
-				if (!hit) {
-					// Nothing was hit, look for infinitelight
-
-					// This is a trick, you can not have a BSDF of something that has
-					// not been hit. DirectHitInfiniteLight must be aware of this.
-					eyeVertex.bsdf.hitPoint.fixedDir = -eyeRay.d;
+			//----------------------------------------------------------------------
+			// Store the light path vertices of all threads in the k-NN accelerator
+			//----------------------------------------------------------------------
+
+			hashGrid.SetThreadVertices(threadIndex, lightPathsVertices);
+			hashGrid.Build(threadIndex, engine->threadsSyncBarrier, radius);
+
+			//cout << "==========================================\n";
+			//cout << "Iteration: " << iteration << "  Paths: " << engine->lightPathsCount << "  Light path vertices: "<< hashGrid.GetVertexCount() <<"\n";
+
+			//----------------------------------------------------------------------
+			// Trace all eye paths
+			//----------------------------------------------------------------------
+
+			for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
+				Sampler *sampler = samplers[samplerIndex];
+
+				PathVertexVM eyeVertex;
+				SampleResult &eyeSampleResult = AddResult(samplesResults[samplerIndex], false);
+
+				film->GetSampleXY(sampler->GetSample(0), sampler->GetSample(1),
+					&eyeSampleResult.filmX, &eyeSampleResult.filmY);
+				Ray eyeRay;
+				camera->GenerateRay(eyeSampleResult.filmX, eyeSampleResult.filmY, &eyeRay,
+					sampler->GetSample(9), sampler->GetSample(10), time);
+
+				eyeVertex.bsdf.hitPoint.fixedDir = -eyeRay.d;
+				eyeVertex.throughput = Spectrum(1.f);
+				const float cosAtCamera = Dot(scene->camera->GetDir(), eyeRay.d);
+				const float cameraPdfW = 1.f / (cosAtCamera * cosAtCamera * cosAtCamera *
+					scene->camera->GetPixelArea());
+				eyeVertex.dVCM = MIS(1.f / cameraPdfW);
+				eyeVertex.dVC = 1.f;
+				eyeVertex.dVM = 1.f;
+
+				eyeVertex.depth = 1;
+				while (eyeVertex.depth <= engine->maxEyePathDepth) {
+					eyeSampleResult.firstPathVertex = (eyeVertex.depth == 1);
+					eyeSampleResult.lastPathVertex = (eyeVertex.depth == engine->maxEyePathDepth);
+
+					const u_int sampleOffset = sampleBootSizeVM + engine->maxLightPathDepth * sampleLightStepSize +
+						(eyeVertex.depth - 1) * sampleEyeStepSize;
+
+					// NOTE: I account for volume emission only with path tracing (i.e. here and
+					// not in any other place)
+					RayHit eyeRayHit;
+					Spectrum connectionThroughput, connectEmission;
+					const bool hit = scene->Intersect(device, false,
+							&eyeVertex.volInfo, sampler->GetSample(sampleOffset),
+							&eyeRay, &eyeRayHit, &eyeVertex.bsdf,
+							&connectionThroughput, &eyeVertex.throughput, &eyeSampleResult);
+
+					if (!hit) {
+						// Nothing was hit, look for infinitelight
+
+						// This is a trick, you can not have a BSDF of something that has
+						// not been hit. DirectHitInfiniteLight must be aware of this.
+						eyeVertex.bsdf.hitPoint.fixedDir = -eyeRay.d;
+						eyeVertex.throughput *= connectionThroughput;
+
+						DirectHitLight(false, eyeVertex, eyeSampleResult);
+
+						if (eyeSampleResult.firstPathVertex) {
+							eyeSampleResult.alpha = 0.f;
+							eyeSampleResult.depth = std::numeric_limits<float>::infinity();
+						}
+						break;
+					}
 					eyeVertex.throughput *= connectionThroughput;
 
-					DirectHitLight(false, eyeVertex, eyeSampleResult);
-
+					// Something was hit
 					if (eyeSampleResult.firstPathVertex) {
-						eyeSampleResult.alpha = 0.f;
-						eyeSampleResult.depth = std::numeric_limits<float>::infinity();
+						eyeSampleResult.alpha = 1.f;
+						eyeSampleResult.depth = eyeRayHit.t;
 					}
-					break;
-				}
-				eyeVertex.throughput *= connectionThroughput;
-
-				// Something was hit
-				if (eyeSampleResult.firstPathVertex) {
-					eyeSampleResult.alpha = 1.f;
-					eyeSampleResult.depth = eyeRayHit.t;
-				}
 
-				// Update MIS constants
-				const float factor = 1.f / MIS(AbsDot(eyeVertex.bsdf.hitPoint.shadeN, eyeVertex.bsdf.hitPoint.fixedDir));
-				eyeVertex.dVCM *= MIS(eyeRayHit.t * eyeRayHit.t) * factor;
-				eyeVertex.dVC *= factor;
-				eyeVertex.dVM *= factor;
-
-				// Check if it is a light source
-				if (eyeVertex.bsdf.IsLightSource())
-					DirectHitLight(true, eyeVertex, eyeSampleResult);
-
-				// Note: pass-through check is done inside Scene::Intersect()
-
-				//--------------------------------------------------------------
-				// Direct light sampling
-				//--------------------------------------------------------------
-
-				DirectLightSampling(time,
-						sampler->GetSample(sampleOffset + 1),
-						sampler->GetSample(sampleOffset + 2),
-						sampler->GetSample(sampleOffset + 3),
-						sampler->GetSample(sampleOffset + 4),
-						sampler->GetSample(sampleOffset + 5),
-						eyeVertex, eyeSampleResult);
-
-				if (!eyeVertex.bsdf.IsDelta()) {
-					//----------------------------------------------------------
-					// Connect vertex path ray with all light path vertices
-					//----------------------------------------------------------
-			
-					const vector<PathVertexVM> &lightPathVertices = lightPathsVertices[samplerIndex];
-					for (vector<PathVertexVM>::const_iterator lightPathVertex = lightPathVertices.begin();
-							lightPathVertex < lightPathVertices.end(); ++lightPathVertex)
-						ConnectVertices(time,
-								eyeVertex, *lightPathVertex, eyeSampleResult,
-								sampler->GetSample(sampleOffset + 6));
-
-					//----------------------------------------------------------
-					// Vertex Merging step
-					//----------------------------------------------------------
-
-					hashGrid.Process(this, eyeVertex, &eyeSampleResult.radiance[0]);
-				}
+					// Update MIS constants
+					const float factor = 1.f / MIS(AbsDot(eyeVertex.bsdf.hitPoint.shadeN, eyeVertex.bsdf.hitPoint.fixedDir));
+					eyeVertex.dVCM *= MIS(eyeRayHit.t * eyeRayHit.t) * factor;
+					eyeVertex.dVC *= factor;
+					eyeVertex.dVM *= factor;
+
+					// Check if it is a light source
+					if (eyeVertex.bsdf.IsLightSource())
+						DirectHitLight(true, eyeVertex, eyeSampleResult);
+
+					// Note: pass-through check is done inside Scene::Intersect()
+
+					//--------------------------------------------------------------
+					// Direct light sampling
+					//--------------------------------------------------------------
+
+					DirectLightSampling(time,
+							sampler->GetSample(sampleOffset + 1),
+							sampler->GetSample(sampleOffset + 2),
+							sampler->GetSample(sampleOffset + 3),
+							sampler->GetSample(sampleOffset + 4),
+							sampler->GetSample(sampleOffset + 5),
+							eyeVertex, eyeSampleResult);
+
+					if (!eyeVertex.bsdf.IsDelta()) {
+						//----------------------------------------------------------
+						// Connect vertex path ray with all light path vertices
+						//----------------------------------------------------------
+				
+						const vector<PathVertexVM> &lightPathVertices = lightPathsVertices[samplerIndex];
+						for (vector<PathVertexVM>::const_iterator lightPathVertex = lightPathVertices.begin();
+								lightPathVertex < lightPathVertices.end(); ++lightPathVertex)
+							ConnectVertices(time,
+									eyeVertex, *lightPathVertex, eyeSampleResult,
+									sampler->GetSample(sampleOffset + 6));
+
+						//----------------------------------------------------------
+						// Vertex Merging step
+						//----------------------------------------------------------
+
+						hashGrid.Process(this, eyeVertex, &eyeSampleResult.radiance[0]);
+					}
 
-				//--------------------------------------------------------------
-				// Build the next vertex path ray
-				//--------------------------------------------------------------
+					//--------------------------------------------------------------
+					// Build the next vertex path ray
+					//--------------------------------------------------------------
 
-				if (!Bounce(time, sampler, sampleOffset + 7, &eyeVertex, &eyeRay))
-					break;
+					if (!Bounce(time, sampler, sampleOffset + 7, &eyeVertex, &eyeRay))
+						break;
+				}
 			}
-		}
 
-		//----------------------------------------------------------------------
-		// Splat all samples
-		//----------------------------------------------------------------------
+			//----------------------------------------------------------------------
+			// Splat all samples
+			//----------------------------------------------------------------------
 
-		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex)
-			samplers[samplerIndex]->NextSample(samplesResults[samplerIndex]);
+			for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex)
+				samplers[samplerIndex]->NextSample(samplesResults[samplerIndex]);
 
-		++iteration;
+			++iteration;
 
 #ifdef WIN32
-		// Work around Windows bad scheduling
-		renderThread->yield();
+			// Work around Windows bad scheduling
+			renderThread->yield();
 #endif
 
-		//hashGrid.PrintStatistics();
+			//hashGrid.PrintStatistics();
 
-		if ((haltDebug > 0u) && (steps >= haltDebug))
-			break;
+			if ((haltDebug > 0u) && (steps >= haltDebug))
+				break;
+		}
+	} catch (boost::thread_interrupted) {
+		// The render thread has been interrupted while waiting the other
+		// threads to build the HashGrid
 	}
 
 	for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex)
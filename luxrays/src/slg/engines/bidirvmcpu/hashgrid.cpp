@@ -18,67 +18,135 @@
 
 #include <boost/format.hpp>
 
+#include "luxrays/utils/atomic.h"
 #include "slg/engines/bidirvmcpu/bidirvmcpu.h"
 
 using namespace std;
 using namespace luxrays;
 using namespace slg;
 
-void HashGrid::Build(vector<vector<PathVertexVM> > &pathsVertices, const float radius) {
-	// Reset statistic counters
-	//mergeHitsV2V = 0;
-	//mergeHitsV2S = 0;
-	//mergeHitsS2S = 0;
+void HashGrid::Init(const u_int threadCount) {
+	threadLightVertices.clear();
+	threadLightVertices.resize(threadCount);
+	threadVertexBBoxes.clear();
+	threadVertexBBoxes.resize(threadCount);
 
-	radius2 = radius * radius;
-
-	// Build the vertices bounding box
 	vertexCount = 0;
-	vertexBBox = BBox();
+}
+
+void HashGrid::SetThreadVertices(const u_int threadIndex,
+		const vector<vector<PathVertexVM> > &pathsVertices) {
+	vector<LightVertexVM> &vertices = threadLightVertices[threadIndex];
+	vertices.clear();
+
 	for (u_int i = 0; i < pathsVertices.size(); ++i) {
-		vertexCount += pathsVertices[i].size();
+		for (u_int j = 0; j < pathsVertices[i].size(); ++j) {
+			const PathVertexVM &pathVertex = pathsVertices[i][j];
+
+			LightVertexVM vertex;
+			vertex.p = pathVertex.bsdf.hitPoint.p;
+			vertex.fixedDir = pathVertex.bsdf.hitPoint.fixedDir;
+			vertex.throughput = pathVertex.throughput;
+			vertex.dVCM = pathVertex.dVCM;
+			vertex.dVM = pathVertex.dVM;
+			vertex.lightID = pathVertex.lightID;
+
+			vertices.push_back(vertex);
+		}
+	}
+}
+
+void HashGrid::Build(const u_int threadIndex, boost::barrier *barrier, const float radius) {
+	const vector<LightVertexVM> &vertices = threadLightVertices[threadIndex];
+
+	//--------------------------------------------------------------------------
+	// Build the bounding box of the vertices of this thread
+	//--------------------------------------------------------------------------
+
+	BBox bbox;
+	for (u_int i = 0; i < vertices.size(); ++i)
+		bbox = Union(bbox, vertices[i].p);
+	threadVertexBBoxes[threadIndex] = bbox;
+
+	// This is also required to be sure that all threads have done with the
+	// grid of the previous pass
+	barrier->wait();
+
+	//--------------------------------------------------------------------------
+	// Allocate the grid
+	//--------------------------------------------------------------------------
 
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j)
-			vertexBBox = Union(vertexBBox, pathsVertices[i][j].bsdf.hitPoint.p);
+	if (threadIndex == 0) {
+		// Reset statistic counters
+		//mergeHitsV2V = 0;
+		//mergeHitsV2S = 0;
+		//mergeHitsS2S = 0;
+
+		radius2 = radius * radius;
+
+		vertexCount = 0;
+		vertexBBox = BBox();
+		for (u_int i = 0; i < threadLightVertices.size(); ++i) {
+			vertexCount += threadLightVertices[i].size();
+			vertexBBox = Union(vertexBBox, threadVertexBBoxes[i]);
+		}
+
+		if (vertexCount > 0) {
+			vertexBBox.Expand(radius + DEFAULT_EPSILON_STATIC);
+
+			// Calculate the size of the grid cell
+			const float cellSize = radius * 2.f;
+			invCellSize = 1.f / cellSize;
+
+			gridSize = vertexCount;
+			cellEnds.resize(gridSize);
+			fill(cellEnds.begin(), cellEnds.end(), 0);
+			lightVertices.resize(vertexCount);
+		}
 	}
 
+	barrier->wait();
+
 	if (vertexCount <= 0)
 		return;
 
-	vertexBBox.Expand(radius + DEFAULT_EPSILON_STATIC);
+	//--------------------------------------------------------------------------
+	// Count the vertices of each cell
+	//--------------------------------------------------------------------------
 
-	// Calculate the size of the grid cell
-	const float cellSize = radius * 2.f;
-	invCellSize = 1.f / cellSize;
+	for (u_int i = 0; i < vertices.size(); ++i)
+		AtomicInc(&cellEnds[Hash(vertices[i].p)]);
 
-	gridSize = vertexCount;	
-	cellEnds.resize(gridSize);
-	fill(cellEnds.begin(), cellEnds.end(), 0);
-	lightVertices.resize(gridSize, NULL);
+	barrier->wait();
 
-	for (u_int i = 0, k = 0; i < pathsVertices.size(); ++i) {
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j, ++k) {
-			const PathVertexVM *vertex = &pathsVertices[i][j];
+	//--------------------------------------------------------------------------
+	// Compute the first index of each cell
+	//--------------------------------------------------------------------------
 
-			cellEnds[Hash(vertex->bsdf.hitPoint.p)]++;
+	if (threadIndex == 0) {
+		u_int sum = 0;
+		for (u_int i = 0; i < cellEnds.size(); ++i) {
+			const u_int temp = cellEnds[i];
+			cellEnds[i] = sum;
+			sum += temp;
 		}
 	}
 
-	int sum = 0;
-	for (u_int i = 0; i < cellEnds.size(); ++i) {
-		int temp = cellEnds[i];
-		cellEnds[i] = sum;
-		sum += temp;
-	}
-	
-	for (u_int i = 0; i < pathsVertices.size(); ++i) {
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j) {
-			const PathVertexVM *vertex = &pathsVertices[i][j];
+	barrier->wait();
 
-			const int targetIdx = cellEnds[Hash(vertex->bsdf.hitPoint.p)]++;
-            lightVertices[targetIdx] = vertex;
-		}
+	//--------------------------------------------------------------------------
+	// Copy the vertices in their cells, at the end cellEnds[i] is the end
+	// of cell i
+	//--------------------------------------------------------------------------
+
+	for (u_int i = 0; i < vertices.size(); ++i) {
+		const LightVertexVM &vertex = vertices[i];
+
+		const u_int targetIdx = AtomicFetchAndInc(&cellEnds[Hash(vertex.p)]);
+		lightVertices[targetIdx] = vertex;
 	}
+
+	barrier->wait();
 }
 
 void HashGrid::Process(const BiDirVMCPURenderThread *thread,
@@ -124,21 +192,20 @@ void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 		const PathVertexVM &eyeVertex, const int i0, const int i1,
 		Spectrum *radiance) const {
 	for (int i = i0; i < i1; ++i) {
-		const PathVertexVM *lightVertex = lightVertices[i];
-		Process(thread, eyeVertex, lightVertex, radiance);
+		Process(thread, eyeVertex, lightVertices[i], radiance);
 	}
 }
 
 void HashGrid::Process(const BiDirVMCPURenderThread *thread,
-		const PathVertexVM &eyeVertex, const PathVertexVM *lightVertex,
+		const PathVertexVM &eyeVertex, const LightVertexVM &lightVertex,
 		Spectrum *radiance) const {
-	const float distance2 = (lightVertex->bsdf.hitPoint.p - eyeVertex.bsdf.hitPoint.p).LengthSquared();
+	const float distance2 = (lightVertex.p - eyeVertex.bsdf.hitPoint.p).LengthSquared();
 
 	if (distance2 <= radius2) {
 		float eyeBsdfPdfW, eyeBsdfRevPdfW;
 		BSDFEvent eyeEvent;
 		// I need to remove the dotN term from the result (see below)
-		Spectrum eyeBsdfEval = eyeVertex.bsdf.Evaluate(lightVertex->bsdf.hitPoint.fixedDir,
+		Spectrum eyeBsdfEval = eyeVertex.bsdf.Evaluate(lightVertex.fixedDir,
 				&eyeEvent, &eyeBsdfPdfW, &eyeBsdfRevPdfW);
 		if(eyeBsdfEval.Black())
 			return;
@@ -146,7 +213,7 @@ void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 		// Volume BSDF doesn't multiply BSDF::Evaluate() by dotN so I need
 		// to remove the term only if it isn't a Volume
 		if (!eyeVertex.bsdf.IsVolume())
-			eyeBsdfEval /= AbsDot(lightVertex->bsdf.hitPoint.fixedDir, eyeVertex.bsdf.hitPoint.geometryN);
+			eyeBsdfEval /= AbsDot(lightVertex.fixedDir, eyeVertex.bsdf.hitPoint.geometryN);
 
 		BiDirVMCPURenderEngine *engine = (BiDirVMCPURenderEngine *)thread->renderEngine;
 		if (eyeVertex.depth >= engine->rrDepth) {
@@ -157,23 +224,23 @@ void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 		}
 
 		// MIS weights
-		const float weightLight = lightVertex->dVCM * thread->misVcWeightFactor +
-			lightVertex->dVM * BiDirVMCPURenderThread::MIS(eyeBsdfPdfW);
+		const float weightLight = lightVertex.dVCM * thread->misVcWeightFactor +
+			lightVertex.dVM * BiDirVMCPURenderThread::MIS(eyeBsdfPdfW);
 		const float weightCamera = eyeVertex.dVCM * thread->misVcWeightFactor +
 			eyeVertex.dVM * BiDirVMCPURenderThread::MIS(eyeBsdfRevPdfW);
 		const float misWeight = 1.f / (weightLight + 1.f + weightCamera);
 
-		radiance[lightVertex->lightID] += (thread->vmNormalization * misWeight) *
-				eyeVertex.throughput * eyeBsdfEval * lightVertex->throughput;
+		radiance[lightVertex.lightID] += (thread->vmNormalization * misWeight) *
+				eyeVertex.throughput * eyeBsdfEval * lightVertex.throughput;
 
 		// Statistics
 		/*if (eyeVertex.bsdf.IsVolume()) {
-			if (lightVertex->bsdf.IsVolume())
+			if (lightVertex.bsdf.IsVolume())
 				++mergeHitsV2V;
 			else
 				++mergeHitsV2S;
 		} else {
-			if (lightVertex->bsdf.IsVolume())
+			if (lightVertex.bsdf.IsVolume())
 				++mergeHitsV2S;
 			else
 				++mergeHitsS2S;			
@@ -224,6 +224,11 @@ void CPUNoTileRenderThread::StartRenderThread() {
 	threadFilm->SetImagePipelines(NULL);
 	threadFilm->Init();
 
+	// The film of the first thread includes the samples of the checkpoint
+	// the rendering is resumed from
+	if ((threadIndex == 0) && cpuNoTileEngine->startFilm)
+		threadFilm->AddFilm(*(cpuNoTileEngine->startFilm));
+
 	CPURenderThread::StartRenderThread();
 }
 
@@ -241,9 +246,18 @@ CPUNoTileRenderEngine::~CPUNoTileRenderEngine() {
 }
 
 void CPUNoTileRenderEngine::StartLockLess() {
+	// Resume the rendering from a checkpoint
+	if (startFilm)
+		SetSeed(startState.Get("checkpoint.seed").Get<u_int>());
+
 	samplerSharedData = renderConfig->AllocSamplerSharedData(&seedBaseGenerator);
-	
+	if (startFilm)
+		samplerSharedData->SetState(startState);
+
 	CPURenderEngine::StartLockLess();
+
+	// The checkpoint film has been added to the film of the first thread
+	startFilm = NULL;
 }
 
 void CPUNoTileRenderEngine::StopLockLess() {
@@ -253,6 +267,16 @@ void CPUNoTileRenderEngine::StopLockLess() {
 	samplerSharedData = NULL;
 }
 
+Properties CPUNoTileRenderEngine::GetCheckpointState() {
+	Properties state = RenderEngine::GetCheckpointState();
+
+	boost::unique_lock<boost::mutex> lock(engineMutex);
+	if (samplerSharedData)
+		state << samplerSharedData->GetState();
+
+	return state;
+}
+
 void CPUNoTileRenderEngine::UpdateFilmLockLess() {
 	boost::unique_lock<boost::mutex> lock(*filmMutex);
 
@@ -81,6 +81,13 @@ void PathCPURenderEngine::StartLockLess() {
 	else
 		sampleSplatter = new FilmSampleSplatter(pixelFilter);
 
+	pathTracer.maxPathDepth = maxPathDepth;
+	pathTracer.rrDepth = rrDepth;
+	pathTracer.rrImportanceCap = rrImportanceCap;
+	pathTracer.pdfClampValue = pdfClampValue;
+	pathTracer.forceBlackBackground = forceBlackBackground;
+	pathTracer.pixelFilterDistribution = useFastPixelFilter ? pixelFilterDistribution : NULL;
+
 	CPUNoTileRenderEngine::StartLockLess();
 }
 
@@ -56,6 +56,7 @@ using namespace slg;
 PathOCLRenderEngine::PathOCLRenderEngine(const RenderConfig *rcfg, Film *flm,
 		boost::mutex *flmMutex) : PathOCLBaseRenderEngine(rcfg, flm, flmMutex),
 		pixelFilterDistribution(NULL) {
+	cpuFallback = false;
 	oclSampler = NULL;
 	oclPixelFilter = NULL;
 }
@@ -114,6 +115,10 @@ void PathOCLRenderEngine::StartLockLess() {
 	useFastPixelFilter = cfg.Get(defaultProps.Get("path.fastpixelfilter.enable")).Get<bool>();
 	usePixelAtomics = cfg.Get(Property("pathocl.pixelatomics.enable")(false)).Get<bool>();
 	forceBlackBackground = cfg.Get(GetDefaultProps().Get("path.forceblackbackground.enable")).Get<bool>();
+	// The CPU fallback is available only with the background kernel compilation
+	cpuFallback = (GetType() == PATHOCL) &&
+			cfg.Get(Property("opencl.kernel.compile.background")(false)).Get<bool>() &&
+			cfg.Get(Property("opencl.kernel.compile.cpufallback")(true)).Get<bool>();
 
 	//--------------------------------------------------------------------------
 	// Sampler
@@ -143,8 +148,16 @@ void PathOCLRenderEngine::StopLockLess() {
 void PathOCLRenderEngine::MergeThreadFilms() {
 	film->Reset();
 	for (size_t i = 0; i < renderThreads.size(); ++i) {
-        if (renderThreads[i])
-            film->AddFilm(*(((PathOCLRenderThread *)(renderThreads[i]))->threadFilms[0]->film));
+        if (renderThreads[i]) {
+            PathOCLRenderThread *thread = (PathOCLRenderThread *)(renderThreads[i]);
+            film->AddFilm(*(thread->threadFilms[0]->film));
+
+            // Add the samples rendered while the kernels were compiled
+            if (thread->fallbackFilm) {
+                boost::unique_lock<boost::mutex> lock(thread->fallbackFilmMutex);
+                film->AddFilm(*(thread->fallbackFilm));
+            }
+        }
     }
 }
 
@@ -160,10 +173,16 @@ void PathOCLRenderEngine::UpdateCounters() {
 	// Update the sample count statistic
 	double totalCount = 0;
 	for (size_t i = 0; i < renderThreads.size(); ++i) {
-		slg::ocl::pathocl::GPUTaskStats *stats = ((PathOCLRenderThread *)(renderThreads[i]))->gpuTaskStats;
+		PathOCLRenderThread *thread = (PathOCLRenderThread *)(renderThreads[i]);
+		slg::ocl::pathocl::GPUTaskStats *stats = thread->gpuTaskStats;
 
 		for (size_t i = 0; i < taskCount; ++i)
 			totalCount += stats[i].sampleCount;
+
+		if (thread->fallbackFilm) {
+			boost::unique_lock<boost::mutex> lock(thread->fallbackFilmMutex);
+			totalCount += thread->fallbackFilm->GetTotalSampleCount();
+		}
 	}
 
 	samplesCount = totalCount;
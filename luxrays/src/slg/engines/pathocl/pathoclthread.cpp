@@ -18,6 +18,8 @@
 
 #if !defined(LUXRAYS_DISABLE_OPENCL)
 
+#include <memory>
+
 #include <boost/lexical_cast.hpp>
 
 #include "luxrays/core/geometry/transform.h"
@@ -31,7 +33,10 @@
 #include "slg/renderconfig.h"
 #include "slg/engines/pathocl/pathocl.h"
 #include "slg/engines/pathocl/pathocl_datatypes.h"
+#include "slg/engines/pathtracer.h"
 #include "slg/samplers/sobol.h"
+#include "slg/samplers/random.h"
+#include "slg/film/filmsamplesplatter.h"
 
 using namespace std;
 using namespace luxrays;
@@ -47,6 +52,7 @@ PathOCLRenderThread::PathOCLRenderThread(const u_int index,
 		OpenCLIntersectionDevice *device, PathOCLRenderEngine *re) :
 		PathOCLBaseRenderThread(index, device, re) {
 	gpuTaskStats = NULL;
+	fallbackFilm = NULL;
 
 	initKernel = NULL;
 	advancePathsKernel_MK_RT_NEXT_VERTEX = NULL;
@@ -92,6 +98,7 @@ PathOCLRenderThread::~PathOCLRenderThread() {
 	delete advancePathsKernel_MK_GENERATE_CAMERA_RAY;
 
 	delete[] gpuTaskStats;
+	delete fallbackFilm;
 }
 
 void PathOCLRenderThread::GetThreadFilmSize(u_int *filmWidth, u_int *filmHeight,
@@ -608,6 +615,14 @@ void PathOCLRenderThread::SetAdditionalKernelArgs() {
 	initKernel->setArg(argIndex++, filmSubRegion[3]);
 }
 
+void PathOCLRenderThread::Start() {
+	// The fallback film has to be allocated before the rendering thread is
+	// started, it is read by the engine while the thread renders
+	InitFallbackFilm();
+
+	PathOCLBaseRenderThread::Start();
+}
+
 void PathOCLRenderThread::Stop() {
 	PathOCLBaseRenderThread::Stop();
 
@@ -624,6 +639,93 @@ void PathOCLRenderThread::Stop() {
 	FreeOCLBuffer(&pixelFilterBuff);
 }
 
+//------------------------------------------------------------------------------
+// CPU fallback
+//
+// The PATHCPU integrator is used to render a preview (radiance and alpha
+// only) while the kernels are compiled in background. The samples are
+// accumulated in fallbackFilm and merged with the OpenCL thread film.
+//------------------------------------------------------------------------------
+
+void PathOCLRenderThread::InitFallbackFilm() {
+	PathOCLRenderEngine *engine = (PathOCLRenderEngine *)renderEngine;
+
+	delete fallbackFilm;
+	fallbackFilm = NULL;
+
+	if (!engine->cpuFallback)
+		return;
+
+	const Film *engineFilm = engine->film;
+	fallbackFilm = new Film(engineFilm->GetWidth(), engineFilm->GetHeight(),
+			engineFilm->GetSubRegion());
+	fallbackFilm->AddChannel(Film::RADIANCE_PER_PIXEL_NORMALIZED);
+	if (engineFilm->HasChannel(Film::ALPHA))
+		fallbackFilm->AddChannel(Film::ALPHA);
+	fallbackFilm->SetRadianceGroupCount(engineFilm->GetRadianceGroupCount());
+	fallbackFilm->Init();
+}
+
+void PathOCLRenderThread::RenderCPUFallback(boost::thread &compileThread) {
+	if (!fallbackFilm) {
+		PathOCLBaseRenderThread::RenderCPUFallback(compileThread);
+		return;
+	}
+
+	PathOCLRenderEngine *engine = (PathOCLRenderEngine *)renderEngine;
+	const Scene *scene = engine->renderConfig->scene;
+
+	// The samples of the previous rendering are not valid anymore
+	if (backgroundKernelsInitClearFilms) {
+		boost::unique_lock<boost::mutex> lock(fallbackFilmMutex);
+		fallbackFilm->Reset();
+	}
+
+	SLG_LOG("[PathOCLRenderThread::" << threadIndex << "] Rendering on the CPU while compiling kernels");
+
+	// The samples are splatted on the film, the fast pixel filter is not used
+	PathTracer pathTracer;
+	pathTracer.maxPathDepth = (u_int)engine->maxPathDepth;
+	pathTracer.rrDepth = (u_int)engine->rrDepth;
+	pathTracer.rrImportanceCap = engine->rrImportanceCap;
+	pathTracer.pdfClampValue = engine->pdfClampValue;
+	pathTracer.forceBlackBackground = engine->forceBlackBackground;
+
+	// (engine->seedBase + 1) seed is used by the OpenCL sampler
+	RandomGenerator rndGen(engine->seedBase + 1 + threadIndex);
+	auto_ptr<Filter> filter(engine->renderConfig->AllocPixelFilter());
+	FilmSampleSplatter splatter(filter.get());
+	RandomSampler sampler(&rndGen, fallbackFilm, &splatter);
+	sampler.RequestSamples(pathTracer.GetSampleSize());
+
+	vector<SampleResult> sampleResults(1);
+	sampleResults[0].Init(Film::RADIANCE_PER_PIXEL_NORMALIZED | Film::ALPHA,
+			fallbackFilm->GetRadianceGroupCount());
+	sampleResults[0].useFilmSplat = true;
+
+	const double startTime = WallClockTime();
+	const double startSampleCount = fallbackFilm->GetTotalSampleCount();
+	while (!compileThread.timed_join(boost::posix_time::seconds(0))) {
+		boost::this_thread::interruption_point();
+
+		// Check if we are in pause mode
+		if (engine->pauseMode) {
+			boost::this_thread::sleep(boost::posix_time::millisec(100));
+			continue;
+		}
+
+		boost::unique_lock<boost::mutex> lock(fallbackFilmMutex);
+		for (u_int i = 0; i < 256; ++i) {
+			pathTracer.RenderSample(intersectionDevice, scene, fallbackFilm, &sampler, sampleResults);
+			sampler.NextSample(sampleResults);
+		}
+	}
+
+	SLG_LOG("[PathOCLRenderThread::" << threadIndex << "] CPU samples rendered while compiling kernels: " <<
+			(fallbackFilm->GetTotalSampleCount() - startSampleCount) << " in " <<
+			int((WallClockTime() - startTime) * 1000.0) << "ms");
+}
+
 void PathOCLRenderThread::EnqueueAdvancePathsKernel(cl::CommandQueue &oclQueue) {
 	PathOCLRenderEngine *engine = (PathOCLRenderEngine *)renderEngine;
 	const u_int taskCount = engine->taskCount;
@@ -37,6 +37,8 @@ CompiledScene::CompiledScene(Scene *scn, Film *flm) {
 	maxMemPageSize = 0xffffffffu;
 
 	lightsDistribution = NULL;
+	geometrySize = 0;
+	flattenedGeometrySize = 0;
 
 	EditActionList editActions;
 	editActions.AddAllAction();
@@ -35,6 +35,17 @@ static bool MeshPtrCompare(Mesh *p0, Mesh *p1) {
 	return p0 < p1;
 }
 
+static size_t GetMeshMemorySize(const ExtMesh *mesh) {
+	const size_t vertCount = mesh->GetTotalVertexCount();
+
+	return vertCount * sizeof(Point) +
+			(mesh->HasNormals() ? vertCount * sizeof(Normal) : 0) +
+			(mesh->HasUVs() ? vertCount * sizeof(UV) : 0) +
+			(mesh->HasColors() ? vertCount * sizeof(Spectrum) : 0) +
+			(mesh->HasAlphas() ? vertCount * sizeof(float) : 0) +
+			mesh->GetTotalTriangleCount() * sizeof(Triangle);
+}
+
 void CompiledScene::CompileGeometry() {
 	SLG_LOG("Compile Geometry");
 
@@ -53,6 +64,12 @@ void CompiledScene::CompileGeometry() {
 
 	//--------------------------------------------------------------------------
 	// Translate geometry
+	//
+	// Instanced and motion blurred meshes are two-level: all the objects
+	// referencing the same base mesh share a single copy of its vertices,
+	// normals, uvs, colors, alphas and triangles (expressed in local
+	// coordinates). Only the mesh descriptor (i.e. the transformation) is
+	// per object.
 	//--------------------------------------------------------------------------
 
 	// Not using boost::unordered_map because because the key is an ExtMesh pointer
@@ -68,53 +85,72 @@ void CompiledScene::CompileGeometry() {
 	memcpy(&newMeshDesc.trans.m, &Matrix4x4::MAT_IDENTITY, sizeof(float[4][4]));
 	memcpy(&newMeshDesc.trans.mInv, &Matrix4x4::MAT_IDENTITY, sizeof(float[4][4]));
 
+	// Used to report the memory saved by the instancing
+	flattenedGeometrySize = 0;
+	u_int sharedMeshCount = 0;
+
 	slg::ocl::Mesh currentMeshDesc;
 	for (u_int i = 0; i < objCount; ++i) {
 		const ExtMesh *mesh = scene->objDefs.GetSceneObject(i)->GetExtMesh();
+		flattenedGeometrySize += GetMeshMemorySize(mesh);
+
+		// Look for the base mesh and the local to world transformation
+		ExtMesh *baseMesh;
+		Transform local2World;
+		switch (mesh->GetType()) {
+			case TYPE_EXT_TRIANGLE_INSTANCE: {
+				// It is an instanced mesh
+				const ExtInstanceTriangleMesh *imesh = (const ExtInstanceTriangleMesh *)mesh;
+				baseMesh = imesh->GetExtTriangleMesh();
+				local2World = imesh->GetTransformation();
+				break;
+			}
+			case TYPE_EXT_TRIANGLE_MOTION: {
+				// It is a motion blurred mesh
+				//
+				// TODO: Motion blur is not supported by the hit point
+				// computation, the transformation at time 0 is used (as
+				// when the mesh was flatten in world coordinates)
+				const ExtMotionTriangleMesh *mmesh = (const ExtMotionTriangleMesh *)mesh;
+				baseMesh = mmesh->GetExtTriangleMesh();
+				local2World = Transform(mmesh->GetMotionSystem().Sample(0.f));
+				break;
+			}
+			default:
+				// It is a not instanced mesh
+				baseMesh = NULL;
+				break;
+		}
 
 		bool isExistingInstance;
-		// TODO: Motion blur is not supported here (!)
-		if (mesh->GetType() == TYPE_EXT_TRIANGLE_INSTANCE) {
-			// It is an instanced mesh
-			ExtInstanceTriangleMesh *imesh = (ExtInstanceTriangleMesh *)mesh;
-
+		if (baseMesh) {
 			// Check if is one of the already defined meshes
-			map<ExtMesh *, u_int, bool (*)(Mesh *, Mesh *)>::iterator it = definedMeshs.find(imesh->GetExtTriangleMesh());
+			map<ExtMesh *, u_int, bool (*)(Mesh *, Mesh *)>::iterator it = definedMeshs.find(baseMesh);
 			if (it == definedMeshs.end()) {
 				// It is a new one
 				currentMeshDesc = newMeshDesc;
-
-				newMeshDesc.vertsOffset += mesh->GetTotalVertexCount();
-				newMeshDesc.trisOffset += mesh->GetTotalTriangleCount();
-				if (mesh->HasNormals())
-					newMeshDesc.normalsOffset += mesh->GetTotalVertexCount();
-				if (mesh->HasUVs())
-					newMeshDesc.uvsOffset += mesh->GetTotalVertexCount();
-				if (mesh->HasColors())
-					newMeshDesc.colsOffset += mesh->GetTotalVertexCount();
-				if (mesh->HasAlphas())
-					newMeshDesc.alphasOffset += mesh->GetTotalVertexCount();
-
 				isExistingInstance = false;
 
 				const u_int index = meshDescs.size();
-				definedMeshs[imesh->GetExtTriangleMesh()] = index;
+				definedMeshs[baseMesh] = index;
 			} else {
 				currentMeshDesc = meshDescs[it->second];
-
 				isExistingInstance = true;
+				++sharedMeshCount;
 			}
 
 			// Overwrite the only different fields in an instanced mesh
-			memcpy(&currentMeshDesc.trans.m, &imesh->GetTransformation().m, sizeof(float[4][4]));
-			memcpy(&currentMeshDesc.trans.mInv, &imesh->GetTransformation().mInv, sizeof(float[4][4]));
+			memcpy(&currentMeshDesc.trans.m, &local2World.m, sizeof(float[4][4]));
+			memcpy(&currentMeshDesc.trans.mInv, &local2World.mInv, sizeof(float[4][4]));
 
 			// In order to express normals and vertices in local coordinates
-			mesh = imesh->GetExtTriangleMesh();
+			mesh = baseMesh;
 		} else {
-			// It is a not instanced mesh
 			currentMeshDesc = newMeshDesc;
+			isExistingInstance = false;
+		}
 
+		if (!isExistingInstance) {
 			newMeshDesc.vertsOffset += mesh->GetTotalVertexCount();
 			newMeshDesc.trisOffset += mesh->GetTotalTriangleCount();
 			if (mesh->HasNormals())
@@ -126,13 +162,6 @@ void CompiledScene::CompileGeometry() {
 			if (mesh->HasAlphas())
 				newMeshDesc.alphasOffset += mesh->GetTotalVertexCount();
 
-			memcpy(&currentMeshDesc.trans.m, &Matrix4x4::MAT_IDENTITY, sizeof(float[4][4]));
-			memcpy(&currentMeshDesc.trans.mInv, &Matrix4x4::MAT_IDENTITY, sizeof(float[4][4]));
-
-			isExistingInstance = false;
-		}
-
-		if (!isExistingInstance) {
 			//------------------------------------------------------------------
 			// Translate mesh normals (expressed in local coordinates)
 			//------------------------------------------------------------------
@@ -194,6 +223,24 @@ void CompiledScene::CompileGeometry() {
 
 	worldBSphere = scene->dataSet->GetBSphere();
 
+	//--------------------------------------------------------------------------
+	// Memory usage
+	//--------------------------------------------------------------------------
+
+	const size_t meshDescsSize = meshDescs.size() * sizeof(slg::ocl::Mesh);
+	geometrySize = verts.size() * sizeof(Point) +
+			normals.size() * sizeof(Normal) +
+			uvs.size() * sizeof(UV) +
+			cols.size() * sizeof(Spectrum) +
+			alphas.size() * sizeof(float) +
+			tris.size() * sizeof(Triangle) +
+			meshDescsSize;
+	flattenedGeometrySize += meshDescsSize;
+
+	SLG_LOG("Shared mesh instances: " << sharedMeshCount << "/" << objCount);
+	SLG_LOG("Geometry memory size: " << geometrySize / 1024 << "Kbytes (" <<
+			flattenedGeometrySize / 1024 << "Kbytes without instancing)");
+
 	const double tEnd = WallClockTime();
 	SLG_LOG("Scene geometry compilation time: " << int((tEnd - tStart) * 1000.0) << "ms");
 }
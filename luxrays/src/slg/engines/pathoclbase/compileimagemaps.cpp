@@ -28,6 +28,7 @@
 #include "slg/kernels/kernels.h"
 
 #include "slg/imagemap/imagemap.h"
+#include "slg/textures/densitygrid.h"
 
 using namespace std;
 using namespace luxrays;
@@ -46,6 +47,26 @@ void CompiledScene::AddEnabledImageMapCode() {
 	if (enabledCode.count("IMAGEMAPS_4xCHANNELS")) usedImageMapChannels.insert(4);	
 }
 
+static u_int GetImageMapMemPage(vector<vector<float> > &imageMapMemBlocks,
+		const size_t maxMemPageSize, const size_t memSize) {
+	if (memSize > maxMemPageSize)
+		throw runtime_error("An image map is too big to fit in a single block of memory");
+
+	for (u_int j = 0; j < imageMapMemBlocks.size(); ++j) {
+		// Check if it fits in this page
+		if (memSize + imageMapMemBlocks[j].size() * sizeof(float) <= maxMemPageSize)
+			return j;
+	}
+
+	// Check if I can add a new page
+	if (imageMapMemBlocks.size() > 8)
+		throw runtime_error("More than 8 blocks of memory are required for image maps");
+
+	// Add a new page
+	imageMapMemBlocks.push_back(vector<float>());
+	return imageMapMemBlocks.size() - 1;
+}
+
 void CompiledScene::CompileImageMaps() {
 	SLG_LOG("Compile ImageMaps");
 
@@ -73,30 +94,7 @@ void CompiledScene::CompileImageMaps() {
 		const u_int pixelCount = im->GetWidth() * im->GetHeight();
 		const size_t memSize = RoundUp(im->GetStorage()->GetMemorySize(), sizeof(float));
 
-		if (memSize > maxMemPageSize)
-			throw runtime_error("An image map is too big to fit in a single block of memory");
-
-		bool found = false;
-		u_int page;
-		for (u_int j = 0; j < imageMapMemBlocks.size(); ++j) {
-			// Check if it fits in this page
-			if (memSize + imageMapMemBlocks[j].size() * sizeof(float) <= maxMemPageSize) {
-				found = true;
-				page = j;
-				break;
-			}
-		}
-
-		if (!found) {
-			// Check if I can add a new page
-			if (imageMapMemBlocks.size() > 8)
-				throw runtime_error("More than 8 blocks of memory are required for image maps");
-
-			// Add a new page
-			imageMapMemBlocks.push_back(vector<float>());
-			page = imageMapMemBlocks.size() - 1;
-		}
-
+		const u_int page = GetImageMapMemPage(imageMapMemBlocks, maxMemPageSize, memSize);
 		vector<float> &imageMapMemBlock = imageMapMemBlocks[page];
 
 		imd->channelCount = im->GetChannelCount();
@@ -139,6 +137,54 @@ void CompiledScene::CompileImageMaps() {
 		usedImageMapChannels.insert(im->GetChannelCount());
 	}
 
+	//--------------------------------------------------------------------------
+	// Translate density grids
+	//
+	// The data of each DensityGridTexture are stored as a 1 channel float
+	// image map, in the same order used by CompileTextures()
+	//--------------------------------------------------------------------------
+
+	const u_int texturesCount = scene->texDefs.GetSize();
+	for (u_int i = 0; i < texturesCount; ++i) {
+		const Texture *t = scene->texDefs.GetTexture(i);
+		if (t->GetType() != DENSITYGRID_TEX)
+			continue;
+
+		const SparseDensityGrid *grid = static_cast<const DensityGridTexture *>(t)->GetGrid();
+		const vector<u_int> &brickIndices = grid->GetBrickIndices();
+		const vector<float> &brickMins = grid->GetBrickMins();
+		const vector<float> &brickMaxs = grid->GetBrickMaxs();
+		const vector<u_char> &voxels = grid->GetVoxelsData();
+
+		// The layout is: brick indices, brick min. values, brick max. values and voxels
+		const size_t brickCount = brickIndices.size();
+		const size_t voxelsSizeInFloat = RoundUp(voxels.size(), sizeof(float)) / sizeof(float);
+		const size_t dataSizeInFloat = 3 * brickCount + voxelsSizeInFloat;
+
+		const u_int page = GetImageMapMemPage(imageMapMemBlocks, maxMemPageSize, dataSizeInFloat * sizeof(float));
+		vector<float> &imageMapMemBlock = imageMapMemBlocks[page];
+
+		slg::ocl::ImageMap imd;
+		imd.channelCount = 1;
+		imd.width = dataSizeInFloat;
+		imd.height = 1;
+		imd.pageIndex = page;
+		imd.pixelsIndex = (u_int)imageMapMemBlock.size();
+		imd.storageType = slg::ocl::FLOAT;
+		imageMapDescs.push_back(imd);
+
+		const size_t start = imageMapMemBlock.size();
+		imageMapMemBlock.resize(start + dataSizeInFloat, 0.f);
+		memcpy(&imageMapMemBlock[start], &brickIndices[0], brickCount * sizeof(u_int));
+		copy(brickMins.begin(), brickMins.end(), &imageMapMemBlock[start + brickCount]);
+		copy(brickMaxs.begin(), brickMaxs.end(), &imageMapMemBlock[start + 2 * brickCount]);
+		if (voxels.size() > 0)
+			memcpy(&imageMapMemBlock[start + 3 * brickCount], &voxels[0], voxels.size());
+
+		usedImageMapFormats.insert(ImageMapStorage::FLOAT);
+		usedImageMapChannels.insert(1);
+	}
+
 	SLG_LOG("Image maps page(s) count: " << imageMapMemBlocks.size());
 	for (u_int i = 0; i < imageMapMemBlocks.size(); ++i)
 		SLG_LOG(" RGB channel page " << i << " size: " << imageMapMemBlocks[i].size() * sizeof(float) / 1024 << "Kbytes");
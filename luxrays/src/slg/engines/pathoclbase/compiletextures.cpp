@@ -40,6 +40,7 @@
 #include "slg/textures/constfloat.h"
 #include "slg/textures/constfloat3.h"
 #include "slg/textures/cloud.h"
+#include "slg/textures/densitygrid.h"
 #include "slg/textures/dots.h"
 #include "slg/textures/fbm.h"
 #include "slg/textures/fresnelapprox.h"
@@ -182,6 +183,11 @@ void CompiledScene::CompileTextures() {
 
 	texs.resize(texturesCount);
 
+	// Density grids data are appended after the image maps by CompileImageMaps().
+	// Scene::AddImageMapsEditAction() requests a textures recompilation when
+	// the image maps change.
+	u_int densityGridIndex = scene->imgMapCache.GetSize();
+
 	for (u_int i = 0; i < texturesCount; ++i) {
 		Texture *t = scene->texDefs.GetTexture(i);
 		slg::ocl::Texture *tex = &texs[i];
@@ -1047,6 +1053,35 @@ void CompiledScene::CompileTextures() {
 				tex->hsvTex.valTexIndex = scene->texDefs.GetTextureIndex(ht->GetValue());
 				break;
 			}
+			case DENSITYGRID_TEX: {
+				DensityGridTexture *dgt = static_cast<DensityGridTexture *>(t);
+				const SparseDensityGrid *grid = dgt->GetGrid();
+
+				tex->type = slg::ocl::DENSITYGRID_TEX;
+				CompileTextureMapping3D(&tex->densityGrid.mapping, dgt->GetTextureMapping());
+				tex->densityGrid.nx = grid->GetNx();
+				tex->densityGrid.ny = grid->GetNy();
+				tex->densityGrid.nz = grid->GetNz();
+				tex->densityGrid.bricksX = grid->GetBricksX();
+				tex->densityGrid.bricksY = grid->GetBricksY();
+				tex->densityGrid.bricksZ = grid->GetBricksZ();
+				switch (grid->GetStorageType()) {
+					case ImageMapStorage::BYTE:
+						tex->densityGrid.storageType = slg::ocl::BYTE;
+						break;
+					case ImageMapStorage::HALF:
+						tex->densityGrid.storageType = slg::ocl::HALF;
+						break;
+					case ImageMapStorage::FLOAT:
+						tex->densityGrid.storageType = slg::ocl::FLOAT;
+						break;
+					default:
+						throw runtime_error("Unknown density grid storage type in CompiledScene::CompileTextures(): " + boost::lexical_cast<string>(grid->GetStorageType()));
+				}
+				tex->densityGrid.wrapMode = dgt->GetWrapMode();
+				tex->densityGrid.imageMapIndex = densityGridIndex++;
+				break;
+			}
 			default:
 				throw runtime_error("Unknown texture in CompiledScene::CompileTextures(): " + boost::lexical_cast<string>(t->GetType()));
 				break;
@@ -1085,6 +1120,9 @@ static string AddTextureSourceCall(const vector<slg::ocl::Texture> &texs,
 		case slg::ocl::NORMALMAP_TEX:
 			ss << "NormalMapTexture_ConstEvaluate" << type << "(&texs[" << i << "])";
 			break;
+		case slg::ocl::DENSITYGRID_TEX:
+			ss << "DensityGridTexture_ConstEvaluate" << type << "(&texs[" << i << "], hitPoint IMAGEMAPS_PARAM)";
+			break;
 		default:
 			ss << "Texture_Index" << i << "_Evaluate" << type << "(&texs[" << i << "], hitPoint TEXTURES_PARAM)";
 			break;
@@ -1339,6 +1377,10 @@ static void AddTexturesSwitchSourceCode(stringstream &source,
 			"#if defined(PARAM_ENABLE_TEX_IMAGEMAP) && defined(PARAM_HAS_IMAGEMAPS)\n"
 			"\t\tcase IMAGEMAP: return ImageMapTexture_ConstEvaluate" << type << "(tex, hitPoint IMAGEMAPS_PARAM);\n"
 			"#endif\n"
+			// I can have a DENSITYGRID texture only if PARAM_HAS_IMAGEMAPS is defined
+			"#if defined(PARAM_ENABLE_TEX_DENSITYGRID) && defined(PARAM_HAS_IMAGEMAPS)\n"
+			"\t\tcase DENSITYGRID_TEX: return DensityGridTexture_ConstEvaluate" << type << "(tex, hitPoint IMAGEMAPS_PARAM);\n"
+			"#endif\n"
 			"#if defined(PARAM_ENABLE_TEX_FRESNELCONST)\n"
 			"\t\tcase FRESNELCONST_TEX: return FresnelConstTexture_ConstEvaluate" << type << "(tex);\n"
 			"#endif\n"
@@ -1367,6 +1409,7 @@ static void AddTexturesSwitchSourceCode(stringstream &source,
 			case slg::ocl::FRESNELCONST_TEX:
 			case slg::ocl::FRESNELCOLOR_TEX:
 			case slg::ocl::NORMALMAP_TEX:
+			case slg::ocl::DENSITYGRID_TEX:
 				// For textures source code that it is not dynamically generated
 				break;
 			default:
@@ -1396,6 +1439,7 @@ string CompiledScene::GetTexturesEvaluationSourceCode() const {
 			case slg::ocl::FRESNELCONST_TEX:
 			case slg::ocl::FRESNELCOLOR_TEX:
 			case slg::ocl::NORMALMAP_TEX:
+			case slg::ocl::DENSITYGRID_TEX:
 				// Constant textures source code is not dynamically generated
 				break;
 			case slg::ocl::SCALE_TEX: {
@@ -55,6 +55,7 @@ PathOCLBaseRenderEngine::PathOCLBaseRenderEngine(const RenderConfig *rcfg, Film
 	compiledScene = NULL;
 	additionalKernelOptions = "";
 	writeKernelsToFile = false;
+	backgroundKernelCompilation = false;
 
 	//--------------------------------------------------------------------------
 	// Allocate devices
@@ -135,6 +136,9 @@ void PathOCLBaseRenderEngine::StartLockLess() {
 	// Suggested compiler options: -cl-fast-relaxed-math -cl-strict-aliasing -cl-mad-enable
 	additionalKernelOptions = cfg.Get(Property("opencl.kernel.options")("")).Get<std::string>();
 	writeKernelsToFile = cfg.Get(Property("opencl.kernel.writetofile")(false)).Get<bool>();
+	// RT engines have their own kernel initialization
+	backgroundKernelCompilation = (GetType() != RTPATHOCL) && (GetType() != RTBIASPATHOCL) &&
+			cfg.Get(Property("opencl.kernel.compile.background")(false)).Get<bool>();
 	
 	//--------------------------------------------------------------------------
 	// Compile the scene
@@ -199,6 +203,36 @@ bool PathOCLBaseRenderEngine::HasDone() const {
 	return true;
 }
 
+u_int PathOCLBaseRenderEngine::GetKernelCacheHitCount() const {
+	u_int count = 0;
+	for (size_t i = 0; i < renderThreads.size(); ++i) {
+		if (renderThreads[i])
+			count += renderThreads[i]->kernelCache->GetHitCount();
+	}
+
+	return count;
+}
+
+u_int PathOCLBaseRenderEngine::GetKernelCacheMissCount() const {
+	u_int count = 0;
+	for (size_t i = 0; i < renderThreads.size(); ++i) {
+		if (renderThreads[i])
+			count += renderThreads[i]->kernelCache->GetMissCount();
+	}
+
+	return count;
+}
+
+u_int PathOCLBaseRenderEngine::GetKernelCacheEvictionCount() const {
+	u_int count = 0;
+	for (size_t i = 0; i < renderThreads.size(); ++i) {
+		if (renderThreads[i])
+			count += renderThreads[i]->kernelCache->GetEvictionCount();
+	}
+
+	return count;
+}
+
 void PathOCLBaseRenderEngine::WaitForDone() const {
 	for (size_t i = 0; i < renderThreads.size(); ++i)
 		renderThreads[i]->WaitForDone();
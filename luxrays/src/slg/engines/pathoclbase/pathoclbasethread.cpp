@@ -551,6 +551,8 @@ PathOCLBaseRenderThread::PathOCLBaseRenderThread(const u_int index,
 	renderEngine = re;
 	started = false;
 	editMode = false;
+	backgroundKernelsInit = false;
+	backgroundKernelsInitClearFilms = false;
 
 	kernelSrcHash = "";
 	filmClearKernel = NULL;
@@ -578,9 +580,12 @@ PathOCLBaseRenderThread::PathOCLBaseRenderThread(const u_int index,
 
 	// Check the kind of kernel cache to use
 	string type = renderEngine->renderConfig->cfg.Get(Property("opencl.kernelcache")("PERSISTENT")).Get<string>();
-	if (type == "PERSISTENT")
-		kernelCache = new oclKernelPersistentCache("LUXCORE_" LUXCORE_VERSION_MAJOR "." LUXCORE_VERSION_MINOR);
-	else if (type == "VOLATILE")
+	if (type == "PERSISTENT") {
+		// The default max. size of the persistent cache is 256MB (0 means no limit)
+		const u_longlong maxSize = renderEngine->renderConfig->cfg.Get(
+				Property("opencl.kernelcache.persistent.maxsize")(256ull * 1024ull * 1024ull)).Get<u_longlong>();
+		kernelCache = new oclKernelPersistentCache("LUXCORE_" LUXCORE_VERSION_MAJOR "." LUXCORE_VERSION_MINOR, maxSize);
+	} else if (type == "VOLATILE")
 		kernelCache = new oclKernelVolatileCache();
 	else if (type == "NONE")
 		kernelCache = new oclKernelDummyCache();
@@ -890,6 +895,8 @@ void PathOCLBaseRenderThread::InitKernels() {
 			break;
 		case ACCEL_EMBREE:
 			throw runtime_error("EMBRRE accelerator is not supported in PathOCLBaseRenderThread::InitKernels()");
+		case ACCEL_CQBVH:
+			throw runtime_error("CQBVH accelerator is not supported in PathOCLBaseRenderThread::InitKernels()");
 		default:
 			throw runtime_error("Unknown accelerator in PathOCLBaseRenderThread::InitKernels()");
 	}
@@ -1048,6 +1055,8 @@ void PathOCLBaseRenderThread::InitKernels() {
 		ssParams << " -D PARAM_ENABLE_TEX_COLORDEPTH";
 	if (cscene->IsTextureCompiled(HSV_TEX))
 		ssParams << " -D PARAM_ENABLE_TEX_HSV";
+	if (cscene->IsTextureCompiled(DENSITYGRID_TEX))
+		ssParams << " -D PARAM_ENABLE_TEX_DENSITYGRID";
 
 	if (cscene->IsMaterialCompiled(MATTE))
 		ssParams << " -D PARAM_ENABLE_MAT_MATTE";
@@ -1308,6 +1317,7 @@ void PathOCLBaseRenderThread::InitKernels() {
 		slg::ocl::KernelSource_texture_blackbody_funcs <<
 		slg::ocl::KernelSource_texture_clamp_funcs <<
 		slg::ocl::KernelSource_texture_colordepth_funcs <<
+		slg::ocl::KernelSource_texture_densitygrid_funcs <<
 		slg::ocl::KernelSource_texture_fresnelcolor_funcs <<
 		slg::ocl::KernelSource_texture_fresnelconst_funcs <<
 		slg::ocl::KernelSource_texture_hsv_funcs <<
@@ -1474,6 +1484,17 @@ void PathOCLBaseRenderThread::InitRender() {
 
 	AdditionalInit();
 
+	if (renderEngine->backgroundKernelCompilation) {
+		// Kernels are compiled (and the thread films cleared) by the rendering
+		// thread, see BackgroundInitKernels()
+		backgroundKernelsInit = true;
+		backgroundKernelsInitClearFilms = true;
+
+		// Reset statistics in order to be more accurate
+		intersectionDevice->ResetPerformaceStats();
+		return;
+	}
+
 	//--------------------------------------------------------------------------
 	// Compile kernels
 	//--------------------------------------------------------------------------
@@ -1554,8 +1575,72 @@ void PathOCLBaseRenderThread::Stop() {
 }
 
 void PathOCLBaseRenderThread::StartRenderThread() {
+	// The error of a previous background kernel compilation is reset here,
+	// before the new thread is started, so WaitForDone() can read it safely
+	kernelsCompilationError = "";
+
 	// Create the thread for the rendering
-	renderThread = new boost::thread(&PathOCLBaseRenderThread::RenderThreadImpl, this);
+	renderThread = new boost::thread(&PathOCLBaseRenderThread::RenderThread, this);
+}
+
+void PathOCLBaseRenderThread::RenderThread() {
+	if (backgroundKernelsInit) {
+		backgroundKernelsInit = false;
+
+		if (!BackgroundInitKernels())
+			return;
+	}
+
+	RenderThreadImpl();
+}
+
+void PathOCLBaseRenderThread::CompileKernelsThreadImpl() {
+	try {
+		InitKernels();
+	} catch (cl::Error &err) {
+		kernelsCompilationError = string(err.what()) + "(" + oclErrorString(err.err()) + ")";
+	} catch (std::exception &err) {
+		kernelsCompilationError = err.what();
+	}
+}
+
+void PathOCLBaseRenderThread::RenderCPUFallback(boost::thread &compileThread) {
+	compileThread.join();
+}
+
+bool PathOCLBaseRenderThread::BackgroundInitKernels() {
+	boost::thread compileThread(&PathOCLBaseRenderThread::CompileKernelsThreadImpl, this);
+
+	bool interrupted = false;
+	try {
+		RenderCPUFallback(compileThread);
+	} catch (boost::thread_interrupted) {
+		interrupted = true;
+	}
+
+	// The compilation can not be aborted, I have always to wait for its end
+	{
+		boost::this_thread::disable_interruption di;
+		compileThread.join();
+	}
+
+	if (kernelsCompilationError != "") {
+		SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Background kernel compilation ERROR: " <<
+				kernelsCompilationError);
+		// The error is thrown by WaitForDone()
+		return false;
+	}
+
+	// The thread films are initialized even if the rendering has been
+	// interrupted because they are transferred by Stop()
+	SetKernelArgs();
+
+	cl::CommandQueue &oclQueue = intersectionDevice->GetOpenCLQueue();
+	if (backgroundKernelsInitClearFilms)
+		ClearThreadFilms(oclQueue);
+	oclQueue.finish();
+
+	return !interrupted && !boost::this_thread::interruption_requested();
 }
 
 void PathOCLBaseRenderThread::StopRenderThread() {
@@ -1627,6 +1712,18 @@ void PathOCLBaseRenderThread::EndSceneEdit(const EditActionList &editActions) {
 	// - Image types edit;
 	// - Geometry type edit;
 	// - etc.
+	if (renderEngine->backgroundKernelCompilation) {
+		// Kernels are compiled by the rendering thread, see BackgroundInitKernels()
+		backgroundKernelsInit = true;
+		backgroundKernelsInitClearFilms = editActions.HasAnyAction();
+
+		// Reset statistics in order to be more accurate
+		intersectionDevice->ResetPerformaceStats();
+
+		StartRenderThread();
+		return;
+	}
+
 	InitKernels();
 
 	if (editActions.HasAnyAction()) {
@@ -1655,6 +1752,12 @@ bool PathOCLBaseRenderThread::HasDone() const {
 void PathOCLBaseRenderThread::WaitForDone() const {
 	if (renderThread)
 		renderThread->join();
+
+	// A background kernel compilation error stops the rendering thread and
+	// it is reported to the application like a synchronous compilation error
+	if (kernelsCompilationError != "")
+		throw runtime_error("Error while compiling OpenCL kernels of device " +
+				intersectionDevice->GetName() + ": " + kernelsCompilationError);
 }
 
 void PathOCLBaseRenderThread::IncThreadFilms() {
@@ -30,6 +30,7 @@
 #include "slg/film/imagepipeline/plugins/tonemaps/autolinear.h"
 
 #include "luxrays/core/intersectiondevice.h"
+#include "luxrays/utils/timeline.h"
 #if !defined(LUXRAYS_DISABLE_OPENCL)
 #include "luxrays/core/ocldevice.h"
 #endif
@@ -48,6 +49,7 @@ RenderEngine::RenderEngine(const RenderConfig *cfg, Film *flm, boost::mutex *flm
 	pixelFilter = NULL;
 	film = flm;
 	filmMutex = flmMutex;
+	startFilm = NULL;
 	started = false;
 	editMode = false;
 	pauseMode = false;
@@ -91,6 +93,8 @@ void RenderEngine::Start() {
 	assert (!started);
 	started = true;
 
+	TimelineScope timelineScope("Render engine start", "engine");
+
 	delete pixelFilter;
 	pixelFilter = renderConfig->AllocPixelFilter();
 
@@ -99,12 +103,18 @@ void RenderEngine::Start() {
 	const float epsilonMax = renderConfig->GetProperty("scene.epsilon.max").Get<float>();
 	MachineEpsilon::SetMax(epsilonMax);
 
-	ctx->Start();
+	{
+		TimelineScope ctxTimelineScope("LuxRays context start", "engine");
+		ctx->Start();
+	}
 	
 	// Only at this point I can safely trace the auto-focus ray
 	renderConfig->scene->camera->UpdateFocus(renderConfig->scene);
 
-	StartLockLess();
+	{
+		TimelineScope engineTimelineScope("Engine start ", GetTag(), "engine");
+		StartLockLess();
+	}
 
 	samplesCount = 0;
 	elapsedTime = 0.0f;
@@ -231,6 +241,36 @@ void RenderEngine::GenerateNewSeed() {
 	seedBase = seedBaseGenerator.uintValue();
 }
 
+Properties RenderEngine::GetCheckpointState() {
+	if (!HasCheckpointSupport())
+		throw runtime_error("Render engine " + GetTag() + " doesn't support checkpoints");
+
+	boost::unique_lock<boost::mutex> lock(engineMutex);
+
+	// The rendering is resumed with a new seed so the threads don't repeat
+	// the random number sequences already used
+	return Properties() <<
+			Property("checkpoint.renderengine.type")(GetTag()) <<
+			Property("checkpoint.seed")(Max(1u, (u_int)seedBaseGenerator.uintValue()));
+}
+
+void RenderEngine::SetCheckpoint(const Film *flm, const Properties &state) {
+	if (!HasCheckpointSupport())
+		throw runtime_error("Render engine " + GetTag() + " doesn't support checkpoints");
+	if (started)
+		throw runtime_error("A checkpoint can be set only before starting the rendering");
+
+	const string engineType = state.Get(Property("checkpoint.renderengine.type")("")).Get<string>();
+	if (engineType != GetTag())
+		throw runtime_error("The checkpoint has been saved by a different render engine: " + engineType);
+	if ((flm->GetWidth() != film->GetWidth()) || (flm->GetHeight() != film->GetHeight()))
+		throw runtime_error("The checkpoint film has a different size: " +
+				ToString(flm->GetWidth()) + "x" + ToString(flm->GetHeight()));
+
+	startFilm = flm;
+	startState = state;
+}
+
 void RenderEngine::UpdateFilm() {
 	boost::unique_lock<boost::mutex> lock(engineMutex);
 
@@ -344,4 +384,5 @@ OBJECTSTATICREGISTRY_REGISTER(RenderEngineRegistry, BiasPathCPURenderEngine);
 OBJECTSTATICREGISTRY_REGISTER(RenderEngineRegistry, BiasPathOCLRenderEngine);
 OBJECTSTATICREGISTRY_REGISTER(RenderEngineRegistry, RTBiasPathOCLRenderEngine);
 #endif
+OBJECTSTATICREGISTRY_REGISTER(RenderEngineRegistry, WavefrontPathCPURenderEngine);
 // Just add here any new RenderEngine (don't forget in the .h too)
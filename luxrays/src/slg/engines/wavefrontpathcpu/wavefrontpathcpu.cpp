@@ -0,0 +1,69 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include "slg/engines/wavefrontpathcpu/wavefrontpathcpu.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// WavefrontPathCPURenderEngine
+//------------------------------------------------------------------------------
+
+WavefrontPathCPURenderEngine::WavefrontPathCPURenderEngine(const RenderConfig *rcfg, Film *flm, boost::mutex *flmMutex) :
+		PathCPURenderEngine(rcfg, flm, flmMutex) {
+}
+
+void WavefrontPathCPURenderEngine::StartLockLess() {
+	const Properties &cfg = renderConfig->cfg;
+
+	//--------------------------------------------------------------------------
+	// Rendering parameters
+	//--------------------------------------------------------------------------
+
+	wavefrontSize = Max(1u, cfg.Get(GetDefaultProps().Get("wavefrontpath.size")).Get<u_int>());
+	sortPaths = cfg.Get(GetDefaultProps().Get("wavefrontpath.sort.enable")).Get<bool>();
+
+	PathCPURenderEngine::StartLockLess();
+}
+
+//------------------------------------------------------------------------------
+// Static methods used by RenderEngineRegistry
+//------------------------------------------------------------------------------
+
+Properties WavefrontPathCPURenderEngine::ToProperties(const Properties &cfg) {
+	return PathCPURenderEngine::ToProperties(cfg) <<
+			cfg.Get(GetDefaultProps().Get("renderengine.type")) <<
+			cfg.Get(GetDefaultProps().Get("wavefrontpath.size")) <<
+			cfg.Get(GetDefaultProps().Get("wavefrontpath.sort.enable"));
+}
+
+RenderEngine *WavefrontPathCPURenderEngine::FromProperties(const RenderConfig *rcfg, Film *flm, boost::mutex *flmMutex) {
+	return new WavefrontPathCPURenderEngine(rcfg, flm, flmMutex);
+}
+
+const Properties &WavefrontPathCPURenderEngine::GetDefaultProps() {
+	static Properties props = Properties() <<
+			PathCPURenderEngine::GetDefaultProps() <<
+			Property("renderengine.type")(GetObjectTag()) <<
+			Property("wavefrontpath.size")(512) <<
+			Property("wavefrontpath.sort.enable")(true);
+
+	return props;
+}
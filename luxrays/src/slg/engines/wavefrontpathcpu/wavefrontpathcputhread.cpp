@@ -0,0 +1,606 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <limits>
+
+#include "slg/engines/wavefrontpathcpu/wavefrontpathcpu.h"
+#include "slg/volumes/volume.h"
+#include "slg/utils/varianceclamping.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+// The same sample layout used by PathTracer::RenderSample()
+static const u_int sampleBootSize = PathTracer::sampleBootSize;
+static const u_int sampleStepSize = PathTracer::sampleStepSize;
+
+//------------------------------------------------------------------------------
+// WavefrontPathCPU RenderThread
+//------------------------------------------------------------------------------
+
+WavefrontPathCPURenderThread::WavefrontPathCPURenderThread(WavefrontPathCPURenderEngine *engine,
+		const u_int index, IntersectionDevice *device) :
+		PathCPURenderThread(engine, index, device), rndGen(NULL) {
+}
+
+WavefrontPathCPURenderThread::~WavefrontPathCPURenderThread() {
+	FreePaths();
+}
+
+void WavefrontPathCPURenderThread::AllocPaths(const u_int sampleSize) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	const u_int size = engine->wavefrontSize;
+
+	states.resize(size, GENERATE_EYE_RAY);
+
+	// Each path has its own sampler because the samplers keep the state of
+	// the current sample
+	samplers.resize(size, NULL);
+	sampleResults.resize(size);
+	for (u_int i = 0; i < size; ++i) {
+		samplers[i] = engine->renderConfig->AllocSampler(rndGen, threadFilm, engine->sampleSplatter,
+				engine->samplerSharedData);
+		samplers[i]->RequestSamples(sampleSize);
+
+		sampleResults[i].resize(1);
+		SampleResult &sampleResult = sampleResults[i][0];
+		sampleResult.Init(Film::RADIANCE_PER_PIXEL_NORMALIZED | Film::ALPHA | Film::DEPTH |
+			Film::POSITION | Film::GEOMETRY_NORMAL | Film::SHADING_NORMAL | Film::MATERIAL_ID |
+			Film::DIRECT_DIFFUSE | Film::DIRECT_GLOSSY | Film::EMISSION | Film::INDIRECT_DIFFUSE |
+			Film::INDIRECT_GLOSSY | Film::INDIRECT_SPECULAR | Film::DIRECT_SHADOW_MASK |
+			Film::INDIRECT_SHADOW_MASK | Film::UV | Film::RAYCOUNT | Film::IRRADIANCE |
+			Film::OBJECT_ID,
+			engine->film->GetRadianceGroupCount());
+		sampleResult.useFilmSplat = !(engine->useFastPixelFilter);
+	}
+
+	rays.resize(size);
+	rayHits.resize(size);
+	bsdfs.resize(size);
+	volInfos.resize(size);
+	pathThroughputs.resize(size);
+	pathVertexCounts.resize(size);
+	lastBSDFEvents.resize(size);
+	lastPdfWs.resize(size);
+	rayCounts.resize(size);
+
+	shadowRays.resize(size);
+	directLightRadiances.resize(size);
+	irradiances.resize(size);
+	directLights.resize(size);
+	directLightEvents.resize(size);
+	hasShadowRays.resize(size);
+	isLightVisibles.resize(size);
+
+	pathIndices.resize(size);
+	sortKeys.resize(size);
+}
+
+void WavefrontPathCPURenderThread::FreePaths() {
+	for (u_int i = 0; i < samplers.size(); ++i)
+		delete samplers[i];
+
+	states.clear();
+	samplers.clear();
+	sampleResults.clear();
+	rays.clear();
+	rayHits.clear();
+	bsdfs.clear();
+	volInfos.clear();
+	pathThroughputs.clear();
+	pathVertexCounts.clear();
+	lastBSDFEvents.clear();
+	lastPdfWs.clear();
+	rayCounts.clear();
+
+	shadowRays.clear();
+	directLightRadiances.clear();
+	irradiances.clear();
+	directLights.clear();
+	directLightEvents.clear();
+	hasShadowRays.clear();
+	isLightVisibles.clear();
+
+	pathIndices.clear();
+	sortKeys.clear();
+}
+
+u_int WavefrontPathCPURenderThread::SelectPaths(const PathState state) {
+	u_int count = 0;
+	for (u_int i = 0; i < states.size(); ++i) {
+		if (states[i] == state)
+			pathIndices[count++] = i;
+	}
+
+	return count;
+}
+
+void WavefrontPathCPURenderThread::SortPathsByDirection(const u_int count) {
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		const Vector &d = rays[index].d;
+
+		// The octant of the direction first and than the quantized direction
+		const u_int octant = ((d.x < 0.f) ? 4 : 0) | ((d.y < 0.f) ? 2 : 0) | ((d.z < 0.f) ? 1 : 0);
+		const u_int qx = Floor2UInt(Clamp(fabsf(d.x), 0.f, 1.f) * 255.f);
+		const u_int qy = Floor2UInt(Clamp(fabsf(d.y), 0.f, 1.f) * 255.f);
+		const u_int qz = Floor2UInt(Clamp(fabsf(d.z), 0.f, 1.f) * 255.f);
+
+		sortKeys[i] = make_pair((octant << 24) | (qx << 16) | (qy << 8) | qz, index);
+	}
+
+	sort(sortKeys.begin(), sortKeys.begin() + count);
+
+	for (u_int i = 0; i < count; ++i)
+		pathIndices[i] = sortKeys[i].second;
+}
+
+void WavefrontPathCPURenderThread::SortPathsByMaterial(const u_int count) {
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		const BSDF &bsdf = bsdfs[index];
+
+		// The material type first (i.e. the same code) and than the material
+		// (i.e. the same textures)
+		sortKeys[i] = make_pair((((u_int)bsdf.GetMaterialType()) << 24) | (bsdf.GetMaterialID() & 0xffffffu), index);
+	}
+
+	sort(sortKeys.begin(), sortKeys.begin() + count);
+
+	for (u_int i = 0; i < count; ++i)
+		pathIndices[i] = sortKeys[i].second;
+}
+
+void WavefrontPathCPURenderThread::InitSampleResult(SampleResult &sampleResult) const {
+	// Set to 0.0 all result colors
+	sampleResult.emission = Spectrum();
+	for (u_int i = 0; i < sampleResult.radiance.size(); ++i)
+		sampleResult.radiance[i] = Spectrum();
+	sampleResult.directDiffuse = Spectrum();
+	sampleResult.directGlossy = Spectrum();
+	sampleResult.indirectDiffuse = Spectrum();
+	sampleResult.indirectGlossy = Spectrum();
+	sampleResult.indirectSpecular = Spectrum();
+	sampleResult.directShadowMask = 1.f;
+	sampleResult.indirectShadowMask = 1.f;
+	sampleResult.irradiance = Spectrum();
+	sampleResult.passThroughPath = true;
+}
+
+void WavefrontPathCPURenderThread::SetMissedFirstHitAOVs(SampleResult &sampleResult) const {
+	sampleResult.alpha = 0.f;
+	sampleResult.depth = std::numeric_limits<float>::infinity();
+	sampleResult.position = Point(
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity());
+	sampleResult.geometryNormal = Normal(
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity());
+	sampleResult.shadingNormal = Normal(
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity());
+	sampleResult.materialID = std::numeric_limits<u_int>::max();
+	sampleResult.objectID = std::numeric_limits<u_int>::max();
+	sampleResult.uv = UV(std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::infinity());
+}
+
+//------------------------------------------------------------------------------
+// Stages
+//------------------------------------------------------------------------------
+
+void WavefrontPathCPURenderThread::GenerateEyeRays(const u_int count) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	Scene *scene = engine->renderConfig->scene;
+
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		SampleResult &sampleResult = sampleResults[index][0];
+
+		InitSampleResult(sampleResult);
+		engine->pathTracer.GenerateEyeRay(scene, threadFilm, rays[index], samplers[index], sampleResult);
+
+		pathVertexCounts[index] = 1;
+		lastBSDFEvents[index] = SPECULAR; // SPECULAR is required to avoid MIS
+		lastPdfWs[index] = 1.f;
+		pathThroughputs[index] = Spectrum(1.f);
+		volInfos[index] = PathVolumeInfo();
+		rayCounts[index] = 0.0;
+
+		states[index] = INTERSECT;
+	}
+}
+
+void WavefrontPathCPURenderThread::Intersect(const u_int count) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	Scene *scene = engine->renderConfig->scene;
+
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		SampleResult &sampleResult = sampleResults[index][0];
+		BSDF &bsdf = bsdfs[index];
+		Spectrum &pathThroughput = pathThroughputs[index];
+
+		sampleResult.firstPathVertex = (pathVertexCounts[index] == 1);
+		sampleResult.lastPathVertex = (pathVertexCounts[index] == engine->maxPathDepth);
+
+		const u_int sampleOffset = sampleBootSize + (pathVertexCounts[index] - 1) * sampleStepSize;
+
+		// To keep track of the number of rays traced
+		const double deviceRayCount = device->GetTotalRaysCount();
+
+		RayHit &eyeRayHit = rayHits[index];
+		Spectrum connectionThroughput;
+		const bool hit = scene->Intersect(device, false,
+				&volInfos[index], samplers[index]->GetSample(sampleOffset),
+				&rays[index], &eyeRayHit, &bsdf, &connectionThroughput,
+				&pathThroughput, &sampleResult);
+		pathThroughput *= connectionThroughput;
+		// Note: pass-through check is done inside Scene::Intersect()
+
+		rayCounts[index] += device->GetTotalRaysCount() - deviceRayCount;
+
+		if (!hit) {
+			// Nothing was hit, look for env. lights
+			if (!engine->forceBlackBackground || !sampleResult.passThroughPath)
+				engine->pathTracer.DirectHitInfiniteLight(scene, lastBSDFEvents[index], pathThroughput, rays[index].d,
+						lastPdfWs[index], &sampleResult);
+
+			if (sampleResult.firstPathVertex)
+				SetMissedFirstHitAOVs(sampleResult);
+
+			states[index] = SPLAT_SAMPLE;
+			continue;
+		}
+
+		// Something was hit
+		if (sampleResult.firstPathVertex) {
+			// The alpha value can be changed if the material is a shadow catcher (see below)
+			sampleResult.alpha = 1.f;
+			sampleResult.depth = eyeRayHit.t;
+			sampleResult.position = bsdf.hitPoint.p;
+			sampleResult.geometryNormal = bsdf.hitPoint.geometryN;
+			sampleResult.shadingNormal = bsdf.hitPoint.shadeN;
+			sampleResult.materialID = bsdf.GetMaterialID();
+			sampleResult.objectID = bsdf.GetObjectID();
+			sampleResult.uv = bsdf.hitPoint.uv;
+		}
+
+		// Check if it is a light source
+		if (bsdf.IsLightSource()) {
+			engine->pathTracer.DirectHitFiniteLight(scene, lastBSDFEvents[index], pathThroughput, eyeRayHit.t,
+					bsdf, lastPdfWs[index], &sampleResult);
+		}
+
+		// I avoid to do DL on the last vertex otherwise it introduces a lot of
+		// noise because I can not use MIS (see PathTracer::RenderSample())
+		states[index] = (sampleResult.lastPathVertex && !sampleResult.firstPathVertex) ?
+			SPLAT_SAMPLE : DIRECT_LIGHT;
+	}
+}
+
+void WavefrontPathCPURenderThread::DirectLightSampling(const u_int count) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	Scene *scene = engine->renderConfig->scene;
+
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		const SampleResult &sampleResult = sampleResults[index][0];
+		const BSDF &bsdf = bsdfs[index];
+		Sampler *sampler = samplers[index];
+
+		hasShadowRays[index] = false;
+		isLightVisibles[index] = false;
+
+		// The following state, the shadow ray is traced in the next stage
+		states[index] = sampleResult.lastPathVertex ? SPLAT_SAMPLE : SAMPLE_BSDF;
+
+		if (bsdf.IsDelta())
+			continue;
+
+		const u_int sampleOffset = sampleBootSize + (pathVertexCounts[index] - 1) * sampleStepSize;
+
+		// Pick a light source to sample
+		float lightPickPdf;
+		const LightSource *light = scene->lightDefs.GetLightStrategy()->SampleLights(
+				sampler->GetSample(sampleOffset + 1), &lightPickPdf);
+
+		Vector lightRayDir;
+		float distance, directPdfW;
+		const Spectrum lightRadiance = light->Illuminate(*scene, bsdf.hitPoint.p,
+				sampler->GetSample(sampleOffset + 2), sampler->GetSample(sampleOffset + 3),
+				sampler->GetSample(sampleOffset + 4), &lightRayDir, &distance, &directPdfW);
+		assert (!lightRadiance.IsNaN() && !lightRadiance.IsInf());
+		if (lightRadiance.Black())
+			continue;
+		assert (!isnan(directPdfW) && !isinf(directPdfW));
+
+		BSDFEvent event;
+		float bsdfPdfW;
+		const Spectrum bsdfEval = bsdf.Evaluate(lightRayDir, &event, &bsdfPdfW);
+		assert (!bsdfEval.IsNaN() && !bsdfEval.IsInf());
+		if (bsdfEval.Black())
+			continue;
+		assert (!isnan(bsdfPdfW) && !isinf(bsdfPdfW));
+
+		Ray &shadowRay = shadowRays[index];
+		shadowRay = Ray(bsdf.hitPoint.p, lightRayDir, 0.f, distance, rays[index].time);
+		shadowRay.UpdateMinMaxWithEpsilon();
+
+		// Everything, except the connection throughput of the shadow ray, can
+		// be computed before to trace the shadow ray
+		const float directLightSamplingPdfW = directPdfW * lightPickPdf;
+		const float factor = 1.f / directLightSamplingPdfW;
+
+		// The +1 is there to account the current path vertex used for DL
+		if (pathVertexCounts[index] + 1 >= engine->rrDepth) {
+			// Russian Roulette
+			bsdfPdfW *= RenderEngine::RussianRouletteProb(bsdfEval, engine->rrImportanceCap);
+		}
+
+		// MIS between direct light sampling and BSDF sampling
+		//
+		// Note: I have to avoiding MIS on the last path vertex
+		const float weight = (!sampleResult.lastPathVertex &&  (light->IsEnvironmental() || light->IsIntersectable())) ? 
+			PowerHeuristic(directLightSamplingPdfW, bsdfPdfW) : 1.f;
+
+		directLightRadiances[index] = bsdfEval * (weight * factor) * lightRadiance;
+		irradiances[index] = (INV_PI * fabsf(Dot(bsdf.hitPoint.shadeN, shadowRay.d)) * factor) * lightRadiance;
+		directLights[index] = light;
+		directLightEvents[index] = event;
+		hasShadowRays[index] = true;
+	}
+}
+
+void WavefrontPathCPURenderThread::TraceShadowRays(const u_int count) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	Scene *scene = engine->renderConfig->scene;
+
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		if (!hasShadowRays[index])
+			continue;
+
+		SampleResult &sampleResult = sampleResults[index][0];
+		const BSDF &bsdf = bsdfs[index];
+		const u_int sampleOffset = sampleBootSize + (pathVertexCounts[index] - 1) * sampleStepSize;
+
+		// To keep track of the number of rays traced
+		const double deviceRayCount = device->GetTotalRaysCount();
+
+		// The volume information of the path must not be changed by the shadow ray
+		PathVolumeInfo volInfo = volInfos[index];
+		RayHit shadowRayHit;
+		BSDF shadowBsdf;
+		Spectrum connectionThroughput;
+		// Check if the light source is visible
+		const bool occluded = scene->Intersect(device, false, &volInfo, samplers[index]->GetSample(sampleOffset + 5),
+				&shadowRays[index], &shadowRayHit, &shadowBsdf, &connectionThroughput);
+
+		rayCounts[index] += device->GetTotalRaysCount() - deviceRayCount;
+
+		if (occluded)
+			continue;
+
+		// Add the light contribution only if it is not a shadow catcher
+		// (because, if the light is visible , the material will be
+		// transparent in the case of a shadow catcher).
+		if (!bsdf.IsShadowCatcher()) {
+			// I'm ignoring volume emission because it is not sampled in
+			// direct light step.
+			sampleResult.AddDirectLight(directLights[index]->GetID(), directLightEvents[index],
+					pathThroughputs[index], directLightRadiances[index] * connectionThroughput, 1.f);
+
+			// The first path vertex is not handled by AddDirectLight(). This is valid
+			// for irradiance AOV only if it is not a SPECULAR material.
+			if ((sampleResult.firstPathVertex) && !(bsdf.GetEventTypes() & SPECULAR))
+				sampleResult.irradiance = irradiances[index] * connectionThroughput;
+		}
+
+		isLightVisibles[index] = true;
+	}
+}
+
+void WavefrontPathCPURenderThread::SampleBSDF(const u_int count) {
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		if (states[index] != SAMPLE_BSDF)
+			continue;
+
+		SampleResult &sampleResult = sampleResults[index][0];
+		const BSDF &bsdf = bsdfs[index];
+		Sampler *sampler = samplers[index];
+		const u_int sampleOffset = sampleBootSize + (pathVertexCounts[index] - 1) * sampleStepSize;
+
+		// Most of the paths end here
+		states[index] = SPLAT_SAMPLE;
+
+		Vector sampledDir;
+		float cosSampledDir;
+		Spectrum bsdfSample;
+		if (bsdf.IsShadowCatcher() && isLightVisibles[index]) {
+			bsdfSample = bsdf.ShadowCatcherSample(&sampledDir, &lastPdfWs[index], &cosSampledDir, &lastBSDFEvents[index]);
+
+			if (sampleResult.firstPathVertex) {
+				// In this case I have also to set the value of the alpha channel to 0.0
+				sampleResult.alpha = 0.f;
+			}
+		} else {
+			bsdfSample = bsdf.Sample(&sampledDir,
+					sampler->GetSample(sampleOffset + 6),
+					sampler->GetSample(sampleOffset + 7),
+					&lastPdfWs[index], &cosSampledDir, &lastBSDFEvents[index]);
+			sampleResult.passThroughPath = false;
+		}
+
+		assert (!bsdfSample.IsNaN() && !bsdfSample.IsInf());
+		if (bsdfSample.Black())
+			continue;
+		assert (!isnan(lastPdfWs[index]) && !isinf(lastPdfWs[index]));
+
+		const BSDFEvent lastBSDFEvent = lastBSDFEvents[index];
+		if (sampleResult.firstPathVertex)
+			sampleResult.firstPathVertexEvent = lastBSDFEvent;
+
+		Spectrum throughputFactor(1.f);
+		const float rrProb = RenderEngine::RussianRouletteProb(bsdfSample, engine->rrImportanceCap);
+		if (pathVertexCounts[index] >= engine->rrDepth) {
+			// Russian Roulette
+			if (rrProb < sampler->GetSample(sampleOffset + 8))
+				continue;
+
+			// Increase path contribution
+			throughputFactor /= rrProb;
+		}
+
+		// PDF clamping (or better: scaling)
+		throughputFactor *= min(1.f, (lastBSDFEvent & SPECULAR) ? 1.f : (lastPdfWs[index] / engine->pdfClampValue));
+		throughputFactor *= bsdfSample;
+
+		pathThroughputs[index] *= throughputFactor;
+		assert (!pathThroughputs[index].IsNaN() && !pathThroughputs[index].IsInf());
+
+		// This is valid for irradiance AOV only if it is not a SPECULAR material and
+		// first path vertex. Set or update sampleResult.irradiancePathThroughput
+		if (sampleResult.firstPathVertex) {
+			if (!(bsdf.GetEventTypes() & SPECULAR))
+				sampleResult.irradiancePathThroughput = INV_PI * fabsf(Dot(bsdf.hitPoint.shadeN, sampledDir)) / rrProb;
+			else
+				sampleResult.irradiancePathThroughput = Spectrum();
+		} else
+			sampleResult.irradiancePathThroughput *= throughputFactor;
+
+		// Update volume information
+		volInfos[index].Update(lastBSDFEvent, bsdf);
+
+		rays[index].Update(bsdf.hitPoint.p, sampledDir);
+		++pathVertexCounts[index];
+
+		states[index] = INTERSECT;
+	}
+}
+
+u_int WavefrontPathCPURenderThread::SplatSamples(const u_int count, VarianceClamping &varianceClamping) {
+	for (u_int i = 0; i < count; ++i) {
+		const u_int index = pathIndices[i];
+		SampleResult &sampleResult = sampleResults[index][0];
+
+		sampleResult.rayCount = (float)rayCounts[index];
+
+		// Variance clamping
+		if (varianceClamping.hasClamping())
+			varianceClamping.Clamp(*threadFilm, sampleResult);
+
+		samplers[index]->NextSample(sampleResults[index]);
+
+		states[index] = GENERATE_EYE_RAY;
+	}
+
+	return count;
+}
+
+//------------------------------------------------------------------------------
+// RenderFuncWavefront() method
+//------------------------------------------------------------------------------
+
+void WavefrontPathCPURenderThread::RenderFuncWavefront() {
+	//SLG_LOG("[WavefrontPathCPURenderEngine::" << threadIndex << "] Rendering thread started");
+
+	//--------------------------------------------------------------------------
+	// Initialization
+	//--------------------------------------------------------------------------
+
+	WavefrontPathCPURenderEngine *engine = (WavefrontPathCPURenderEngine *)renderEngine;
+	// (engine->seedBase + 1) seed is used for sharedRndGen
+	rndGen = new RandomGenerator(engine->seedBase + 1 + threadIndex);
+	const u_int filmWidth = threadFilm->GetWidth();
+	const u_int filmHeight = threadFilm->GetHeight();
+
+	const u_int sampleSize = 
+		sampleBootSize + // To generate eye ray
+		(engine->maxPathDepth + 1) * sampleStepSize; // For each path vertex
+	AllocPaths(sampleSize);
+
+	VarianceClamping varianceClamping(engine->sqrtVarianceClampMaxValue);
+
+	// I can not use engine->renderConfig->GetProperty() here because the
+	// RenderConfig properties cache is not thread safe
+	const u_int haltDebug = engine->renderConfig->cfg.Get(Property("batch.haltdebug")(0u)).Get<u_int>() *
+		filmWidth * filmHeight;
+
+	//--------------------------------------------------------------------------
+	// Trace paths
+	//--------------------------------------------------------------------------
+
+	u_int steps = 0;
+	while (!boost::this_thread::interruption_requested()) {
+		// Check if we are in pause mode
+		if (engine->pauseMode) {
+			// Check every 100ms if I have to continue the rendering
+			while (!boost::this_thread::interruption_requested() && engine->pauseMode)
+				boost::this_thread::sleep(boost::posix_time::millisec(100));
+
+			if (boost::this_thread::interruption_requested())
+				break;
+		}
+
+		// Start new paths where the old ones have ended
+		u_int count = SelectPaths(GENERATE_EYE_RAY);
+		GenerateEyeRays(count);
+
+		// Trace all path rays
+		count = SelectPaths(INTERSECT);
+		if (engine->sortPaths)
+			SortPathsByDirection(count);
+		Intersect(count);
+
+		// Shade all path vertices: the same list of paths, sorted by
+		// material, is used by all shading stages
+		count = SelectPaths(DIRECT_LIGHT);
+		if (engine->sortPaths)
+			SortPathsByMaterial(count);
+		DirectLightSampling(count);
+		TraceShadowRays(count);
+		SampleBSDF(count);
+
+		// Splat all the ended paths
+		count = SelectPaths(SPLAT_SAMPLE);
+		steps += SplatSamples(count, varianceClamping);
+
+#ifdef WIN32
+		// Work around Windows bad scheduling
+		renderThread->yield();
+#endif
+
+		if ((haltDebug > 0u) && (steps >= haltDebug))
+			break;
+	}
+
+	FreePaths();
+	delete rndGen;
+	rndGen = NULL;
+
+	//SLG_LOG("[WavefrontPathCPURenderEngine::" << threadIndex << "] Rendering thread halted");
+}
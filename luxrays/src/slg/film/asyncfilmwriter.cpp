@@ -0,0 +1,354 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <set>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <OpenImageIO/imageio.h>
+OIIO_NAMESPACE_USING
+
+#include "slg/film/asyncfilmwriter.h"
+#include "slg/film/film.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// AsyncFilmWriter
+//------------------------------------------------------------------------------
+
+AsyncFilmWriter::AsyncFilmWriter(const string &fn, const string &comp,
+		const u_int ts, const u_int threadCount) : fileName(fn), compression(comp),
+		tileSize(Max(ts, 16u)), pendingSnapshot(NULL), isWriting(false), quit(false) {
+	// The compression of the EXR tiles is done by the OpenEXR thread pool
+	if (threadCount > 0)
+		OIIO::attribute("exr_threads", (int)threadCount);
+
+	writeThread = new boost::thread(boost::bind(&AsyncFilmWriter::WriteThreadImpl, this));
+}
+
+AsyncFilmWriter::~AsyncFilmWriter() {
+	// The last snapshot is always written
+	{
+		boost::unique_lock<boost::mutex> lock(queueMutex);
+		quit = true;
+	}
+	queueCondition.notify_all();
+
+	writeThread->join();
+	delete writeThread;
+	delete pendingSnapshot;
+}
+
+// Returns false if the film doesn't have the output
+static bool GetOutputIndex(const Film &film, const FilmOutputs::FilmOutputType type,
+		const Properties &props, u_int *index, string *name) {
+	*index = 0;
+	*name = FilmOutputs::FilmOutputType2String(type);
+
+	if (!film.HasOutput(type))
+		return false;
+
+	switch (type) {
+		case FilmOutputs::RGB_IMAGEPIPELINE:
+		case FilmOutputs::RGBA_IMAGEPIPELINE:
+			*index = props.Get(Property("index")(0)).Get<u_int>();
+			*name += "_" + ToString(*index);
+			return (*index < film.GetImagePipelineCount());
+		case FilmOutputs::RADIANCE_GROUP:
+			*index = props.Get(Property("id")(0)).Get<u_int>();
+			*name += "_" + ToString(*index);
+			return (*index < film.GetRadianceGroupCount());
+		case FilmOutputs::MATERIAL_ID_MASK:
+		case FilmOutputs::BY_MATERIAL_ID:
+		case FilmOutputs::OBJECT_ID_MASK:
+		case FilmOutputs::BY_OBJECT_ID: {
+			const u_int id = props.Get(Property("id")(255)).Get<u_int>();
+			*name += "_" + ToString(id);
+
+			u_int count;
+			switch (type) {
+				case FilmOutputs::MATERIAL_ID_MASK:
+					count = film.GetMaskMaterialIDCount();
+					break;
+				case FilmOutputs::BY_MATERIAL_ID:
+					count = film.GetByMaterialIDCount();
+					break;
+				case FilmOutputs::OBJECT_ID_MASK:
+					count = film.GetMaskObjectIDCount();
+					break;
+				default:
+					count = film.GetByObjectIDCount();
+					break;
+			}
+
+			for (u_int i = 0; i < count; ++i) {
+				u_int outputID;
+				switch (type) {
+					case FilmOutputs::MATERIAL_ID_MASK:
+						outputID = film.GetMaskMaterialID(i);
+						break;
+					case FilmOutputs::BY_MATERIAL_ID:
+						outputID = film.GetByMaterialID(i);
+						break;
+					case FilmOutputs::OBJECT_ID_MASK:
+						outputID = film.GetMaskObjectID(i);
+						break;
+					default:
+						outputID = film.GetByObjectID(i);
+						break;
+				}
+
+				if (outputID == id) {
+					*index = i;
+					return true;
+				}
+			}
+			return false;
+		}
+		default:
+			return true;
+	}
+}
+
+void AsyncFilmWriter::Write(Film &film) {
+	const double startTime = WallClockTime();
+
+	Snapshot *snapshot = new Snapshot();
+	snapshot->width = film.GetWidth();
+	snapshot->height = film.GetHeight();
+	const size_t pixelCount = snapshot->width * snapshot->height;
+
+	const FilmOutputs &filmOutputs = film.GetFilmOutputs();
+	set<string> partNames;
+	for (u_int i = 0; i < filmOutputs.GetCount(); ++i) {
+		const FilmOutputs::FilmOutputType type = filmOutputs.GetType(i);
+
+		u_int index;
+		string name;
+		if (!GetOutputIndex(film, type, filmOutputs.GetProperties(i), &index, &name))
+			continue;
+
+		// The same output can be defined more than once with different file
+		// names (i.e. formats)
+		if (partNames.count(name) > 0)
+			continue;
+		partNames.insert(name);
+
+		snapshot->parts.resize(snapshot->parts.size() + 1);
+		Part &part = snapshot->parts.back();
+		part.name = name;
+		part.channelCount = film.GetOutputSize(type) / pixelCount;
+
+		switch (type) {
+			case FilmOutputs::MATERIAL_ID:
+			case FilmOutputs::OBJECT_ID:
+			case FilmOutputs::FRAMEBUFFER_MASK:
+				part.isUInt = true;
+				part.uintPixels.resize(film.GetOutputSize(type));
+				film.GetOutput<u_int>(type, &part.uintPixels[0], index);
+				break;
+			default:
+				part.isUInt = false;
+				part.floatPixels.resize(film.GetOutputSize(type));
+				film.GetOutput<float>(type, &part.floatPixels[0], index);
+				break;
+		}
+	}
+
+	SLG_LOG("[AsyncFilmWriter] Film snapshot of " << snapshot->parts.size() << " outputs time: " <<
+			int((WallClockTime() - startTime) * 1000.0) << "ms");
+
+	{
+		boost::unique_lock<boost::mutex> lock(queueMutex);
+
+		if (pendingSnapshot) {
+			SLG_LOG("[AsyncFilmWriter] The previous film snapshot has not been written yet and has been replaced");
+			delete pendingSnapshot;
+		}
+		pendingSnapshot = snapshot;
+	}
+	queueCondition.notify_all();
+}
+
+void AsyncFilmWriter::WaitForDone() {
+	boost::unique_lock<boost::mutex> lock(queueMutex);
+
+	while (pendingSnapshot || isWriting)
+		queueCondition.wait(lock);
+}
+
+void AsyncFilmWriter::WriteThreadImpl() {
+	for (;;) {
+		Snapshot *snapshot;
+		{
+			boost::unique_lock<boost::mutex> lock(queueMutex);
+
+			while (!pendingSnapshot && !quit)
+				queueCondition.wait(lock);
+
+			if (!pendingSnapshot)
+				break;
+
+			snapshot = pendingSnapshot;
+			pendingSnapshot = NULL;
+			isWriting = true;
+		}
+
+		const double startTime = WallClockTime();
+		try {
+			WriteSnapshot(*snapshot);
+
+			SLG_LOG("[AsyncFilmWriter] Film writing time (" << fileName << "): " <<
+					int((WallClockTime() - startTime) * 1000.0) << "ms");
+		} catch (exception &err) {
+			SLG_LOG("[AsyncFilmWriter] Error while writing " << fileName << ": " << err.what());
+		}
+		delete snapshot;
+
+		{
+			boost::unique_lock<boost::mutex> lock(queueMutex);
+			isWriting = false;
+		}
+		queueCondition.notify_all();
+	}
+}
+
+void AsyncFilmWriter::WriteSnapshot(const Snapshot &snapshot) const {
+	if (snapshot.parts.size() == 0)
+		return;
+
+	vector<ImageSpec> specs(snapshot.parts.size());
+	for (u_int i = 0; i < snapshot.parts.size(); ++i) {
+		const Part &part = snapshot.parts[i];
+
+		ImageSpec &spec = specs[i];
+		spec = ImageSpec(snapshot.width, snapshot.height, part.channelCount,
+				part.isUInt ? TypeDesc::UINT : TypeDesc::FLOAT);
+		spec.tile_width = tileSize;
+		spec.tile_height = tileSize;
+		spec.attribute("compression", compression);
+		spec.attribute("oiio:subimagename", part.name);
+
+		spec.channelnames.clear();
+		switch (part.channelCount) {
+			case 1:
+				spec.channelnames.push_back("Y");
+				break;
+			case 2:
+				spec.channelnames.push_back("U");
+				spec.channelnames.push_back("V");
+				break;
+			default:
+				spec.channelnames.push_back("R");
+				spec.channelnames.push_back("G");
+				spec.channelnames.push_back("B");
+				if (part.channelCount > 3)
+					spec.channelnames.push_back("A");
+				break;
+		}
+	}
+
+	// I write a temporary file first so a crash (or a kill) can not leave a
+	// broken file in place of the last one written
+	const string tmpFileName = fileName + ".tmp";
+
+	ImageOutput *out = ImageOutput::create(fileName);
+	if (!out)
+		throw runtime_error("Unable to create an image output for: " + fileName);
+	if (!out->supports("multiimage") || !out->supports("tiles")) {
+		delete out;
+		throw runtime_error("The image format doesn't support tiled multipart files: " + fileName);
+	}
+
+	if (!out->open(tmpFileName, specs.size(), &specs[0])) {
+		const string err = out->geterror();
+		delete out;
+		throw runtime_error("Unable to open " + tmpFileName + ": " + err);
+	}
+
+	for (u_int i = 0; i < snapshot.parts.size(); ++i) {
+		const Part &part = snapshot.parts[i];
+
+		if ((i > 0) && !out->open(tmpFileName, specs[i], ImageOutput::AppendSubimage)) {
+			const string err = out->geterror();
+			delete out;
+			throw runtime_error("Unable to append the part " + part.name + " to " + tmpFileName + ": " + err);
+		}
+
+		// The film origin is the lower left corner so I write the rows in
+		// reverse order
+		const size_t rowSize = snapshot.width * part.channelCount;
+		const size_t lastRowOffset = (snapshot.height - 1) * rowSize;
+		bool ok;
+		if (part.isUInt)
+			ok = out->write_image(TypeDesc::UINT, &part.uintPixels[lastRowOffset],
+					AutoStride, -(stride_t)(rowSize * sizeof(u_int)));
+		else
+			ok = out->write_image(TypeDesc::FLOAT, &part.floatPixels[lastRowOffset],
+					AutoStride, -(stride_t)(rowSize * sizeof(float)));
+
+		if (!ok) {
+			const string err = out->geterror();
+			delete out;
+			throw runtime_error("Unable to write the part " + part.name + " of " + tmpFileName + ": " + err);
+		}
+	}
+
+	out->close();
+	delete out;
+
+	boost::filesystem::rename(tmpFileName, fileName);
+}
+
+//------------------------------------------------------------------------------
+// Static methods
+//------------------------------------------------------------------------------
+
+AsyncFilmWriter *AsyncFilmWriter::FromProperties(const Properties &cfg) {
+	const string fileName = cfg.Get(GetDefaultProps().Get("film.multipartexr.filename")).Get<string>();
+	if (fileName == "")
+		return NULL;
+
+	const string compression = cfg.Get(GetDefaultProps().Get("film.multipartexr.compression")).Get<string>();
+	const u_int tileSize = cfg.Get(GetDefaultProps().Get("film.multipartexr.tilesize")).Get<u_int>();
+	const u_int threadCount = cfg.Get(GetDefaultProps().Get("film.multipartexr.threads")).Get<u_int>();
+
+	return new AsyncFilmWriter(fileName, compression, tileSize, threadCount);
+}
+
+Properties AsyncFilmWriter::ToProperties(const Properties &cfg) {
+	return Properties() <<
+			cfg.Get(GetDefaultProps().Get("film.multipartexr.filename")) <<
+			cfg.Get(GetDefaultProps().Get("film.multipartexr.compression")) <<
+			cfg.Get(GetDefaultProps().Get("film.multipartexr.tilesize")) <<
+			cfg.Get(GetDefaultProps().Get("film.multipartexr.threads"));
+}
+
+const Properties &AsyncFilmWriter::GetDefaultProps() {
+	static Properties props = Properties() <<
+			Property("film.multipartexr.filename")("") <<
+			Property("film.multipartexr.compression")("zip") <<
+			Property("film.multipartexr.tilesize")(64u) <<
+			Property("film.multipartexr.threads")(0u);
+
+	return props;
+}
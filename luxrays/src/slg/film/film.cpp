@@ -76,6 +76,7 @@ Film::Film() {
 	channel_FRAMEBUFFER_MASK = NULL;
 
 	convTest = NULL;
+	version = 0;
 
 	enabledOverlappedScreenBufferUpdate = true;
 
@@ -122,6 +123,7 @@ Film::Film(const u_int w, const u_int h, const u_int *sr) {
 	channel_FRAMEBUFFER_MASK = NULL;
 
 	convTest = NULL;
+	version = 0;
 
 	enabledOverlappedScreenBufferUpdate = true;
 
@@ -189,6 +191,7 @@ void Film::SetImagePipelines(ImagePipeline *newImagePiepeline) {
 		imagePipelines[0] = newImagePiepeline;
 	} else
 		imagePipelines.resize(0);
+	++version;
 }
 
 void Film::SetImagePipelines(std::vector<ImagePipeline *> &newImagePiepelines) {
@@ -196,6 +199,7 @@ void Film::SetImagePipelines(std::vector<ImagePipeline *> &newImagePiepelines) {
 		delete ip;
 
 	imagePipelines = newImagePiepelines;
+	++version;
 }
 
 void Film::CopyDynamicSettings(const Film &film) {
@@ -215,6 +219,28 @@ void Film::CopyDynamicSettings(const Film &film) {
 	SetOverlappedScreenBufferUpdateFlag(film.IsOverlappedScreenBufferUpdate());
 }
 
+Film *Film::Copy() const {
+	Film *newFilm = new Film(width, height, subRegion);
+	newFilm->CopyDynamicSettings(*this);
+	newFilm->filmOutputs = filmOutputs;
+	newFilm->Init();
+
+	newFilm->AddFilm(*this);
+
+	// AddFilm() doesn't include the channels computed by the image pipeline
+	for (u_int i = 0; i < channel_IMAGEPIPELINEs.size(); ++i)
+		copy(channel_IMAGEPIPELINEs[i]->GetPixels(), channel_IMAGEPIPELINEs[i]->GetPixels() + pixelCount * 3,
+				newFilm->channel_IMAGEPIPELINEs[i]->GetPixels());
+	if (channel_FRAMEBUFFER_MASK)
+		copy(channel_FRAMEBUFFER_MASK->GetPixels(), channel_FRAMEBUFFER_MASK->GetPixels() + pixelCount,
+				newFilm->channel_FRAMEBUFFER_MASK->GetPixels());
+
+	newFilm->statsStartSampleTime = statsStartSampleTime;
+	newFilm->statsAvgSampleSec = statsAvgSampleSec;
+
+	return newFilm;
+}
+
 void Film::AddChannel(const FilmChannelType type, const Properties *prop) {
 	if (initialized)
 		throw runtime_error("It is only possible to add a channel to a Film before initialization");
@@ -280,6 +306,7 @@ void Film::Resize(const u_int w, const u_int h) {
 
 	delete convTest;
 	convTest = NULL;
+	++version;
 
 	// Delete all already allocated channels
 	FreeChannels();
@@ -449,6 +476,7 @@ void Film::SetRadianceChannelScale(const u_int index, const RadianceChannelScale
 
 	radianceChannelScales[index] = scale;
 	radianceChannelScales[index].Init();
+	++version;
 }
 
 void Film::Reset() {
@@ -517,6 +545,7 @@ void Film::Reset() {
 
 	// convTest has to be reset explicitly
 
+	++version;
 	statsTotalSampleCount = 0.0;
 	statsAvgSampleSec = 0.0;
 	statsStartSampleTime = WallClockTime();
@@ -545,6 +574,7 @@ void Film::AddFilm(const Film &film,
 		const u_int srcWidth, const u_int srcHeight,
 		const u_int dstOffsetX, const u_int dstOffsetY) {
 	statsTotalSampleCount += film.statsTotalSampleCount;
+	++version;
 
 	if (HasChannel(RADIANCE_PER_PIXEL_NORMALIZED) && film.HasChannel(RADIANCE_PER_PIXEL_NORMALIZED)) {
 		for (u_int i = 0; i < Min(radianceGroupCount, film.radianceGroupCount); ++i) {
@@ -923,6 +953,43 @@ u_int Film::GetChannelCount(const FilmChannelType type) const {
 	}
 }
 
+u_int Film::GetChannelPixelSize(const FilmChannelType type) {
+	switch (type) {
+		case RADIANCE_PER_PIXEL_NORMALIZED:
+		case DIRECT_DIFFUSE:
+		case DIRECT_GLOSSY:
+		case EMISSION:
+		case INDIRECT_DIFFUSE:
+		case INDIRECT_GLOSSY:
+		case INDIRECT_SPECULAR:
+		case BY_MATERIAL_ID:
+		case IRRADIANCE:
+		case BY_OBJECT_ID:
+			return 4;
+		case RADIANCE_PER_SCREEN_NORMALIZED:
+		case IMAGEPIPELINE:
+		case POSITION:
+		case GEOMETRY_NORMAL:
+		case SHADING_NORMAL:
+			return 3;
+		case ALPHA:
+		case MATERIAL_ID_MASK:
+		case DIRECT_SHADOW_MASK:
+		case INDIRECT_SHADOW_MASK:
+		case UV:
+		case OBJECT_ID_MASK:
+			return 2;
+		case DEPTH:
+		case MATERIAL_ID:
+		case RAYCOUNT:
+		case OBJECT_ID:
+		case FRAMEBUFFER_MASK:
+			return 1;
+		default:
+			throw runtime_error("Unknown FilmChannelType in Film::GetChannelPixelSize(): " + ToString(type));
+	}
+}
+
 template<> const float *Film::GetChannel<float>(const FilmChannelType type, const u_int index) {
 	switch (type) {
 		case RADIANCE_PER_PIXEL_NORMALIZED:
@@ -932,7 +999,10 @@ template<> const float *Film::GetChannel<float>(const FilmChannelType type, cons
 		case ALPHA:
 			return channel_ALPHA->GetPixels();
 		case IMAGEPIPELINE: {
-			ExecuteImagePipeline(index);
+			// Run the image pipeline only if the film has changed since the
+			// last run
+			if ((index >= imagePipelineVersions.size()) || (imagePipelineVersions[index] != version))
+				ExecuteImagePipeline(index);
 			return channel_IMAGEPIPELINEs[index]->GetPixels();
 		}
 		case DEPTH:
@@ -1070,6 +1140,10 @@ void Film::ExecuteImagePipeline(const u_int index) {
 #endif
 
 	imagePipelines[index]->Apply(*this, index);
+
+	if (index >= imagePipelineVersions.size())
+		imagePipelineVersions.resize(index + 1, 0);
+	imagePipelineVersions[index] = version;
 	//const double p2 = WallClockTime();
 	//SLG_LOG("Image pipeline " << index << " time: " << int((p2 - p1) * 1000.0) << "ms");
 }
@@ -1271,6 +1345,138 @@ void Film::AddSampleResultColor(const u_int x, const u_int y,
 	}
 }
 
+void Film::BuildSplatChannels(const SampleResult &sampleResult) {
+	// Values used for MATERIAL_ID_MASK and OBJECT_ID_MASK
+	static const float maskValues[2] = { 0.f, 1.f };
+
+	splatChannels41.clear();
+	splatChannels30.clear();
+	splatChannels21.clear();
+	// splatColors must not be reallocated while building the lists
+	splatColors.clear();
+	splatColors.reserve(byMaterialIDs.size() + byObjectIDs.size());
+
+	const u_int radianceCount = sampleResult.radiance.size();
+	if ((channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size() > 0) && sampleResult.HasChannel(RADIANCE_PER_PIXEL_NORMALIZED)) {
+		for (u_int i = 0; i < Min<u_int>(radianceCount, channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size()); ++i) {
+			if (sampleResult.radiance[i].IsNaN() || sampleResult.radiance[i].IsInf())
+				continue;
+
+			splatChannels41.push_back(SplatChannel<4, 1>(channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i], sampleResult.radiance[i].c));
+		}
+	}
+
+	if ((channel_RADIANCE_PER_SCREEN_NORMALIZEDs.size() > 0) && sampleResult.HasChannel(RADIANCE_PER_SCREEN_NORMALIZED)) {
+		for (u_int i = 0; i < Min<u_int>(radianceCount, channel_RADIANCE_PER_SCREEN_NORMALIZEDs.size()); ++i) {
+			if (sampleResult.radiance[i].IsNaN() || sampleResult.radiance[i].IsInf())
+				continue;
+
+			splatChannels30.push_back(SplatChannel<3, 0>(channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i], sampleResult.radiance[i].c));
+		}
+	}
+
+	if (channel_ALPHA && sampleResult.HasChannel(ALPHA))
+		splatChannels21.push_back(SplatChannel<2, 1>(channel_ALPHA, &sampleResult.alpha));
+
+	if (!hasComposingChannel)
+		return;
+
+	if (channel_DIRECT_DIFFUSE && sampleResult.HasChannel(DIRECT_DIFFUSE))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_DIRECT_DIFFUSE, sampleResult.directDiffuse.c));
+	if (channel_DIRECT_GLOSSY && sampleResult.HasChannel(DIRECT_GLOSSY))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_DIRECT_GLOSSY, sampleResult.directGlossy.c));
+	if (channel_EMISSION && sampleResult.HasChannel(EMISSION))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_EMISSION, sampleResult.emission.c));
+	if (channel_INDIRECT_DIFFUSE && sampleResult.HasChannel(INDIRECT_DIFFUSE))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_INDIRECT_DIFFUSE, sampleResult.indirectDiffuse.c));
+	if (channel_INDIRECT_GLOSSY && sampleResult.HasChannel(INDIRECT_GLOSSY))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_INDIRECT_GLOSSY, sampleResult.indirectGlossy.c));
+	if (channel_INDIRECT_SPECULAR && sampleResult.HasChannel(INDIRECT_SPECULAR))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_INDIRECT_SPECULAR, sampleResult.indirectSpecular.c));
+
+	// Merge of all radiance groups used by BY_MATERIAL_ID and BY_OBJECT_ID
+	Spectrum radianceSum;
+	if ((channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size() > 0) && sampleResult.HasChannel(RADIANCE_PER_PIXEL_NORMALIZED) &&
+			((sampleResult.HasChannel(MATERIAL_ID) && (byMaterialIDs.size() > 0)) ||
+			(sampleResult.HasChannel(OBJECT_ID) && (byObjectIDs.size() > 0)))) {
+		for (u_int i = 0; i < Min<u_int>(radianceCount, channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size()); ++i) {
+			if (sampleResult.radiance[i].IsNaN() || sampleResult.radiance[i].IsInf())
+				continue;
+
+			radianceSum += sampleResult.radiance[i];
+		}
+	}
+
+	if (sampleResult.HasChannel(MATERIAL_ID)) {
+		for (u_int i = 0; i < maskMaterialIDs.size(); ++i) {
+			splatChannels21.push_back(SplatChannel<2, 1>(channel_MATERIAL_ID_MASKs[i],
+					&maskValues[(sampleResult.materialID == maskMaterialIDs[i]) ? 1 : 0]));
+		}
+
+		if ((channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size() > 0) && sampleResult.HasChannel(RADIANCE_PER_PIXEL_NORMALIZED)) {
+			for (u_int index = 0; index < byMaterialIDs.size(); ++index) {
+				splatColors.push_back((sampleResult.materialID == byMaterialIDs[index]) ? radianceSum : Spectrum());
+				splatChannels41.push_back(SplatChannel<4, 1>(channel_BY_MATERIAL_IDs[index], splatColors.back().c));
+			}
+		}
+	}
+
+	if (channel_DIRECT_SHADOW_MASK && sampleResult.HasChannel(DIRECT_SHADOW_MASK))
+		splatChannels21.push_back(SplatChannel<2, 1>(channel_DIRECT_SHADOW_MASK, &sampleResult.directShadowMask));
+	if (channel_INDIRECT_SHADOW_MASK && sampleResult.HasChannel(INDIRECT_SHADOW_MASK))
+		splatChannels21.push_back(SplatChannel<2, 1>(channel_INDIRECT_SHADOW_MASK, &sampleResult.indirectShadowMask));
+	if (channel_IRRADIANCE && sampleResult.HasChannel(IRRADIANCE))
+		splatChannels41.push_back(SplatChannel<4, 1>(channel_IRRADIANCE, sampleResult.irradiance.c));
+
+	if (sampleResult.HasChannel(OBJECT_ID)) {
+		for (u_int i = 0; i < maskObjectIDs.size(); ++i) {
+			splatChannels21.push_back(SplatChannel<2, 1>(channel_OBJECT_ID_MASKs[i],
+					&maskValues[(sampleResult.objectID == maskObjectIDs[i]) ? 1 : 0]));
+		}
+
+		if ((channel_RADIANCE_PER_PIXEL_NORMALIZEDs.size() > 0) && sampleResult.HasChannel(RADIANCE_PER_PIXEL_NORMALIZED)) {
+			for (u_int index = 0; index < byObjectIDs.size(); ++index) {
+				splatColors.push_back((sampleResult.objectID == byObjectIDs[index]) ? radianceSum : Spectrum());
+				splatChannels41.push_back(SplatChannel<4, 1>(channel_BY_OBJECT_IDs[index], splatColors.back().c));
+			}
+		}
+	}
+}
+
+void Film::AddSampleResultColor(const int x0, const int y0,
+		const u_int footprintWidth, const u_int footprintHeight,
+		const float *footprintWeights,
+		const SampleResult &sampleResult, const float weight) {
+	BuildSplatChannels(sampleResult);
+
+	const size_t count41 = splatChannels41.size();
+	const size_t count30 = splatChannels30.size();
+	const size_t count21 = splatChannels21.size();
+	if (count41 + count30 + count21 == 0)
+		return;
+
+	// Clip the footprint to the film
+	const int ix0 = Max(x0, 0);
+	const int ix1 = Min(x0 + (int)footprintWidth, (int)width);
+	const int iy0 = Max(y0, 0);
+	const int iy1 = Min(y0 + (int)footprintHeight, (int)height);
+
+	for (int iy = iy0; iy < iy1; ++iy) {
+		const float *rowWeights = &footprintWeights[(iy - y0) * (int)footprintWidth];
+
+		for (int ix = ix0; ix < ix1; ++ix) {
+			const float filteredWeight = weight * rowWeights[ix - x0];
+
+			for (size_t i = 0; i < count41; ++i)
+				splatChannels41[i].channel->AddWeightedPixel(ix, iy, splatChannels41[i].value, filteredWeight);
+			for (size_t i = 0; i < count30; ++i)
+				splatChannels30[i].channel->AddWeightedPixel(ix, iy, splatChannels30[i].value, filteredWeight);
+			for (size_t i = 0; i < count21; ++i)
+				splatChannels21[i].channel->AddWeightedPixel(ix, iy, splatChannels21[i].value, filteredWeight);
+		}
+	}
+}
+
 void Film::AddSampleResultData(const u_int x, const u_int y,
 		const SampleResult &sampleResult)  {
 	bool depthWrite = true;
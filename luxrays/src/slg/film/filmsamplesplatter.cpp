@@ -98,3 +98,48 @@ void FilmSampleSplatter::SplatSample(Film &film, const SampleResult &sampleResul
 		}
 	}
 }
+
+void FilmSampleSplatter::SplatSamples(Film &film, const vector<SampleResult> &sampleResults,
+		const float weight) const {
+	const u_int width = film.GetWidth();
+	const u_int height = film.GetHeight();
+	const bool hasDataChannel = film.HasDataChannel();
+
+	for (vector<SampleResult>::const_iterator sr = sampleResults.begin(); sr < sampleResults.end(); ++sr) {
+		if (!sr->useFilmSplat) {
+			film.AddSample(sr->pixelX, sr->pixelY, *sr, weight);
+			continue;
+		}
+
+		if (!filter) {
+			SplatSample(film, *sr, weight);
+			continue;
+		}
+
+		//----------------------------------------------------------------------
+		// Add all data related information (not filtered)
+		//----------------------------------------------------------------------
+
+		if (hasDataChannel) {
+			const int x = Floor2Int(sr->filmX);
+			const int y = Floor2Int(sr->filmY);
+
+			if ((x >= 0) && (x < (int)width) && (y >= 0) && (y < (int)height))
+				film.AddSampleResultData(x, y, *sr);
+		}
+
+		//----------------------------------------------------------------------
+		// Add all color related information (filtered)
+		//----------------------------------------------------------------------
+
+		const float dImageX = sr->filmX - .5f;
+		const float dImageY = sr->filmY - .5f;
+		const FilterLUT *filterLUT = filterLUTs->GetLUT(dImageX - floorf(sr->filmX), dImageY - floorf(sr->filmY));
+
+		const int x0 = Floor2Int(dImageX - filter->xWidth * .5f + .5f);
+		const int y0 = Floor2Int(dImageY - filter->yWidth * .5f + .5f);
+
+		film.AddSampleResultColor(x0, y0, filterLUT->GetWidth(), filterLUT->GetHeight(),
+				filterLUT->GetLUT(), *sr, weight);
+	}
+}
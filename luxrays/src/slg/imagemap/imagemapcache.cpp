@@ -18,6 +18,9 @@
 
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "luxrays/utils/timeline.h"
 
 #include "slg/imagemap/imagemapcache.h"
 #include "slg/core/sdl.h"
@@ -37,6 +40,8 @@ ImageMapCache::ImageMapCache() {
 ImageMapCache::~ImageMapCache() {
 	BOOST_FOREACH(ImageMap *m, maps)
 		delete m;
+
+	DeletePreloadedImageMaps();
 }
 
 string ImageMapCache::GetCacheKey(const string &fileName, const float gamma,
@@ -75,7 +80,27 @@ ImageMap *ImageMapCache::GetImageMap(const string &fileName, const float gamma,
 		return im;
 	}
 
-	// I haven't yet loaded the file
+	// Check if the file has been already loaded by PreloadImageMaps()
+	ImageMap *im;
+	boost::unordered_map<std::string, ImageMap *>::iterator pit = preloadedMaps.find(key);
+	if (pit != preloadedMaps.end()) {
+		im = pit->second;
+		preloadedMaps.erase(pit);
+	} else {
+		// I haven't yet loaded the file
+		im = LoadImageMap(fileName, gamma, selectionType, storageType);
+	}
+
+	mapByName.insert(make_pair(key, im));
+	maps.push_back(im);
+
+	return im;
+}
+
+ImageMap *ImageMapCache::LoadImageMap(const string &fileName, const float gamma,
+		const ImageMapStorage::ChannelSelectionType selectionType,
+		const ImageMapStorage::StorageType storageType) const {
+	TimelineScope timelineScope("Load image map ", fileName, "imagemap");
 
 	ImageMap *im = new ImageMap(fileName, gamma, storageType);
 	im->SelectChannel(selectionType);
@@ -94,12 +119,66 @@ ImageMap *ImageMapCache::GetImageMap(const string &fileName, const float gamma,
 		im->Resize(newWidth, newHeight);
 	}
 
-	mapByName.insert(make_pair(key, im));
-	maps.push_back(im);
-
 	return im;
 }
 
+void ImageMapCache::PreloadImageMaps(const vector<ImageMapRequest> &requests) {
+	// Look for the image maps not yet loaded
+	vector<const ImageMapRequest *> toLoad;
+	boost::unordered_set<string> toLoadKeys;
+	BOOST_FOREACH(const ImageMapRequest &req, requests) {
+		const string key = GetCacheKey(req.fileName, req.gamma, req.selectionType, req.storageType);
+
+		if ((mapByName.find(GetCacheKey(req.fileName)) == mapByName.end()) &&
+				(mapByName.find(key) == mapByName.end()) &&
+				(preloadedMaps.find(key) == preloadedMaps.end()) &&
+				toLoadKeys.insert(key).second)
+			toLoad.push_back(&req);
+	}
+
+	if (toLoad.size() == 0)
+		return;
+
+	const double tStart = WallClockTime();
+
+	// Decode all image maps in parallel. Errors are reported later, when (and
+	// if) the image map is requested with GetImageMap().
+	vector<ImageMap *> loadedMaps(toLoad.size(), NULL);
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int i = 0; i < toLoad.size(); ++i) {
+		const ImageMapRequest &req = *toLoad[i];
+
+		try {
+			loadedMaps[i] = LoadImageMap(req.fileName, req.gamma, req.selectionType, req.storageType);
+		} catch (std::exception &) {
+			loadedMaps[i] = NULL;
+		}
+	}
+
+	// Store the result in the requests order
+	for (u_int i = 0; i < toLoad.size(); ++i) {
+		if (loadedMaps[i]) {
+			const ImageMapRequest &req = *toLoad[i];
+			preloadedMaps[GetCacheKey(req.fileName, req.gamma, req.selectionType, req.storageType)] = loadedMaps[i];
+		}
+	}
+
+	Timeline::AddEvent("Image maps preloading", "imagemap", tStart, WallClockTime());
+	SDL_LOG("Image maps preloading time: " << int((WallClockTime() - tStart) * 1000.0) << "ms (" <<
+			toLoad.size() << " image maps)");
+}
+
+void ImageMapCache::DeletePreloadedImageMaps() {
+	for (boost::unordered_map<std::string, ImageMap *>::const_iterator it = preloadedMaps.begin(); it != preloadedMaps.end(); ++it)
+		delete it->second;
+	preloadedMaps.clear();
+}
+
 void ImageMapCache::DefineImageMap(const string &name, ImageMap *im) {
 	SDL_LOG("Define ImageMap: " << name);
 
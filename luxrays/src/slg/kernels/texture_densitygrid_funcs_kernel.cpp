@@ -0,0 +1,143 @@
+#include <string> 
+namespace slg { namespace ocl { 
+std::string KernelSource_texture_densitygrid_funcs = 
+"#line 2 \"texture_densitygrid_funcs.cl\"\n" 
+"/***************************************************************************\n" 
+"* Copyright 1998-2015 by authors (see AUTHORS.txt)                        *\n" 
+"*                                                                         *\n" 
+"*   This file is part of LuxRender.                                       *\n" 
+"*                                                                         *\n" 
+"* Licensed under the Apache License, Version 2.0 (the \"License\");         *\n" 
+"* you may not use this file except in compliance with the License.        *\n" 
+"* You may obtain a copy of the License at                                 *\n" 
+"*                                                                         *\n" 
+"*     http://www.apache.org/licenses/LICENSE-2.0                          *\n" 
+"*                                                                         *\n" 
+"* Unless required by applicable law or agreed to in writing, software     *\n" 
+"* distributed under the License is distributed on an \"AS IS\" BASIS,       *\n" 
+"* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*\n" 
+"* See the License for the specific language governing permissions and     *\n" 
+"* limitations under the License.                                          *\n" 
+"***************************************************************************/\n" 
+"//------------------------------------------------------------------------------\n" 
+"// DensityGrid texture\n" 
+"//------------------------------------------------------------------------------\n" 
+"// I can have a DENSITYGRID texture only if PARAM_HAS_IMAGEMAPS is defined\n" 
+"#if defined(PARAM_ENABLE_TEX_DENSITYGRID) && defined(PARAM_HAS_IMAGEMAPS)\n" 
+"#define DENSITYGRID_BRICK_SIZE_SHIFT 3\n" 
+"#define DENSITYGRID_BRICK_SIZE_MASK 7\n" 
+"#define DENSITYGRID_BRICK_VOXEL_COUNT 512\n" 
+"#define DENSITYGRID_CONSTANT_BRICK 0xffffffffu\n" 
+"#define DENSITYGRID_WRAP_REPEAT 0\n" 
+"#define DENSITYGRID_WRAP_BLACK 1\n" 
+"#define DENSITYGRID_WRAP_WHITE 2\n" 
+"#define DENSITYGRID_WRAP_CLAMP 3\n" 
+"// The data layout is: brick indices, brick min. values, brick max. values and\n" 
+"// the voxels of the stored bricks\n" 
+"float DensityGridTexture_D(__global const DensityGridTexParam *densityGrid,\n" 
+"__global const float *data, const int x, const int y, const int z) {\n" 
+"const uint cx = clamp(x, 0, (int)densityGrid->nx - 1);\n" 
+"const uint cy = clamp(y, 0, (int)densityGrid->ny - 1);\n" 
+"const uint cz = clamp(z, 0, (int)densityGrid->nz - 1);\n" 
+"const uint brickCount = densityGrid->bricksX * densityGrid->bricksY * densityGrid->bricksZ;\n" 
+"const uint brickIndex = ((cz >> DENSITYGRID_BRICK_SIZE_SHIFT) * densityGrid->bricksY +\n" 
+"(cy >> DENSITYGRID_BRICK_SIZE_SHIFT)) * densityGrid->bricksX + (cx >> DENSITYGRID_BRICK_SIZE_SHIFT);\n" 
+"// The brick indices are stored as uint\n" 
+"__global const uint *brickIndices = (__global const uint *)data;\n" 
+"const uint storedBrickIndex = brickIndices[brickIndex];\n" 
+"const float brickMin = data[brickCount + brickIndex];\n" 
+"if (storedBrickIndex == DENSITYGRID_CONSTANT_BRICK)\n" 
+"return brickMin;\n" 
+"const float brickMax = data[2 * brickCount + brickIndex];\n" 
+"const uint voxelIndex = storedBrickIndex * DENSITYGRID_BRICK_VOXEL_COUNT +\n" 
+"((((cz & DENSITYGRID_BRICK_SIZE_MASK) << DENSITYGRID_BRICK_SIZE_SHIFT) +\n" 
+"(cy & DENSITYGRID_BRICK_SIZE_MASK)) << DENSITYGRID_BRICK_SIZE_SHIFT) + (cx & DENSITYGRID_BRICK_SIZE_MASK);\n" 
+"__global const void *voxels = &data[3 * brickCount];\n" 
+"switch (densityGrid->storageType) {\n" 
+"case BYTE:\n" 
+"return mix(brickMin, brickMax, ((__global const uchar *)voxels)[voxelIndex] * (1.f / 255.f));\n" 
+"case HALF:\n" 
+"return mix(brickMin, brickMax, vload_half(voxelIndex, (__global const half *)voxels));\n" 
+"case FLOAT:\n" 
+"return ((__global const float *)voxels)[voxelIndex];\n" 
+"default:\n" 
+"return 0.f;\n" 
+"}\n" 
+"}\n" 
+"float DensityGridTexture_ConstEvaluateFloat(__global const Texture *tex,\n" 
+"__global HitPoint *hitPoint\n" 
+"IMAGEMAPS_PARAM_DECL) {\n" 
+"__global const DensityGridTexParam *densityGrid = &tex->densityGrid;\n" 
+"__global const ImageMap *imageMap = &imageMapDescs[densityGrid->imageMapIndex];\n" 
+"__global const float *data = ImageMap_GetPixelsAddress(\n" 
+"imageMapBuff, imageMap->pageIndex, imageMap->pixelsIndex);\n" 
+"const float3 P = TextureMapping3D_Map(&densityGrid->mapping, hitPoint);\n" 
+"const int nx = densityGrid->nx;\n" 
+"const int ny = densityGrid->ny;\n" 
+"const int nz = densityGrid->nz;\n" 
+"float x, y, z;\n" 
+"int vx, vy, vz;\n" 
+"switch (densityGrid->wrapMode) {\n" 
+"case DENSITYGRID_WRAP_REPEAT:\n" 
+"x = P.x * nx;\n" 
+"vx = Floor2Int(x);\n" 
+"x -= vx;\n" 
+"vx = Mod(vx, nx);\n" 
+"y = P.y * ny;\n" 
+"vy = Floor2Int(y);\n" 
+"y -= vy;\n" 
+"vy = Mod(vy, ny);\n" 
+"z = P.z * nz;\n" 
+"vz = Floor2Int(z);\n" 
+"z -= vz;\n" 
+"vz = Mod(vz, nz);\n" 
+"break;\n" 
+"case DENSITYGRID_WRAP_BLACK:\n" 
+"case DENSITYGRID_WRAP_WHITE:\n" 
+"if (P.x < 0.f || P.x >= 1.f ||\n" 
+"P.y < 0.f || P.y >= 1.f ||\n" 
+"P.z < 0.f || P.z >= 1.f)\n" 
+"return (densityGrid->wrapMode == DENSITYGRID_WRAP_BLACK) ? 0.f : 1.f;\n" 
+"x = P.x * nx;\n" 
+"vx = Floor2Int(x);\n" 
+"x -= vx;\n" 
+"y = P.y * ny;\n" 
+"vy = Floor2Int(y);\n" 
+"y -= vy;\n" 
+"z = P.z * nz;\n" 
+"vz = Floor2Int(z);\n" 
+"z -= vz;\n" 
+"break;\n" 
+"case DENSITYGRID_WRAP_CLAMP:\n" 
+"x = clamp(P.x, 0.f, 1.f) * nx;\n" 
+"vx = min(Floor2Int(x), nx - 1);\n" 
+"x -= vx;\n" 
+"y = clamp(P.y, 0.f, 1.f) * ny;\n" 
+"vy = min(Floor2Int(P.y * ny), ny - 1);\n" 
+"y -= vy;\n" 
+"z = clamp(P.z, 0.f, 1.f) * nz;\n" 
+"vz = min(Floor2Int(P.z * nz), nz - 1);\n" 
+"z -= vz;\n" 
+"break;\n" 
+"default:\n" 
+"return 0.f;\n" 
+"}\n" 
+"// Trilinear interpolation of the grid element\n" 
+"return mix(\n" 
+"mix(\n" 
+"mix(DensityGridTexture_D(densityGrid, data, vx, vy, vz), DensityGridTexture_D(densityGrid, data, vx + 1, vy, vz), x),\n" 
+"mix(DensityGridTexture_D(densityGrid, data, vx, vy + 1, vz), DensityGridTexture_D(densityGrid, data, vx + 1, vy + 1, vz), x),\n" 
+"y),\n" 
+"mix(\n" 
+"mix(DensityGridTexture_D(densityGrid, data, vx, vy, vz + 1), DensityGridTexture_D(densityGrid, data, vx + 1, vy, vz + 1), x),\n" 
+"mix(DensityGridTexture_D(densityGrid, data, vx, vy + 1, vz + 1), DensityGridTexture_D(densityGrid, data, vx + 1, vy + 1, vz + 1), x),\n" 
+"y),\n" 
+"z);\n" 
+"}\n" 
+"float3 DensityGridTexture_ConstEvaluateSpectrum(__global const Texture *tex,\n" 
+"__global HitPoint *hitPoint\n" 
+"IMAGEMAPS_PARAM_DECL) {\n" 
+"return (float3)(DensityGridTexture_ConstEvaluateFloat(tex, hitPoint IMAGEMAPS_PARAM));\n" 
+"}\n" 
+"#endif\n" 
+; } } 
@@ -24,7 +24,7 @@ std::string KernelSource_texture_types =
 "CONST_FLOAT, CONST_FLOAT3, IMAGEMAP, SCALE_TEX, FRESNEL_APPROX_N,\n" 
 "FRESNEL_APPROX_K, MIX_TEX, ADD_TEX, SUBTRACT_TEX, HITPOINTCOLOR, HITPOINTALPHA,\n" 
 "HITPOINTGREY, NORMALMAP_TEX, BLACKBODY_TEX, IRREGULARDATA_TEX,\n" 
-"ABS_TEX, CLAMP_TEX, BILERP_TEX, COLORDEPTH_TEX, HSV_TEX,\n" 
+"ABS_TEX, CLAMP_TEX, BILERP_TEX, COLORDEPTH_TEX, HSV_TEX, DENSITYGRID_TEX,\n" 
 "// Procedural textures\n" 
 "BLENDER_BLEND, BLENDER_CLOUDS, BLENDER_DISTORTED_NOISE, BLENDER_MAGIC,\n" 
 "BLENDER_MARBLE, BLENDER_MUSGRAVE, BLENDER_STUCCI, BLENDER_WOOD, BLENDER_VORONOI,\n" 
@@ -261,6 +261,14 @@ std::string KernelSource_texture_types =
 "Spectrum rgb;\n" 
 "} IrregularDataParam;\n" 
 "typedef struct {\n" 
+"TextureMapping3D mapping;\n" 
+"unsigned int nx, ny, nz;\n" 
+"unsigned int bricksX, bricksY, bricksZ;\n" 
+"// The brick indices, bounds and voxels are stored as an image map\n" 
+"unsigned int imageMapIndex;\n" 
+"unsigned int storageType, wrapMode;\n" 
+"} DensityGridTexParam;\n" 
+"typedef struct {\n" 
 "unsigned int krIndex;\n" 
 "} FresnelColorParam;\n" 
 "typedef struct {\n" 
@@ -321,6 +329,7 @@ std::string KernelSource_texture_types =
 "NormalMapTexParam normalMap;\n" 
 "BlackBodyParam blackBody;\n" 
 "IrregularDataParam irregularData;\n" 
+"DensityGridTexParam densityGrid;\n" 
 "FresnelColorParam fresnelColor;\n" 
 "FresnelConstParam fresnelConst;\n" 
 "AbsTexParam absTex;\n" 
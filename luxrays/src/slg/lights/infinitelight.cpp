@@ -18,6 +18,7 @@
 
 #include <boost/format.hpp>
 
+#include "luxrays/utils/timeline.h"
 #include "slg/lights/infinitelight.h"
 #include "slg/scene/scene.h"
 
@@ -30,39 +31,76 @@ using namespace slg;
 //------------------------------------------------------------------------------
 
 InfiniteLight::InfiniteLight() :
-	imageMap(NULL), mapping(1.f, 1.f, 0.f, 0.f), sampleUpperHemisphereOnly(false) {
+	imageMap(NULL), mapping(1.f, 1.f, 0.f, 0.f), sampleUpperHemisphereOnly(false),
+	distributionMaxSize(0), distributionCache(NULL), imageMapDistribution(NULL) {
 }
 
 InfiniteLight::~InfiniteLight() {
-	delete imageMapDistribution;
+	if (distributionCache)
+		distributionCache->Release(imageMapDistribution);
+	else
+		delete imageMapDistribution;
 }
 
-void InfiniteLight::Preprocess() {
-	const ImageMapStorage *imageMapStorage = imageMap->GetStorage();
-
-	vector<float> data(imageMap->GetWidth() * imageMap->GetHeight());
-	if (sampleUpperHemisphereOnly) {
-		for (u_int y = 0; y < imageMap->GetHeight(); ++y) {
-			for (u_int x = 0; x < imageMap->GetWidth(); ++x) {
-				const u_int index = x + y * imageMap->GetWidth();
+Distribution2D *InfiniteLight::BuildImageMapDistribution(const ImageMap *imageMap,
+		const bool sampleUpperHemisphereOnly, const u_int width, const u_int height) {
+	TimelineScope timelineScope("InfiniteLight distribution build", "scene");
 
-				if (y > imageMap->GetHeight() / 2)
-					data[index] = 0.f;
-				else
-					data[index] = imageMapStorage->GetFloat(index);
+	const ImageMapStorage *imageMapStorage = imageMap->GetStorage();
+	const u_int imageWidth = imageMap->GetWidth();
+	const u_int imageHeight = imageMap->GetHeight();
+
+	// Each row is independent so they are computed in parallel
+	vector<float> data(width * height);
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int y = 0; y < height; ++y) {
+		// The image map rows covered by this distribution row
+		const u_int y0 = y * imageHeight / height;
+		const u_int y1 = Max<u_int>(y0 + 1, (y + 1) * imageHeight / height);
+
+		for (u_int x = 0; x < width; ++x) {
+			const u_int x0 = x * imageWidth / width;
+			const u_int x1 = Max<u_int>(x0 + 1, (x + 1) * imageWidth / width);
+
+			float sum = 0.f;
+			for (u_int iy = y0; iy < y1; ++iy) {
+				if (sampleUpperHemisphereOnly && (iy > imageHeight / 2))
+					continue;
+
+				for (u_int ix = x0; ix < x1; ++ix)
+					sum += imageMapStorage->GetFloat(ix + iy * imageWidth);
 			}
-		}
-	} else {
-		for (u_int y = 0; y < imageMap->GetHeight(); ++y) {
-			for (u_int x = 0; x < imageMap->GetWidth(); ++x) {
-				const u_int index = x + y * imageMap->GetWidth();
 
-				data[index] = imageMapStorage->GetFloat(index);
-			}
+			data[x + y * width] = sum / ((x1 - x0) * (y1 - y0));
 		}
 	}
 
-	imageMapDistribution = new Distribution2D(&data[0], imageMap->GetWidth(), imageMap->GetHeight());
+	return new Distribution2D(&data[0], width, height);
+}
+
+void InfiniteLight::Preprocess() {
+	// Compute the resolution of the distribution, keeping the aspect ratio
+	u_int width = imageMap->GetWidth();
+	u_int height = imageMap->GetHeight();
+	if ((distributionMaxSize > 0) && (Max(width, height) > distributionMaxSize)) {
+		const float scale = distributionMaxSize / static_cast<float>(Max(width, height));
+		width = Max<u_int>(1, Floor2UInt(width * scale));
+		height = Max<u_int>(1, Floor2UInt(height * scale));
+	}
+
+	if (distributionCache) {
+		if (imageMapDistribution)
+			distributionCache->Release(imageMapDistribution);
+		imageMapDistribution = distributionCache->Get(imageMap, sampleUpperHemisphereOnly, width, height);
+	} else {
+		delete imageMapDistribution;
+		imageMapDistribution = BuildImageMapDistribution(imageMap, sampleUpperHemisphereOnly, width, height);
+	}
 }
 
 void InfiniteLight::GetPreprocessedData(const Distribution2D **imageMapDistributionData) const {
@@ -179,6 +217,76 @@ Properties InfiniteLight::ToProperties(const ImageMapCache &imgMapCache) const {
 	props.Set(Property(prefix + ".gamma")(1.f));
 	props.Set(Property(prefix + ".shift")(mapping.uDelta, mapping.vDelta));
 	props.Set(Property(prefix + ".sampleupperhemisphereonly")(sampleUpperHemisphereOnly));
+	props.Set(Property(prefix + ".distribution.maxsize")(distributionMaxSize));
 
 	return props;
 }
+
+//------------------------------------------------------------------------------
+// InfiniteLightDistributionCache
+//------------------------------------------------------------------------------
+
+InfiniteLightDistributionCache::~InfiniteLightDistributionCache() {
+	for (boost::unordered_map<const Distribution2D *, CacheEntry *>::const_iterator it = entryByDistribution.begin();
+			it != entryByDistribution.end(); ++it) {
+		delete it->second->distribution;
+		delete it->second;
+	}
+}
+
+const Distribution2D *InfiniteLightDistributionCache::Get(const ImageMap *imageMap,
+		const bool sampleUpperHemisphereOnly, const u_int width, const u_int height) {
+	// Compose the cache key
+	const string key = (boost::format("%p_%d_%d_%d") % imageMap %
+			sampleUpperHemisphereOnly % width % height).str();
+
+	boost::unordered_map<string, CacheEntry *>::const_iterator it = entryByKey.find(key);
+	if (it != entryByKey.end()) {
+		CacheEntry *entry = it->second;
+		++(entry->refCount);
+
+		return entry->distribution;
+	}
+
+	CacheEntry *entry = new CacheEntry();
+	entry->distribution = InfiniteLight::BuildImageMapDistribution(imageMap,
+			sampleUpperHemisphereOnly, width, height);
+	entry->imageMap = imageMap;
+	entry->key = key;
+	entry->refCount = 1;
+
+	entryByKey[key] = entry;
+	entryByDistribution[entry->distribution] = entry;
+
+	return entry->distribution;
+}
+
+void InfiniteLightDistributionCache::Release(const Distribution2D *distribution) {
+	if (!distribution)
+		return;
+
+	boost::unordered_map<const Distribution2D *, CacheEntry *>::iterator it = entryByDistribution.find(distribution);
+	if (it == entryByDistribution.end())
+		return;
+
+	CacheEntry *entry = it->second;
+	if (--(entry->refCount) == 0) {
+		// The entry may have been already removed by Invalidate()
+		boost::unordered_map<string, CacheEntry *>::iterator keyIt = entryByKey.find(entry->key);
+		if ((keyIt != entryByKey.end()) && (keyIt->second == entry))
+			entryByKey.erase(keyIt);
+		entryByDistribution.erase(it);
+
+		delete entry->distribution;
+		delete entry;
+	}
+}
+
+void InfiniteLightDistributionCache::Invalidate(const ImageMap *imageMap) {
+	for (boost::unordered_map<string, CacheEntry *>::iterator it = entryByKey.begin(); it != entryByKey.end(); ) {
+		if (it->second->imageMap == imageMap)
+			it = entryByKey.erase(it);
+		else
+			++it;
+	}
+}
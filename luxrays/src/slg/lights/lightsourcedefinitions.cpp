@@ -18,6 +18,8 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include "luxrays/utils/timeline.h"
+
 #include "slg/scene/scene.h"
 #include "slg/lights/trianglelight.h"
 
@@ -189,5 +191,6 @@ void LightSourceDefinitions::Preprocess(const Scene *scene) {
 	}
 
 	// Build the light strategy
+	TimelineScope timelineScope("Light strategy preprocessing", "scene");
 	lightStrategy->Preprocess(scene);
 }
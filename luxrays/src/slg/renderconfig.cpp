@@ -26,6 +26,7 @@
 #include "slg/renderconfig.h"
 #include "slg/engines/renderengine.h"
 #include "slg/film/film.h"
+#include "slg/film/asyncfilmwriter.h"
 
 #include "slg/samplers/random.h"
 #include "slg/samplers/sobol.h"
@@ -392,6 +393,7 @@ Properties RenderConfig::ToProperties(const Properties &cfg) {
 
 	// Film
 	props << Film::ToProperties(cfg);
+	props << AsyncFilmWriter::ToProperties(cfg);
 
 	// This property isn't really used by LuxCore but is useful for GUIs.
 	props << cfg.Get(Property("screen.refresh.interval")(100u));
@@ -16,7 +16,17 @@
  * limitations under the License.                                          *
  ***************************************************************************/
 
+#include <fstream>
+
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "luxrays/utils/timeline.h"
 
 #include "slg/rendersession.h"
 
@@ -38,17 +48,55 @@ RenderSession::RenderSession(RenderConfig *rcfg) {
 	lastPeriodicSave = WallClockTime();
 	periodicSaveEnabled = (periodiceSaveTime > 0.f);
 
+	asyncFilmWriter = AsyncFilmWriter::FromProperties(renderConfig->cfg);
+
+	checkpointFileName = renderConfig->cfg.Get(Property("batch.checkpoint.filename")("")).Get<string>();
+	checkpointThread = NULL;
+	checkpointStartFilm = NULL;
+
 	//--------------------------------------------------------------------------
 	// Create the Film
 	//--------------------------------------------------------------------------
 
-	film = renderConfig->AllocFilm();
+	{
+		TimelineScope timelineScope("Film allocation", "session");
+		film = renderConfig->AllocFilm();
+	}
 
 	//--------------------------------------------------------------------------
 	// Create the RenderEngine
 	//--------------------------------------------------------------------------
 
-	renderEngine = renderConfig->AllocRenderEngine(film, &filmMutex);
+	{
+		TimelineScope timelineScope("Render engine allocation", "session");
+		renderEngine = renderConfig->AllocRenderEngine(film, &filmMutex);
+	}
+
+	//--------------------------------------------------------------------------
+	// Resume the rendering from a checkpoint
+	//--------------------------------------------------------------------------
+
+	if (checkpointFileName != "") {
+		if (!renderEngine->HasCheckpointSupport()) {
+			SLG_LOG("[RenderSession] Render engine " << renderEngine->GetTag() << " doesn't support checkpoints");
+			checkpointFileName = "";
+		} else if (renderConfig->cfg.Get(Property("batch.checkpoint.resume")(true)).Get<bool>() &&
+				boost::filesystem::exists(checkpointFileName)) {
+			SLG_LOG("[RenderSession] Resuming the rendering from checkpoint: " << checkpointFileName);
+
+			try {
+				TimelineScope timelineScope("Checkpoint loading", "session");
+				Properties engineState;
+				checkpointStartFilm = LoadCheckpoint(checkpointFileName, &engineState);
+				renderEngine->SetCheckpoint(checkpointStartFilm, engineState);
+			} catch (exception &err) {
+				SLG_LOG("[RenderSession] Unable to resume the rendering from the checkpoint: " << err.what());
+
+				delete checkpointStartFilm;
+				checkpointStartFilm = NULL;
+			}
+		}
+	}
 }
 
 RenderSession::~RenderSession() {
@@ -57,12 +105,24 @@ RenderSession::~RenderSession() {
 	if (renderEngine->IsStarted())
 		Stop();
 
+	if (checkpointThread) {
+		checkpointThread->join();
+		delete checkpointThread;
+	}
+
 	delete renderEngine;
+	// Waits for the pending film snapshot to be written
+	delete asyncFilmWriter;
+	delete checkpointStartFilm;
 	delete film;
 }
 
 void RenderSession::Start() {
 	renderEngine->Start();
+
+	// The checkpoint film has been merged in the rendering
+	delete checkpointStartFilm;
+	checkpointStartFilm = NULL;
 }
 
 void RenderSession::Stop() {
@@ -117,11 +177,17 @@ void RenderSession::SaveFilm(const string &fileName) {
 	// Ask the RenderEngine to update the film
 	renderEngine->UpdateFilm();
 
-	// renderEngine->UpdateFilm() uses the film lock on its own
-	boost::unique_lock<boost::mutex> lock(filmMutex);
+	auto_ptr<Film> filmCopy;
+	{
+		// renderEngine->UpdateFilm() uses the film lock on its own
+		boost::unique_lock<boost::mutex> lock(filmMutex);
+
+		// Only a copy of the film is done while holding the lock
+		filmCopy.reset(film->Copy());
+	}
 
 	// Serialize the film
-	Film::SaveSerialized(fileName, film);
+	Film::SaveSerialized(fileName, filmCopy.get());
 }
 
 void RenderSession::SaveFilmOutputs() {
@@ -130,11 +196,112 @@ void RenderSession::SaveFilmOutputs() {
 	// Ask the RenderEngine to update the film
 	renderEngine->UpdateFilm();
 
-	// renderEngine->UpdateFilm() uses the film lock on its own
-	boost::unique_lock<boost::mutex> lock(filmMutex);
+	Film *checkpointFilm = NULL;
+	{
+		// renderEngine->UpdateFilm() uses the film lock on its own
+		boost::unique_lock<boost::mutex> lock(filmMutex);
+
+		// Save the film
+		film->Output();
+
+		// The multipart EXR file is written in addition to the film outputs.
+		// The film is locked only for the time required to take a snapshot,
+		// the file is written on a background thread.
+		if (asyncFilmWriter)
+			asyncFilmWriter->Write(*film);
+
+		// A checkpoint is saved together with the film outputs. As above, only
+		// a copy of the film is done while holding the lock.
+		if ((checkpointFileName != "") && !IsCheckpointWriting())
+			checkpointFilm = film->Copy();
+	}
+
+	if (checkpointFilm)
+		WriteCheckpoint(checkpointFilm);
+}
+
+//------------------------------------------------------------------------------
+// Checkpoints
+//------------------------------------------------------------------------------
+
+bool RenderSession::IsCheckpointWriting() {
+	if (!checkpointThread)
+		return false;
+
+	if (checkpointThread->timed_join(boost::posix_time::seconds(0))) {
+		delete checkpointThread;
+		checkpointThread = NULL;
+
+		return false;
+	}
+
+	SLG_LOG("[RenderSession] The previous checkpoint is still being written, skipping a checkpoint");
+	return true;
+}
+
+void RenderSession::WriteCheckpoint(Film *checkpointFilm) {
+	// The engine state is read after the copy of the film so the saved pass
+	// counters include all the samples of the film
+	const Properties engineState = renderEngine->GetCheckpointState();
+
+	checkpointThread = new boost::thread(boost::bind(&RenderSession::CheckpointThreadImpl,
+			this, checkpointFilm, engineState));
+}
+
+void RenderSession::CheckpointThreadImpl(Film *checkpointFilm, const Properties engineState) {
+	const double startTime = WallClockTime();
+	try {
+		SaveCheckpoint(checkpointFileName, checkpointFilm, engineState);
+
+		SLG_LOG("[RenderSession] Checkpoint writing time (" << checkpointFileName << "): " <<
+				int((WallClockTime() - startTime) * 1000.0) << "ms");
+	} catch (exception &err) {
+		SLG_LOG("[RenderSession] Error while writing checkpoint " << checkpointFileName << ": " << err.what());
+	}
+
+	delete checkpointFilm;
+}
+
+void RenderSession::SaveCheckpoint(const string &fileName, const Film *film,
+		const Properties &engineState) {
+	// I write a temporary file first so an interrupted rendering can not
+	// leave a broken checkpoint in place of the last one written
+	const string tmpFileName = fileName + ".tmp";
+	{
+		ofstream outFile;
+		outFile.exceptions(ofstream::failbit | ofstream::badbit | ofstream::eofbit);
+		outFile.open(tmpFileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+
+		// Enable compression
+		boost::iostreams::filtering_stream<boost::iostreams::output> gzipStream;
+		gzipStream.push(boost::iostreams::gzip_compressor(4));
+		gzipStream.push(outFile);
+
+		boost::archive::binary_oarchive outArchive(gzipStream);
+		outArchive << film;
+		outArchive << engineState;
+	}
+
+	boost::filesystem::rename(tmpFileName, fileName);
+}
+
+Film *RenderSession::LoadCheckpoint(const string &fileName, Properties *engineState) {
+	ifstream inFile;
+	inFile.exceptions(ifstream::failbit | ifstream::badbit | ifstream::eofbit);
+	inFile.open(fileName.c_str(), ios_base::in | ios_base::binary);
+
+	// Enable compression
+	boost::iostreams::filtering_stream<boost::iostreams::input> gzipStream;
+	gzipStream.push(boost::iostreams::gzip_decompressor());
+	gzipStream.push(inFile);
+
+	boost::archive::binary_iarchive inArchive(gzipStream);
+
+	Film *film;
+	inArchive >> film;
+	inArchive >> *engineState;
 
-	// Save the film
-	film->Output();
+	return film;
 }
 
 void RenderSession::Parse(const luxrays::Properties &props) {
@@ -150,11 +317,14 @@ void RenderSession::Parse(const luxrays::Properties &props) {
 		renderConfig->UpdateFilmProperties(props);
 
 		// Delete the old film
+		const u_longlong filmVersion = film->GetVersion();
 		delete film;
 		film = NULL;
 
-		// Create the new film
+		// Create the new film, its version must be different from any
+		// version of the old film (the channel memory has changed)
 		film = renderConfig->AllocFilm();
+		film->SetVersion(filmVersion + 1);
 
 		// I have to update the camera
 		renderConfig->scene->PreprocessCamera(film->GetWidth(), film->GetHeight(), film->GetSubRegion());
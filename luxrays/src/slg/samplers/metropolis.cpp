@@ -30,14 +30,45 @@ using namespace slg;
 // MetropolisSamplerSharedData
 //------------------------------------------------------------------------------
 
-MetropolisSamplerSharedData::MetropolisSamplerSharedData() : SamplerSharedData() {
-	totalLuminance = 0.;
-	sampleCount = 0.;
+MetropolisSamplerSharedData::MetropolisSamplerSharedData(const u_int chainCount) : SamplerSharedData() {
+	totalLuminance.resize(chainCount, 0.);
+	sampleCount.resize(chainCount, 0.);
+}
+
+Properties MetropolisSamplerSharedData::GetState() const {
+	Property totalLuminanceProp("sampler.metropolis.state.totalluminance");
+	Property sampleCountProp("sampler.metropolis.state.samplecount");
+	for (u_int i = 0; i < totalLuminance.size(); ++i) {
+		totalLuminanceProp.Add(totalLuminance[i]);
+		sampleCountProp.Add(sampleCount[i]);
+	}
+
+	return Properties() << totalLuminanceProp << sampleCountProp;
+}
+
+void MetropolisSamplerSharedData::SetState(const Properties &state) {
+	if (!state.IsDefined("sampler.metropolis.state.totalluminance"))
+		return;
+
+	const Property &totalLuminanceProp = state.Get("sampler.metropolis.state.totalluminance");
+	const Property &sampleCountProp = state.Get("sampler.metropolis.state.samplecount");
+	// The estimation of the image mean intensity can be restored only if the
+	// number of chains has not changed
+	if ((totalLuminanceProp.GetSize() != totalLuminance.size()) ||
+			(sampleCountProp.GetSize() != sampleCount.size()))
+		return;
+
+	for (u_int i = 0; i < totalLuminance.size(); ++i) {
+		totalLuminance[i] = totalLuminanceProp.Get<double>(i);
+		sampleCount[i] = sampleCountProp.Get<double>(i);
+	}
 }
 
 SamplerSharedData *MetropolisSamplerSharedData::FromProperties(const Properties &cfg,
 		RandomGenerator *rndGen) {
-	return new MetropolisSamplerSharedData();
+	const u_int chainCount = Max(1u, cfg.Get(Property("sampler.metropolis.chaincount")(1u)).Get<u_int>());
+
+	return new MetropolisSamplerSharedData(chainCount);
 }
 
 //------------------------------------------------------------------------------
@@ -47,18 +78,43 @@ SamplerSharedData *MetropolisSamplerSharedData::FromProperties(const Properties
 MetropolisSampler::MetropolisSampler(RandomGenerator *rnd, Film *flm,
 		const FilmSampleSplatter *flmSplatter, const u_int maxRej,
 		const float pLarge, const float imgRange,
-		MetropolisSamplerSharedData *samplerSharedData) : Sampler(rnd, flm, flmSplatter),
+		MetropolisSamplerSharedData *samplerSharedData,
+		const u_int chainCount, const float swapRate,
+		const float hotExponent, const bool stratified) : Sampler(rnd, flm, flmSplatter),
 		sharedData(samplerSharedData),
 		maxRejects(maxRej),	largeMutationProbability(pLarge), imageMutationRange(imgRange),
-		samples(NULL), sampleStamps(NULL), currentSamples(NULL), currentSampleStamps(NULL),
-		cooldown(true) {
+		chainSwapRate(swapRate), hotChainExponent(hotExponent),
+		stratifiedLargeSteps(stratified), chainIndex(0), largeStepIndex(0),
+		largeStepOffsetX(0.f), largeStepOffsetY(0.f) {
+	if (chainCount > sharedData->totalLuminance.size())
+		throw runtime_error("Metropolis sampler shared data has been allocated for " +
+				boost::lexical_cast<string>(sharedData->totalLuminance.size()) +
+				" chains instead of " + boost::lexical_cast<string>(chainCount));
+
+	chains.resize(Max(1u, chainCount));
+	for (u_int i = 0; i < chains.size(); ++i) {
+		MetropolisChain &chain = chains[i];
+
+		chain.samples = NULL;
+		chain.sampleStamps = NULL;
+		chain.currentSamples = NULL;
+		chain.currentSampleStamps = NULL;
+		// Chain 0 has always the luminance as target function, the last one
+		// luminance^hotChainExponent
+		chain.exponent = (i == 0) ? 1.f : powf(hotChainExponent, i / float(chains.size() - 1));
+		chain.cooldown = true;
+	}
 }
 
 MetropolisSampler::~MetropolisSampler() {
-	delete samples;
-	delete sampleStamps;
-	delete currentSamples;
-	delete currentSampleStamps;
+	for (u_int i = 0; i < chains.size(); ++i) {
+		MetropolisChain &chain = chains[i];
+
+		delete[] chain.samples;
+		delete[] chain.sampleStamps;
+		delete[] chain.currentSamples;
+		delete[] chain.currentSampleStamps;
+	}
 }
 
 // Mutate a value in the range [0-1]
@@ -96,52 +152,153 @@ float MutateScaled(const float x, const float range, const float randomValue) {
 
 void MetropolisSampler::RequestSamples(const u_int size) {
 	sampleSize = size;
-	samples = new float[sampleSize];
-	sampleStamps = new u_int[sampleSize];
-	currentSamples = new float[sampleSize];
-	currentSampleStamps = new u_int[sampleSize];
-
-	isLargeMutation = true;
-	weight = 0.f;
-	consecRejects = 0;
-	currentLuminance = 0.;
-	fill(sampleStamps, sampleStamps + sampleSize, 0);
-	stamp = 1;
-	currentStamp = 1;
-	currentSampleResult.resize(0);
+
+	for (u_int i = 0; i < chains.size(); ++i) {
+		MetropolisChain &chain = chains[i];
+
+		chain.samples = new float[sampleSize];
+		chain.sampleStamps = new u_int[sampleSize];
+		chain.currentSamples = new float[sampleSize];
+		chain.currentSampleStamps = new u_int[sampleSize];
+
+		chain.isLargeMutation = true;
+		chain.weight = 0.f;
+		chain.consecRejects = 0;
+		chain.currentLuminance = 0.;
+		fill(chain.sampleStamps, chain.sampleStamps + sampleSize, 0);
+		chain.stamp = 1;
+		chain.currentStamp = 1;
+		chain.currentSampleResult.resize(0);
+	}
+	chainIndex = 0;
+
+	if (stratifiedLargeSteps) {
+		// Each sampler uses a different random offset of the same sequence
+		largeStepIndex = 0;
+		largeStepOffsetX = rndGen->floatValue();
+		largeStepOffsetY = rndGen->floatValue();
+	}
 }
 
 float MetropolisSampler::GetSample(const u_int index) {
 	assert (index < sampleSize);
 
-	u_int sampleStamp = sampleStamps[index];
+	MetropolisChain &chain = chains[chainIndex];
+	u_int sampleStamp = chain.sampleStamps[index];
 
 	float s;
 	if (sampleStamp == 0) {
-		s = rndGen->floatValue();
+		if (stratifiedLargeSteps && (index < 2)) {
+			// Large mutations of image X/Y follow a (0,2) sequence in order
+			// to not leave large regions of the image without any chain
+			s = static_cast<float>(RadicalInverse(largeStepIndex + 1, (index == 0) ? 2 : 3)) +
+					((index == 0) ? largeStepOffsetX : largeStepOffsetY);
+			if (s >= 1.f)
+				s -= 1.f;
+		} else
+			s = rndGen->floatValue();
 		sampleStamp = 1;
 	} else
-		s = samples[index];
+		s = chain.samples[index];
 
 	// Mutate the sample up to the currentStamp
 	if ((index == 0) || (index == 1)) {
 		// 0 and 1 are used for image X/Y
-		for (u_int i = sampleStamp; i < stamp; ++i)
+		for (u_int i = sampleStamp; i < chain.stamp; ++i)
 			s = MutateScaled(s, imageMutationRange, rndGen->floatValue());
 	} else {
-		for (u_int i = sampleStamp; i < stamp; ++i)
+		for (u_int i = sampleStamp; i < chain.stamp; ++i)
 			s = Mutate(s, rndGen->floatValue());
 	}
 
-	samples[index] = s;
-	sampleStamps[index] = stamp;
+	chain.samples[index] = s;
+	chain.sampleStamps[index] = chain.stamp;
 
 	return s;
 }
 
+double MetropolisSampler::Target(const MetropolisChain &chain, const double luminance) const {
+	return (chain.exponent == 1.f) ? luminance : pow(luminance, (double)chain.exponent);
+}
+
+float MetropolisSampler::InvMeanTarget(const u_int index) const {
+	return (sharedData->totalLuminance[index] > 0.) ?
+		static_cast<float>(sharedData->sampleCount[index] / sharedData->totalLuminance[index]) : 1.f;
+}
+
+void MetropolisSampler::SplatCurrentSample(const u_int index) {
+	const MetropolisChain &chain = chains[index];
+
+	// Define the probability of large mutations. It is 50% if we are still
+	// inside the cooldown phase.
+	const float currentLargeMutationProbability = (chain.cooldown) ? .5f : largeMutationProbability;
+
+	const float norm = chain.weight / (Target(chain, chain.currentLuminance) * InvMeanTarget(index) +
+			currentLargeMutationProbability);
+	if (norm > 0.f)
+		AddSamplesToFilm(chain.currentSampleResult, norm);
+}
+
+void MetropolisSampler::SetUpNextMutation(MetropolisChain &chain) {
+	if (chain.isLargeMutation) {
+		chain.stamp = 1;
+		fill(chain.sampleStamps, chain.sampleStamps + sampleSize, 0);
+		++largeStepIndex;
+	} else
+		++chain.stamp;
+}
+
+void MetropolisSampler::TrySwap() {
+	// Select a random pair of adjacent chains
+	const u_int index0 = Min<u_int>(Floor2UInt(rndGen->floatValue() * (chains.size() - 1)), chains.size() - 2);
+	const u_int index1 = index0 + 1;
+	MetropolisChain &chain0 = chains[index0];
+	MetropolisChain &chain1 = chains[index1];
+
+	// Replica exchange acceptance probability:
+	// (T0(x1) * T1(x0)) / (T0(x0) * T1(x1))
+	float accProb;
+	if (chain0.currentLuminance <= 0.)
+		accProb = 1.f;
+	else if (chain1.currentLuminance <= 0.)
+		accProb = 0.f;
+	else
+		accProb = Min<float>(1.f, pow(chain1.currentLuminance / chain0.currentLuminance,
+				(double)(chain0.exponent - chain1.exponent)));
+
+	if ((accProb == 1.f) || ((accProb > 0.f) && (rndGen->floatValue() < accProb))) {
+		// Add accumulated SampleResult of both current samples
+		SplatCurrentSample(index0);
+		SplatCurrentSample(index1);
+
+		// Exchange the current samples
+		swap(chain0.currentStamp, chain1.currentStamp);
+		swap(chain0.currentLuminance, chain1.currentLuminance);
+		swap(chain0.currentSamples, chain1.currentSamples);
+		swap(chain0.currentSampleStamps, chain1.currentSampleStamps);
+		chain0.currentSampleResult.swap(chain1.currentSampleResult);
+
+		MetropolisChain *swappedChains[2] = { &chain0, &chain1 };
+		for (u_int i = 0; i < 2; ++i) {
+			MetropolisChain &chain = *swappedChains[i];
+
+			chain.weight = 0.f;
+			chain.consecRejects = 0;
+
+			// Restart the next mutation from the new current sample
+			chain.stamp = chain.currentStamp;
+			copy(chain.currentSamples, chain.currentSamples + sampleSize, chain.samples);
+			copy(chain.currentSampleStamps, chain.currentSampleStamps + sampleSize, chain.sampleStamps);
+			SetUpNextMutation(chain);
+		}
+	}
+}
+
 void MetropolisSampler::NextSample(const vector<SampleResult> &sampleResults) {
 	film->AddSampleCount(1.0);
 
+	MetropolisChain &chain = chains[chainIndex];
+
 	// Calculate the sample result luminance
 	const u_int pixelCount = film->GetWidth() * film->GetHeight();
 	float newLuminance = 0.f;
@@ -167,83 +324,89 @@ void MetropolisSampler::NextSample(const vector<SampleResult> &sampleResults) {
 		}
 	}
 
-	if (isLargeMutation) {
+	if (chain.isLargeMutation) {
 		// Atomic 64bit for double are not available on all CPUs so I simply
 		// avoid synchronization.
-		sharedData->totalLuminance += newLuminance;
-		sharedData->sampleCount += 1.;
+		sharedData->totalLuminance[chainIndex] += Target(chain, newLuminance);
+		sharedData->sampleCount[chainIndex] += 1.;
 	}
 
-	const float invMeanIntensity = (sharedData->totalLuminance > 0.) ?
-		static_cast<float>(sharedData->sampleCount / sharedData->totalLuminance) : 1.f;
+	const float invMeanIntensity = InvMeanTarget(chainIndex);
 
 	// Define the probability of large mutations. It is 50% if we are still
 	// inside the cooldown phase.
-	const float currentLargeMutationProbability = (cooldown) ? .5f : largeMutationProbability;
+	const float currentLargeMutationProbability = (chain.cooldown) ? .5f : largeMutationProbability;
 
 	// Calculate accept probability from old and new image sample
 	float accProb;
-	if ((currentLuminance > 0.f) && (consecRejects < maxRejects))
-		accProb = Min<float>(1.f, newLuminance / currentLuminance);
+	if ((chain.currentLuminance > 0.f) && (chain.consecRejects < maxRejects))
+		accProb = Min<float>(1.f, Target(chain, newLuminance) / Target(chain, chain.currentLuminance));
 	else
 		accProb = 1.f;
-	const float newWeight = accProb + (isLargeMutation ? 1.f : 0.f);
-	weight += 1.f - accProb;
+	const float newWeight = accProb + (chain.isLargeMutation ? 1.f : 0.f);
+	chain.weight += 1.f - accProb;
 
 	// Try or force accepting of the new sample
 	if ((accProb == 1.f) || (rndGen->floatValue() < accProb)) {
 		// Add accumulated SampleResult of previous reference sample
-		const float norm = weight / (currentLuminance * invMeanIntensity + currentLargeMutationProbability);
-		if (norm > 0.f)
-			AddSamplesToFilm(currentSampleResult, norm);
+		SplatCurrentSample(chainIndex);
 
 		// Save new contributions for reference
-		weight = newWeight;
-		currentStamp = stamp;
-		currentLuminance = newLuminance;
-		copy(samples, samples + sampleSize, currentSamples);
-		copy(sampleStamps, sampleStamps + sampleSize, currentSampleStamps);
-		currentSampleResult = sampleResults;
-
-		consecRejects = 0;
+		chain.weight = newWeight;
+		chain.currentStamp = chain.stamp;
+		chain.currentLuminance = newLuminance;
+		copy(chain.samples, chain.samples + sampleSize, chain.currentSamples);
+		copy(chain.sampleStamps, chain.sampleStamps + sampleSize, chain.currentSampleStamps);
+		chain.currentSampleResult = sampleResults;
+
+		chain.consecRejects = 0;
 	} else {
 		// Add contribution of new sample before rejecting it
-		const float norm = newWeight / (newLuminance * invMeanIntensity + currentLargeMutationProbability);
+		const float norm = newWeight / (Target(chain, newLuminance) * invMeanIntensity + currentLargeMutationProbability);
 		if (norm > 0.f)
 			AddSamplesToFilm(sampleResults, norm);
 
 		// Restart from previous reference
-		stamp = currentStamp;
-		copy(currentSamples, currentSamples + sampleSize, samples);
-		copy(currentSampleStamps, currentSampleStamps + sampleSize, sampleStamps);
+		chain.stamp = chain.currentStamp;
+		copy(chain.currentSamples, chain.currentSamples + sampleSize, chain.samples);
+		copy(chain.currentSampleStamps, chain.currentSampleStamps + sampleSize, chain.sampleStamps);
 
-		++consecRejects;
+		++chain.consecRejects;
 	}
 
 	// Cooldown is used in order to not have problems in the estimation of meanIntensity
 	// when large mutation probability is very small
-	if (cooldown) {
+	if (chain.cooldown) {
 		// Check if it is time to end the cooldown
-		if (sharedData->sampleCount > pixelCount) {
-			cooldown = false;
-			isLargeMutation = (rndGen->floatValue() < currentLargeMutationProbability);
+		if (sharedData->sampleCount[chainIndex] > pixelCount) {
+			chain.cooldown = false;
+			chain.isLargeMutation = (rndGen->floatValue() < currentLargeMutationProbability);
 		} else
-			isLargeMutation = (rndGen->floatValue() < .5f);
+			chain.isLargeMutation = (rndGen->floatValue() < .5f);
 	} else
-		isLargeMutation = (rndGen->floatValue() < currentLargeMutationProbability);
+		chain.isLargeMutation = (rndGen->floatValue() < currentLargeMutationProbability);
 
-	if (isLargeMutation) {
-		stamp = 1;
-		fill(sampleStamps, sampleStamps + sampleSize, 0);
-	} else
-		++stamp;
+	SetUpNextMutation(chain);
+
+	if (chains.size() > 1) {
+		// Replica exchange between adjacent chains
+		if ((chainSwapRate > 0.f) && (rndGen->floatValue() < chainSwapRate))
+			TrySwap();
+
+		// Multiplex the chains
+		chainIndex = (chainIndex + 1) % chains.size();
+	}
 }
 
 Properties MetropolisSampler::ToProperties() const {
 	return Sampler::ToProperties() <<
 			Property("sampler.metropolis.largesteprate")(largeMutationProbability) <<
 			Property("sampler.metropolis.maxconsecutivereject")(maxRejects) <<
-			Property("sampler.metropolis.imagemutationrate")(imageMutationRange);
+			Property("sampler.metropolis.imagemutationrate")(imageMutationRange) <<
+			Property("sampler.metropolis.chaincount")((u_int)chains.size()) <<
+			Property("sampler.metropolis.swaprate")(chainSwapRate) <<
+			Property("sampler.metropolis.hotchainexponent")(hotChainExponent) <<
+			Property("sampler.metropolis.stratifiedlargesteps")(stratifiedLargeSteps);
 }
 
 //------------------------------------------------------------------------------
@@ -255,7 +418,11 @@ Properties MetropolisSampler::ToProperties(const Properties &cfg) {
 			cfg.Get(GetDefaultProps().Get("sampler.type")) <<
 			cfg.Get(GetDefaultProps().Get("sampler.metropolis.largesteprate")) <<
 			cfg.Get(GetDefaultProps().Get("sampler.metropolis.maxconsecutivereject")) <<
-			cfg.Get(GetDefaultProps().Get("sampler.metropolis.imagemutationrate"));
+			cfg.Get(GetDefaultProps().Get("sampler.metropolis.imagemutationrate")) <<
+			cfg.Get(GetDefaultProps().Get("sampler.metropolis.chaincount")) <<
+			cfg.Get(GetDefaultProps().Get("sampler.metropolis.swaprate")) <<
+			cfg.Get(GetDefaultProps().Get("sampler.metropolis.hotchainexponent")) <<
+			cfg.Get(GetDefaultProps().Get("sampler.metropolis.stratifiedlargesteps"));
 }
 
 Sampler *MetropolisSampler::FromProperties(const Properties &cfg, RandomGenerator *rndGen,
@@ -263,10 +430,15 @@ Sampler *MetropolisSampler::FromProperties(const Properties &cfg, RandomGenerato
 	const float rate = Clamp(cfg.Get(GetDefaultProps().Get("sampler.metropolis.largesteprate")).Get<float>(), 0.f, 1.f);
 	const u_int reject = cfg.Get(GetDefaultProps().Get("sampler.metropolis.maxconsecutivereject")).Get<u_int>();
 	const float mutationRate = Clamp(cfg.Get(GetDefaultProps().Get("sampler.metropolis.imagemutationrate")).Get<float>(), 0.f, 1.f);
+	const u_int chainCount = Max(1u, cfg.Get(GetDefaultProps().Get("sampler.metropolis.chaincount")).Get<u_int>());
+	const float swapRate = Clamp(cfg.Get(GetDefaultProps().Get("sampler.metropolis.swaprate")).Get<float>(), 0.f, 1.f);
+	const float hotExponent = Clamp(cfg.Get(GetDefaultProps().Get("sampler.metropolis.hotchainexponent")).Get<float>(), .01f, 1.f);
+	const bool stratified = cfg.Get(GetDefaultProps().Get("sampler.metropolis.stratifiedlargesteps")).Get<bool>();
 
 	return new MetropolisSampler(rndGen, film, flmSplatter,
 			reject, rate, mutationRate,
-			(MetropolisSamplerSharedData *)sharedData);
+			(MetropolisSamplerSharedData *)sharedData,
+			chainCount, swapRate, hotExponent, stratified);
 }
 
 slg::ocl::Sampler *MetropolisSampler::FromPropertiesOCL(const Properties &cfg) {
@@ -276,6 +448,8 @@ slg::ocl::Sampler *MetropolisSampler::FromPropertiesOCL(const Properties &cfg) {
 	oclSampler->metropolis.largeMutationProbability = cfg.Get(GetDefaultProps().Get("sampler.metropolis.largesteprate")).Get<float>();
 	oclSampler->metropolis.imageMutationRange = cfg.Get(GetDefaultProps().Get("sampler.metropolis.imagemutationrate")).Get<float>();
 	oclSampler->metropolis.maxRejects = cfg.Get(GetDefaultProps().Get("sampler.metropolis.maxconsecutivereject")).Get<u_int>();
+	// Multiple chains (sampler.metropolis.chaincount, etc.) are supported only
+	// by the CPU implementation
 
 	return oclSampler;
 }
@@ -286,7 +460,11 @@ const Properties &MetropolisSampler::GetDefaultProps() {
 			Property("sampler.type")(GetObjectTag()) <<
 			Property("sampler.metropolis.largesteprate")(.4f) <<
 			Property("sampler.metropolis.maxconsecutivereject")(512) <<
-			Property("sampler.metropolis.imagemutationrate")(.1f);
+			Property("sampler.metropolis.imagemutationrate")(.1f) <<
+			Property("sampler.metropolis.chaincount")(1u) <<
+			Property("sampler.metropolis.swaprate")(.1f) <<
+			Property("sampler.metropolis.hotchainexponent")(.5f) <<
+			Property("sampler.metropolis.stratifiedlargesteps")(false);
 
 	return props;
 }
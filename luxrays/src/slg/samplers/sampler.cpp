@@ -45,6 +45,11 @@ SamplerSharedData *SamplerSharedData::FromProperties(const Properties &cfg, Rand
 //------------------------------------------------------------------------------
 
 void Sampler::AddSamplesToFilm(const vector<SampleResult> &sampleResults, const float weight) const {
+	if (filmSplatter) {
+		filmSplatter->SplatSamples(*film, sampleResults, weight);
+		return;
+	}
+
 	for (vector<SampleResult>::const_iterator sr = sampleResults.begin(); sr < sampleResults.end(); ++sr) {
 		if (sr->useFilmSplat)
 			filmSplatter->SplatSample(*film, *sr, weight);
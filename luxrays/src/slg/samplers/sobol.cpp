@@ -36,36 +36,54 @@ SobolSamplerSharedData::SobolSamplerSharedData(RandomGenerator *rndGen) : Sample
 	pass = SOBOL_STARTOFFSET;
 }
 
+Properties SobolSamplerSharedData::GetState() const {
+	return Properties() <<
+			Property("sampler.sobol.state.pass")(pass.load()) <<
+			Property("sampler.sobol.state.rng0")(rng0) <<
+			Property("sampler.sobol.state.rng1")(rng1);
+}
+
+void SobolSamplerSharedData::SetState(const Properties &state) {
+	// The sequence continues from where it was and with the same scrambling
+	if (state.IsDefined("sampler.sobol.state.pass")) {
+		pass = state.Get("sampler.sobol.state.pass").Get<u_int>();
+		rng0 = state.Get("sampler.sobol.state.rng0").Get<float>();
+		rng1 = state.Get("sampler.sobol.state.rng1").Get<float>();
+	}
+}
+
 SamplerSharedData *SobolSamplerSharedData::FromProperties(const Properties &cfg,
 		RandomGenerator *rndGen) {
 	return new SobolSamplerSharedData(rndGen);
 }
 
 //------------------------------------------------------------------------------
-// Sobol sampler
-//
-// This sampler is based on Blender Cycles Sobol implementation.
+// SobolSequence
 //------------------------------------------------------------------------------
 
-SobolSampler::SobolSampler(RandomGenerator *rnd, Film *flm,
-		const FilmSampleSplatter *flmSplatter,
-		SobolSamplerSharedData *samplerSharedData) : Sampler(rnd, flm, flmSplatter),
-		sharedData(samplerSharedData), directions(NULL) {
+SobolSequence::SobolSequence() : dimensionCount(0), index(0) {
 }
 
-SobolSampler::~SobolSampler() {
-	delete directions;
-}
+void SobolSequence::RequestSamples(const u_int size) {
+	dimensionCount = size;
 
-void SobolSampler::RequestSamples(const u_int size) {
-	directions = new u_int[size * SOBOL_BITS];
-	SobolGenerateDirectionVectors(directions, size);
+	directions.resize(size * SOBOL_BITS);
+	SobolGenerateDirectionVectors(&directions[0], size);
 
-	passBase = sharedData->pass.fetch_add(SOBOL_THREAD_WORK_SIZE);
-	passOffset = 0;
+	grayDirections.resize(size * SOBOL_BITS);
+	for (u_int d = 0; d < size; ++d) {
+		u_int prefix = 0;
+		for (u_int j = 0; j < SOBOL_BITS; ++j) {
+			prefix ^= directions[d * SOBOL_BITS + j];
+			grayDirections[j * size + d] = prefix;
+		}
+	}
+
+	values.resize(size);
+	SetIndex(0);
 }
 
-u_int SobolSampler::SobolDimension(const u_int index, const u_int dimension) const {
+u_int SobolSequence::SobolDimension(const u_int index, const u_int dimension) const {
 	const u_int offset = dimension * SOBOL_BITS;
 	u_int result = 0;
 	u_int i = index;
@@ -78,8 +96,75 @@ u_int SobolSampler::SobolDimension(const u_int index, const u_int dimension) con
 	return result;
 }
 
+void SobolSequence::SetIndex(const u_int i) {
+	index = i;
+	for (u_int d = 0; d < dimensionCount; ++d)
+		values[d] = SobolDimension(index, d);
+}
+
+static inline u_int CountTrailingZeros(u_int v) {
+	// v is never 0 here
+	u_int c = 0;
+	while (!(v & 1)) {
+		v >>= 1;
+		++c;
+	}
+
+	return c;
+}
+
+void SobolSequence::NextIndex() {
+	++index;
+	if (!index) {
+		// Wrapped around
+		SetIndex(0);
+		return;
+	}
+
+	const u_int *gray = &grayDirections[CountTrailingZeros(index) * dimensionCount];
+	u_int *v = &values[0];
+	for (u_int d = 0; d < dimensionCount; ++d)
+		v[d] ^= gray[d];
+}
+
+void SobolSequence::GenerateBlock(const u_int first, const u_int count, u_int *result) {
+	if (!count)
+		return;
+
+	SetIndex(first);
+	for (u_int s = 0;;) {
+		copy(values.begin(), values.end(), &result[s * dimensionCount]);
+		if (++s >= count)
+			break;
+		NextIndex();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Sobol sampler
+//
+// This sampler is based on Blender Cycles Sobol implementation.
+//------------------------------------------------------------------------------
+
+SobolSampler::SobolSampler(RandomGenerator *rnd, Film *flm,
+		const FilmSampleSplatter *flmSplatter,
+		SobolSamplerSharedData *samplerSharedData) : Sampler(rnd, flm, flmSplatter),
+		sharedData(samplerSharedData) {
+}
+
+SobolSampler::~SobolSampler() {
+}
+
+void SobolSampler::RequestSamples(const u_int size) {
+	sequence.RequestSamples(size);
+
+	passBase = sharedData->pass.fetch_add(SOBOL_THREAD_WORK_SIZE);
+	passOffset = 0;
+	sequence.SetIndex(passBase);
+}
+
 float SobolSampler::GetSample(const u_int index) {
-	const u_int iResult = SobolDimension(passBase + passOffset, index);
+	const u_int iResult = sequence.GetValues()[index];
 	const float fResult = iResult * (1.f / 0xffffffffu);
 	
 	// Cranley-Patterson rotation to reduce visible regular patterns
@@ -97,7 +182,9 @@ void SobolSampler::NextSample(const vector<SampleResult> &sampleResults) {
 	if (passOffset >= SOBOL_THREAD_WORK_SIZE) {
 		passBase = sharedData->pass.fetch_add(SOBOL_THREAD_WORK_SIZE);
 		passOffset = 0;
-	}
+		sequence.SetIndex(passBase);
+	} else
+		sequence.NextIndex();
 }
 
 //------------------------------------------------------------------------------
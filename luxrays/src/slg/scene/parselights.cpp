@@ -85,7 +85,7 @@ void Scene::ParseLights(const Properties &props) {
 		if ((newLight->GetType() == TYPE_IL) ||
 				(newLight->GetType() == TYPE_MAPPOINT) ||
 				(newLight->GetType() == TYPE_PROJECTION))
-			editActions.AddActions(IMAGEMAPS_EDIT);
+			AddImageMapsEditAction();
 	}
 
 	editActions.AddActions(LIGHTS_EDIT | LIGHT_TYPES_EDIT);
@@ -234,6 +234,8 @@ LightSource *Scene::CreateLightSource(const string &lightName, const luxrays::Pr
 		il->lightToWorld = light2World;
 		il->imageMap = imgMap;
 		il->sampleUpperHemisphereOnly = props.Get(Property(propName + ".sampleupperhemisphereonly")(false)).Get<bool>();
+		il->distributionMaxSize = Max(0, props.Get(Property(propName + ".distribution.maxsize")(0)).Get<int>());
+		il->distributionCache = &infiniteLightDistributionCache;
 
 		// An old parameter kept only for compatibility
 		const UV shift = props.Get(Property(propName + ".shift")(0.f, 0.f)).Get<UV>();
@@ -34,6 +34,18 @@ using namespace std;
 using namespace luxrays;
 using namespace slg;
 
+// Frees all the loaded meshes, starting from index first, not yet defined in
+// the scene
+static void DeleteLoadedMeshes(vector<ExtMesh *> &loadedMeshes, const u_int first) {
+	for (u_int i = first; i < loadedMeshes.size(); ++i) {
+		if (loadedMeshes[i]) {
+			loadedMeshes[i]->Delete();
+			delete loadedMeshes[i];
+			loadedMeshes[i] = NULL;
+		}
+	}
+}
+
 void Scene::ParseShapes(const Properties &props) {
 	vector<string> shapeKeys = props.GetAllUniqueSubNames("scene.shapes");
 	if (shapeKeys.size() == 0) {
@@ -41,15 +53,72 @@ void Scene::ParseShapes(const Properties &props) {
 		return;
 	}
 
-	double lastPrint = WallClockTime();
-	u_int shapeCount = 0;
+	vector<string> shapeNames;
+	shapeNames.reserve(shapeKeys.size());
 	BOOST_FOREACH(const string &key, shapeKeys) {
 		// Extract the shape name
 		const string shapeName = Property::ExtractField(key, 2);
 		if (shapeName == "")
 			throw runtime_error("Syntax error in shape definition: " + shapeName);
 
-		ExtMesh *mesh = CreateShape(shapeName, props);
+		shapeNames.push_back(shapeName);
+	}
+
+	//--------------------------------------------------------------------------
+	// Load in parallel all the shapes without dependencies from other shapes
+	// or from the scene (i.e. ply files and inlined meshes)
+	//--------------------------------------------------------------------------
+
+	const double tStart = WallClockTime();
+
+	vector<ExtMesh *> loadedMeshes(shapeNames.size(), NULL);
+	vector<string> loadErrors(shapeNames.size());
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int i = 0; i < shapeNames.size(); ++i) {
+		const string propName = "scene.shapes." + shapeNames[i];
+		const string shapeType = props.Get(Property(propName + ".type")("mesh")).Get<string>();
+
+		if ((shapeType == "mesh") || (shapeType == "inlinedmesh")) {
+			try {
+				loadedMeshes[i] = CreateShape(shapeNames[i], props);
+			} catch (std::exception &err) {
+				loadErrors[i] = err.what();
+			}
+		}
+	}
+
+	SDL_LOG("Shapes loading time: " << int((WallClockTime() - tStart) * 1000.0) << "ms");
+
+	//--------------------------------------------------------------------------
+	// Define the shapes in the same order of the properties
+	//--------------------------------------------------------------------------
+
+	double lastPrint = WallClockTime();
+	u_int shapeCount = 0;
+	for (u_int i = 0; i < shapeNames.size(); ++i) {
+		const string &shapeName = shapeNames[i];
+
+		if (loadErrors[i] != "") {
+			DeleteLoadedMeshes(loadedMeshes, i);
+
+			throw runtime_error(loadErrors[i]);
+		}
+
+		ExtMesh *mesh = loadedMeshes[i];
+		if (!mesh) {
+			// The shapes with dependencies are created serially
+			try {
+				mesh = CreateShape(shapeName, props);
+			} catch (...) {
+				DeleteLoadedMeshes(loadedMeshes, i + 1);
+				throw;
+			}
+		}
 		if (extMeshCache.IsExtMeshDefined(shapeName)) {
 			// A replacement for an existing mesh
 			const ExtMesh *oldMesh = extMeshCache.GetExtMesh(shapeName);
@@ -76,6 +76,23 @@ void Scene::ParseTextures(const Properties &props) {
 		return;
 	}
 
+	// Decode in parallel all the image maps used by the textures
+	vector<ImageMapCache::ImageMapRequest> imgMapRequests;
+	BOOST_FOREACH(const string &key, texKeys) {
+		const string propName = "scene.textures." + Property::ExtractField(key, 2);
+
+		if (props.Get(Property(propName + ".type")("imagemap")).Get<string>() == "imagemap") {
+			imgMapRequests.push_back(ImageMapCache::ImageMapRequest(
+					props.Get(Property(propName + ".file")("image.png")).Get<string>(),
+					props.Get(Property(propName + ".gamma")(2.2f)).Get<float>(),
+					ImageMapStorage::String2ChannelSelectionType(
+						props.Get(Property(propName + ".channel")("default")).Get<string>()),
+					ImageMapStorage::String2StorageType(
+						props.Get(Property(propName + ".storage")("auto")).Get<string>())));
+		}
+	}
+	imgMapCache.PreloadImageMaps(imgMapRequests);
+
 	BOOST_FOREACH(const string &key, texKeys) {
 		// Extract the texture name
 		const string texName = Property::ExtractField(key, 2);
@@ -85,7 +102,8 @@ void Scene::ParseTextures(const Properties &props) {
 		SDL_LOG("Texture definition: " << texName);
 
 		Texture *tex = CreateTexture(texName, props);
-		if (tex->GetType() == IMAGEMAP)
+		// Density grids are compiled for OpenCL with the image maps
+		if ((tex->GetType() == IMAGEMAP) || (tex->GetType() == DENSITYGRID_TEX))
 			editActions.AddAction(IMAGEMAPS_EDIT);
 
 		if (texDefs.IsTextureDefined(texName)) {
@@ -104,6 +122,8 @@ void Scene::ParseTextures(const Properties &props) {
 		}
 	}
 
+	imgMapCache.DeletePreloadedImageMaps();
+
 	editActions.AddActions(MATERIALS_EDIT | MATERIAL_TYPES_EDIT);
 }
 
@@ -151,6 +171,20 @@ Texture *Scene::CreateTexture(const string &texName, const Properties &props) {
 
 		return new CheckerBoard3DTexture(CreateTextureMapping3D(propName + ".mapping", props), tex1, tex2);
 	} else if (texType == "densitygrid") {
+        const string wrapMode = props.Get(Property(propName + ".wrap")("repeat")).Get<string>();
+
+		if (props.IsDefined(propName + ".file")) {
+			// A bricked volume file
+			const string fileName = props.Get(Property(propName + ".file")("volume.bvol")).Get<string>();
+			SparseDensityGrid *grid = SparseDensityGrid::LoadSerialized(fileName);
+
+			SDL_LOG("Density grid " << fileName << ": " << grid->GetNx() << "x" << grid->GetNy() << "x" << grid->GetNz() <<
+					" voxels, " << grid->GetStoredBrickCount() << "/" << grid->GetBrickCount() << " bricks stored, " <<
+					grid->GetMemorySize() / 1024 << "Kbytes");
+
+			return new DensityGridTexture(CreateTextureMapping3D(propName + ".mapping", props), grid, wrapMode, fileName);
+		}
+
 		if (!props.IsDefined(propName + ".nx") || !props.IsDefined(propName + ".ny") || !props.IsDefined(propName + ".nz"))
 			throw runtime_error("Missing dimensions property in densitygrid texture: " + propName);
 		if (!props.IsDefined(propName + ".data"))
@@ -159,7 +193,8 @@ Texture *Scene::CreateTexture(const string &texName, const Properties &props) {
 	    const u_int nx = props.Get(Property(propName + ".nx")(1)).Get<int>();
 	    const u_int ny = props.Get(Property(propName + ".ny")(1)).Get<int>();
 	    const u_int nz = props.Get(Property(propName + ".nz")(1)).Get<int>();
-        const string wrapMode = props.Get(Property(propName + ".wrap")("repeat")).Get<string>();
+		const ImageMapStorage::StorageType storageType = ImageMapStorage::String2StorageType(
+			props.Get(Property(propName + ".storage")("float")).Get<string>());
 		const Property &dt = props.Get(Property(propName + ".data"));
 
         const u_int data_size = nx*ny*nz;
@@ -171,11 +206,20 @@ Texture *Scene::CreateTexture(const string &texName, const Properties &props) {
 			throw runtime_error("Number of data elements doesn't match dimension of densitygrid texture: " + propName);
 
 		vector<float> data;
+		data.reserve(data_size);
 		for (u_int i = 0; i < dt.GetSize(); ++i) {
 			data.push_back(dt.Get<float>(i));
 		}
 
-		return new DensityGridTexture(CreateTextureMapping3D(propName + ".mapping", props), nx, ny, nz, &data[0], wrapMode);
+		DensityGridTexture *tex = new DensityGridTexture(CreateTextureMapping3D(propName + ".mapping", props),
+				nx, ny, nz, &data[0], wrapMode, storageType);
+
+		const SparseDensityGrid *grid = tex->GetGrid();
+		SDL_LOG("Density grid " << nx << "x" << ny << "x" << nz << " voxels, " <<
+				grid->GetStoredBrickCount() << "/" << grid->GetBrickCount() << " bricks stored, " <<
+				grid->GetMemorySize() / 1024 << "Kbytes (dense: " << data_size * sizeof(float) / 1024 << "Kbytes)");
+
+		return tex;
 	} else if (texType == "mix") {
 		const Texture *amtTex = GetTexture(props.Get(Property(propName + ".amount")(.5f)));
 		const Texture *tex1 = GetTexture(props.Get(Property(propName + ".texture1")(0.f)));
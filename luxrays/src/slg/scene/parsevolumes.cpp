@@ -130,8 +130,11 @@ Volume *Scene::CreateVolume(const u_int defaultVolID, const string &volName, con
 		const float stepSize =  props.Get(Property(propName + ".steps.size")(1.f)).Get<float>();
 		const u_int maxStepsCount =  props.Get(Property(propName + ".steps.maxcount")(32u)).Get<u_int>();
 		const bool multiScattering =  props.Get(Property(propName + ".multiscattering")(false)).Get<bool>();
+		const bool tracking =  props.Get(Property(propName + ".tracking.enable")(false)).Get<bool>();
+		const u_int trackingCellSize =  Max(1u, props.Get(Property(propName + ".tracking.cellsize")(8u)).Get<u_int>());
 
-		vol = new HeterogeneousVolume(iorTex, emissionTex, absorption, scattering, asymmetry, stepSize, maxStepsCount, multiScattering);
+		vol = new HeterogeneousVolume(iorTex, emissionTex, absorption, scattering, asymmetry, stepSize, maxStepsCount, multiScattering,
+				tracking, trackingCellSize);
 	} else
 		throw runtime_error("Unknown volume type: " + volType);
 
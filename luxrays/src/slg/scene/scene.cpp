@@ -36,6 +36,7 @@
 #include "luxrays/core/dataset.h"
 #include "luxrays/core/intersectiondevice.h"
 #include "luxrays/utils/properties.h"
+#include "luxrays/utils/timeline.h"
 #include "slg/core/sphericalfunction/sphericalfunction.h"
 #include "slg/editaction.h"
 #include "slg/samplers/sampler.h"
@@ -57,6 +58,7 @@ Scene::Scene(const string &fileName, const float imageScale) {
 
 	SDL_LOG("Reading scene: " << fileName);
 
+	TimelineScope timelineScope("Load scene ", fileName, "scene");
 	Properties scnProp(fileName);
 	Parse(scnProp);
 }
@@ -109,12 +111,16 @@ void Scene::Preprocess(Context *ctx,
 			throw runtime_error("The scene doesn't include any light source");*/
 	}
 
+	TimelineScope timelineScope("Scene preprocessing", "scene");
+
 	// Check if I have to update the camera
 	if (editActions.Has(CAMERA_EDIT))
 		PreprocessCamera(filmWidth, filmHeight, filmSubRegion);
 
 	// Check if I have to rebuild the dataset
 	if (editActions.Has(GEOMETRY_EDIT)) {
+		TimelineScope dataSetTimelineScope("DataSet build", "scene");
+
 		// Rebuild the data set
 		delete dataSet;
 		dataSet = new DataSet(ctx);
@@ -135,6 +141,7 @@ void Scene::Preprocess(Context *ctx,
 			editActions.Has(LIGHTS_EDIT) ||
 			editActions.Has(LIGHT_TYPES_EDIT) ||
 			editActions.Has(IMAGEMAPS_EDIT)) {
+		TimelineScope lightsTimelineScope("Light sources preprocessing", "scene");
 		lightDefs.Preprocess(this);
 	}
 
@@ -198,9 +205,27 @@ Properties Scene::ToProperties() {
 //--------------------------------------------------------------------------
 
 void Scene::DefineImageMap(const string &name, ImageMap *im) {
+	// The distributions of the old image map can not be used anymore
+	if (imgMapCache.IsImageMapDefined(name))
+		infiniteLightDistributionCache.Invalidate(imgMapCache.GetImageMap(name, 1.f,
+				ImageMapStorage::DEFAULT, ImageMapStorage::AUTO));
+
 	imgMapCache.DefineImageMap(name, im);
 
+	AddImageMapsEditAction();
+}
+
+void Scene::AddImageMapsEditAction() {
 	editActions.AddAction(IMAGEMAPS_EDIT);
+
+	// Density grids are compiled for OpenCL after the image maps so their
+	// indices can change and I need to update also the textures
+	for (u_int i = 0; i < texDefs.GetSize(); ++i) {
+		if (texDefs.GetTexture(i)->GetType() == DENSITYGRID_TEX) {
+			editActions.AddAction(MATERIALS_EDIT);
+			break;
+		}
+	}
 }
 
 bool Scene::IsImageMapDefined(const string &imgMapName) const {
@@ -262,43 +287,79 @@ void Scene::Parse(const Properties &props) {
 	// Read camera position and target
 	//--------------------------------------------------------------------------
 
+	double t0 = WallClockTime();
 	ParseCamera(props);
+	double t1 = WallClockTime();
+	const double cameraTime = t1 - t0;
+	Timeline::AddEvent("Parse camera", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all textures
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseTextures(props);
+	t1 = WallClockTime();
+	const double texturesTime = t1 - t0;
+	Timeline::AddEvent("Parse textures", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all volumes
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseVolumes(props);
+	t1 = WallClockTime();
+	const double volumesTime = t1 - t0;
+	Timeline::AddEvent("Parse volumes", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all materials
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseMaterials(props);
+	t1 = WallClockTime();
+	const double materialsTime = t1 - t0;
+	Timeline::AddEvent("Parse materials", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all shapes
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseShapes(props);
+	t1 = WallClockTime();
+	const double shapesTime = t1 - t0;
+	Timeline::AddEvent("Parse shapes", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all objects
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseObjects(props);
+	t1 = WallClockTime();
+	const double objectsTime = t1 - t0;
+	Timeline::AddEvent("Parse objects", "scene", t0, t1);
 
 	//--------------------------------------------------------------------------
 	// Read all env. lights
 	//--------------------------------------------------------------------------
 
+	t0 = t1;
 	ParseLights(props);
+	t1 = WallClockTime();
+	const double lightsTime = t1 - t0;
+	Timeline::AddEvent("Parse lights", "scene", t0, t1);
+
+	SDL_LOG("Scene parsing time: camera " << int(cameraTime * 1000.0) << "ms, " <<
+			"textures " << int(texturesTime * 1000.0) << "ms, " <<
+			"volumes " << int(volumesTime * 1000.0) << "ms, " <<
+			"materials " << int(materialsTime * 1000.0) << "ms, " <<
+			"shapes " << int(shapesTime * 1000.0) << "ms, " <<
+			"objects " << int(objectsTime * 1000.0) << "ms, " <<
+			"lights " << int(lightsTime * 1000.0) << "ms");
 }
 
 void Scene::UpdateObjectTransformation(const string &objName, const Transform &trans) {
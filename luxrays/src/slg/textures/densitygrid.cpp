@@ -27,10 +27,21 @@ using namespace slg;
 //------------------------------------------------------------------------------
 
 DensityGridTexture::DensityGridTexture(const TextureMapping3D *mp, const u_int nx, const u_int ny, const u_int nz,
-        const float *dt, const std::string wrapmode) : mapping(mp), nx(nx), ny(ny), nz(nz), data(nx*ny*nz), wrapMode(WRAP_REPEAT) {
+        const float *dt, const std::string wrapmode, const ImageMapStorage::StorageType storageType) :
+		mapping(mp), nx(nx), ny(ny), nz(nz), wrapMode(WRAP_REPEAT) {
+	grid = new SparseDensityGrid(nx, ny, nz, dt, storageType);
 
-	data.assign(dt, dt + nx * ny * nz);
+	SetWrapMode(wrapmode);
+}
+
+DensityGridTexture::DensityGridTexture(const TextureMapping3D *mp, SparseDensityGrid *g,
+		const std::string wrapmode, const std::string &fn) : mapping(mp),
+		nx(g->GetNx()), ny(g->GetNy()), nz(g->GetNz()), grid(g),
+		wrapMode(WRAP_REPEAT), fileName(fn) {
+	SetWrapMode(wrapmode);
+}
 
+void DensityGridTexture::SetWrapMode(const std::string &wrapmode) {
 	if(wrapmode == "black") { wrapMode = WRAP_BLACK; }
 	else if(wrapmode == "white") { wrapMode = WRAP_WHITE; }
 	else if(wrapmode == "clamp") wrapMode = WRAP_CLAMP;
@@ -135,11 +146,33 @@ Properties DensityGridTexture::ToProperties(const ImageMapCache &imgMapCache) co
 
 	const string name = GetName();
 	props.Set(Property("scene.textures." + name + ".type")("densitygrid"));
-	props.Set(Property("scene.textures." + name + ".nx")(nx));
-	props.Set(Property("scene.textures." + name + ".ny")(ny));
-	props.Set(Property("scene.textures." + name + ".nz")(nz));
 	props.Set(Property("scene.textures." + name + ".wrap")(wrap));
-	props.Set(Property("scene.textures." + name + ".data")(data));
+	if (fileName != "")
+		props.Set(Property("scene.textures." + name + ".file")(fileName));
+	else {
+		props.Set(Property("scene.textures." + name + ".nx")(nx));
+		props.Set(Property("scene.textures." + name + ".ny")(ny));
+		props.Set(Property("scene.textures." + name + ".nz")(nz));
+
+		vector<float> data;
+		grid->GetDenseData(data);
+		props.Set(Property("scene.textures." + name + ".data")(data));
+
+		string storage;
+		switch (grid->GetStorageType()) {
+			case ImageMapStorage::BYTE:
+				storage = "byte";
+				break;
+			case ImageMapStorage::HALF:
+				storage = "half";
+				break;
+			case ImageMapStorage::FLOAT:
+			default:
+				storage = "float";
+				break;
+		}
+		props.Set(Property("scene.textures." + name + ".storage")(storage));
+	}
 	props.Set(mapping->ToProperties("scene.textures." + name + ".mapping"));
 
 	return props;
@@ -0,0 +1,284 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstring>
+#include <fstream>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "slg/textures/sparsedensitygrid.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// SparseDensityGrid
+//------------------------------------------------------------------------------
+
+// Required when the constants are passed by reference (i.e. to vector::resize())
+const u_int SparseDensityGrid::BRICK_SIZE_SHIFT;
+const u_int SparseDensityGrid::BRICK_SIZE;
+const u_int SparseDensityGrid::BRICK_SIZE_MASK;
+const u_int SparseDensityGrid::BRICK_VOXEL_COUNT;
+const u_int SparseDensityGrid::CONSTANT_BRICK;
+
+SparseDensityGrid::SparseDensityGrid(const u_int x, const u_int y, const u_int z,
+		const float *data, const ImageMapStorage::StorageType st) :
+		nx(x), ny(y), nz(z), storedBrickCount(0), storageType(st) {
+	if (storageType == ImageMapStorage::AUTO)
+		storageType = ImageMapStorage::FLOAT;
+
+	bricksX = (nx + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT;
+	bricksY = (ny + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT;
+	bricksZ = (nz + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT;
+
+	const u_int brickCount = GetBrickCount();
+	brickIndices.resize(brickCount, CONSTANT_BRICK);
+	brickMins.resize(brickCount);
+	brickMaxs.resize(brickCount);
+
+	// Voxels outside of the grid (in the last bricks) replicate the border
+	// like the clamped lookups do
+	#define DENSE(x, y, z) (data[(static_cast<size_t>(Min((z), nz - 1)) * ny + Min((y), ny - 1)) * nx + Min((x), nx - 1)])
+
+	const size_t voxelSize = GetVoxelSize(storageType);
+	for (u_int bz = 0; bz < bricksZ; ++bz) {
+		for (u_int by = 0; by < bricksY; ++by) {
+			for (u_int bx = 0; bx < bricksX; ++bx) {
+				const u_int brickIndex = (bz * bricksY + by) * bricksX + bx;
+				const u_int x0 = bx << BRICK_SIZE_SHIFT;
+				const u_int y0 = by << BRICK_SIZE_SHIFT;
+				const u_int z0 = bz << BRICK_SIZE_SHIFT;
+
+				// Compute the brick bounds
+				float min = DENSE(x0, y0, z0);
+				float max = min;
+				for (u_int vz = 0; vz < BRICK_SIZE; ++vz)
+					for (u_int vy = 0; vy < BRICK_SIZE; ++vy)
+						for (u_int vx = 0; vx < BRICK_SIZE; ++vx) {
+							const float v = DENSE(x0 + vx, y0 + vy, z0 + vz);
+							min = Min(min, v);
+							max = Max(max, v);
+						}
+				brickMins[brickIndex] = min;
+				brickMaxs[brickIndex] = max;
+
+				// Constant bricks don't require any voxel storage
+				if (min == max)
+					continue;
+
+				const u_int storedBrickIndex = storedBrickCount++;
+				brickIndices[brickIndex] = storedBrickIndex;
+				voxels.resize(static_cast<size_t>(storedBrickCount) * BRICK_VOXEL_COUNT * voxelSize);
+
+				for (u_int vz = 0; vz < BRICK_SIZE; ++vz)
+					for (u_int vy = 0; vy < BRICK_SIZE; ++vy)
+						for (u_int vx = 0; vx < BRICK_SIZE; ++vx) {
+							const u_int voxelIndex = (((vz << BRICK_SIZE_SHIFT) + vy) << BRICK_SIZE_SHIFT) + vx;
+							EncodeVoxel(storedBrickIndex, voxelIndex,
+									DENSE(x0 + vx, y0 + vy, z0 + vz), min, max);
+						}
+			}
+		}
+	}
+
+	#undef DENSE
+}
+
+size_t SparseDensityGrid::GetVoxelSize(const ImageMapStorage::StorageType storageType) {
+	switch (storageType) {
+		case ImageMapStorage::BYTE:
+			return sizeof(u_char);
+		case ImageMapStorage::HALF:
+			return sizeof(half);
+		case ImageMapStorage::FLOAT:
+			return sizeof(float);
+		default:
+			throw runtime_error("Unknown storage type in SparseDensityGrid::GetVoxelSize(): " + boost::lexical_cast<string>(storageType));
+	}
+}
+
+size_t SparseDensityGrid::GetMemorySize() const {
+	return brickIndices.size() * sizeof(u_int) +
+			brickMins.size() * sizeof(float) +
+			brickMaxs.size() * sizeof(float) +
+			voxels.size() * sizeof(u_char);
+}
+
+void SparseDensityGrid::EncodeVoxel(const u_int storedBrickIndex, const u_int voxelIndex,
+		const float value, const float min, const float max) {
+	const size_t index = static_cast<size_t>(storedBrickIndex) * BRICK_VOXEL_COUNT + voxelIndex;
+
+	// Byte and half values are normalized in the brick [min, max] range
+	const float normalizedValue = Clamp((value - min) / (max - min), 0.f, 1.f);
+	switch (storageType) {
+		case ImageMapStorage::BYTE:
+			voxels[index] = static_cast<u_char>(Floor2UInt(normalizedValue * 255.f + .5f));
+			break;
+		case ImageMapStorage::HALF: {
+			const half h(normalizedValue);
+			memcpy(&voxels[index * sizeof(half)], &h, sizeof(half));
+			break;
+		}
+		case ImageMapStorage::FLOAT:
+			memcpy(&voxels[index * sizeof(float)], &value, sizeof(float));
+			break;
+		default:
+			throw runtime_error("Unknown storage type in SparseDensityGrid::EncodeVoxel(): " + boost::lexical_cast<string>(storageType));
+	}
+}
+
+float SparseDensityGrid::DecodeVoxel(const u_int brickIndex, const u_int storedBrickIndex,
+		const u_int voxelIndex) const {
+	const size_t index = static_cast<size_t>(storedBrickIndex) * BRICK_VOXEL_COUNT + voxelIndex;
+
+	switch (storageType) {
+		case ImageMapStorage::BYTE:
+			return Lerp(voxels[index] * (1.f / 255.f), brickMins[brickIndex], brickMaxs[brickIndex]);
+		case ImageMapStorage::HALF: {
+			half h;
+			memcpy(&h, &voxels[index * sizeof(half)], sizeof(half));
+			return Lerp(static_cast<float>(h), brickMins[brickIndex], brickMaxs[brickIndex]);
+		}
+		case ImageMapStorage::FLOAT: {
+			float v;
+			memcpy(&v, &voxels[index * sizeof(float)], sizeof(float));
+			return v;
+		}
+		default:
+			return 0.f;
+	}
+}
+
+float SparseDensityGrid::GetVoxel(const int x, const int y, const int z) const {
+	const u_int cx = Clamp(x, 0, static_cast<int>(nx) - 1);
+	const u_int cy = Clamp(y, 0, static_cast<int>(ny) - 1);
+	const u_int cz = Clamp(z, 0, static_cast<int>(nz) - 1);
+
+	const u_int brickIndex = ((cz >> BRICK_SIZE_SHIFT) * bricksY + (cy >> BRICK_SIZE_SHIFT)) * bricksX +
+			(cx >> BRICK_SIZE_SHIFT);
+	const u_int storedBrickIndex = brickIndices[brickIndex];
+	if (storedBrickIndex == CONSTANT_BRICK)
+		return brickMins[brickIndex];
+
+	const u_int voxelIndex = ((((cz & BRICK_SIZE_MASK) << BRICK_SIZE_SHIFT) +
+			(cy & BRICK_SIZE_MASK)) << BRICK_SIZE_SHIFT) + (cx & BRICK_SIZE_MASK);
+
+	return DecodeVoxel(brickIndex, storedBrickIndex, voxelIndex);
+}
+
+void SparseDensityGrid::GetDenseData(vector<float> &data) const {
+	data.resize(static_cast<size_t>(nx) * ny * nz);
+
+	for (u_int z = 0; z < nz; ++z)
+		for (u_int y = 0; y < ny; ++y)
+			for (u_int x = 0; x < nx; ++x)
+				data[(static_cast<size_t>(z) * ny + y) * nx + x] = GetVoxel(x, y, z);
+}
+
+//------------------------------------------------------------------------------
+// Serialization
+//------------------------------------------------------------------------------
+
+bool SparseDensityGrid::IsValid() const {
+	if ((nx == 0) || (ny == 0) || (nz == 0) ||
+			(bricksX != (nx + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT) ||
+			(bricksY != (ny + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT) ||
+			(bricksZ != (nz + BRICK_SIZE - 1) >> BRICK_SIZE_SHIFT))
+		return false;
+
+	if ((storageType != ImageMapStorage::BYTE) &&
+			(storageType != ImageMapStorage::HALF) &&
+			(storageType != ImageMapStorage::FLOAT))
+		return false;
+
+	const size_t brickCount = static_cast<size_t>(bricksX) * bricksY * bricksZ;
+	if ((brickIndices.size() != brickCount) ||
+			(brickMins.size() != brickCount) ||
+			(brickMaxs.size() != brickCount))
+		return false;
+
+	if (voxels.size() != static_cast<size_t>(storedBrickCount) * BRICK_VOXEL_COUNT * GetVoxelSize(storageType))
+		return false;
+
+	for (size_t i = 0; i < brickCount; ++i) {
+		if ((brickIndices[i] != CONSTANT_BRICK) && (brickIndices[i] >= storedBrickCount))
+			return false;
+	}
+
+	return true;
+}
+
+SparseDensityGrid *SparseDensityGrid::LoadSerialized(const std::string &fileName) {
+	ifstream inFile;
+	inFile.exceptions(ifstream::failbit | ifstream::badbit | ifstream::eofbit);
+	inFile.open(fileName.c_str(), ios_base::in | ios_base::binary);
+
+	// Enable compression
+	boost::iostreams::filtering_stream<boost::iostreams::input> gzipStream;
+	gzipStream.push(boost::iostreams::gzip_decompressor());
+	gzipStream.push(inFile);
+
+	boost::archive::binary_iarchive inArchive(gzipStream);
+
+	SparseDensityGrid *grid;
+	inArchive >> grid;
+
+	if (!grid->IsValid()) {
+		delete grid;
+		throw runtime_error("Corrupted bricked volume file: " + fileName);
+	}
+
+	return grid;
+}
+
+void SparseDensityGrid::SaveSerialized(const std::string &fileName, const SparseDensityGrid *grid) {
+	ofstream outFile;
+	outFile.exceptions(ofstream::failbit | ofstream::badbit | ofstream::eofbit);
+	outFile.open(fileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+
+	// Enable compression
+	boost::iostreams::filtering_stream<boost::iostreams::output> gzipStream;
+	gzipStream.push(boost::iostreams::gzip_compressor(4));
+	gzipStream.push(outFile);
+
+	boost::archive::binary_oarchive outArchive(gzipStream);
+	outArchive << grid;
+}
+
+template<class Archive> void SparseDensityGrid::serialize(Archive &ar, const u_int version) {
+	ar & nx;
+	ar & ny;
+	ar & nz;
+	ar & bricksX;
+	ar & bricksY;
+	ar & bricksZ;
+	ar & storedBrickCount;
+	ar & storageType;
+
+	ar & brickIndices;
+	ar & brickMins;
+	ar & brickMaxs;
+	ar & voxels;
+}
@@ -18,6 +18,8 @@
 
 #include <cstddef>
 
+#include "luxrays/core/randomgen.h"
+#include "slg/slg.h"
 #include "slg/volumes/heterogenous.h"
 #include "slg/bsdf/bsdf.h"
 
@@ -32,11 +34,36 @@ using namespace slg;
 HeterogeneousVolume::HeterogeneousVolume(const Texture *iorTex, const Texture *emiTex,
 		const Texture *a, const Texture *s, const Texture *g,
 		const float ss, const u_int maxStepC,
-		const bool multiScat) : Volume(iorTex, emiTex),
+		const bool multiScat, const bool track, const u_int trackCellSize) :
+		Volume(iorTex, emiTex),
 		schlickScatter(this, g), stepSize(ss), maxStepsCount(maxStepC),
-		multiScattering(multiScat) {
+		multiScattering(multiScat), tracking(track),
+		trackingCellSize(trackCellSize), majorantGrid(NULL) {
 	sigmaA = a;
 	sigmaS = s;
+
+	UpdateMajorantGrid();
+}
+
+HeterogeneousVolume::~HeterogeneousVolume() {
+	delete majorantGrid;
+}
+
+void HeterogeneousVolume::UpdateMajorantGrid() {
+	delete majorantGrid;
+	majorantGrid = NULL;
+
+	if (tracking) {
+		majorantGrid = VolumeMajorantGrid::Create(sigmaA, sigmaS, trackingCellSize);
+
+		if (majorantGrid) {
+			SLG_LOG("Heterogeneous volume majorant grid cells: " << majorantGrid->GetCellCount());
+		} else {
+			SLG_LOG("WARNING: heterogeneous volume absorption and scattering are not "
+					"supported by tracking (they must be densitygrid, constant or "
+					"scale of the two textures), falling back to ray marching");
+		}
+	}
 }
 
 Spectrum HeterogeneousVolume::SigmaA(const HitPoint &hitPoint) const {
@@ -47,7 +74,157 @@ Spectrum HeterogeneousVolume::SigmaS(const HitPoint &hitPoint) const {
 	return sigmaS->GetSpectrumValue(hitPoint).Clamp();
 }
 
-float HeterogeneousVolume::Scatter(const Ray &ray, const float initialU,
+float HeterogeneousVolume::Scatter(const Ray &ray, const float u,
+		const bool scatteredStart, Spectrum *connectionThroughput,
+		Spectrum *connectionEmission) const {
+	if (majorantGrid)
+		return ScatterTracking(ray, u, scatteredStart, connectionThroughput, connectionEmission);
+	else
+		return ScatterRayMarching(ray, u, scatteredStart, connectionThroughput, connectionEmission);
+}
+
+//------------------------------------------------------------------------------
+// Delta/ratio tracking
+//
+// Tentative collisions are sampled with the piecewise constant majorant of
+// the grid cells crossed by the ray, so empty space is skipped in a single
+// step. The scattering point is selected with spectral tracking while
+// transmittance is estimated with ratio tracking. Both estimators are
+// unbiased.
+//------------------------------------------------------------------------------
+
+// Upper bound of the tentative collisions and cell crossings of one ray
+static const u_int trackingMaxIterations = 4096;
+// Weight below which ratio tracking is stopped with Russian roulette
+static const float trackingRRWeight = .1f;
+
+float HeterogeneousVolume::ScatterTracking(const Ray &ray, const float u,
+		const bool scatteredStart, Spectrum *connectionThroughput,
+		Spectrum *connectionEmission) const {
+	const bool scatterAllowed = (!scatteredStart || multiScattering);
+
+	// The first free flight is sampled with u, the following with a random
+	// number sequence seeded with u. The seed is computed in double precision
+	// because u * 4294967295.f rounds up to 2^32 (out of range) as u -> 1.
+	TauswortheRandomGenerator rng(static_cast<u_int>(Clamp(static_cast<double>(u), 0.0, 1.0) * 4294967295.0));
+	float freeFlightU = u;
+
+	HitPoint hitPoint =  {
+		ray.d,
+		ray(ray.mint),
+		UV(),
+		Normal(-ray.d),
+		Normal(-ray.d),
+		Spectrum(1.f),
+		Vector(0.f, 0.f, 0.f), Vector(0.f, 0.f, 0.f),
+		Normal(0.f, 0.f, 0.f), Normal(0.f, 0.f, 0.f),
+		1.f,
+		0.f, // It doesn't matter here
+		Transform(),
+		this, this, // It doesn't matter here
+		true, true // It doesn't matter here
+	};
+
+	const Ray gridRay = majorantGrid->ToGridSpace(ray);
+
+	// As with ray marching, an infinite ray is evaluated only up to
+	// stepSize * maxStepsCount. Otherwise, outside of a repeated or clamped
+	// grid, the tracking would never end.
+	const float maxT = (ray.maxt == numeric_limits<float>::infinity()) ?
+		(ray.mint + stepSize * maxStepsCount) : ray.maxt;
+
+	Spectrum weight(1.f), emission;
+	float t = ray.mint;
+	float scatterT = -1.f;
+	for (u_int i = 0; (i < trackingMaxIterations) && (t < maxT); ++i) {
+		float tExit;
+		const float majorant = majorantGrid->GetMajorant(gridRay, t, &tExit);
+		tExit = Min(tExit, maxT);
+
+		// Skip empty space
+		if (majorant <= 0.f) {
+			// There are no collisions where to estimate the volume emission
+			// so it is estimated with one sample of the whole segment
+			if (volumeEmissionTex) {
+				hitPoint.p = ray(t + rng.floatValue() * (tExit - t));
+				emission += weight * (tExit - t) * volumeEmissionTex->GetSpectrumValue(hitPoint).Clamp();
+			}
+
+			t = tExit;
+			continue;
+		}
+
+		// Sample a tentative collision
+		const float dt = -logf(1.f - freeFlightU) / majorant;
+		freeFlightU = rng.floatValue();
+		if (t + dt >= tExit) {
+			// No collision inside this cell, exponential distribution is
+			// memoryless so I can restart from the cell exit
+			t = tExit;
+			continue;
+		}
+		t += dt;
+
+		hitPoint.p = ray(t);
+		const Spectrum sigmaS = SigmaS(hitPoint);
+		const Spectrum sigmaT = sigmaS + SigmaA(hitPoint);
+		const Spectrum sigmaN = Spectrum(majorant) - sigmaT;
+
+		// Collision estimator of volume emission
+		if (volumeEmissionTex)
+			emission += weight * volumeEmissionTex->GetSpectrumValue(hitPoint).Clamp() / majorant;
+
+		if (scatterAllowed) {
+			// Spectral tracking
+			const float pScatter = Spectrum((weight * sigmaS).Abs()).Filter();
+			const float pNull = Spectrum((weight * sigmaN).Abs()).Filter();
+			const float pTotal = pScatter + pNull;
+			if (pTotal <= 0.f) {
+				weight = Spectrum();
+				break;
+			}
+
+			if (rng.floatValue() * pTotal < pScatter) {
+				// SigmaT instead of SigmaS because the albedo is applied
+				// by SchlickScatter::Evaluate()
+				weight *= sigmaT * (pTotal / (majorant * pScatter));
+				scatterT = t;
+				break;
+			} else
+				weight *= sigmaN * (pTotal / (majorant * pNull));
+		} else {
+			// Ratio tracking
+			weight *= sigmaN / majorant;
+
+			// Russian roulette
+			const float maxWeight = Max(weight.c[0], Max(weight.c[1], weight.c[2]));
+			if (maxWeight < trackingRRWeight) {
+				const float prob = maxWeight / trackingRRWeight;
+				if (rng.floatValue() >= prob) {
+					weight = Spectrum();
+					break;
+				}
+
+				weight /= prob;
+			}
+		}
+	}
+
+	// Add volume emission
+	if (volumeEmissionTex)
+		*connectionEmission += *connectionThroughput * emission;
+
+	// Apply volume transmittance
+	*connectionThroughput *= weight;
+
+	return scatterT;
+}
+
+//------------------------------------------------------------------------------
+// Ray marching
+//------------------------------------------------------------------------------
+
+float HeterogeneousVolume::ScatterRayMarching(const Ray &ray, const float initialU,
 		const bool scatteredStart, Spectrum *connectionThroughput,
 		Spectrum *connectionEmission) const {
 	// Compute the number of steps to evaluate the volume
@@ -215,6 +392,16 @@ void HeterogeneousVolume::UpdateTextureReferences(const Texture *oldTex, const T
 		sigmaS = newTex;
 	if (schlickScatter.g == oldTex)
 		schlickScatter.g = newTex;
+
+	// The majorant grid has to be rebuilt if the density has been edited
+	if (tracking) {
+		boost::unordered_set<const Texture *> referencedTexs;
+		sigmaA->AddReferencedTextures(referencedTexs);
+		sigmaS->AddReferencedTextures(referencedTexs);
+
+		if (referencedTexs.count(newTex))
+			UpdateMajorantGrid();
+	}
 }
 
 Properties HeterogeneousVolume::ToProperties() const {
@@ -228,6 +415,8 @@ Properties HeterogeneousVolume::ToProperties() const {
 	props.Set(Property("scene.volumes." + name + ".multiscattering")(multiScattering));
 	props.Set(Property("scene.volumes." + name + ".steps.size")(stepSize));
 	props.Set(Property("scene.volumes." + name + ".steps.maxcount")(maxStepsCount));
+	props.Set(Property("scene.volumes." + name + ".tracking.enable")(tracking));
+	props.Set(Property("scene.volumes." + name + ".tracking.cellsize")(trackingCellSize));
 	props.Set(Volume::ToProperties());
 
 	return props;
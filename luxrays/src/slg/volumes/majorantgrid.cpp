@@ -0,0 +1,209 @@
+/***************************************************************************
+ * Copyright 1998-2015 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxRender.                                       *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <limits>
+
+#include "luxrays/core/epsilon.h"
+#include "luxrays/core/geometry/bbox.h"
+#include "slg/volumes/majorantgrid.h"
+#include "slg/textures/constfloat.h"
+#include "slg/textures/constfloat3.h"
+#include "slg/textures/densitygrid.h"
+#include "slg/textures/scale.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// VolumeMajorantGrid
+//------------------------------------------------------------------------------
+
+// Bounds the value of a texture with scale * density + offset, where density is
+// the value of a DensityGridTexture. Returns false if the texture is not supported.
+static bool BoundTexture(const Texture *tex, const DensityGridTexture **densityTex,
+		float *scale, float *offset) {
+	switch (tex->GetType()) {
+		case CONST_FLOAT:
+			*scale = 0.f;
+			*offset = Max(static_cast<const ConstFloatTexture *>(tex)->GetValue(), 0.f);
+			return true;
+		case CONST_FLOAT3: {
+			const Spectrum &c = static_cast<const ConstFloat3Texture *>(tex)->GetColor();
+			*scale = 0.f;
+			*offset = Max(Max(c.c[0], Max(c.c[1], c.c[2])), 0.f);
+			return true;
+		}
+		case DENSITYGRID_TEX: {
+			const DensityGridTexture *dgt = static_cast<const DensityGridTexture *>(tex);
+			// Only one density grid can be used
+			if (*densityTex && (*densityTex != dgt))
+				return false;
+			// The grid space must be an affine transformation of the world space
+			if (dgt->GetTextureMapping()->GetType() == UVMAPPING3D)
+				return false;
+
+			*densityTex = dgt;
+			*scale = 1.f;
+			*offset = 0.f;
+			return true;
+		}
+		case SCALE_TEX: {
+			const ScaleTexture *st = static_cast<const ScaleTexture *>(tex);
+
+			float scale1, offset1, scale2, offset2;
+			if (!BoundTexture(st->GetTexture1(), densityTex, &scale1, &offset1) ||
+					!BoundTexture(st->GetTexture2(), densityTex, &scale2, &offset2))
+				return false;
+
+			// One of the 2 textures must be a constant
+			if (scale1 == 0.f) {
+				*scale = offset1 * scale2;
+				*offset = offset1 * offset2;
+			} else if (scale2 == 0.f) {
+				*scale = offset2 * scale1;
+				*offset = offset2 * offset1;
+			} else
+				return false;
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+VolumeMajorantGrid *VolumeMajorantGrid::Create(const Texture *sigmaA, const Texture *sigmaS,
+		const u_int cellSize) {
+	const DensityGridTexture *densityTex = NULL;
+	float scaleA, offsetA, scaleS, offsetS;
+	if (!BoundTexture(sigmaA, &densityTex, &scaleA, &offsetA) ||
+			!BoundTexture(sigmaS, &densityTex, &scaleS, &offsetS) ||
+			!densityTex)
+		return NULL;
+
+	return new VolumeMajorantGrid(densityTex, scaleA + scaleS, offsetA + offsetS, cellSize);
+}
+
+VolumeMajorantGrid::VolumeMajorantGrid(const DensityGridTexture *densityTex,
+		const float scale, const float offset, const u_int cs) {
+	worldToGrid = densityTex->GetTextureMapping()->worldToLocal;
+
+	const int nx = densityTex->GetNx();
+	const int ny = densityTex->GetNy();
+	const int nz = densityTex->GetNz();
+	const int cellSize = Max<int>(cs, 1);
+
+	cellCountX = (nx + cellSize - 1) / cellSize;
+	cellCountY = (ny + cellSize - 1) / cellSize;
+	cellCountZ = (nz + cellSize - 1) / cellSize;
+	cellSizeX = cellSize / static_cast<float>(nx);
+	cellSizeY = cellSize / static_cast<float>(ny);
+	cellSizeZ = cellSize / static_cast<float>(nz);
+
+	majorants.resize(cellCountX * cellCountY * cellCountZ);
+	maxMajorant = 0.f;
+	for (u_int cz = 0; cz < cellCountZ; ++cz) {
+		for (u_int cy = 0; cy < cellCountY; ++cy) {
+			for (u_int cx = 0; cx < cellCountX; ++cx) {
+				// The +1 is the apron required by the trilinear interpolation
+				// of the last voxel of the cell
+				float maxDensity = 0.f;
+				for (int z = cz * cellSize; z <= static_cast<int>((cz + 1) * cellSize); ++z)
+					for (int y = cy * cellSize; y <= static_cast<int>((cy + 1) * cellSize); ++y)
+						for (int x = cx * cellSize; x <= static_cast<int>((cx + 1) * cellSize); ++x)
+							maxDensity = Max(maxDensity, densityTex->GetVoxel(x, y, z));
+
+				const float majorant = scale * maxDensity + offset;
+				majorants[(cz * cellCountY + cy) * cellCountX + cx] = majorant;
+				maxMajorant = Max(maxMajorant, majorant);
+			}
+		}
+	}
+
+	switch (densityTex->GetWrapMode()) {
+		case DensityGridTexture::WRAP_BLACK:
+			outsideMajorant = offset;
+			break;
+		case DensityGridTexture::WRAP_WHITE:
+			outsideMajorant = scale + offset;
+			break;
+		case DensityGridTexture::WRAP_REPEAT:
+		case DensityGridTexture::WRAP_CLAMP:
+		default:
+			outsideMajorant = maxMajorant;
+			break;
+	}
+	maxMajorant = Max(maxMajorant, outsideMajorant);
+}
+
+static inline float CellExit(const float o, const float d, const int cell, const float cellSize) {
+	if (d > 0.f)
+		return ((cell + 1) * cellSize - o) / d;
+	else if (d < 0.f)
+		return (cell * cellSize - o) / d;
+	else
+		return numeric_limits<float>::infinity();
+}
+
+static inline int CellIndex(const float p, const float d, const float cellSize, const u_int cellCount) {
+	const float f = p / cellSize;
+	int cell = Clamp(Floor2Int(f), 0, static_cast<int>(cellCount) - 1);
+	// On a cell boundary, pick the cell the ray is moving into
+	if ((d < 0.f) && (cell > 0) && (f == cell))
+		--cell;
+
+	return cell;
+}
+
+float VolumeMajorantGrid::GetMajorant(const Ray &gridRay, const float t, float *tExit) const {
+	const Point p = gridRay(t);
+
+	float majorant;
+	if ((p.x < 0.f) || (p.x > 1.f) ||
+			(p.y < 0.f) || (p.y > 1.f) ||
+			(p.z < 0.f) || (p.z > 1.f)) {
+		// Outside of the grid, look for where the ray enters the grid
+		const Ray r(gridRay.o, gridRay.d, t, numeric_limits<float>::infinity());
+		float t0, t1;
+		if (BBox::IntersectP(r, Point(0.f, 0.f, 0.f), Point(1.f, 1.f, 1.f), &t0, &t1))
+			*tExit = t0;
+		else
+			*tExit = numeric_limits<float>::infinity();
+
+		majorant = outsideMajorant;
+	} else {
+		const int cx = CellIndex(p.x, gridRay.d.x, cellSizeX, cellCountX);
+		const int cy = CellIndex(p.y, gridRay.d.y, cellSizeY, cellCountY);
+		const int cz = CellIndex(p.z, gridRay.d.z, cellSizeZ, cellCountZ);
+
+		*tExit = Min(CellExit(gridRay.o.x, gridRay.d.x, cx, cellSizeX),
+				Min(CellExit(gridRay.o.y, gridRay.d.y, cy, cellSizeY),
+				CellExit(gridRay.o.z, gridRay.d.z, cz, cellSizeZ)));
+		// The last cells can extend past the grid domain
+		*tExit = Min(*tExit, Min(CellExit(gridRay.o.x, gridRay.d.x, 0, 1.f),
+				Min(CellExit(gridRay.o.y, gridRay.d.y, 0, 1.f),
+				CellExit(gridRay.o.z, gridRay.d.z, 0, 1.f))));
+
+		majorant = Cell(cx, cy, cz);
+	}
+
+	// Always move forward, even in case of numerical errors on cell boundaries
+	*tExit = Max(*tExit, t + MachineEpsilon::E(t));
+
+	return majorant;
+}